@@ -0,0 +1,19 @@
+#ifndef __ATOMICS_KERNELS_ARM__
+#define __ATOMICS_KERNELS_ARM__
+
+#include <stdbool.h>
+
+#include "../../common/atomickernels.h"
+
+// The same kernels, compiled twice: with LSE (FEAT_LSE, single
+// instruction atomics) and forcing the classic exclusive load/store
+// (LL/SC) loops. If the compiler could not build one of them, the
+// corresponding *_compiled function returns false and the kernels
+// must not be used.
+
+bool atomics_lse_compiled(void);
+bool atomics_llsc_compiled(void);
+extern const atomic_fn atomics_lse[ATOMIC_NUM_OPS];
+extern const atomic_fn atomics_llsc[ATOMIC_NUM_OPS];
+
+#endif
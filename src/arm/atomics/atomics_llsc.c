@@ -0,0 +1,18 @@
+#include "../../common/global.h"
+#include "atomics.h"
+
+// Compiled without LSE and without outline atomics (which would pick
+// LSE at runtime), so every atomic is an exclusive load/store loop
+#ifndef __ARM_FEATURE_ATOMICS
+bool atomics_llsc_compiled(void) {
+  return true;
+}
+
+const atomic_fn atomics_llsc[ATOMIC_NUM_OPS] = ATOMIC_KERNELS;
+#else
+bool atomics_llsc_compiled(void) {
+  return false;
+}
+
+const atomic_fn atomics_llsc[ATOMIC_NUM_OPS] = { NULL };
+#endif
@@ -0,0 +1,16 @@
+#include "../../common/global.h"
+#include "atomics.h"
+
+#ifdef __ARM_FEATURE_ATOMICS
+bool atomics_lse_compiled(void) {
+  return true;
+}
+
+const atomic_fn atomics_lse[ATOMIC_NUM_OPS] = ATOMIC_KERNELS;
+#else
+bool atomics_lse_compiled(void) {
+  return false;
+}
+
+const atomic_fn atomics_lse[ATOMIC_NUM_OPS] = { NULL };
+#endif
@@ -0,0 +1,52 @@
+#include <stdint.h>
+
+#include "copy.h"
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+
+// Sizes that are not a multiple of the vector width are handled
+// with a last (overlapping) vector aligned to the end of the buffer
+void copy_neon(void* dst, const void* src, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+  const uint8_t* s = (const uint8_t *) src;
+
+  if(n < 16) {
+    for(size_t i=0; i < n; i++) d[i] = s[i];
+    return;
+  }
+
+  uint8x16_t last = vld1q_u8(s + n - 16);
+  uint8_t* end = d + n - 16;
+
+  for(; n >= 64; d += 64, s += 64, n -= 64) {
+    uint8x16x4_t v = vld1q_u8_x4(s);
+    vst1q_u8_x4(d, v);
+  }
+  for(; n >= 16; d += 16, s += 16, n -= 16) {
+    vst1q_u8(d, vld1q_u8(s));
+  }
+  vst1q_u8(end, last);
+}
+
+void set_neon(void* dst, int c, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+
+  if(n < 16) {
+    for(size_t i=0; i < n; i++) d[i] = (uint8_t) c;
+    return;
+  }
+
+  uint8x16_t v = vdupq_n_u8((uint8_t) c);
+  uint8x16x4_t v4 = { { v, v, v, v } };
+  uint8_t* end = d + n - 16;
+
+  for(; n >= 64; d += 64, n -= 64) {
+    vst1q_u8_x4(d, v4);
+  }
+  for(; n >= 16; d += 16, n -= 16) {
+    vst1q_u8(d, v);
+  }
+  vst1q_u8(end, v);
+}
+#endif
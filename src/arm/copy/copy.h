@@ -0,0 +1,25 @@
+#ifndef __COPY_KERNELS__
+#define __COPY_KERNELS__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Copy and set kernels used by the memcpy/memset benchmark. The SVE
+// and MOPS versions live in their own files, compiled with the
+// corresponding flags. If the compiler does not support them, the
+// *_compiled functions return false and the kernels must not be used.
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+void copy_neon(void* dst, const void* src, size_t n);
+void set_neon(void* dst, int c, size_t n);
+#endif
+
+bool copy_sve_compiled(void);
+void copy_sve(void* dst, const void* src, size_t n);
+void set_sve(void* dst, int c, size_t n);
+
+bool copy_mops_compiled(void);
+void copy_mops(void* dst, const void* src, size_t n);
+void set_mops(void* dst, int c, size_t n);
+
+#endif
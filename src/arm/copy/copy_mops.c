@@ -0,0 +1,49 @@
+#include <stdint.h>
+
+#include "../../common/global.h"
+#include "copy.h"
+
+#ifdef __ARM_FEATURE_MOPS
+bool copy_mops_compiled(void) {
+  return true;
+}
+
+// FEAT_MOPS splits memcpy/memset in prologue, main and epilogue
+// instructions, which must be issued back to back
+void copy_mops(void* dst, const void* src, size_t n) {
+  __asm volatile("cpyfp [%0]!, [%1]!, %2!\n\t"
+                 "cpyfm [%0]!, [%1]!, %2!\n\t"
+                 "cpyfe [%0]!, [%1]!, %2!"
+                 : "+r"(dst), "+r"(src), "+r"(n)
+                 :
+                 : "memory", "cc");
+}
+
+void set_mops(void* dst, int c, size_t n) {
+  uint64_t v = (uint8_t) c;
+  __asm volatile("setp [%0]!, %1!, %2\n\t"
+                 "setm [%0]!, %1!, %2\n\t"
+                 "sete [%0]!, %1!, %2"
+                 : "+r"(dst), "+r"(n)
+                 : "r"(v)
+                 : "memory", "cc");
+}
+#else
+bool copy_mops_compiled(void) {
+  return false;
+}
+
+void copy_mops(void* dst, const void* src, size_t n) {
+  UNUSED(dst);
+  UNUSED(src);
+  UNUSED(n);
+  printBug("copy_mops: MOPS was not enabled by the compiler");
+}
+
+void set_mops(void* dst, int c, size_t n) {
+  UNUSED(dst);
+  UNUSED(c);
+  UNUSED(n);
+  printBug("set_mops: MOPS was not enabled by the compiler");
+}
+#endif
@@ -0,0 +1,52 @@
+#include <stdint.h>
+
+#include "../../common/global.h"
+#include "copy.h"
+
+#ifdef __ARM_FEATURE_SVE
+#include <arm_sve.h>
+
+bool copy_sve_compiled(void) {
+  return true;
+}
+
+// The predicate of the last iteration covers the tail,
+// so no special case is needed for any size
+void copy_sve(void* dst, const void* src, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+  const uint8_t* s = (const uint8_t *) src;
+
+  for(uint64_t i=0; i < n; i += svcntb()) {
+    svbool_t pg = svwhilelt_b8_u64(i, n);
+    svst1_u8(pg, d + i, svld1_u8(pg, s + i));
+  }
+}
+
+void set_sve(void* dst, int c, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+  svuint8_t v = svdup_n_u8((uint8_t) c);
+
+  for(uint64_t i=0; i < n; i += svcntb()) {
+    svbool_t pg = svwhilelt_b8_u64(i, n);
+    svst1_u8(pg, d + i, v);
+  }
+}
+#else
+bool copy_sve_compiled(void) {
+  return false;
+}
+
+void copy_sve(void* dst, const void* src, size_t n) {
+  UNUSED(dst);
+  UNUSED(src);
+  UNUSED(n);
+  printBug("copy_sve: SVE was not enabled by the compiler");
+}
+
+void set_sve(void* dst, int c, size_t n) {
+  UNUSED(dst);
+  UNUSED(c);
+  UNUSED(n);
+  printBug("set_sve: SVE was not enabled by the compiler");
+}
+#endif
@@ -0,0 +1,298 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "../../common/global.h"
+#include "crypto.h"
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRYPTO) && defined(__ARM_FEATURE_CRC32)
+#include <arm_neon.h>
+#include <arm_acle.h>
+
+// Same as in the x86 version (see src/x86/crypto/crypto_crc.c)
+#define CRC_BLOCK  1024
+#define CRC_K1     0x170076FA
+#define CRC_K2     0xA51B6135
+
+bool crypto_ce_compiled(void) {
+  return true;
+}
+
+// aese with a zero key and the word replicated in the 4 columns
+// is just SubBytes, since ShiftRows does not change anything
+static inline uint32_t aes_sub_word(uint32_t w) {
+  uint8x16_t v = vaeseq_u8(vreinterpretq_u8_u32(vdupq_n_u32(w)), vdupq_n_u8(0));
+  return vgetq_lane_u32(vreinterpretq_u32_u8(v), 0);
+}
+
+void aes128_expand_key_ce(const uint8_t* key, uint8_t* round_keys) {
+  static const uint8_t rcon[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36 };
+  uint32_t w[44];
+
+  memcpy(w, key, 16);
+  for(int i=4; i < 44; i++) {
+    uint32_t t = w[i-1];
+    if(i % 4 == 0) {
+      t = aes_sub_word(t);
+      t = ((t >> 8) | (t << 24)) ^ rcon[i/4 - 1];
+    }
+    w[i] = w[i-4] ^ t;
+  }
+  memcpy(round_keys, w, sizeof(w));
+}
+
+static inline uint8x16_t ctr_block(uint32x4_t base, uint32_t ctr) {
+  return vreinterpretq_u8_u32(vsetq_lane_u32(__builtin_bswap32(ctr), base, 3));
+}
+
+static inline uint8x16_t aes128_encrypt(uint8x16_t b, const uint8x16_t* rk) {
+  for(int r=0; r < 9; r++) b = vaesmcq_u8(vaeseq_u8(b, rk[r]));
+  return veorq_u8(vaeseq_u8(b, rk[9]), rk[10]);
+}
+
+// 8 independent blocks per iteration to hide the latency of aese/aesmc
+void aes128_ctr_ce(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n) {
+  uint8x16_t rk[11];
+  uint8x16_t b[8];
+  uint32x4_t base = vreinterpretq_u32_u8(vld1q_u8(ctr));
+  uint32_t c = __builtin_bswap32(vgetq_lane_u32(base, 3));
+
+  for(int i=0; i < 11; i++) rk[i] = vld1q_u8(round_keys + 16*i);
+
+  for(; n >= 128; n -= 128, in += 128, out += 128, c += 8) {
+    for(int j=0; j < 8; j++) b[j] = ctr_block(base, c + j);
+    for(int r=0; r < 9; r++) {
+      for(int j=0; j < 8; j++) b[j] = vaesmcq_u8(vaeseq_u8(b[j], rk[r]));
+    }
+    for(int j=0; j < 8; j++) {
+      b[j] = veorq_u8(vaeseq_u8(b[j], rk[9]), rk[10]);
+      vst1q_u8(out + 16*j, veorq_u8(vld1q_u8(in + 16*j), b[j]));
+    }
+  }
+
+  for(; n >= 16; n -= 16, in += 16, out += 16, c++) {
+    uint8x16_t x = aes128_encrypt(ctr_block(base, c), rk);
+    vst1q_u8(out, veorq_u8(vld1q_u8(in), x));
+  }
+}
+
+// GHASH is implemented exactly as the x86 version (see ghash_pclmul in
+// src/x86/crypto/crypto_aesni.c), translating each SSE operation
+#define SLL_BYTES(x, n) vextq_u8(vdupq_n_u8(0), x, 16 - (n))
+#define SRL_BYTES(x, n) vextq_u8(x, vdupq_n_u8(0), n)
+#define SLL32(x, n) vreinterpretq_u8_u32(vshlq_n_u32(vreinterpretq_u32_u8(x), n))
+#define SRL32(x, n) vreinterpretq_u8_u32(vshrq_n_u32(vreinterpretq_u32_u8(x), n))
+
+static inline uint8x16_t bswap128(uint8x16_t x) {
+  x = vrev64q_u8(x);
+  return vextq_u8(x, x, 8);
+}
+
+static inline uint8x16_t clmul(uint8x16_t a, int ia, uint8x16_t b, int ib) {
+  poly64x2_t pa = vreinterpretq_p64_u8(a);
+  poly64x2_t pb = vreinterpretq_p64_u8(b);
+  poly64_t x = ia ? vgetq_lane_p64(pa, 1) : vgetq_lane_p64(pa, 0);
+  poly64_t y = ib ? vgetq_lane_p64(pb, 1) : vgetq_lane_p64(pb, 0);
+  return vreinterpretq_u8_p128(vmull_p64(x, y));
+}
+
+static inline void gf_mul_unreduced(uint8x16_t a, uint8x16_t b, uint8x16_t* lo, uint8x16_t* hi) {
+  uint8x16_t t0 = clmul(a, 0, b, 0);
+  uint8x16_t t1 = veorq_u8(clmul(a, 0, b, 1), clmul(a, 1, b, 0));
+  uint8x16_t t3 = clmul(a, 1, b, 1);
+
+  *lo = veorq_u8(t0, SLL_BYTES(t1, 8));
+  *hi = veorq_u8(t3, SRL_BYTES(t1, 8));
+}
+
+static inline uint8x16_t gf_reduce(uint8x16_t lo, uint8x16_t hi) {
+  uint8x16_t t7 = SRL32(lo, 31);
+  uint8x16_t t8 = SRL32(hi, 31);
+  lo = SLL32(lo, 1);
+  hi = SLL32(hi, 1);
+
+  uint8x16_t t9 = SRL_BYTES(t7, 12);
+  t8 = SLL_BYTES(t8, 4);
+  t7 = SLL_BYTES(t7, 4);
+  lo = vorrq_u8(lo, t7);
+  hi = vorrq_u8(hi, t8);
+  hi = vorrq_u8(hi, t9);
+
+  t7 = veorq_u8(veorq_u8(SLL32(lo, 31), SLL32(lo, 30)), SLL32(lo, 25));
+  t8 = SRL_BYTES(t7, 4);
+  t7 = SLL_BYTES(t7, 12);
+  lo = veorq_u8(lo, t7);
+
+  uint8x16_t t2 = veorq_u8(veorq_u8(SRL32(lo, 1), SRL32(lo, 2)), SRL32(lo, 7));
+  t2 = veorq_u8(t2, t8);
+  lo = veorq_u8(lo, t2);
+  return veorq_u8(hi, lo);
+}
+
+static inline uint8x16_t gf_mul(uint8x16_t a, uint8x16_t b) {
+  uint8x16_t lo;
+  uint8x16_t hi;
+  gf_mul_unreduced(a, b, &lo, &hi);
+  return gf_reduce(lo, hi);
+}
+
+void ghash_pmull(const uint8_t* h, uint8_t* y, const uint8_t* in, size_t n) {
+  uint8x16_t h1 = bswap128(vld1q_u8(h));
+  uint8x16_t h2 = gf_mul(h1, h1);
+  uint8x16_t h3 = gf_mul(h2, h1);
+  uint8x16_t h4 = gf_mul(h3, h1);
+  uint8x16_t x = bswap128(vld1q_u8(y));
+
+  for(; n >= 64; n -= 64, in += 64) {
+    uint8x16_t lo, hi, l, m;
+
+    gf_mul_unreduced(veorq_u8(x, bswap128(vld1q_u8(in))), h4, &lo, &hi);
+    gf_mul_unreduced(bswap128(vld1q_u8(in + 16)), h3, &l, &m);
+    lo = veorq_u8(lo, l); hi = veorq_u8(hi, m);
+    gf_mul_unreduced(bswap128(vld1q_u8(in + 32)), h2, &l, &m);
+    lo = veorq_u8(lo, l); hi = veorq_u8(hi, m);
+    gf_mul_unreduced(bswap128(vld1q_u8(in + 48)), h1, &l, &m);
+    lo = veorq_u8(lo, l); hi = veorq_u8(hi, m);
+    x = gf_reduce(lo, hi);
+  }
+
+  for(; n >= 16; n -= 16, in += 16) {
+    x = gf_mul(veorq_u8(x, bswap128(vld1q_u8(in))), h1);
+  }
+
+  vst1q_u8(y, bswap128(x));
+}
+
+static const uint32_t sha256_k[64] = {
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+// Each group of 4 rounds g uses the message words in m[g%4] and, for
+// the first 12 groups, computes the words used 4 groups later. It is a
+// macro so that every index and condition is a constant.
+#define SHA256_GROUP(g) do {                                                                          \
+  uint32x4_t wk = vaddq_u32(m[(g)%4], vld1q_u32(&sha256_k[4*(g)]));                                   \
+  if((g) < 12) m[(g)%4] = vsha256su1q_u32(vsha256su0q_u32(m[(g)%4], m[((g)+1)%4]), m[((g)+2)%4], m[((g)+3)%4]); \
+  uint32x4_t tmp = s0;                                                                                \
+  s0 = vsha256hq_u32(s0, s1, wk);                                                                     \
+  s1 = vsha256h2q_u32(s1, tmp, wk);                                                                   \
+} while(0)
+
+void sha256_blocks_ce(uint32_t* state, const uint8_t* data, size_t nblocks) {
+  uint32x4_t s0 = vld1q_u32(&state[0]);
+  uint32x4_t s1 = vld1q_u32(&state[4]);
+  uint32x4_t m[4];
+
+  for(; nblocks > 0; nblocks--, data += 64) {
+    uint32x4_t abcd = s0;
+    uint32x4_t efgh = s1;
+
+    for(int g=0; g < 4; g++) m[g] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + 16*g)));
+
+    SHA256_GROUP(0);  SHA256_GROUP(1);  SHA256_GROUP(2);  SHA256_GROUP(3);
+    SHA256_GROUP(4);  SHA256_GROUP(5);  SHA256_GROUP(6);  SHA256_GROUP(7);
+    SHA256_GROUP(8);  SHA256_GROUP(9);  SHA256_GROUP(10); SHA256_GROUP(11);
+    SHA256_GROUP(12); SHA256_GROUP(13); SHA256_GROUP(14); SHA256_GROUP(15);
+
+    s0 = vaddq_u32(s0, abcd);
+    s1 = vaddq_u32(s1, efgh);
+  }
+
+  vst1q_u32(&state[0], s0);
+  vst1q_u32(&state[4], s1);
+}
+
+uint32_t crc32c_armv8(uint32_t crc, const uint8_t* data, size_t n) {
+  uint64_t w;
+
+  for(; n >= 8; n -= 8, data += 8) {
+    memcpy(&w, data, 8);
+    crc = __crc32cd(crc, w);
+  }
+  for(; n > 0; n--, data++) crc = __crc32cb(crc, *data);
+  return crc;
+}
+
+static inline uint32_t crc32c_shift(uint32_t crc, uint32_t k) {
+  poly128_t p = vmull_p64((poly64_t) crc, (poly64_t) k);
+  return __crc32cd(0, vgetq_lane_u64(vreinterpretq_u64_p128(p), 0));
+}
+
+// As in x86, 3 independent streams are needed to hide the latency of crc32cx
+uint32_t crc32c_armv8_3way(uint32_t crc, const uint8_t* data, size_t n) {
+  uint64_t w0, w1, w2;
+
+  for(; n >= 3 * CRC_BLOCK; n -= 3 * CRC_BLOCK, data += 3 * CRC_BLOCK) {
+    uint32_t c0 = crc;
+    uint32_t c1 = 0;
+    uint32_t c2 = 0;
+
+    for(size_t i=0; i < CRC_BLOCK; i += 8) {
+      memcpy(&w0, data + i, 8);
+      memcpy(&w1, data + CRC_BLOCK + i, 8);
+      memcpy(&w2, data + 2 * CRC_BLOCK + i, 8);
+      c0 = __crc32cd(c0, w0);
+      c1 = __crc32cd(c1, w1);
+      c2 = __crc32cd(c2, w2);
+    }
+
+    crc = crc32c_shift(c0, CRC_K2) ^ crc32c_shift(c1, CRC_K1) ^ c2;
+  }
+
+  return crc32c_armv8(crc, data, n);
+}
+#else
+bool crypto_ce_compiled(void) {
+  return false;
+}
+
+void aes128_expand_key_ce(const uint8_t* key, uint8_t* round_keys) {
+  UNUSED(key);
+  UNUSED(round_keys);
+  printBug("aes128_expand_key_ce: Crypto extensions were not enabled by the compiler");
+}
+
+void aes128_ctr_ce(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n) {
+  UNUSED(round_keys);
+  UNUSED(ctr);
+  UNUSED(in);
+  UNUSED(out);
+  UNUSED(n);
+  printBug("aes128_ctr_ce: Crypto extensions were not enabled by the compiler");
+}
+
+void ghash_pmull(const uint8_t* h, uint8_t* y, const uint8_t* in, size_t n) {
+  UNUSED(h);
+  UNUSED(y);
+  UNUSED(in);
+  UNUSED(n);
+  printBug("ghash_pmull: Crypto extensions were not enabled by the compiler");
+}
+
+void sha256_blocks_ce(uint32_t* state, const uint8_t* data, size_t nblocks) {
+  UNUSED(state);
+  UNUSED(data);
+  UNUSED(nblocks);
+  printBug("sha256_blocks_ce: Crypto extensions were not enabled by the compiler");
+}
+
+uint32_t crc32c_armv8(uint32_t crc, const uint8_t* data, size_t n) {
+  UNUSED(data);
+  UNUSED(n);
+  printBug("crc32c_armv8: CRC32 instructions were not enabled by the compiler");
+  return crc;
+}
+
+uint32_t crc32c_armv8_3way(uint32_t crc, const uint8_t* data, size_t n) {
+  UNUSED(data);
+  UNUSED(n);
+  printBug("crc32c_armv8_3way: CRC32 instructions were not enabled by the compiler");
+  return crc;
+}
+#endif
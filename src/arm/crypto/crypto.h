@@ -0,0 +1,25 @@
+#ifndef __CRYPTO_KERNELS__
+#define __CRYPTO_KERNELS__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Crypto and checksum primitives used by the crypto benchmark (ARMv8
+// Cryptographic Extension and CRC32 instructions). crypto.c is compiled
+// with the flags that enable them; if the compiler does not support them,
+// crypto_ce_compiled returns false and the kernels must not be used.
+// Sizes passed to the AES and GHASH functions must be a multiple of 16
+// bytes. aes128_ctr_ce increments the last 32 bits of the counter block
+// (as in GCM).
+
+bool crypto_ce_compiled(void);
+
+void aes128_expand_key_ce(const uint8_t* key, uint8_t* round_keys);
+void aes128_ctr_ce(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n);
+void ghash_pmull(const uint8_t* h, uint8_t* y, const uint8_t* in, size_t n);
+void sha256_blocks_ce(uint32_t* state, const uint8_t* data, size_t nblocks);
+uint32_t crc32c_armv8(uint32_t crc, const uint8_t* data, size_t n);
+uint32_t crc32c_armv8_3way(uint32_t crc, const uint8_t* data, size_t n);
+
+#endif
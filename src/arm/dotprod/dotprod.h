@@ -0,0 +1,52 @@
+#ifndef __DOTPROD_KERNELS__
+#define __DOTPROD_KERNELS__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Throughput kernels of the int8/BF16 benchmark. Each kernel runs
+// DOT_PER_ITER independent instructions per iteration. The NEON and
+// SVE kernels live in their own files, compiled with the flags that
+// enable the instructions; the tables only contain the kernels that
+// the compiler was able to build, and each kernel must only be called
+// if the CPU supports the feature in requires.
+
+#define DOT_PER_ITER  32
+
+enum {
+  DOT_REQ_DOTPROD,
+  DOT_REQ_I8MM,
+  DOT_REQ_BF16,
+  DOT_REQ_SVE,
+  DOT_REQ_SVEI8MM,
+  DOT_REQ_SVEBF16
+};
+
+typedef void (*dot_fn)(uint64_t iters);
+
+struct dot_kernel {
+  const char* name;
+  const char* type;
+  int requires;
+  // Operations (multiplies and adds) per instruction and 128 bits
+  int ops;
+  // SVE kernels scale with the vector length
+  bool scalable;
+  dot_fn fn;
+};
+
+extern const struct dot_kernel dot_kernels_neon[];
+extern const int dot_num_kernels_neon;
+extern const struct dot_kernel dot_kernels_sve[];
+extern const int dot_num_kernels_sve;
+
+// 16 accumulators hide the latency (3-4 cycles) of up to 4 pipes.
+// They skip v8-v15/z8-z15 (callee-saved); the sources are 16 and 17
+#define DOT_CHAINS(OP) OP(0) OP(1) OP(2) OP(3) OP(4) OP(5) OP(6) OP(7) \
+                       OP(18) OP(19) OP(20) OP(21) OP(22) OP(23) OP(24) OP(25)
+#define DOT_LOOP_BEGIN "1:\n\t"
+#define DOT_LOOP_END   "subs %0, %0, #1\n\t" "b.ne 1b\n\t"
+#define DOT_CLOBBERS   "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v16", "v17", \
+                       "v18", "v19", "v20", "v21", "v22", "v23", "v24", "v25", "cc"
+
+#endif
@@ -0,0 +1,61 @@
+#include <stddef.h>
+
+#include "../../common/global.h"
+#include "dotprod.h"
+
+#ifdef __aarch64__
+
+// The int8 sources are all ones and the BF16 ones are 0.5 (0x3F00),
+// which keeps the FP32 accumulators far from special values
+#define INIT_ZERO(n) "movi v" #n ".16b, #0\n\t"
+#define INIT_B "movi v16.16b, #1\n\t" "movi v17.16b, #1\n\t" DOT_CHAINS(INIT_ZERO)
+#define INIT_H "movi v16.8h, #0x3f, lsl #8\n\t" "movi v17.8h, #0x3f, lsl #8\n\t" DOT_CHAINS(INIT_ZERO)
+
+#define DOT_KERNEL(name, OP, init)                                                \
+  static void name(uint64_t iters) {                                              \
+    __asm volatile(init DOT_LOOP_BEGIN DOT_CHAINS(OP) DOT_CHAINS(OP) DOT_LOOP_END \
+                   : "+r"(iters) : : DOT_CLOBBERS);                                \
+  }
+
+#ifdef __ARM_FEATURE_DOTPROD
+#define OP_SDOT(n) "sdot v" #n ".4s, v16.16b, v17.16b\n\t"
+#define OP_UDOT(n) "udot v" #n ".4s, v16.16b, v17.16b\n\t"
+DOT_KERNEL(sdot_4s, OP_SDOT, INIT_B)
+DOT_KERNEL(udot_4s, OP_UDOT, INIT_B)
+#endif
+
+#ifdef __ARM_FEATURE_MATMUL_INT8
+#define OP_SMMLA(n) "smmla v" #n ".4s, v16.16b, v17.16b\n\t"
+#define OP_UMMLA(n) "ummla v" #n ".4s, v16.16b, v17.16b\n\t"
+DOT_KERNEL(smmla_4s, OP_SMMLA, INIT_B)
+DOT_KERNEL(ummla_4s, OP_UMMLA, INIT_B)
+#endif
+
+#ifdef __ARM_FEATURE_BF16_VECTOR_ARITHMETIC
+#define OP_BFDOT(n)  "bfdot v" #n ".4s, v16.8h, v17.8h\n\t"
+#define OP_BFMMLA(n) "bfmmla v" #n ".4s, v16.8h, v17.8h\n\t"
+DOT_KERNEL(bfdot_4s,  OP_BFDOT,  INIT_H)
+DOT_KERNEL(bfmmla_4s, OP_BFMMLA, INIT_H)
+#endif
+
+#endif // #ifdef __aarch64__
+
+// Per 128 bits: SDOT does 4x4 multiply-adds, SMMLA a 2x8 by 8x2 matrix
+// product (32), BFDOT 4x2 and BFMMLA a 2x4 by 4x2 product (16)
+const struct dot_kernel dot_kernels_neon[] = {
+#if defined(__aarch64__) && defined(__ARM_FEATURE_DOTPROD)
+  { "sdot v.4s",   "int8", DOT_REQ_DOTPROD, 32, false, sdot_4s },
+  { "udot v.4s",   "int8", DOT_REQ_DOTPROD, 32, false, udot_4s },
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_MATMUL_INT8)
+  { "smmla v.4s",  "int8", DOT_REQ_I8MM,    64, false, smmla_4s },
+  { "ummla v.4s",  "int8", DOT_REQ_I8MM,    64, false, ummla_4s },
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_BF16_VECTOR_ARITHMETIC)
+  { "bfdot v.4s",  "bf16", DOT_REQ_BF16,    16, false, bfdot_4s },
+  { "bfmmla v.4s", "bf16", DOT_REQ_BF16,    32, false, bfmmla_4s },
+#endif
+  { NULL, NULL, 0, 0, false, NULL }
+};
+
+const int dot_num_kernels_neon = sizeof(dot_kernels_neon) / sizeof(dot_kernels_neon[0]) - 1;
@@ -0,0 +1,57 @@
+#include <stddef.h>
+
+#include "../../common/global.h"
+#include "dotprod.h"
+
+#ifdef __ARM_FEATURE_SVE
+
+// Same sources as the NEON kernels: int8 ones and BF16 0.5 (0x3F00)
+#define INIT_ZERO(n) "mov z" #n ".d, #0\n\t"
+#define INIT_B "mov z16.b, #1\n\t" "mov z17.b, #1\n\t" DOT_CHAINS(INIT_ZERO)
+#define INIT_H "mov z16.h, #0x3f00\n\t" "mov z17.h, #0x3f00\n\t" DOT_CHAINS(INIT_ZERO)
+
+#define DOT_KERNEL(name, OP, init)                                                \
+  static void name(uint64_t iters) {                                              \
+    __asm volatile(init DOT_LOOP_BEGIN DOT_CHAINS(OP) DOT_CHAINS(OP) DOT_LOOP_END \
+                   : "+r"(iters) : : DOT_CLOBBERS);                                \
+  }
+
+// SDOT/UDOT are part of the base SVE
+#define OP_SDOT(n) "sdot z" #n ".s, z16.b, z17.b\n\t"
+#define OP_UDOT(n) "udot z" #n ".s, z16.b, z17.b\n\t"
+DOT_KERNEL(sve_sdot_s, OP_SDOT, INIT_B)
+DOT_KERNEL(sve_udot_s, OP_UDOT, INIT_B)
+
+#ifdef __ARM_FEATURE_SVE_MATMUL_INT8
+#define OP_SMMLA(n) "smmla z" #n ".s, z16.b, z17.b\n\t"
+#define OP_UMMLA(n) "ummla z" #n ".s, z16.b, z17.b\n\t"
+DOT_KERNEL(sve_smmla_s, OP_SMMLA, INIT_B)
+DOT_KERNEL(sve_ummla_s, OP_UMMLA, INIT_B)
+#endif
+
+#ifdef __ARM_FEATURE_SVE_BF16
+#define OP_BFDOT(n)  "bfdot z" #n ".s, z16.h, z17.h\n\t"
+#define OP_BFMMLA(n) "bfmmla z" #n ".s, z16.h, z17.h\n\t"
+DOT_KERNEL(sve_bfdot_s,  OP_BFDOT,  INIT_H)
+DOT_KERNEL(sve_bfmmla_s, OP_BFMMLA, INIT_H)
+#endif
+
+#endif // #ifdef __ARM_FEATURE_SVE
+
+const struct dot_kernel dot_kernels_sve[] = {
+#ifdef __ARM_FEATURE_SVE
+  { "sdot z.s",   "int8", DOT_REQ_SVE,     32, true, sve_sdot_s },
+  { "udot z.s",   "int8", DOT_REQ_SVE,     32, true, sve_udot_s },
+#endif
+#if defined(__ARM_FEATURE_SVE) && defined(__ARM_FEATURE_SVE_MATMUL_INT8)
+  { "smmla z.s",  "int8", DOT_REQ_SVEI8MM, 64, true, sve_smmla_s },
+  { "ummla z.s",  "int8", DOT_REQ_SVEI8MM, 64, true, sve_ummla_s },
+#endif
+#if defined(__ARM_FEATURE_SVE) && defined(__ARM_FEATURE_SVE_BF16)
+  { "bfdot z.s",  "bf16", DOT_REQ_SVEBF16, 16, true, sve_bfdot_s },
+  { "bfmmla z.s", "bf16", DOT_REQ_SVEBF16, 32, true, sve_bfmmla_s },
+#endif
+  { NULL, NULL, 0, 0, false, NULL }
+};
+
+const int dot_num_kernels_sve = sizeof(dot_kernels_sve) / sizeof(dot_kernels_sve[0]) - 1;
@@ -0,0 +1,25 @@
+#ifndef __GATHER_KERNELS__
+#define __GATHER_KERNELS__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Gather, scatter and masked load/store kernels used by the gather
+// benchmark. They live in a file compiled with the SVE flags. If the
+// compiler does not support SVE, gather_sve_compiled returns false
+// and the kernels must not be used.
+//
+// gather:  returns the (wrapping) sum of table[idx[i]]
+// scatter: table[idx[i]] = val[i]
+// masked:  dst[i] = src[i] for every i where mask[i] is not zero
+
+bool gather_sve_compiled(void);
+uint32_t gather32_sve(const int32_t* table, const int32_t* idx, size_t n);
+uint64_t gather64_sve(const int64_t* table, const int64_t* idx, size_t n);
+void scatter32_sve(int32_t* table, const int32_t* idx, const int32_t* val, size_t n);
+void scatter64_sve(int64_t* table, const int64_t* idx, const int64_t* val, size_t n);
+void masked32_sve(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n);
+void masked64_sve(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n);
+
+#endif
@@ -0,0 +1,118 @@
+#include "../../common/global.h"
+#include "gather.h"
+
+#ifdef __ARM_FEATURE_SVE
+#include <arm_sve.h>
+
+bool gather_sve_compiled(void) {
+  return true;
+}
+
+// As in the copy kernels, the predicate of the last iteration
+// covers the tail, so no special case is needed for any size
+uint32_t gather32_sve(const int32_t* table, const int32_t* idx, size_t n) {
+  svuint32_t acc = svdup_n_u32(0);
+
+  for(uint64_t i=0; i < n; i += svcntw()) {
+    svbool_t pg = svwhilelt_b32_u64(i, n);
+    svint32_t vi = svld1_s32(pg, idx + i);
+    acc = svadd_u32_m(pg, acc, svld1_gather_s32index_u32(pg, (const uint32_t *) table, vi));
+  }
+
+  return (uint32_t) svaddv_u32(svptrue_b32(), acc);
+}
+
+uint64_t gather64_sve(const int64_t* table, const int64_t* idx, size_t n) {
+  svuint64_t acc = svdup_n_u64(0);
+
+  for(uint64_t i=0; i < n; i += svcntd()) {
+    svbool_t pg = svwhilelt_b64_u64(i, n);
+    svint64_t vi = svld1_s64(pg, idx + i);
+    acc = svadd_u64_m(pg, acc, svld1_gather_s64index_u64(pg, (const uint64_t *) table, vi));
+  }
+
+  return svaddv_u64(svptrue_b64(), acc);
+}
+
+void scatter32_sve(int32_t* table, const int32_t* idx, const int32_t* val, size_t n) {
+  for(uint64_t i=0; i < n; i += svcntw()) {
+    svbool_t pg = svwhilelt_b32_u64(i, n);
+    svst1_scatter_s32index_s32(pg, table, svld1_s32(pg, idx + i), svld1_s32(pg, val + i));
+  }
+}
+
+void scatter64_sve(int64_t* table, const int64_t* idx, const int64_t* val, size_t n) {
+  for(uint64_t i=0; i < n; i += svcntd()) {
+    svbool_t pg = svwhilelt_b64_u64(i, n);
+    svst1_scatter_s64index_s64(pg, table, svld1_s64(pg, idx + i), svld1_s64(pg, val + i));
+  }
+}
+
+void masked32_sve(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n) {
+  for(uint64_t i=0; i < n; i += svcntw()) {
+    svbool_t pg = svwhilelt_b32_u64(i, n);
+    svbool_t pm = svcmpne_n_s32(pg, svld1_s32(pg, mask + i), 0);
+    svst1_s32(pm, dst + i, svld1_s32(pm, src + i));
+  }
+}
+
+void masked64_sve(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n) {
+  for(uint64_t i=0; i < n; i += svcntd()) {
+    svbool_t pg = svwhilelt_b64_u64(i, n);
+    svbool_t pm = svcmpne_n_s64(pg, svld1_s64(pg, mask + i), 0);
+    svst1_s64(pm, dst + i, svld1_s64(pm, src + i));
+  }
+}
+#else
+bool gather_sve_compiled(void) {
+  return false;
+}
+
+uint32_t gather32_sve(const int32_t* table, const int32_t* idx, size_t n) {
+  UNUSED(table);
+  UNUSED(idx);
+  UNUSED(n);
+  printBug("gather32_sve: SVE was not enabled by the compiler");
+  return 0;
+}
+
+uint64_t gather64_sve(const int64_t* table, const int64_t* idx, size_t n) {
+  UNUSED(table);
+  UNUSED(idx);
+  UNUSED(n);
+  printBug("gather64_sve: SVE was not enabled by the compiler");
+  return 0;
+}
+
+void scatter32_sve(int32_t* table, const int32_t* idx, const int32_t* val, size_t n) {
+  UNUSED(table);
+  UNUSED(idx);
+  UNUSED(val);
+  UNUSED(n);
+  printBug("scatter32_sve: SVE was not enabled by the compiler");
+}
+
+void scatter64_sve(int64_t* table, const int64_t* idx, const int64_t* val, size_t n) {
+  UNUSED(table);
+  UNUSED(idx);
+  UNUSED(val);
+  UNUSED(n);
+  printBug("scatter64_sve: SVE was not enabled by the compiler");
+}
+
+void masked32_sve(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n) {
+  UNUSED(dst);
+  UNUSED(src);
+  UNUSED(mask);
+  UNUSED(n);
+  printBug("masked32_sve: SVE was not enabled by the compiler");
+}
+
+void masked64_sve(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n) {
+  UNUSED(dst);
+  UNUSED(src);
+  UNUSED(mask);
+  UNUSED(n);
+  printBug("masked64_sve: SVE was not enabled by the compiler");
+}
+#endif
@@ -0,0 +1,30 @@
+#ifndef __GEMM_KERNELS__
+#define __GEMM_KERNELS__
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Register-blocked microkernels of the GEMM benchmark. The NEON kernels
+// need AArch64 and the SVE ones live in a file compiled with the SVE
+// flags; gemm_neon_compiled and gemm_sve_compiled return false when
+// the compiler could not build them, and then they must not be used.
+//
+// Each kernel computes C += A * B on a MR x NR tile of C (row major,
+// with leading dimension ldc), where A is a MR x kc panel packed by
+// columns (MR consecutive elements for each k) and B is a kc x NR panel
+// packed by rows (NR consecutive elements for each k). The tile is two
+// vectors wide, so NR is twice the number of elements of a vector (of
+// the current SVE vector length for the SVE kernels).
+
+#define GEMM_MR_NEON  8
+#define GEMM_MR_SVE   8
+
+bool gemm_neon_compiled(void);
+void sgemm_neon(int kc, const float* a, const float* b, float* c, size_t ldc);
+void dgemm_neon(int kc, const double* a, const double* b, double* c, size_t ldc);
+
+bool gemm_sve_compiled(void);
+void sgemm_sve(int kc, const float* a, const float* b, float* c, size_t ldc);
+void dgemm_sve(int kc, const double* a, const double* b, double* c, size_t ldc);
+
+#endif
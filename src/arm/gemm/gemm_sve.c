@@ -0,0 +1,106 @@
+#include "../../common/global.h"
+#include "gemm.h"
+
+#ifdef __ARM_FEATURE_SVE
+#include <arm_sve.h>
+
+bool gemm_sve_compiled(void) {
+  return true;
+}
+
+// Same 8x2 tile as the NEON kernels, but two SVE vectors wide. The A
+// elements are replicated to every 128 bit segment with LD1RQ, so the
+// indexed FMLA can use them without broadcasts.
+
+#define SGEMM_LOAD(i) \
+  svfloat32_t c##i##0 = svld1_f32(pg, c + i*ldc); \
+  svfloat32_t c##i##1 = svld1_f32(pg, c + i*ldc + vl);
+
+#define SGEMM_ROW(i, av, lane) \
+  c##i##0 = svmla_lane_f32(c##i##0, b0, av, lane); \
+  c##i##1 = svmla_lane_f32(c##i##1, b1, av, lane);
+
+#define SGEMM_STORE(i) \
+  svst1_f32(pg, c + i*ldc, c##i##0); \
+  svst1_f32(pg, c + i*ldc + vl, c##i##1);
+
+void sgemm_sve(int kc, const float* a, const float* b, float* c, size_t ldc) {
+  svbool_t pg = svptrue_b32();
+  uint64_t vl = svcntw();
+  SGEMM_LOAD(0) SGEMM_LOAD(1) SGEMM_LOAD(2) SGEMM_LOAD(3)
+  SGEMM_LOAD(4) SGEMM_LOAD(5) SGEMM_LOAD(6) SGEMM_LOAD(7)
+
+  for(int p=0; p < kc; p++) {
+    svfloat32_t a0 = svld1rq_f32(pg, a);
+    svfloat32_t a1 = svld1rq_f32(pg, a + 4);
+    svfloat32_t b0 = svld1_f32(pg, b);
+    svfloat32_t b1 = svld1_f32(pg, b + vl);
+    SGEMM_ROW(0, a0, 0) SGEMM_ROW(1, a0, 1) SGEMM_ROW(2, a0, 2) SGEMM_ROW(3, a0, 3)
+    SGEMM_ROW(4, a1, 0) SGEMM_ROW(5, a1, 1) SGEMM_ROW(6, a1, 2) SGEMM_ROW(7, a1, 3)
+    a += GEMM_MR_SVE;
+    b += 2 * vl;
+  }
+
+  SGEMM_STORE(0) SGEMM_STORE(1) SGEMM_STORE(2) SGEMM_STORE(3)
+  SGEMM_STORE(4) SGEMM_STORE(5) SGEMM_STORE(6) SGEMM_STORE(7)
+}
+
+#define DGEMM_LOAD(i) \
+  svfloat64_t c##i##0 = svld1_f64(pg, c + i*ldc); \
+  svfloat64_t c##i##1 = svld1_f64(pg, c + i*ldc + vl);
+
+#define DGEMM_ROW(i, av, lane) \
+  c##i##0 = svmla_lane_f64(c##i##0, b0, av, lane); \
+  c##i##1 = svmla_lane_f64(c##i##1, b1, av, lane);
+
+#define DGEMM_STORE(i) \
+  svst1_f64(pg, c + i*ldc, c##i##0); \
+  svst1_f64(pg, c + i*ldc + vl, c##i##1);
+
+void dgemm_sve(int kc, const double* a, const double* b, double* c, size_t ldc) {
+  svbool_t pg = svptrue_b64();
+  uint64_t vl = svcntd();
+  DGEMM_LOAD(0) DGEMM_LOAD(1) DGEMM_LOAD(2) DGEMM_LOAD(3)
+  DGEMM_LOAD(4) DGEMM_LOAD(5) DGEMM_LOAD(6) DGEMM_LOAD(7)
+
+  for(int p=0; p < kc; p++) {
+    svfloat64_t a0 = svld1rq_f64(pg, a);
+    svfloat64_t a1 = svld1rq_f64(pg, a + 2);
+    svfloat64_t a2 = svld1rq_f64(pg, a + 4);
+    svfloat64_t a3 = svld1rq_f64(pg, a + 6);
+    svfloat64_t b0 = svld1_f64(pg, b);
+    svfloat64_t b1 = svld1_f64(pg, b + vl);
+    DGEMM_ROW(0, a0, 0) DGEMM_ROW(1, a0, 1) DGEMM_ROW(2, a1, 0) DGEMM_ROW(3, a1, 1)
+    DGEMM_ROW(4, a2, 0) DGEMM_ROW(5, a2, 1) DGEMM_ROW(6, a3, 0) DGEMM_ROW(7, a3, 1)
+    a += GEMM_MR_SVE;
+    b += 2 * vl;
+  }
+
+  DGEMM_STORE(0) DGEMM_STORE(1) DGEMM_STORE(2) DGEMM_STORE(3)
+  DGEMM_STORE(4) DGEMM_STORE(5) DGEMM_STORE(6) DGEMM_STORE(7)
+}
+
+#else
+bool gemm_sve_compiled(void) {
+  return false;
+}
+
+void sgemm_sve(int kc, const float* a, const float* b, float* c, size_t ldc) {
+  UNUSED(kc);
+  UNUSED(a);
+  UNUSED(b);
+  UNUSED(c);
+  UNUSED(ldc);
+  printBug("sgemm_sve: SVE was not enabled by the compiler");
+}
+
+void dgemm_sve(int kc, const double* a, const double* b, double* c, size_t ldc) {
+  UNUSED(kc);
+  UNUSED(a);
+  UNUSED(b);
+  UNUSED(c);
+  UNUSED(ldc);
+  printBug("dgemm_sve: SVE was not enabled by the compiler");
+}
+
+#endif // #ifdef __ARM_FEATURE_SVE
@@ -0,0 +1,166 @@
+#include <stddef.h>
+
+#include "insn.h"
+
+enum {
+  ISA_BASE,
+  ISA_NEON,
+  ISA_SVE
+};
+
+#ifdef __aarch64__
+
+// Registers of each chain: x8-x15 for integer kernels (the constant
+// source is x6) and v0-v7 for FP and vector kernels. FP kernels keep
+// every chain at exactly 1.0 (x+0, x*1, x/1, sqrt(x), x+0*0), so no
+// denormal or special value shows up
+#define G_0 "x8"
+#define G_1 "x9"
+#define G_2 "x10"
+#define G_3 "x11"
+#define G_4 "x12"
+#define G_5 "x13"
+#define G_6 "x14"
+#define G_7 "x15"
+#define G(n)    G_##n
+#define S(n)    "s" #n
+#define D(n)    "d" #n
+#define V8B(n)  "v" #n ".8b"
+#define V16B(n) "v" #n ".16b"
+#define V4S(n)  "v" #n ".4s"
+#define V2D(n)  "v" #n ".2d"
+
+// Operand forms. The chain always goes through the destination
+// register d, and s is the constant source
+#define OP2(ins, s, R, d)     ins " " R(d) ", " R(d) "\n\t"
+#define OP3(ins, s, R, d)     ins " " R(d) ", " R(d) ", " R(s) "\n\t"
+#define OPFMLA(ins, s, R, d)  ins " " R(d) ", " R(s) ", " R(s) "\n\t"
+#define OPFMADD(ins, s, R, d) ins " " R(d) ", " R(s) ", " R(s) ", " R(d) "\n\t"
+#define OPTBL(ins, s, R, d)   ins " " R(d) ", {" R(d) "}, " R(s) "\n\t"
+#define OPEXT(ins, s, R, d)   ins " " R(d) ", " R(d) ", " R(s) ", #4\n\t"
+#define GPR2(ins, s, R, d)    ins " " R(d) ", " R(d) "\n\t"
+#define GPR3(ins, s, R, d)    ins " " R(d) ", " R(d) ", " s "\n\t"
+
+#define GPR_CLOBBERS "x6", "x8", "x9", "x10", "x11", "x12", "x13", "x14", "x15", "cc"
+#define GPR_INIT \
+  "mov x6, #1\n\t" \
+  "mov x8, %1\n\t" "mov x9, %1\n\t" "mov x10, %1\n\t" "mov x11, %1\n\t" \
+  "mov x12, %1\n\t" "mov x13, %1\n\t" "mov x14, %1\n\t" "mov x15, %1\n\t"
+
+#define VEC_MOVS \
+  "mov v0.16b, v16.16b\n\t" "mov v1.16b, v16.16b\n\t" "mov v2.16b, v16.16b\n\t" "mov v3.16b, v16.16b\n\t" \
+  "mov v4.16b, v16.16b\n\t" "mov v5.16b, v16.16b\n\t" "mov v6.16b, v16.16b\n\t" "mov v7.16b, v16.16b\n\t"
+#define INIT_S "fmov v16.4s, #1.0\n\t" "movi v17.16b, #0\n\t" VEC_MOVS
+#define INIT_D "fmov v16.2d, #1.0\n\t" "movi v17.16b, #0\n\t" VEC_MOVS
+
+#define GPR_KERNELS(name, OP, ins, s)                                             \
+  static void name##_lat(uint64_t iters) {                                        \
+    __asm volatile(GPR_INIT LOOP_BEGIN LAT_BODY(OP, ins, s, G) LOOP_END           \
+                   : "+r"(iters) : "r"((uint64_t) 3) : GPR_CLOBBERS);              \
+  }                                                                               \
+  static void name##_tput(uint64_t iters) {                                       \
+    __asm volatile(GPR_INIT LOOP_BEGIN TPUT_BODY(OP, ins, s, G) LOOP_END          \
+                   : "+r"(iters) : "r"((uint64_t) 3) : GPR_CLOBBERS);              \
+  }
+
+#define VEC_KERNELS(name, OP, ins, s, R, init)                                    \
+  static void name##_lat(uint64_t iters) {                                        \
+    __asm volatile(init LOOP_BEGIN LAT_BODY(OP, ins, s, R) LOOP_END               \
+                   : "+r"(iters) : : VEC_CLOBBERS);                                \
+  }                                                                               \
+  static void name##_tput(uint64_t iters) {                                       \
+    __asm volatile(init LOOP_BEGIN TPUT_BODY(OP, ins, s, R) LOOP_END              \
+                   : "+r"(iters) : : VEC_CLOBBERS);                                \
+  }
+
+// Integer (divisions keep the dividend constant by dividing by one)
+GPR_KERNELS(add_x,  GPR3, "add",  "x6")
+GPR_KERNELS(mul_x,  GPR3, "mul",  "x6")
+GPR_KERNELS(sdiv_x, GPR3, "sdiv", "x6")
+GPR_KERNELS(udiv_x, GPR3, "udiv", "x6")
+GPR_KERNELS(clz_x,  GPR2, "clz",  "")
+
+// Floating point
+VEC_KERNELS(fadd_d,      OP3,     "fadd",  17, D,    INIT_D)
+VEC_KERNELS(fadd_2d,     OP3,     "fadd",  17, V2D,  INIT_D)
+VEC_KERNELS(fmul_d,      OP3,     "fmul",  16, D,    INIT_D)
+VEC_KERNELS(fmul_2d,     OP3,     "fmul",  16, V2D,  INIT_D)
+VEC_KERNELS(fmadd_d,     OPFMADD, "fmadd", 17, D,    INIT_D)
+VEC_KERNELS(fmla_2d,     OPFMLA,  "fmla",  17, V2D,  INIT_D)
+VEC_KERNELS(fdiv_s,      OP3,     "fdiv",  16, S,    INIT_S)
+VEC_KERNELS(fdiv_4s,     OP3,     "fdiv",  16, V4S,  INIT_S)
+VEC_KERNELS(fdiv_d,      OP3,     "fdiv",  16, D,    INIT_D)
+VEC_KERNELS(fdiv_2d,     OP3,     "fdiv",  16, V2D,  INIT_D)
+VEC_KERNELS(fsqrt_s,     OP2,     "fsqrt", 0,  S,    INIT_S)
+VEC_KERNELS(fsqrt_4s,    OP2,     "fsqrt", 0,  V4S,  INIT_S)
+VEC_KERNELS(fsqrt_d,     OP2,     "fsqrt", 0,  D,    INIT_D)
+VEC_KERNELS(fsqrt_2d,    OP2,     "fsqrt", 0,  V2D,  INIT_D)
+
+// Vector integer and shuffles
+VEC_KERNELS(add_4s,      OP3,     "add",   17, V4S,  INIT_S)
+VEC_KERNELS(mul_4s,      OP3,     "mul",   16, V4S,  INIT_S)
+VEC_KERNELS(cnt_8b,      OP2,     "cnt",   0,  V8B,  INIT_S)
+VEC_KERNELS(cnt_16b,     OP2,     "cnt",   0,  V16B, INIT_S)
+VEC_KERNELS(tbl_16b,     OPTBL,   "tbl",   17, V16B, INIT_S)
+VEC_KERNELS(ext_16b,     OPEXT,   "ext",   17, V16B, INIT_S)
+VEC_KERNELS(zip1_4s,     OP3,     "zip1",  17, V4S,  INIT_S)
+
+#define INSN(name, str, isa) { str, isa, name##_lat, name##_tput }
+
+const struct insn_test insn_tests[] = {
+  INSN(add_x,       "add x",            ISA_BASE),
+  INSN(mul_x,       "mul x",            ISA_BASE),
+  INSN(sdiv_x,      "sdiv x",           ISA_BASE),
+  INSN(udiv_x,      "udiv x",           ISA_BASE),
+  INSN(clz_x,       "clz x",            ISA_BASE),
+  INSN(fadd_d,      "fadd d",           ISA_BASE),
+  INSN(fadd_2d,     "fadd v.2d",        ISA_NEON),
+  INSN(sve_fadd_d,  "fadd z.d",         ISA_SVE),
+  INSN(fmul_d,      "fmul d",           ISA_BASE),
+  INSN(fmul_2d,     "fmul v.2d",        ISA_NEON),
+  INSN(sve_fmul_d,  "fmul z.d",         ISA_SVE),
+  INSN(fmadd_d,     "fmadd d",          ISA_BASE),
+  INSN(fmla_2d,     "fmla v.2d",        ISA_NEON),
+  INSN(sve_fmla_d,  "fmla z.d",         ISA_SVE),
+  INSN(fdiv_s,      "fdiv s",           ISA_BASE),
+  INSN(fdiv_4s,     "fdiv v.4s",        ISA_NEON),
+  INSN(sve_fdiv_s,  "fdiv z.s",         ISA_SVE),
+  INSN(fdiv_d,      "fdiv d",           ISA_BASE),
+  INSN(fdiv_2d,     "fdiv v.2d",        ISA_NEON),
+  INSN(sve_fdiv_d,  "fdiv z.d",         ISA_SVE),
+  INSN(fsqrt_s,     "fsqrt s",          ISA_BASE),
+  INSN(fsqrt_4s,    "fsqrt v.4s",       ISA_NEON),
+  INSN(sve_fsqrt_s, "fsqrt z.s",        ISA_SVE),
+  INSN(fsqrt_d,     "fsqrt d",          ISA_BASE),
+  INSN(fsqrt_2d,    "fsqrt v.2d",       ISA_NEON),
+  INSN(sve_fsqrt_d, "fsqrt z.d",        ISA_SVE),
+  INSN(add_4s,      "add v.4s",         ISA_NEON),
+  INSN(sve_add_s,   "add z.s",          ISA_SVE),
+  INSN(mul_4s,      "mul v.4s",         ISA_NEON),
+  INSN(sve_mul_s,   "mul z.s",          ISA_SVE),
+  INSN(cnt_8b,      "cnt v.8b",         ISA_NEON),
+  INSN(cnt_16b,     "cnt v.16b",        ISA_NEON),
+  INSN(tbl_16b,     "tbl v.16b",        ISA_NEON),
+  INSN(sve_tbl_b,   "tbl z.b",          ISA_SVE),
+  INSN(ext_16b,     "ext v.16b",        ISA_NEON),
+  INSN(zip1_4s,     "zip1 v.4s",        ISA_NEON),
+};
+
+const int insn_num_tests = sizeof(insn_tests) / sizeof(insn_tests[0]);
+
+#else
+
+// The kernels are only written for AArch64
+const struct insn_test insn_tests[] = { { "", ISA_BASE, NULL, NULL } };
+const int insn_num_tests = 0;
+
+#endif // #ifdef __aarch64__
+
+bool insn_supported(struct features* feat, int isa) {
+  switch(isa) {
+    case ISA_BASE: return true;
+    case ISA_NEON: return feat->NEON;
+    case ISA_SVE:  return feat->SVE && insn_sve_compiled();
+    default:       return false;
+  }
+}
@@ -0,0 +1,68 @@
+#ifndef __INSN_KERNELS__
+#define __INSN_KERNELS__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../common/cpu.h"
+
+// Kernels used by the instruction latency/throughput table. Each kernel
+// runs INSN_PER_ITER instances of the instruction per iteration: the
+// latency one as a single dependency chain and the throughput one as
+// INSN_CHAINS independent chains. They are written in inline assembly
+// (AArch64 only) and must only be called if insn_supported returns true
+// for the CPU. The first test is always the integer add, whose latency
+// is one cycle in every core. The SVE kernels live in their own file,
+// compiled with the SVE flags; if the compiler does not support SVE,
+// insn_sve_compiled returns false and they must not be used.
+
+#define INSN_PER_ITER  32
+#define INSN_CHAINS     8
+
+typedef void (*insn_fn)(uint64_t iters);
+
+struct insn_test {
+  const char* name;
+  int isa;
+  insn_fn lat;
+  insn_fn tput;
+};
+
+extern const struct insn_test insn_tests[];
+extern const int insn_num_tests;
+
+bool insn_supported(struct features* feat, int isa);
+
+// Helpers to write the kernels, shared by the NEON and SVE files.
+// Chains use the vector registers 0-7 and the constants (ones and
+// zeros) live in 16 and 17, so that no callee-saved register is used
+#define REP4(x)  x x x x
+#define REP8(x)  REP4(x) REP4(x)
+#define REP32(x) REP8(x) REP8(x) REP8(x) REP8(x)
+
+#define LAT_BODY(OP, ins, s, R)  REP32(OP(ins, s, R, 0))
+#define TPUT_BODY(OP, ins, s, R) REP4(OP(ins, s, R, 0) OP(ins, s, R, 1) OP(ins, s, R, 2) OP(ins, s, R, 3) \
+                                      OP(ins, s, R, 4) OP(ins, s, R, 5) OP(ins, s, R, 6) OP(ins, s, R, 7))
+
+#define LOOP_BEGIN "1:\n\t"
+#define LOOP_END   "subs %0, %0, #1\n\t" "b.ne 1b\n\t"
+
+#define VEC_CLOBBERS "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v16", "v17", "cc"
+
+#define INSN_SVE_KERNELS(name) \
+  void name##_lat(uint64_t iters); \
+  void name##_tput(uint64_t iters);
+
+bool insn_sve_compiled(void);
+INSN_SVE_KERNELS(sve_fadd_d)
+INSN_SVE_KERNELS(sve_fmul_d)
+INSN_SVE_KERNELS(sve_fmla_d)
+INSN_SVE_KERNELS(sve_fdiv_s)
+INSN_SVE_KERNELS(sve_fdiv_d)
+INSN_SVE_KERNELS(sve_fsqrt_s)
+INSN_SVE_KERNELS(sve_fsqrt_d)
+INSN_SVE_KERNELS(sve_add_s)
+INSN_SVE_KERNELS(sve_mul_s)
+INSN_SVE_KERNELS(sve_tbl_b)
+
+#endif
@@ -0,0 +1,76 @@
+#include "../../common/global.h"
+#include "insn.h"
+
+#ifdef __ARM_FEATURE_SVE
+
+bool insn_sve_compiled(void) {
+  return true;
+}
+
+#define ZB(n) "z" #n ".b"
+#define ZS(n) "z" #n ".s"
+#define ZD(n) "z" #n ".d"
+
+// Operand forms. The chain always goes through the destination
+// register d, and s is the constant source (p0 is all true)
+#define OP3(ins, s, R, d)     ins " " R(d) ", " R(d) ", " R(s) "\n\t"
+#define OPP2(ins, s, R, d)    ins " " R(d) ", p0/m, " R(d) "\n\t"
+#define OPP3(ins, s, R, d)    ins " " R(d) ", p0/m, " R(d) ", " R(s) "\n\t"
+#define OPFMLA(ins, s, R, d)  ins " " R(d) ", p0/m, " R(s) ", " R(s) "\n\t"
+#define OPTBL(ins, s, R, d)   ins " " R(d) ", {" R(d) "}, " R(s) "\n\t"
+
+#define SVE_MOVS \
+  "mov z0.d, z16.d\n\t" "mov z1.d, z16.d\n\t" "mov z2.d, z16.d\n\t" "mov z3.d, z16.d\n\t" \
+  "mov z4.d, z16.d\n\t" "mov z5.d, z16.d\n\t" "mov z6.d, z16.d\n\t" "mov z7.d, z16.d\n\t"
+#define INIT_S "ptrue p0.b\n\t" "fmov z16.s, #1.0\n\t" "mov z17.d, #0\n\t" SVE_MOVS
+#define INIT_D "ptrue p0.b\n\t" "fmov z16.d, #1.0\n\t" "mov z17.d, #0\n\t" SVE_MOVS
+
+#define SVE_KERNELS(name, OP, ins, s, R, init)                                    \
+  void name##_lat(uint64_t iters) {                                               \
+    __asm volatile(init LOOP_BEGIN LAT_BODY(OP, ins, s, R) LOOP_END               \
+                   : "+r"(iters) : : VEC_CLOBBERS, "p0");                          \
+  }                                                                               \
+  void name##_tput(uint64_t iters) {                                              \
+    __asm volatile(init LOOP_BEGIN TPUT_BODY(OP, ins, s, R) LOOP_END              \
+                   : "+r"(iters) : : VEC_CLOBBERS, "p0");                          \
+  }
+
+SVE_KERNELS(sve_fadd_d,  OP3,    "fadd",  17, ZD, INIT_D)
+SVE_KERNELS(sve_fmul_d,  OP3,    "fmul",  16, ZD, INIT_D)
+SVE_KERNELS(sve_fmla_d,  OPFMLA, "fmla",  17, ZD, INIT_D)
+SVE_KERNELS(sve_fdiv_s,  OPP3,   "fdiv",  16, ZS, INIT_S)
+SVE_KERNELS(sve_fdiv_d,  OPP3,   "fdiv",  16, ZD, INIT_D)
+SVE_KERNELS(sve_fsqrt_s, OPP2,   "fsqrt", 0,  ZS, INIT_S)
+SVE_KERNELS(sve_fsqrt_d, OPP2,   "fsqrt", 0,  ZD, INIT_D)
+SVE_KERNELS(sve_add_s,   OP3,    "add",   17, ZS, INIT_S)
+SVE_KERNELS(sve_mul_s,   OPP3,   "mul",   16, ZS, INIT_S)
+SVE_KERNELS(sve_tbl_b,   OPTBL,  "tbl",   17, ZB, INIT_S)
+
+#else
+
+bool insn_sve_compiled(void) {
+  return false;
+}
+
+#define SVE_KERNELS(name)                                                         \
+  void name##_lat(uint64_t iters) {                                               \
+    UNUSED(iters);                                                                \
+    printBug(#name "_lat: SVE was not enabled by the compiler");                  \
+  }                                                                               \
+  void name##_tput(uint64_t iters) {                                              \
+    UNUSED(iters);                                                                \
+    printBug(#name "_tput: SVE was not enabled by the compiler");                 \
+  }
+
+SVE_KERNELS(sve_fadd_d)
+SVE_KERNELS(sve_fmul_d)
+SVE_KERNELS(sve_fmla_d)
+SVE_KERNELS(sve_fdiv_s)
+SVE_KERNELS(sve_fdiv_d)
+SVE_KERNELS(sve_fsqrt_s)
+SVE_KERNELS(sve_fsqrt_d)
+SVE_KERNELS(sve_add_s)
+SVE_KERNELS(sve_mul_s)
+SVE_KERNELS(sve_tbl_b)
+
+#endif
@@ -14,9 +14,11 @@
 
 #ifdef __linux__
   #include <sys/auxv.h>
+  #include <sys/prctl.h>
   #include <asm/hwcap.h>
   #include "../common/freq.h"
 #elif defined __APPLE__ || __MACH__
+  #include <sys/sysctl.h>
   #include "../common/sysctl.h"
   #include "./metal_bench.h"
 #elif defined _WIN32
@@ -33,6 +35,11 @@
 #include "uarch.h"
 #include "sve.h"
 
+#if defined(__linux__) && !defined(PR_SME_GET_VL)
+  #define PR_SME_GET_VL      64
+  #define PR_SME_VL_LEN_MASK 0xffff
+#endif
+
 
 #if defined _WIN32
 // Windows stores processor information in registery at:
@@ -100,8 +107,24 @@ struct cache* get_cache_info(struct cpuInfo* cpu) {
     cach->cach_arr[i]->exists = true;
     cach->cach_arr[i]->num_caches = 1;
     cach->cach_arr[i]->size = 0;
+#ifdef __linux__
+    // The line size is the same in all the clusters of the SoCs
+    // we know of, so we just read it from the first core
+    cach->cach_arr[i]->line_size = get_cache_line_size(0, i);
+#elif defined __APPLE__ || __MACH__
+    cach->cach_arr[i]->line_size = get_sys_info_by_name("hw.cachelinesize");
+#endif
   }
 
+#if defined(__linux__) && defined(__aarch64__)
+  // Fallback to CTR_EL0 (the kernel allows reading it from EL0)
+  if(cach->L1d->line_size <= 0) {
+    uint64_t ctr;
+    __asm volatile("mrs %0, ctr_el0" : "=r" (ctr));
+    cach->L1d->line_size = 4 << ((ctr >> 16) & 0xF);
+  }
+#endif
+
   return cach;
 }
 
@@ -217,6 +240,36 @@ int64_t get_peak_performance(struct cpuInfo* cpu) {
   return total_flops;
 }
 
+// Models the int8 throughput from the instructions used by inference
+// kernels: SDOT/UDOT do 4 multiply-adds (8 operations) per 32 bit lane
+// and SMMLA/UMMLA do 8 (16 operations). SVE only has SMMLA with
+// SVEI8MM; otherwise, it runs on 128 bit NEON registers
+int64_t get_peak_int8_performance(struct cpuInfo* cpu) {
+  struct cpuInfo* ptr = cpu;
+  int64_t total_ops = 0;
+
+  for(int i=0; i < cpu->num_cpus; ptr = ptr->next_cpu, i++) {
+    if(get_freq(ptr->freq) == UNKNOWN_DATA) return -1;
+  }
+
+  ptr = cpu;
+  for(int i=0; i < cpu->num_cpus; ptr = ptr->next_cpu, i++) {
+    int vpus_width = get_vpus_width(ptr);
+    int64_t ops_per_vpu = 0;
+
+    if(ptr->feat->DOTPROD) ops_per_vpu = (vpus_width / 32) * 8;
+    if(ptr->feat->I8MM) {
+      int mm_width = ptr->feat->SVE && !ptr->feat->SVEI8MM ? 128 : vpus_width;
+      int64_t mm_ops = (mm_width / 32) * 16;
+      if(mm_ops > ops_per_vpu) ops_per_vpu = mm_ops;
+    }
+
+    total_ops += ptr->topo->total_cores * get_freq(ptr->freq) * 1000000 * get_number_of_vpus(ptr) * ops_per_vpu;
+  }
+
+  return total_ops > 0 ? total_ops : -1;
+}
+
 uint32_t fill_ids_from_midr(uint32_t* midr_array, int32_t* freq_array, uint32_t* ids_array, int len) {
   uint32_t latest_id = 0;
   bool found;
@@ -251,6 +304,119 @@ void init_cpu_info(struct cpuInfo* cpu) {
   cpu->next_cpu = NULL;
 }
 
+// Fields of the ID_AA64*_EL1 registers are 4 bits wide. Signed fields
+// (e.g., FP and AdvSIMD) use 0xF to indicate "not implemented"
+#define ID_FIELD(reg, shift) (((reg) >> (shift)) & 0xF)
+#define ID_FIELD_SIGNED(reg, shift) (ID_FIELD(reg, shift) >= 8 ? (int) ID_FIELD(reg, shift) - 16 : (int) ID_FIELD(reg, shift))
+
+// ID registers used to decode the features. The ones that could not
+// be read must be zero, which always means "not implemented"
+// https://developer.arm.com/documentation/ddi0601/latest/AArch64-Registers
+struct arm_id_regs {
+  uint64_t isar0;
+  uint64_t isar1;
+  uint64_t isar2;
+  uint64_t pfr0;
+  uint64_t pfr1;
+  uint64_t mmfr2;
+  uint64_t zfr0;
+  uint64_t smfr0;
+};
+
+// Adds the features found in the ID registers. NEON is not decoded
+// here, since AdvSIMD reads as zero (i.e., implemented) when PFR0 is
+// not available
+void fill_features_from_id_regs(struct features* feat, struct arm_id_regs* regs) {
+  // ID_AA64ISAR0_EL1
+  feat->AES     |= ID_FIELD(regs->isar0, 4) >= 1;
+  feat->PMULL   |= ID_FIELD(regs->isar0, 4) >= 2;
+  feat->SHA1    |= ID_FIELD(regs->isar0, 8) >= 1;
+  feat->SHA2    |= ID_FIELD(regs->isar0, 12) >= 1;
+  feat->CRC32   |= ID_FIELD(regs->isar0, 16) >= 1;
+  feat->LSE     |= ID_FIELD(regs->isar0, 20) >= 2;
+  feat->DOTPROD |= ID_FIELD(regs->isar0, 44) >= 1;
+  feat->FHM     |= ID_FIELD(regs->isar0, 48) >= 1;
+
+  // ID_AA64ISAR1_EL1 and ID_AA64ISAR2_EL1 (APA, API and APA3 are the
+  // address authentication algorithms)
+  feat->PAC     |= ID_FIELD(regs->isar1, 4) >= 1 || ID_FIELD(regs->isar1, 8) >= 1 || ID_FIELD(regs->isar2, 12) >= 1;
+  feat->RCPC    |= ID_FIELD(regs->isar1, 20) >= 1;
+  feat->BF16    |= ID_FIELD(regs->isar1, 44) >= 1;
+  feat->I8MM    |= ID_FIELD(regs->isar1, 52) >= 1;
+  feat->MOPS    |= ID_FIELD(regs->isar2, 16) >= 1;
+
+  // ID_AA64PFR0_EL1: FP16 requires both FP and AdvSIMD to be 1
+  feat->FP16    |= ID_FIELD_SIGNED(regs->pfr0, 16) == 1 && ID_FIELD_SIGNED(regs->pfr0, 20) == 1;
+  feat->SVE     |= ID_FIELD(regs->pfr0, 32) >= 1;
+
+  // ID_AA64PFR1_EL1: MTE 1 is only the instructions, 2 is full MTE
+  feat->BTI     |= ID_FIELD(regs->pfr1, 0) >= 1;
+  feat->MTE     |= ID_FIELD(regs->pfr1, 8) >= 2;
+  feat->SME     |= ID_FIELD(regs->pfr1, 24) >= 1;
+
+  // ID_AA64MMFR2_EL1
+  feat->LSE2    |= ID_FIELD(regs->mmfr2, 32) >= 1;
+
+  // ID_AA64ZFR0_EL1 and ID_AA64SMFR0_EL1
+  feat->SVE2    |= ID_FIELD(regs->zfr0, 0) >= 1;
+  feat->SVEBF16 |= ID_FIELD(regs->zfr0, 20) >= 1;
+  feat->SVEI8MM |= ID_FIELD(regs->zfr0, 44) >= 1;
+  feat->SME2    |= ID_FIELD(regs->smfr0, 56) >= 1;
+}
+
+#if defined(__linux__) && defined(__aarch64__)
+// Linux traps EL0 reads of the ID registers and emulates them, exposing
+// the sanitized values (HWCAP_CPUID). The registers are named by their
+// encoding so that old assemblers accept them
+#define DEFINE_ID_REG_READ(fn, reg) \
+  uint64_t fn(void) {               \
+    uint64_t value;                 \
+    __asm volatile("mrs %0, " reg : "=r"(value)); \
+    return value;                   \
+  }
+
+DEFINE_ID_REG_READ(read_id_aa64isar0, "S3_0_C0_C6_0")
+DEFINE_ID_REG_READ(read_id_aa64isar1, "S3_0_C0_C6_1")
+DEFINE_ID_REG_READ(read_id_aa64isar2, "S3_0_C0_C6_2")
+DEFINE_ID_REG_READ(read_id_aa64pfr0,  "S3_0_C0_C4_0")
+DEFINE_ID_REG_READ(read_id_aa64pfr1,  "S3_0_C0_C4_1")
+DEFINE_ID_REG_READ(read_id_aa64zfr0,  "S3_0_C0_C4_4")
+DEFINE_ID_REG_READ(read_id_aa64smfr0, "S3_0_C0_C4_5")
+DEFINE_ID_REG_READ(read_id_aa64mmfr2, "S3_0_C0_C7_2")
+
+void read_id_regs(struct arm_id_regs* regs) {
+  regs->isar0 = read_id_aa64isar0();
+  regs->isar1 = read_id_aa64isar1();
+  regs->isar2 = read_id_aa64isar2();
+  regs->pfr0 = read_id_aa64pfr0();
+  regs->pfr1 = read_id_aa64pfr1();
+  regs->mmfr2 = read_id_aa64mmfr2();
+  regs->zfr0 = read_id_aa64zfr0();
+  regs->smfr0 = read_id_aa64smfr0();
+}
+
+// Streaming vector length of the current thread
+uint64_t get_sme_svl(void) {
+  int vl = prctl(PR_SME_GET_VL, 0, 0, 0, 0);
+  if(vl < 0) {
+    printWarn("prctl(PR_SME_GET_VL): %s", strerror(errno));
+    return 0;
+  }
+  return vl & PR_SME_VL_LEN_MASK;
+}
+#endif
+
+#if defined __APPLE__ || __MACH__
+// hw.optional.arm.FEAT_* keys are not present in old macOS versions,
+// where they are assumed to be unsupported
+bool get_apple_feature(const char* name) {
+  uint32_t value = 0;
+  size_t size = sizeof(value);
+  if(sysctlbyname(name, &value, &size, NULL, 0) != 0) return false;
+  return value != 0;
+}
+#endif
+
 // We assume all cpus share the same hardware
 // capabilities but I'm not sure it is always
 // true...
@@ -276,8 +442,33 @@ struct features* get_features_info(void) {
     feat->CRC32 = hwcaps & HWCAP_CRC32;
     feat->SHA1 = hwcaps & HWCAP_SHA1;
     feat->SHA2 = hwcaps & HWCAP_SHA2;
+    feat->PMULL = hwcaps & HWCAP_PMULL;
     feat->NEON = hwcaps & HWCAP_ASIMD;
     feat->SVE = hwcaps & HWCAP_SVE;
+    feat->LSE = hwcaps & HWCAP_ATOMICS;
+    // Newer bits may be missing in old kernel headers
+    #ifdef HWCAP_ASIMDHP
+      feat->FP16 = (hwcaps & HWCAP_FPHP) && (hwcaps & HWCAP_ASIMDHP);
+    #endif
+    #ifdef HWCAP_ASIMDDP
+      feat->DOTPROD = hwcaps & HWCAP_ASIMDDP;
+    #endif
+    #ifdef HWCAP_ASIMDFHM
+      feat->FHM = hwcaps & HWCAP_ASIMDFHM;
+    #endif
+    #ifdef HWCAP_LRCPC
+      feat->RCPC = hwcaps & HWCAP_LRCPC;
+    #endif
+    #ifdef HWCAP_USCAT
+      feat->LSE2 = hwcaps & HWCAP_USCAT;
+    #endif
+    #ifdef HWCAP_PACA
+      feat->PAC = hwcaps & HWCAP_PACA;
+    #endif
+    bool cpuid = false;
+    #ifdef HWCAP_CPUID
+      cpuid = hwcaps & HWCAP_CPUID;
+    #endif
 
     hwcaps = getauxval(AT_HWCAP2);
     if (errno == ENOENT) {
@@ -287,7 +478,44 @@ struct features* get_features_info(void) {
       #ifdef HWCAP2_SVE2
         feat->SVE2 = hwcaps & HWCAP2_SVE2;
       #endif
+      #ifdef HWCAP2_MOPS
+        feat->MOPS = hwcaps & HWCAP2_MOPS;
+      #endif
+      #ifdef HWCAP2_I8MM
+        feat->I8MM = hwcaps & HWCAP2_I8MM;
+      #endif
+      #ifdef HWCAP2_BF16
+        feat->BF16 = hwcaps & HWCAP2_BF16;
+      #endif
+      #ifdef HWCAP2_SVEI8MM
+        feat->SVEI8MM = hwcaps & HWCAP2_SVEI8MM;
+      #endif
+      #ifdef HWCAP2_SVEBF16
+        feat->SVEBF16 = hwcaps & HWCAP2_SVEBF16;
+      #endif
+      #ifdef HWCAP2_MTE
+        feat->MTE = hwcaps & HWCAP2_MTE;
+      #endif
+      #ifdef HWCAP2_BTI
+        feat->BTI = hwcaps & HWCAP2_BTI;
+      #endif
+      #ifdef HWCAP2_SME
+        feat->SME = hwcaps & HWCAP2_SME;
+      #endif
+      #ifdef HWCAP2_SME2
+        feat->SME2 = hwcaps & HWCAP2_SME2;
+      #endif
+    }
+
+    // The ID registers fill what the headers cpufetch was built with
+    // do not know about. The kernel hides the features it does not
+    // support, so they never add anything unusable
+    if(cpuid) {
+      struct arm_id_regs regs;
+      read_id_regs(&regs);
+      fill_features_from_id_regs(feat, &regs);
     }
+    if(feat->SME) feat->svl = get_sme_svl();
   }
 #else
   else {
@@ -303,6 +531,7 @@ struct features* get_features_info(void) {
     feat->CRC32 = hwcaps & HWCAP2_CRC32;
     feat->SHA1 = hwcaps & HWCAP2_SHA1;
     feat->SHA2 = hwcaps & HWCAP2_SHA2;
+    feat->PMULL = hwcaps & HWCAP2_PMULL;
     feat->SVE = false;
     feat->SVE2 = false;
   }
@@ -313,49 +542,64 @@ struct features* get_features_info(void) {
   feat->CRC32 = true;
   feat->SHA1 = true;
   feat->SHA2 = true;
+  feat->PMULL = true;
   feat->NEON = true;
   feat->SVE = false;
   feat->SVE2 = false;
+  feat->LSE = true;
+  // Every Apple core supports these (ARMv8.4)
+  feat->FP16 = true;
+  feat->FHM = true;
+  feat->DOTPROD = true;
+  feat->RCPC = true;
+  feat->LSE2 = true;
+  // The rest depend on the generation
+  feat->I8MM = get_apple_feature("hw.optional.arm.FEAT_I8MM");
+  feat->BF16 = get_apple_feature("hw.optional.arm.FEAT_BF16");
+  feat->PAC = get_apple_feature("hw.optional.arm.FEAT_PAuth");
+  feat->BTI = get_apple_feature("hw.optional.arm.FEAT_BTI");
+  feat->SME = get_apple_feature("hw.optional.arm.FEAT_SME");
+  feat->SME2 = get_apple_feature("hw.optional.arm.FEAT_SME2");
+  if(feat->SME) {
+    uint32_t svl = 0;
+    size_t size = sizeof(svl);
+    if(sysctlbyname("hw.optional.arm.sme_max_svl_b", &svl, &size, NULL, 0) == 0) feat->svl = svl;
+  }
 #elif defined _WIN32
-
-  // CP 4020 maps to the ID_AA64PFR0_EL1 register on Windows
+  // Windows exposes the ID registers in the registry, as "CP <encoding>"
   // https://developer.arm.com/documentation/ddi0601/2024-06/AArch64-Registers/ID-AA64PFR0-EL1--AArch64-Processor-Feature-Register-0
-  int64_t pfr0 = 0;
-  if(!get_win32_core_info_int(0, "CP 4020", &pfr0, true)) {
+  struct arm_id_regs regs;
+  memset(&regs, 0, sizeof(struct arm_id_regs));
+  int64_t value = 0;
+
+  // CP 4020 maps to the ID_AA64PFR0_EL1 register
+  if(!get_win32_core_info_int(0, "CP 4020", &value, true)) {
     printWarn("Unable to retrieve PFR0 via registry");
   }
   else {
+    regs.pfr0 = value;
     // AdvSimd[23:20]
     // -1: Not available
     //  0: AdvSimd support
     //  1: AdvSimd support + FP16
-    int8_t adv_simd = ((int64_t)(pfr0 << (60 - 20)) >> 60);
-    feat->NEON = (adv_simd >= 0);
-
-    // SVE[35:32]
-    feat->SVE = (pfr0 >> 32) & 0xF ? true : false;
+    feat->NEON = ID_FIELD_SIGNED(regs.pfr0, 20) >= 0;
   }
 
-  // Windoes does not expose a registry entry for the ID_AA64ZFR0_EL1 register
-  // this would have mapped to "CP 4024".
-  feat->SVE2 = false;
-
-  // CP 4030 maps to the ID_AA64ISAR0_EL1 register on Windows
-  // https://developer.arm.com/documentation/ddi0601/2024-06/AArch64-Registers/ID-AA64ISAR0-EL1--AArch64-Instruction-Set-Attribute-Register-0
-  int64_t isar0 = 0;
-  if(!get_win32_core_info_int(0, "CP 4030", &isar0, true)) {
+  // CP 4030 maps to the ID_AA64ISAR0_EL1 register
+  if(!get_win32_core_info_int(0, "CP 4030", &value, true)) {
     printWarn("Unable to retrieve ISAR0 via registry");
   }
   else {
-    // AES[7:4]
-    feat->AES = (isar0 >> 4) & 0xF ? true : false;
-    // SHA1[11:8]
-    feat->SHA1 = (isar0 >> 8) & 0xF ? true : false;
-    // SHA2[15:12]
-    feat->SHA2 = (isar0 >> 12) & 0xF ? true : false;
-    // CRC32[19:16]
-    feat->CRC32 = (isar0 >> 16) & 0xF ? true : false;
+    regs.isar0 = value;
   }
+
+  // CP 4031 and CP 4021 map to ID_AA64ISAR1_EL1 and ID_AA64PFR1_EL1
+  if(get_win32_core_info_int(0, "CP 4031", &value, true)) regs.isar1 = value;
+  if(get_win32_core_info_int(0, "CP 4021", &value, true)) regs.pfr1 = value;
+
+  // Windows does not expose a registry entry for the ID_AA64ZFR0_EL1 register
+  // this would have mapped to "CP 4024", so SVE2 is never detected
+  fill_features_from_id_regs(feat, &regs);
 #endif  // ifdef __linux__
 
   if (feat->SVE || feat->SVE2) {
@@ -458,6 +702,7 @@ struct cpuInfo* get_cpu_info_linux(struct cpuInfo* cpu) {
   cpu->hv->present = false;
   cpu->soc = get_soc(cpu);
   cpu->peak_performance = get_peak_performance(cpu);
+  cpu->int8_ops_performance = get_peak_int8_performance(cpu);
 #if defined(CPUFETCH_NEON)
   cpu->vis_ops_performance = measure_neon_ops_total(cpu);
 #else
@@ -637,11 +882,13 @@ struct cpuInfo* get_cpu_info_mach(struct cpuInfo* cpu) {
     fill_cpu_info_firestorm_icestorm(cpu, pcores, ecores);
     cpu->soc = get_soc(cpu);
     cpu->peak_performance = get_peak_performance(cpu);
+    cpu->int8_ops_performance = get_peak_int8_performance(cpu);
   }
   else if(cpu_family == CPUFAMILY_ARM_AVALANCHE_BLIZZARD) {
     fill_cpu_info_avalanche_blizzard(cpu, pcores, ecores);
     cpu->soc = get_soc(cpu);
     cpu->peak_performance = get_peak_performance(cpu);
+    cpu->int8_ops_performance = get_peak_int8_performance(cpu);
   }
   else if(cpu_family == CPUFAMILY_ARM_EVEREST_SAWTOOTH ||
           cpu_family == CPUFAMILY_ARM_EVEREST_SAWTOOTH_2   ||
@@ -650,11 +897,13 @@ struct cpuInfo* get_cpu_info_mach(struct cpuInfo* cpu) {
     fill_cpu_info_everest_sawtooth(cpu, pcores, ecores);
     cpu->soc = get_soc(cpu);
     cpu->peak_performance = get_peak_performance(cpu);
+    cpu->int8_ops_performance = get_peak_int8_performance(cpu);
   }
   else if(cpu_family == CPUFAMILY_ARM_M4) {
     fill_cpu_info_m4(cpu, pcores, ecores);
     cpu->soc = get_soc(cpu);
     cpu->peak_performance = get_peak_performance(cpu);
+    cpu->int8_ops_performance = get_peak_int8_performance(cpu);
   }
   else {
     printBugCheckRelease("Found invalid cpu_family: 0x%.8X", cpu_family);
@@ -748,6 +997,7 @@ struct cpuInfo* get_cpu_info_windows(struct cpuInfo* cpu) {
   cpu->hv->present = false;
   cpu->soc = get_soc(cpu);
   cpu->peak_performance = get_peak_performance(cpu);
+  cpu->int8_ops_performance = get_peak_int8_performance(cpu);
 
   return cpu;
 }
@@ -774,47 +1024,82 @@ char* get_str_topology(struct cpuInfo* cpu, struct topology* topo, bool dual_soc
   return string;
 }
 
-char* get_str_features(struct cpuInfo* cpu) {
-  struct features* feat = cpu->feat;
-  uint32_t max_len = strlen("NEON,SHA1,SHA2,AES,CRC32,SVE,SVE2,") + 1;
-  uint32_t len = 0;
+struct feature_name {
+  const char* name;
+  bool present;
+};
+
+// Joins the names of the present features with commas
+char* get_str_feature_list(struct feature_name* list, int n) {
+  uint32_t max_len = 1;
+  for(int i=0; i < n; i++) max_len += strlen(list[i].name) + 1;
   char* string = ecalloc(max_len, sizeof(char));
 
-  if(feat->NEON) {
-    strcat(string, "NEON,");
-    len += 5;
-  }
-  if(feat->SVE) {
-    strcat(string, "SVE,");
-    len += 4;
-  }
-  if(feat->SVE2) {
-    strcat(string, "SVE2,");
-    len += 5;
-  }
-  if(feat->SHA1) {
-    strcat(string, "SHA1,");
-    len += 5;
-  }
-  if(feat->SHA2) {
-    strcat(string, "SHA2,");
-    len += 5;
-  }
-  if(feat->AES) {
-    strcat(string, "AES,");
-    len += 4;
-  }
-  if(feat->CRC32) {
-    strcat(string, "CRC32,");
-    len += 6;
+  for(int i=0; i < n; i++) {
+    if(!list[i].present) continue;
+    if(string[0] != '\0') strcat(string, ",");
+    strcat(string, list[i].name);
   }
 
-  if(len > 0) {
-    string[len-1] = '\0';
-    return string;
-  }
-  else
+  if(string[0] == '\0') {
+    free(string);
     return NULL;
+  }
+  return string;
+}
+
+// Only the features that matter for the compute throughput are shown
+// here, the complete list is printed with --debug
+char* get_str_features(struct cpuInfo* cpu) {
+  struct features* feat = cpu->feat;
+  struct feature_name list[] = {
+    { "NEON",    feat->NEON },
+    { "SVE",     feat->SVE },
+    { "SVE2",    feat->SVE2 },
+    { "SME",     feat->SME },
+    { "SME2",    feat->SME2 },
+    { "DOTPROD", feat->DOTPROD },
+    { "I8MM",    feat->I8MM },
+    { "BF16",    feat->BF16 },
+    { "FP16",    feat->FP16 },
+    { "SHA1",    feat->SHA1 },
+    { "SHA2",    feat->SHA2 },
+    { "AES",     feat->AES },
+    { "CRC32",   feat->CRC32 }
+  };
+  return get_str_feature_list(list, sizeof(list) / sizeof(list[0]));
+}
+
+void print_debug_features(struct features* feat) {
+  struct feature_name list[] = {
+    { "NEON",    feat->NEON },
+    { "FP16",    feat->FP16 },
+    { "FHM",     feat->FHM },
+    { "DOTPROD", feat->DOTPROD },
+    { "I8MM",    feat->I8MM },
+    { "BF16",    feat->BF16 },
+    { "SVE",     feat->SVE },
+    { "SVE2",    feat->SVE2 },
+    { "SVEI8MM", feat->SVEI8MM },
+    { "SVEBF16", feat->SVEBF16 },
+    { "SME",     feat->SME },
+    { "SME2",    feat->SME2 },
+    { "AES",     feat->AES },
+    { "PMULL",   feat->PMULL },
+    { "SHA1",    feat->SHA1 },
+    { "SHA2",    feat->SHA2 },
+    { "CRC32",   feat->CRC32 },
+    { "LSE",     feat->LSE },
+    { "LSE2",    feat->LSE2 },
+    { "RCPC",    feat->RCPC },
+    { "MOPS",    feat->MOPS },
+    { "MTE",     feat->MTE },
+    { "PAC",     feat->PAC },
+    { "BTI",     feat->BTI }
+  };
+  char* str = get_str_feature_list(list, sizeof(list) / sizeof(list[0]));
+  printf("- features: %s\n", str != NULL ? str : "none");
+  free(str);
 }
 
 void print_debug(struct cpuInfo* cpu) {
@@ -841,9 +1126,13 @@ void print_debug(struct cpuInfo* cpu) {
     }
   }
 
+  print_debug_features(cpu->feat);
   if (cpu->feat->SVE || cpu->feat->SVE2) {
     printf("- cntb: %d\n", (int) cpu->feat->cntb);
   }
+  if (cpu->feat->SME) {
+    printf("- svl: %d\n", (int) cpu->feat->svl);
+  }
 
   #if defined(__APPLE__) || defined(__MACH__)
     printf("hw.cpufamily: 0x%.8X\n", get_sys_info_by_name("hw.cpufamily"));
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 #include "args.h"
 #include "global.h"
 
@@ -39,6 +40,35 @@ struct args_struct {
   bool logo_intel_old;
   bool verbose_flag;
   bool version_flag;
+  bool wakeup_latency_flag;
+  bool numa_matrix_flag;
+  bool tlb_bench_flag;
+  bool mlp_flag;
+  bool false_sharing_flag;
+  int emit_format;
+  int plan_threads;
+  int policy;
+  bool copy_bench_flag;
+  bool crypto_bench_flag;
+  bool gather_bench_flag;
+  bool insn_table_flag;
+  bool frontend_bench_flag;
+  bool rdt_flag;
+  uint64_t cat_mask;
+  bool pmu_flag;
+  bool mitigations_flag;
+  bool atomics_bench_flag;
+  bool dotprod_bench_flag;
+  bool gemm_bench_flag;
+  bool os_noise_flag;
+  int noise_time;
+  bool cpu_isolation;
+  bool core_ranking;
+  bool rank_scan;
+  bool freq_policy;
+  bool dram_info;
+  bool dram_bench;
+  bool pci_report;
   STYLE style;
   struct color** colors;
 };
@@ -60,6 +90,35 @@ const char args_chr[] = {
   /* [ARG_DEBUG]            = */ 'd',
   /* [ARG_VERBOSE]          = */ 'v',
   /* [ARG_VERSION]          = */ 'V',
+  /* [ARG_WAKEUP_LATENCY]   = */ 9,
+  /* [ARG_NUMA_MATRIX]      = */ 10,
+  /* [ARG_TLB_BENCH]        = */ 11,
+  /* [ARG_MLP]              = */ 12,
+  /* [ARG_FALSE_SHARING]    = */ 13,
+  /* [ARG_EMIT_HEADER]      = */ 14,
+  /* [ARG_PLAN_THREADS]     = */ 15,
+  /* [ARG_POLICY]           = */ 16,
+  /* [ARG_COPY_BENCH]       = */ 17,
+  /* [ARG_CRYPTO_BENCH]     = */ 18,
+  /* [ARG_GATHER_BENCH]     = */ 19,
+  /* [ARG_INSN_TABLE]       = */ 20,
+  /* [ARG_FRONTEND_BENCH]   = */ 21,
+  /* [ARG_RDT]              = */ 22,
+  /* [ARG_CAT_MASK]         = */ 23,
+  /* [ARG_PMU]              = */ 24,
+  /* [ARG_MITIGATIONS]      = */ 25,
+  /* [ARG_ATOMICS_BENCH]    = */ 26,
+  /* [ARG_DOTPROD_BENCH]    = */ 27,
+  /* [ARG_GEMM_BENCH]       = */ 28,
+  /* [ARG_OS_NOISE]         = */ 29,
+  /* [ARG_NOISE_TIME]       = */ 30,
+  /* [ARG_CPU_ISOLATION]    = */ 31,
+  /* [ARG_CORE_RANKING]     = */ 32,
+  /* [ARG_RANK_SCAN]        = */ 33,
+  /* [ARG_FREQ_POLICY]      = */ 34,
+  /* [ARG_DRAM_INFO]        = */ 35,
+  /* [ARG_DRAM_BENCH]       = */ 36,
+  /* [ARG_PCI_REPORT]       = */ 37,
 };
 
 const char *args_str[] = {
@@ -79,6 +138,49 @@ const char *args_str[] = {
   /* [ARG_DEBUG]            = */ "debug",
   /* [ARG_VERBOSE]          = */ "verbose",
   /* [ARG_VERSION]          = */ "version",
+  /* [ARG_WAKEUP_LATENCY]   = */ "wakeup-latency",
+  /* [ARG_NUMA_MATRIX]      = */ "numa-matrix",
+  /* [ARG_TLB_BENCH]        = */ "tlb-bench",
+  /* [ARG_MLP]              = */ "mlp",
+  /* [ARG_FALSE_SHARING]    = */ "false-sharing",
+  /* [ARG_EMIT_HEADER]      = */ "emit-header",
+  /* [ARG_PLAN_THREADS]     = */ "plan-threads",
+  /* [ARG_POLICY]           = */ "policy",
+  /* [ARG_COPY_BENCH]       = */ "copy-bench",
+  /* [ARG_CRYPTO_BENCH]     = */ "crypto-bench",
+  /* [ARG_GATHER_BENCH]     = */ "gather-bench",
+  /* [ARG_INSN_TABLE]       = */ "insn-table",
+  /* [ARG_FRONTEND_BENCH]   = */ "frontend-bench",
+  /* [ARG_RDT]              = */ "rdt",
+  /* [ARG_CAT_MASK]         = */ "cat-mask",
+  /* [ARG_PMU]              = */ "pmu",
+  /* [ARG_MITIGATIONS]      = */ "mitigations",
+  /* [ARG_ATOMICS_BENCH]    = */ "atomics-bench",
+  /* [ARG_DOTPROD_BENCH]    = */ "dotprod-bench",
+  /* [ARG_GEMM_BENCH]       = */ "gemm-bench",
+  /* [ARG_OS_NOISE]         = */ "os-noise",
+  /* [ARG_NOISE_TIME]       = */ "noise-time",
+  /* [ARG_CPU_ISOLATION]    = */ "cpu-isolation",
+  /* [ARG_CORE_RANKING]     = */ "core-ranking",
+  /* [ARG_RANK_SCAN]        = */ "rank-scan",
+  /* [ARG_FREQ_POLICY]      = */ "freq-policy",
+  /* [ARG_DRAM_INFO]        = */ "dram-info",
+  /* [ARG_DRAM_BENCH]       = */ "dram-bench",
+  /* [ARG_PCI_REPORT]       = */ "pci-report",
+};
+
+static const char* EMIT_FORMATS_STR[] = {
+  [EMIT_NONE]      = NULL,
+  [EMIT_C]         = "c",
+  [EMIT_CMAKE]     = "cmake",
+  [EMIT_PKGCONFIG] = "pkgconfig",
+};
+
+static const char* POLICIES_STR[] = {
+  [POLICY_SPREAD]        = "spread",
+  [POLICY_COMPACT]       = "compact",
+  [POLICY_PER_L3]        = "per-l3",
+  [POLICY_P_CORES_FIRST] = "p-cores-first",
 };
 
 static struct args_struct args;
@@ -147,6 +249,127 @@ bool verbose_enabled(void) {
   return args.verbose_flag;
 }
 
+bool wakeup_latency_flag(void) {
+  return args.wakeup_latency_flag;
+}
+
+bool numa_matrix_flag(void) {
+  return args.numa_matrix_flag;
+}
+
+bool tlb_bench_flag(void) {
+  return args.tlb_bench_flag;
+}
+
+bool mlp_flag(void) {
+  return args.mlp_flag;
+}
+
+bool false_sharing_flag(void) {
+  return args.false_sharing_flag;
+}
+
+int get_emit_format(void) {
+  return args.emit_format;
+}
+
+int get_plan_threads(void) {
+  return args.plan_threads;
+}
+
+int get_policy(void) {
+  return args.policy;
+}
+
+const char* get_str_policy(int policy) {
+  if(policy < 0 || policy >= POLICY_INVALID) return STRING_UNKNOWN;
+  return POLICIES_STR[policy];
+}
+
+bool copy_bench_flag(void) {
+  return args.copy_bench_flag;
+}
+
+bool crypto_bench_flag(void) {
+  return args.crypto_bench_flag;
+}
+
+bool gather_bench_flag(void) {
+  return args.gather_bench_flag;
+}
+
+bool insn_table_flag(void) {
+  return args.insn_table_flag;
+}
+
+bool frontend_bench_flag(void) {
+  return args.frontend_bench_flag;
+}
+
+bool rdt_flag(void) {
+  return args.rdt_flag;
+}
+
+uint64_t get_cat_mask(void) {
+  return args.cat_mask;
+}
+
+bool pmu_flag(void) {
+  return args.pmu_flag;
+}
+
+bool mitigations_flag(void) {
+  return args.mitigations_flag;
+}
+
+bool atomics_bench_flag(void) {
+  return args.atomics_bench_flag;
+}
+
+bool dotprod_bench_flag(void) {
+  return args.dotprod_bench_flag;
+}
+
+bool gemm_bench_flag(void) {
+  return args.gemm_bench_flag;
+}
+
+bool os_noise_flag(void) {
+  return args.os_noise_flag;
+}
+
+int get_noise_time(void) {
+  return args.noise_time;
+}
+
+bool cpu_isolation_flag(void) {
+  return args.cpu_isolation;
+}
+
+bool core_ranking_flag(void) {
+  return args.core_ranking;
+}
+
+bool rank_scan_flag(void) {
+  return args.rank_scan;
+}
+
+bool freq_policy_flag(void) {
+  return args.freq_policy;
+}
+
+bool dram_info_flag(void) {
+  return args.dram_info;
+}
+
+bool dram_bench_flag(void) {
+  return args.dram_bench;
+}
+
+bool pci_report_flag(void) {
+  return args.pci_report;
+}
+
 int max_arg_str_length(void) {
   int max_len = -1;
   int len = sizeof(args_str) / sizeof(args_str[0]);
@@ -169,6 +392,26 @@ STYLE parse_style(char* style) {
   return i;
 }
 
+int parse_emit_format(char* format) {
+  int i = 0;
+  int formats_count = sizeof(EMIT_FORMATS_STR) / sizeof(EMIT_FORMATS_STR[0]);
+
+  while(i != formats_count && (EMIT_FORMATS_STR[i] == NULL || strcmp(EMIT_FORMATS_STR[i], format) != 0))
+    i++;
+
+  if(i == formats_count)
+    return EMIT_INVALID;
+
+  return i;
+}
+
+int parse_policy(char* policy) {
+  int i = 0;
+  while(i != POLICY_INVALID && strcmp(POLICIES_STR[i], policy) != 0)
+    i++;
+  return i;
+}
+
 void free_colors_struct(struct color** cs) {
   for(int i=0; i < NUM_COLORS; i++) {
     free(cs[i]);
@@ -309,6 +552,35 @@ bool parse_args(int argc, char* argv[]) {
   args.logo_intel_new = false;
   args.logo_intel_old = false;
   args.help_flag = false;
+  args.wakeup_latency_flag = false;
+  args.numa_matrix_flag = false;
+  args.tlb_bench_flag = false;
+  args.mlp_flag = false;
+  args.false_sharing_flag = false;
+  args.emit_format = EMIT_NONE;
+  args.plan_threads = 0;
+  args.policy = POLICY_INVALID;
+  args.copy_bench_flag = false;
+  args.crypto_bench_flag = false;
+  args.gather_bench_flag = false;
+  args.insn_table_flag = false;
+  args.frontend_bench_flag = false;
+  args.rdt_flag = false;
+  args.cat_mask = 0;
+  args.pmu_flag = false;
+  args.mitigations_flag = false;
+  args.atomics_bench_flag = false;
+  args.dotprod_bench_flag = false;
+  args.gemm_bench_flag = false;
+  args.os_noise_flag = false;
+  args.noise_time = DEFAULT_NOISE_TIME;
+  args.cpu_isolation = false;
+  args.core_ranking = false;
+  args.rank_scan = false;
+  args.freq_policy = false;
+  args.dram_info = false;
+  args.dram_bench = false;
+  args.pci_report = false;
   args.style = STYLE_EMPTY;
   args.colors = NULL;
 
@@ -345,6 +617,37 @@ bool parse_args(int argc, char* argv[]) {
     {args_str[ARG_ACCURATE_PP],          no_argument,   0, args_chr[ARG_ACCURATE_PP]          },
     {args_str[ARG_ACCURATE_PP_WITH_OPS], no_argument,   0, args_chr[ARG_ACCURATE_PP_WITH_OPS] },
 #endif
+#ifdef __linux__
+    {args_str[ARG_WAKEUP_LATENCY],   no_argument,       0, args_chr[ARG_WAKEUP_LATENCY]   },
+    {args_str[ARG_NUMA_MATRIX],      no_argument,       0, args_chr[ARG_NUMA_MATRIX]      },
+    {args_str[ARG_TLB_BENCH],         no_argument,       0, args_chr[ARG_TLB_BENCH]        },
+    {args_str[ARG_MLP],               no_argument,       0, args_chr[ARG_MLP]              },
+    {args_str[ARG_FALSE_SHARING],     no_argument,       0, args_chr[ARG_FALSE_SHARING]    },
+    {args_str[ARG_PLAN_THREADS],     required_argument, 0, args_chr[ARG_PLAN_THREADS]     },
+    {args_str[ARG_POLICY],           required_argument, 0, args_chr[ARG_POLICY]           },
+    {args_str[ARG_COPY_BENCH],        no_argument,       0, args_chr[ARG_COPY_BENCH]       },
+    {args_str[ARG_CRYPTO_BENCH],      no_argument,       0, args_chr[ARG_CRYPTO_BENCH]     },
+    {args_str[ARG_GATHER_BENCH],      no_argument,       0, args_chr[ARG_GATHER_BENCH]     },
+    {args_str[ARG_INSN_TABLE],        no_argument,       0, args_chr[ARG_INSN_TABLE]       },
+    {args_str[ARG_FRONTEND_BENCH],    no_argument,       0, args_chr[ARG_FRONTEND_BENCH]   },
+    {args_str[ARG_RDT],               no_argument,       0, args_chr[ARG_RDT]              },
+    {args_str[ARG_CAT_MASK],          required_argument, 0, args_chr[ARG_CAT_MASK]      },
+    {args_str[ARG_PMU],               no_argument,       0, args_chr[ARG_PMU]              },
+    {args_str[ARG_MITIGATIONS],       no_argument,       0, args_chr[ARG_MITIGATIONS]      },
+    {args_str[ARG_ATOMICS_BENCH],     no_argument,       0, args_chr[ARG_ATOMICS_BENCH]    },
+    {args_str[ARG_DOTPROD_BENCH],     no_argument,       0, args_chr[ARG_DOTPROD_BENCH]    },
+    {args_str[ARG_GEMM_BENCH],        no_argument,       0, args_chr[ARG_GEMM_BENCH]       },
+    {args_str[ARG_OS_NOISE],          no_argument,       0, args_chr[ARG_OS_NOISE]         },
+    {args_str[ARG_NOISE_TIME],        required_argument, 0, args_chr[ARG_NOISE_TIME]       },
+    {args_str[ARG_CPU_ISOLATION],     no_argument,       0, args_chr[ARG_CPU_ISOLATION]    },
+    {args_str[ARG_CORE_RANKING],      no_argument,       0, args_chr[ARG_CORE_RANKING]     },
+    {args_str[ARG_RANK_SCAN],         no_argument,       0, args_chr[ARG_RANK_SCAN]        },
+    {args_str[ARG_FREQ_POLICY],       no_argument,       0, args_chr[ARG_FREQ_POLICY]      },
+    {args_str[ARG_DRAM_INFO],         no_argument,       0, args_chr[ARG_DRAM_INFO]        },
+    {args_str[ARG_DRAM_BENCH],        no_argument,       0, args_chr[ARG_DRAM_BENCH]       },
+    {args_str[ARG_PCI_REPORT],        no_argument,       0, args_chr[ARG_PCI_REPORT]       },
+#endif
+    {args_str[ARG_EMIT_HEADER],      required_argument, 0, args_chr[ARG_EMIT_HEADER]      },
     {args_str[ARG_LOGO_SHORT],       no_argument,       0, args_chr[ARG_LOGO_SHORT]       },
     {args_str[ARG_LOGO_LONG],        no_argument,       0, args_chr[ARG_LOGO_LONG]        },
     {args_str[ARG_DEBUG],            no_argument,       0, args_chr[ARG_DEBUG]            },
@@ -379,6 +682,41 @@ bool parse_args(int argc, char* argv[]) {
         return false;
       }
     }
+    else if(opt == args_chr[ARG_EMIT_HEADER]) {
+      if(args.emit_format != EMIT_NONE) {
+        printErr("Emit header option specified more than once");
+        return false;
+      }
+      args.emit_format = parse_emit_format(optarg);
+      if(args.emit_format == EMIT_INVALID) {
+        printErr("Invalid header format '%s'", optarg);
+        return false;
+      }
+    }
+    else if(opt == args_chr[ARG_PLAN_THREADS]) {
+      if(args.plan_threads != 0) {
+        printErr("Plan threads option specified more than once");
+        return false;
+      }
+      char* end;
+      long n = strtol(optarg, &end, 10);
+      if(*optarg == '\0' || *end != '\0' || n <= 0 || n > INT32_MAX) {
+        printErr("Invalid number of threads '%s'", optarg);
+        return false;
+      }
+      args.plan_threads = n;
+    }
+    else if(opt == args_chr[ARG_POLICY]) {
+      if(args.policy != POLICY_INVALID) {
+        printErr("Policy option specified more than once");
+        return false;
+      }
+      args.policy = parse_policy(optarg);
+      if(args.policy == POLICY_INVALID) {
+        printErr("Invalid policy '%s'", optarg);
+        return false;
+      }
+    }
     else if(opt == args_chr[ARG_HELP]) {
       args.help_flag  = true;
     }
@@ -424,6 +762,101 @@ bool parse_args(int argc, char* argv[]) {
     else if(opt == args_chr[ARG_VERSION]) {
       args.version_flag = true;
     }
+    else if(opt == args_chr[ARG_WAKEUP_LATENCY]) {
+      args.wakeup_latency_flag = true;
+    }
+    else if(opt == args_chr[ARG_NUMA_MATRIX]) {
+      args.numa_matrix_flag = true;
+    }
+    else if(opt == args_chr[ARG_TLB_BENCH]) {
+      args.tlb_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_MLP]) {
+      args.mlp_flag = true;
+    }
+    else if(opt == args_chr[ARG_FALSE_SHARING]) {
+      args.false_sharing_flag = true;
+    }
+    else if(opt == args_chr[ARG_COPY_BENCH]) {
+      args.copy_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_CRYPTO_BENCH]) {
+      args.crypto_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_GATHER_BENCH]) {
+      args.gather_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_INSN_TABLE]) {
+      args.insn_table_flag = true;
+    }
+    else if(opt == args_chr[ARG_FRONTEND_BENCH]) {
+      args.frontend_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_RDT]) {
+      args.rdt_flag = true;
+    }
+    else if(opt == args_chr[ARG_CAT_MASK]) {
+      char* end;
+      errno = 0;
+      unsigned long long mask = strtoull(optarg, &end, 16);
+      if(*optarg == '\0' || *end != '\0' || errno != 0 || mask == 0) {
+        printErr("Invalid CAT mask '%s'", optarg);
+        return false;
+      }
+      args.cat_mask = mask;
+      args.rdt_flag = true; // implies the RDT report
+    }
+    else if(opt == args_chr[ARG_PMU]) {
+      args.pmu_flag = true;
+    }
+    else if(opt == args_chr[ARG_MITIGATIONS]) {
+      args.mitigations_flag = true;
+    }
+    else if(opt == args_chr[ARG_ATOMICS_BENCH]) {
+      args.atomics_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_DOTPROD_BENCH]) {
+      args.dotprod_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_GEMM_BENCH]) {
+      args.gemm_bench_flag = true;
+    }
+    else if(opt == args_chr[ARG_OS_NOISE]) {
+      args.os_noise_flag = true;
+    }
+    else if(opt == args_chr[ARG_NOISE_TIME]) {
+      char* end;
+      long n = strtol(optarg, &end, 10);
+      if(*optarg == '\0' || *end != '\0' || n <= 0 || n > MAX_NOISE_TIME) {
+        printErr("Invalid OS noise time '%s' (must be between 1 and %d seconds)", optarg, MAX_NOISE_TIME);
+        return false;
+      }
+      args.noise_time = n;
+      args.os_noise_flag = true; // implies the OS noise benchmark
+    }
+    else if(opt == args_chr[ARG_CPU_ISOLATION]) {
+      args.cpu_isolation = true;
+    }
+    else if(opt == args_chr[ARG_CORE_RANKING]) {
+      args.core_ranking = true;
+    }
+    else if(opt == args_chr[ARG_RANK_SCAN]) {
+      args.rank_scan = true;
+      args.core_ranking = true; // implies the core ranking
+    }
+    else if(opt == args_chr[ARG_FREQ_POLICY]) {
+      args.freq_policy = true;
+    }
+    else if(opt == args_chr[ARG_DRAM_INFO]) {
+      args.dram_info = true;
+    }
+    else if(opt == args_chr[ARG_DRAM_BENCH]) {
+      args.dram_bench = true;
+      args.dram_info = true; // implies the DRAM report
+    }
+    else if(opt == args_chr[ARG_PCI_REPORT]) {
+      args.pci_report = true;
+    }
     else {
       printWarn("Invalid options");
       args.help_flag  = true;
@@ -438,6 +871,11 @@ bool parse_args(int argc, char* argv[]) {
     args.help_flag  = true;
   }
 
+  if(args.policy != POLICY_INVALID && args.plan_threads == 0) {
+    printErr("%s option is valid only with %s", args_str[ARG_POLICY], args_str[ARG_PLAN_THREADS]);
+    return false;
+  }
+
   if(args.logo_intel_new && args.logo_intel_old) {
     printWarn("%s and %s cannot be specified together", args_str[ARG_LOGO_INTEL_NEW], args_str[ARG_LOGO_INTEL_OLD]);
     args.logo_intel_new = false;
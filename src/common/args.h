@@ -4,6 +4,10 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Duration of --os-noise, in seconds
+#define DEFAULT_NOISE_TIME  5
+#define MAX_NOISE_TIME      3600
+
 struct color {
   int32_t R;
   int32_t G;
@@ -18,6 +22,22 @@ enum {
   STYLE_INVALID
 };
 
+enum {
+  EMIT_NONE,
+  EMIT_C,
+  EMIT_CMAKE,
+  EMIT_PKGCONFIG,
+  EMIT_INVALID
+};
+
+enum {
+  POLICY_SPREAD,
+  POLICY_COMPACT,
+  POLICY_PER_L3,
+  POLICY_P_CORES_FIRST,
+  POLICY_INVALID
+};
+
 enum {
   ARG_STYLE,
   ARG_COLOR,
@@ -34,7 +54,36 @@ enum {
   ARG_MEASURE_MAX_FREQ,
   ARG_DEBUG,
   ARG_VERBOSE,
-  ARG_VERSION
+  ARG_VERSION,
+  ARG_WAKEUP_LATENCY,
+  ARG_NUMA_MATRIX,
+  ARG_TLB_BENCH,
+  ARG_MLP,
+  ARG_FALSE_SHARING,
+  ARG_EMIT_HEADER,
+  ARG_PLAN_THREADS,
+  ARG_POLICY,
+  ARG_COPY_BENCH,
+  ARG_CRYPTO_BENCH,
+  ARG_GATHER_BENCH,
+  ARG_INSN_TABLE,
+  ARG_FRONTEND_BENCH,
+  ARG_RDT,
+  ARG_CAT_MASK,
+  ARG_PMU,
+  ARG_MITIGATIONS,
+  ARG_ATOMICS_BENCH,
+  ARG_DOTPROD_BENCH,
+  ARG_GEMM_BENCH,
+  ARG_OS_NOISE,
+  ARG_NOISE_TIME,
+  ARG_CPU_ISOLATION,
+  ARG_CORE_RANKING,
+  ARG_RANK_SCAN,
+  ARG_FREQ_POLICY,
+  ARG_DRAM_INFO,
+  ARG_DRAM_BENCH,
+  ARG_PCI_REPORT
 };
 
 extern const char args_chr[];
@@ -58,6 +107,36 @@ bool show_raw(void);
 bool show_debug(void);
 bool show_version(void);
 bool verbose_enabled(void);
+bool wakeup_latency_flag(void);
+bool numa_matrix_flag(void);
+bool tlb_bench_flag(void);
+bool mlp_flag(void);
+bool false_sharing_flag(void);
+int get_emit_format(void);
+int get_plan_threads(void);
+int get_policy(void);
+const char* get_str_policy(int policy);
+bool copy_bench_flag(void);
+bool crypto_bench_flag(void);
+bool gather_bench_flag(void);
+bool insn_table_flag(void);
+bool frontend_bench_flag(void);
+bool rdt_flag(void);
+uint64_t get_cat_mask(void);
+bool pmu_flag(void);
+bool mitigations_flag(void);
+bool atomics_bench_flag(void);
+bool dotprod_bench_flag(void);
+bool gemm_bench_flag(void);
+bool os_noise_flag(void);
+int get_noise_time(void);
+bool cpu_isolation_flag(void);
+bool core_ranking_flag(void);
+bool rank_scan_flag(void);
+bool freq_policy_flag(void);
+bool dram_info_flag(void);
+bool dram_bench_flag(void);
+bool pci_report_flag(void);
 void free_colors_struct(struct color** cs);
 struct color** get_colors(void);
 STYLE get_style(void);
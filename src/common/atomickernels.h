@@ -0,0 +1,96 @@
+#ifndef __ATOMIC_KERNELS__
+#define __ATOMIC_KERNELS__
+
+#include <stdint.h>
+
+#include "bench.h"
+
+// Kernels of the atomics benchmark. They are static inline so that
+// each file including this header gets its own copy, compiled with
+// its own flags: this is how ARM builds a LSE and a LL/SC version.
+// Every kernel runs until sh->stop is set and returns the number of
+// operations performed by the calling thread.
+
+#define ATOMIC_LINE_SIZE   128
+// Operations between two checks of the stop flag
+#define ATOMIC_BATCH       64
+
+enum {
+  ATOMIC_FETCH_ADD,
+  ATOMIC_CAS,
+  ATOMIC_EXCHANGE,
+  ATOMIC_TICKET_LOCK,
+  ATOMIC_NUM_OPS
+};
+
+// All the contended data lives in the first line; the stop flag is
+// only written once, but it is kept in its own line anyway
+struct atomic_shared {
+  uint64_t value;
+  uint32_t next_ticket;
+  uint32_t owner;
+  uint64_t protected_data;
+  char pad[ATOMIC_LINE_SIZE - 3 * sizeof(uint64_t)];
+  uint32_t stop;
+} __attribute__((aligned(ATOMIC_LINE_SIZE)));
+
+typedef uint64_t (*atomic_fn)(struct atomic_shared* sh);
+
+static inline uint64_t atomic_fetch_add_kernel(struct atomic_shared* sh) {
+  uint64_t ops = 0;
+  while(!__atomic_load_n(&sh->stop, __ATOMIC_RELAXED)) {
+    for(int i=0; i < ATOMIC_BATCH; i++)
+      __atomic_fetch_add(&sh->value, 1, __ATOMIC_SEQ_CST);
+    ops += ATOMIC_BATCH;
+  }
+  return ops;
+}
+
+// Failed attempts are retried and do not count as operations
+static inline uint64_t atomic_cas_kernel(struct atomic_shared* sh) {
+  uint64_t ops = 0;
+  while(!__atomic_load_n(&sh->stop, __ATOMIC_RELAXED)) {
+    for(int i=0; i < ATOMIC_BATCH; i++) {
+      uint64_t v = __atomic_load_n(&sh->value, __ATOMIC_RELAXED);
+      while(!__atomic_compare_exchange_n(&sh->value, &v, v + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+    }
+    ops += ATOMIC_BATCH;
+  }
+  return ops;
+}
+
+static inline uint64_t atomic_exchange_kernel(struct atomic_shared* sh) {
+  uint64_t ops = 0;
+  while(!__atomic_load_n(&sh->stop, __ATOMIC_RELAXED)) {
+    for(int i=0; i < ATOMIC_BATCH; i++)
+      __atomic_exchange_n(&sh->value, ops + i, __ATOMIC_SEQ_CST);
+    ops += ATOMIC_BATCH;
+  }
+  return ops;
+}
+
+// One operation is a lock acquire, an update of the protected data
+// and a release. The lock is always released before checking the
+// stop flag, so no thread can be left waiting forever
+static inline uint64_t atomic_ticket_lock_kernel(struct atomic_shared* sh) {
+  uint64_t ops = 0;
+  while(!__atomic_load_n(&sh->stop, __ATOMIC_RELAXED)) {
+    for(int i=0; i < ATOMIC_BATCH; i++) {
+      uint32_t ticket = __atomic_fetch_add(&sh->next_ticket, 1, __ATOMIC_RELAXED);
+      while(__atomic_load_n(&sh->owner, __ATOMIC_ACQUIRE) != ticket) cpu_relax();
+      sh->protected_data++;
+      __atomic_store_n(&sh->owner, ticket + 1, __ATOMIC_RELEASE);
+    }
+    ops += ATOMIC_BATCH;
+  }
+  return ops;
+}
+
+#define ATOMIC_KERNELS { \
+  [ATOMIC_FETCH_ADD]   = atomic_fetch_add_kernel, \
+  [ATOMIC_CAS]         = atomic_cas_kernel, \
+  [ATOMIC_EXCHANGE]    = atomic_exchange_kernel, \
+  [ATOMIC_TICKET_LOCK] = atomic_ticket_lock_kernel \
+}
+
+#endif
@@ -0,0 +1,320 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "atomickernels.h"
+#include "atomics.h"
+
+#ifdef ARCH_ARM
+  #include "../arm/atomics/atomics.h"
+#endif
+
+// Time each configuration runs for
+#define ATOMIC_RUN_US   (100 * 1000)
+
+struct atomic_impl {
+  const char* name;
+  const atomic_fn* kernels;
+};
+
+struct atomic_thread {
+  struct atomic_shared* sh;
+  atomic_fn fn;
+  volatile uint32_t* ready;
+  volatile uint32_t* start;
+  uint64_t ops;
+  uint64_t ns;
+};
+
+static const char* atomic_op_names[ATOMIC_NUM_OPS] = {
+  [ATOMIC_FETCH_ADD]   = "fetch_add",
+  [ATOMIC_CAS]         = "CAS loop",
+  [ATOMIC_EXCHANGE]    = "exchange",
+  [ATOMIC_TICKET_LOCK] = "ticket lock"
+};
+
+#ifndef ARCH_ARM
+static const atomic_fn atomics_default[ATOMIC_NUM_OPS] = ATOMIC_KERNELS;
+#endif
+
+void* atomic_thread(void* arg) {
+  struct atomic_thread* th = (struct atomic_thread*) arg;
+
+  __atomic_fetch_add(th->ready, 1, __ATOMIC_RELEASE);
+  while(!__atomic_load_n(th->start, __ATOMIC_ACQUIRE)) cpu_relax();
+
+  uint64_t t0 = get_time_ns();
+  th->ops = th->fn(th->sh);
+  th->ns = get_time_ns() - t0;
+
+  return NULL;
+}
+
+// Runs fn in nthreads threads (placed in the first nthreads CPUs of
+// cpus) for ATOMIC_RUN_US. Returns false on error; otherwise, stores
+// the aggregated operations per second and the average time per
+// operation seen by each thread
+bool run_atomic_kernel(atomic_fn fn, int* cpus, int nthreads, double* ops_per_s, double* ns_per_op) {
+  struct atomic_shared* sh = aligned_alloc(ATOMIC_LINE_SIZE, sizeof(struct atomic_shared));
+  struct atomic_thread* th = ecalloc(nthreads, sizeof(struct atomic_thread));
+  pthread_t* threads = emalloc(sizeof(pthread_t) * nthreads);
+  volatile uint32_t ready = 0;
+  volatile uint32_t start = 0;
+  int created = 0;
+  bool ret = true;
+
+  if(sh == NULL) {
+    printErr("aligned_alloc failed");
+    free(th);
+    free(threads);
+    return false;
+  }
+  memset(sh, 0, sizeof(struct atomic_shared));
+
+  for(int i=0; i < nthreads && ret; i++) {
+    th[i].sh = sh;
+    th[i].fn = fn;
+    th[i].ready = &ready;
+    th[i].start = &start;
+    if(create_thread_on_cpu(&threads[i], cpus[i], atomic_thread, &th[i])) created++;
+    else ret = false;
+  }
+
+  // On error, the created threads are released and stopped right away
+  while(__atomic_load_n(&ready, __ATOMIC_ACQUIRE) != (uint32_t) created) cpu_relax();
+  if(!ret) __atomic_store_n(&sh->stop, 1, __ATOMIC_RELAXED);
+  __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+  if(ret) sleep_us(ATOMIC_RUN_US);
+  __atomic_store_n(&sh->stop, 1, __ATOMIC_RELAXED);
+
+  for(int i=0; i < created; i++) pthread_join(threads[i], NULL);
+
+  if(ret) {
+    uint64_t total_ops = 0;
+    uint64_t max_ns = 0;
+    double sum_ns_per_op = 0.0;
+    for(int i=0; i < nthreads; i++) {
+      total_ops += th[i].ops;
+      if(th[i].ns > max_ns) max_ns = th[i].ns;
+      if(th[i].ops > 0) sum_ns_per_op += (double) th[i].ns / th[i].ops;
+    }
+    *ops_per_s = max_ns > 0 ? (double) total_ops * 1e9 / max_ns : 0.0;
+    *ns_per_op = sum_ns_per_op / nthreads;
+  }
+
+  free(sh);
+  free(th);
+  free(threads);
+  return ret;
+}
+
+// Reorders the CPUs so that consecutive CPUs alternate between the
+// different L3s (or packages), which places the second thread on
+// the farthest domain and balances the rest
+void interleave_cpus(struct cpu_map* map, int* cpus, int n, bool by_package) {
+  int* out = emalloc(sizeof(int) * n);
+  bool* used = ecalloc(n, sizeof(bool));
+  int32_t* round_keys = emalloc(sizeof(int32_t) * n);
+  int nout = 0;
+
+  while(nout < n) {
+    int nkeys = 0;
+    for(int i=0; i < n; i++) {
+      if(used[i]) continue;
+      struct cpu_location* loc = &map->cpus[cpus[i]];
+      int32_t key = by_package ? loc->package : loc->l3;
+      bool seen = false;
+      for(int k=0; k < nkeys && !seen; k++) seen = round_keys[k] == key;
+      if(seen) continue;
+      round_keys[nkeys++] = key;
+      used[i] = true;
+      out[nout++] = cpus[i];
+    }
+  }
+
+  memcpy(cpus, out, sizeof(int) * n);
+  free(round_keys);
+  free(used);
+  free(out);
+}
+
+// Fills cpus with the CPUs where threads are placed for the domain
+// given by relation (relative to the first CPU), returning how many
+// there are. Except for the SMT domain, only one thread runs in each
+// physical core, so that SMT does not get mixed with the domain.
+int get_domain_cpus(struct cpu_map* map, bool* allowed, int first, int relation, int* cpus) {
+  int n = 0;
+
+  for(int i=0; i < map->num_cpus; i++) {
+    if(!allowed[i] || !map->cpus[i].online) continue;
+    int rel = get_cpu_relation(map, first, i);
+    if(rel == CPU_RELATION_INVALID || rel > relation) continue;
+    if(relation == CPU_RELATION_SMT) {
+      cpus[n++] = i;
+      continue;
+    }
+
+    bool same_core = false;
+    for(int j=0; j < n && !same_core; j++) {
+      same_core = get_cpu_relation(map, cpus[j], i) == CPU_RELATION_SMT;
+    }
+    if(!same_core) cpus[n++] = i;
+  }
+
+  if(relation == CPU_RELATION_SOCKET) interleave_cpus(map, cpus, n, false);
+  else if(relation == CPU_RELATION_CROSS_SOCKET) interleave_cpus(map, cpus, n, true);
+
+  // The domain is only meaningful if the first two threads are
+  // actually placed with that relation
+  if(n < 2 || get_cpu_relation(map, cpus[0], cpus[1]) != relation) return 0;
+  return n;
+}
+
+void print_domain_cpus(int* cpus, int n, int ncpus) {
+  bool* set = ecalloc(ncpus, sizeof(bool));
+  for(int i=0; i < n; i++) set[cpus[i]] = true;
+  char* str = get_str_cpu_list(set, ncpus);
+  printf("CPUs %s", str);
+  free(str);
+  free(set);
+}
+
+void print_atomics_header(void) {
+  printf("  %7s", "Threads");
+  for(int op=0; op < ATOMIC_NUM_OPS; op++) printf(" %18s", atomic_op_names[op]);
+  printf("\n  %7s", "");
+  for(int op=0; op < ATOMIC_NUM_OPS; op++) printf(" %9s %8s", "Mops/s", "ns/op");
+  printf("\n");
+}
+
+bool print_atomics_row(const struct atomic_impl* impl, int* cpus, int nthreads) {
+  printf("  %7d", nthreads);
+  for(int op=0; op < ATOMIC_NUM_OPS; op++) {
+    double ops_per_s, ns_per_op;
+    if(!run_atomic_kernel(impl->kernels[op], cpus, nthreads, &ops_per_s, &ns_per_op)) {
+      printf("\n");
+      return false;
+    }
+    printf(" %9.2f %8.2f", ops_per_s / 1e6, ns_per_op);
+    fflush(stdout);
+  }
+  printf("\n");
+  return true;
+}
+
+bool print_atomics_impl(const struct atomic_impl* impl, struct cpu_map* map, bool* allowed, int first) {
+  const int relations[] = { CPU_RELATION_SMT, CPU_RELATION_L3, CPU_RELATION_SOCKET, CPU_RELATION_CROSS_SOCKET };
+  const int nrelations = sizeof(relations) / sizeof(relations[0]);
+  int* cpus = emalloc(sizeof(int) * map->num_cpus);
+  bool ret = true;
+
+  printf("\nAtomics: %s\n", impl->name);
+  printf("\nUncontended (CPU %d):\n", first);
+  print_atomics_header();
+  ret = print_atomics_row(impl, &first, 1);
+
+  for(int r=0; r < nrelations && ret; r++) {
+    int n = get_domain_cpus(map, allowed, first, relations[r], cpus);
+    if(n == 0) {
+      printf("\n%s: no CPUs available in this domain\n", get_str_cpu_relation(relations[r]));
+      continue;
+    }
+
+    printf("\n%s (", get_str_cpu_relation(relations[r]));
+    print_domain_cpus(cpus, n, map->num_cpus);
+    printf("):\n");
+    print_atomics_header();
+    for(int t=2; t <= n && ret; t = (t == n || t * 2 <= n) ? t * 2 : n) {
+      ret = print_atomics_row(impl, cpus, t);
+    }
+  }
+
+  free(cpus);
+  return ret;
+}
+
+// Returns the implementations of the atomic operations to compare,
+// which are the LSE and LL/SC versions in ARM
+int get_atomic_impls(struct cpuInfo* cpu, struct atomic_impl* impls) {
+  int n = 0;
+#ifdef ARCH_ARM
+  // Threads may run in any module, so all of them must support LSE
+  bool lse = true;
+  for(int m=0; m < get_num_modules(cpu); m++) {
+    if(!get_module(cpu, m)->feat->LSE) lse = false;
+  }
+
+  if(!lse) printf("LSE atomics: not supported by the CPU\n");
+  else if(!atomics_lse_compiled()) printWarn("LSE atomics are supported by the CPU, but cpufetch was compiled without LSE support");
+  else impls[n++] = (struct atomic_impl) { "LSE (single instruction)", atomics_lse };
+
+  if(atomics_llsc_compiled()) impls[n++] = (struct atomic_impl) { "LL/SC (exclusive load/store loops)", atomics_llsc };
+  else printWarn("cpufetch was compiled without LL/SC atomics support");
+#elif defined(ARCH_X86)
+  UNUSED(cpu);
+  impls[n++] = (struct atomic_impl) { "lock prefixed instructions", atomics_default };
+#else
+  UNUSED(cpu);
+  impls[n++] = (struct atomic_impl) { "compiler default", atomics_default };
+#endif
+  return n;
+}
+
+// Measures fetch_add, CAS loops, exchange and a ticket spinlock on a
+// single shared line, with an increasing number of threads placed in
+// the same core (SMT), sharing the L3, in the same socket and across
+// sockets. The cost of an atomic is dominated by moving the line
+// between cores, so it reflects the distance between them.
+bool print_atomics_benchmark(struct cpuInfo* cpu) {
+  struct atomic_impl impls[2];
+  int nimpls = get_atomic_impls(cpu, impls);
+  if(nimpls == 0) {
+    printErr("No atomic operations implementation available");
+    return false;
+  }
+
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  if(!get_allowed_cpus(allowed, map->num_cpus)) {
+    free(allowed);
+    free_cpu_map(map);
+    return false;
+  }
+
+  int first = -1;
+  for(int i=0; i < map->num_cpus && first == -1; i++) {
+    if(allowed[i] && map->cpus[i].online) first = i;
+  }
+  if(first == -1) {
+    printErr("Unable to find an online CPU to run the benchmark");
+    free(allowed);
+    free_cpu_map(map);
+    return false;
+  }
+
+  printf("cpufetch is measuring atomic operations on a shared cache line...\n");
+  printf("Mops/s is the aggregated throughput; ns/op is the average time per operation seen by each thread\n");
+
+  bool ret = true;
+  for(int i=0; i < nimpls && ret; i++) {
+    ret = print_atomics_impl(&impls[i], map, allowed, first);
+  }
+
+  free(allowed);
+  free_cpu_map(map);
+  return ret;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __ATOMICS__
+#define __ATOMICS__
+
+#include "cpu.h"
+
+bool print_atomics_benchmark(struct cpuInfo* cpu);
+
+#endif
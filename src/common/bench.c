@@ -0,0 +1,78 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "global.h"
+#include "bench.h"
+
+uint64_t get_time_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+void sleep_us(uint64_t us) {
+  struct timespec ts;
+  ts.tv_sec = us / 1000000;
+  ts.tv_nsec = (us % 1000000) * 1000;
+  while(nanosleep(&ts, &ts) == -1 && errno == EINTR);
+}
+
+// Creates a thread that starts running already bound to the CPU
+// specified. As in measure_frequency, we cannot rely on the affinity
+// of the main thread, since we might have called bind_to_cpu before.
+bool create_thread_on_cpu(pthread_t* thread, int cpu, void* (*function)(void*), void* arg) {
+  int ret;
+  cpu_set_t cpus;
+  pthread_attr_t attr;
+
+  if((ret = pthread_attr_init(&attr)) != 0) {
+    printErr("pthread_attr_init: %s", strerror(ret));
+    return false;
+  }
+
+  CPU_ZERO(&cpus);
+  CPU_SET(cpu, &cpus);
+  if((ret = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus)) != 0) {
+    printErr("pthread_attr_setaffinity_np: %s", strerror(ret));
+    pthread_attr_destroy(&attr);
+    return false;
+  }
+
+  if((ret = pthread_create(thread, &attr, function, arg)) != 0) {
+    printErr("pthread_create on CPU %d: %s", cpu, strerror(ret));
+    pthread_attr_destroy(&attr);
+    return false;
+  }
+
+  pthread_attr_destroy(&attr);
+  return true;
+}
+
+int compare_samples(const void* a, const void* b) {
+  uint64_t x = *(const uint64_t *) a;
+  uint64_t y = *(const uint64_t *) b;
+  return (x > y) - (x < y);
+}
+
+void sort_samples(uint64_t* samples, int n) {
+  qsort(samples, n, sizeof(uint64_t), compare_samples);
+}
+
+// Nearest-rank percentile (percentile in [0, 100])
+uint64_t get_percentile(uint64_t* sorted_samples, int n, double percentile) {
+  if(n <= 0) return 0;
+
+  int idx = (int) (percentile / 100.0 * n + 0.5) - 1;
+  if(idx < 0) idx = 0;
+  if(idx >= n) idx = n - 1;
+  return sorted_samples[idx];
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,44 @@
+#ifndef __BENCH__
+#define __BENCH__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+// Helpers shared by the benchmark modes (Linux only)
+
+static inline void cpu_relax(void) {
+#if defined(ARCH_X86)
+  __asm volatile("pause" ::: "memory");
+#elif defined(ARCH_ARM) && defined(__aarch64__)
+  __asm volatile("yield" ::: "memory");
+#else
+  __asm volatile("" ::: "memory");
+#endif
+}
+
+uint64_t get_time_ns(void);
+void sleep_us(uint64_t us);
+bool create_thread_on_cpu(pthread_t* thread, int cpu, void* (*function)(void*), void* arg);
+void sort_samples(uint64_t* samples, int n);
+uint64_t get_percentile(uint64_t* sorted_samples, int n, double percentile);
+
+// Reads the cycle counter (the TSC in x86, the virtual counter in
+// AArch64), which is cheaper and finer than get_time_ns. It runs at a
+// constant rate that has to be calibrated against get_time_ns. Other
+// architectures fall back to get_time_ns itself.
+static inline uint64_t get_cycles(void) {
+#if defined(ARCH_X86)
+  uint32_t lo, hi;
+  __asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64_t) hi << 32) | lo;
+#elif defined(ARCH_ARM) && defined(__aarch64__)
+  uint64_t cnt;
+  __asm volatile("isb; mrs %0, cntvct_el0" : "=r"(cnt) :: "memory");
+  return cnt;
+#else
+  return get_time_ns();
+#endif
+}
+
+#endif
@@ -0,0 +1,301 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "bench.h"
+#include "membench.h"
+#include "copybench.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+  #include "../x86/copy/copy.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+  #include "../arm/copy/copy.h"
+#endif
+
+#define COPY_MIN_SIZE          16UL
+#define COPY_MAX_SIZE          (64UL * 1024 * 1024)
+#define COPY_NUM_SIZES         23
+// Bytes moved in each sample, so that small sizes are repeated enough
+#define COPY_BYTES_PER_SAMPLE  (128UL * 1024 * 1024)
+#define COPY_REPS              3
+#define COPY_MAX_STRATEGIES    5
+// A strategy must be this much faster than libc to be reported as better
+#define COPY_MARGIN            1.03
+#define COPY_SET_VALUE         0x5A
+
+typedef void (*copy_fn)(void* dst, const void* src, size_t n);
+typedef void (*set_fn)(void* dst, int c, size_t n);
+
+struct copy_strategy {
+  const char* name;
+  copy_fn copy;
+  set_fn set;
+};
+
+void copy_libc(void* dst, const void* src, size_t n) {
+  memcpy(dst, src, n);
+}
+
+void set_libc(void* dst, int c, size_t n) {
+  memset(dst, c, n);
+}
+
+// Fills the strategies supported by the CPU (libc is always the first one)
+int get_copy_strategies(struct cpuInfo* cpu, struct copy_strategy* st) {
+  int n = 0;
+  st[n++] = (struct copy_strategy) { "libc", copy_libc, set_libc };
+
+#ifdef ARCH_X86
+  st[n++] = (struct copy_strategy) { "rep string", copy_rep_movsb, set_rep_stosb };
+  if(cpu->feat->AVX2)
+    st[n++] = (struct copy_strategy) { "AVX2", copy_avx2, set_avx2 };
+  if(cpu->feat->AVX512)
+    st[n++] = (struct copy_strategy) { "AVX-512", copy_avx512, set_avx512 };
+#ifdef __SSE2__
+  if(cpu->feat->SSE2)
+    st[n++] = (struct copy_strategy) { "non-temporal", copy_nt, set_nt };
+#endif
+#elif ARCH_ARM
+#if defined(__ARM_NEON) && defined(__aarch64__)
+  if(cpu->feat->NEON)
+    st[n++] = (struct copy_strategy) { "NEON", copy_neon, set_neon };
+#endif
+  if(cpu->feat->SVE) {
+    if(copy_sve_compiled())
+      st[n++] = (struct copy_strategy) { "SVE", copy_sve, set_sve };
+    else
+      printWarn("CPU supports SVE, but it was not enabled by the compiler");
+  }
+  if(cpu->feat->MOPS) {
+    if(copy_mops_compiled())
+      st[n++] = (struct copy_strategy) { "MOPS", copy_mops, set_mops };
+    else
+      printWarn("CPU supports MOPS, but it was not enabled by the compiler");
+  }
+#else
+  UNUSED(cpu);
+#endif
+
+  return n;
+}
+
+void get_str_copy_size(char* str, size_t len, size_t bytes) {
+  if(bytes >= (1UL << 20))
+    snprintf(str, len, "%lu MiB", (unsigned long) (bytes >> 20));
+  else if(bytes >= (1UL << 10))
+    snprintf(str, len, "%lu KiB", (unsigned long) (bytes >> 10));
+  else
+    snprintf(str, len, "%lu B", (unsigned long) bytes);
+}
+
+// Returns the best bandwidth (in bytes/s) out of COPY_REPS samples. The
+// same region is copied over and over, so sizes that fit in a cache level
+// measure that level
+double measure_copy(struct copy_strategy* st, bool set, void* dst, void* src, size_t size) {
+  uint64_t iters = size >= COPY_BYTES_PER_SAMPLE ? 1 : COPY_BYTES_PER_SAMPLE / size;
+  double best = 0.0;
+
+  if(set) st->set(dst, COPY_SET_VALUE, size);
+  else st->copy(dst, src, size);
+
+  for(int r=0; r < COPY_REPS; r++) {
+    uint64_t t0 = get_time_ns();
+    if(set) {
+      for(uint64_t i=0; i < iters; i++) {
+        st->set(dst, COPY_SET_VALUE, size);
+        __asm volatile("" ::: "memory");
+      }
+    }
+    else {
+      for(uint64_t i=0; i < iters; i++) {
+        st->copy(dst, src, size);
+        __asm volatile("" ::: "memory");
+      }
+    }
+    uint64_t t1 = get_time_ns();
+    if(t1 == t0) t1++;
+
+    double bw = (double) size * iters / ((double) (t1 - t0) / 1e9);
+    if(bw > best) best = bw;
+  }
+
+  return best;
+}
+
+bool check_copy(struct copy_strategy* st, bool set, uint8_t* dst, uint8_t* src, size_t size) {
+  bool ok;
+
+  if(set) ok = dst[0] == COPY_SET_VALUE && dst[size/2] == COPY_SET_VALUE && dst[size-1] == COPY_SET_VALUE;
+  else ok = memcmp(dst, src, size) == 0;
+
+  if(!ok) {
+    printBug("%s %s produced a wrong result for %lu bytes", st->name, set ? "memset" : "memcpy", (unsigned long) size);
+  }
+  // Leave the destination dirty for the next strategy
+  memset(dst, 0, size);
+  return ok;
+}
+
+void get_str_size_range(char* str, size_t len, int first, int last) {
+  char from[32];
+  char to[32];
+
+  get_str_copy_size(from, sizeof(from), COPY_MIN_SIZE << first);
+  get_str_copy_size(to, sizeof(to), COPY_MIN_SIZE << last);
+  if(first == last) snprintf(str, len, "%s", from);
+  else snprintf(str, len, "%s - %s", from, to);
+}
+
+void print_size_ranges(bool* in_range) {
+  char range[80];
+  bool first = true;
+
+  for(int s=0; s < COPY_NUM_SIZES; s++) {
+    if(!in_range[s]) continue;
+    int e = s;
+    while(e+1 < COPY_NUM_SIZES && in_range[e+1]) e++;
+
+    get_str_size_range(range, sizeof(range), s, e);
+    printf("%s%s", first ? "" : ", ", range);
+    first = false;
+    s = e;
+  }
+
+  printf("%s\n", first ? "never" : "");
+}
+
+// Prints the bandwidth of each strategy for each size, followed by the
+// size ranges where each strategy is the fastest and where it beats libc
+bool print_copy_table(struct copy_strategy* st, int nst, bool set, void* dst, void* src) {
+  double bw[COPY_NUM_SIZES][COPY_MAX_STRATEGIES];
+  bool in_range[COPY_NUM_SIZES];
+  char size_str[32];
+
+  printf("\n  %-9s", set ? "memset" : "memcpy");
+  for(int k=0; k < nst; k++) printf(" %12s", st[k].name);
+  printf("   (GB/s)\n");
+
+  for(int s=0; s < COPY_NUM_SIZES; s++) {
+    size_t size = COPY_MIN_SIZE << s;
+    get_str_copy_size(size_str, sizeof(size_str), size);
+    printf("  %9s", size_str);
+    for(int k=0; k < nst; k++) {
+      bw[s][k] = measure_copy(&st[k], set, dst, src, size);
+      if(!check_copy(&st[k], set, dst, src, size)) return false;
+      printf(" %12.1f", bw[s][k] / 1e9);
+    }
+    printf("\n");
+  }
+
+  // Strategies within COPY_MARGIN of the fastest one are considered
+  // as fast, so that the noise does not split the ranges
+  printf("\n  Fastest %s:\n", set ? "memset" : "memcpy");
+  int s = 0;
+  while(s < COPY_NUM_SIZES) {
+    int best = 0;
+    for(int k=1; k < nst; k++) {
+      if(bw[s][k] > bw[s][best]) best = k;
+    }
+    int e = s;
+    while(e+1 < COPY_NUM_SIZES) {
+      double fastest = 0.0;
+      for(int k=0; k < nst; k++) {
+        if(bw[e+1][k] > fastest) fastest = bw[e+1][k];
+      }
+      if(bw[e+1][best] * COPY_MARGIN < fastest) break;
+      e++;
+    }
+
+    char range[80];
+    get_str_size_range(range, sizeof(range), s, e);
+    printf("    %-21s %s\n", range, st[best].name);
+    s = e + 1;
+  }
+
+  if(nst > 1) printf("  Faster than libc:\n");
+  for(int k=1; k < nst; k++) {
+    for(int i=0; i < COPY_NUM_SIZES; i++) {
+      in_range[i] = bw[i][k] > bw[i][0] * COPY_MARGIN;
+    }
+    printf("    %-21s ", st[k].name);
+    print_size_ranges(in_range);
+  }
+
+  return true;
+}
+
+void print_copy_features(struct cpuInfo* cpu) {
+#ifdef ARCH_X86
+  struct features* feat = cpu->feat;
+  printf("  ERMS: %s, FSRM: %s, FZRM: %s, FSRS: %s\n", feat->ERMS ? "Yes" : "No", feat->FSRM ? "Yes" : "No",
+         feat->FZRM ? "Yes" : "No", feat->FSRS ? "Yes" : "No");
+#elif ARCH_ARM
+  printf("  MOPS: %s\n", cpu->feat->MOPS ? "Yes" : "No");
+#else
+  UNUSED(cpu);
+#endif
+}
+
+bool print_copy_module(struct cpuInfo* cpu, int module, void* dst, void* src) {
+  struct cpuInfo* ptr = get_module(cpu, module);
+  int32_t first_cpu = get_module_first_cpu(cpu, module);
+  struct copy_strategy st[COPY_MAX_STRATEGIES];
+
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    return false;
+  }
+
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  printf("\n%s (CPU %d):\n", get_str_uarch(ptr), first_cpu);
+#else
+  printf("\nCPU %d:\n", first_cpu);
+#endif
+  print_copy_features(ptr);
+
+  int nst = get_copy_strategies(ptr, st);
+  return print_copy_table(st, nst, false, dst, src) &&
+         print_copy_table(st, nst, true, dst, src);
+}
+
+// Measures memcpy and memset throughput from COPY_MIN_SIZE to COPY_MAX_SIZE
+// with each copy strategy supported by the CPU and reports the sizes where
+// each one is the best choice, for each module (core type) of the CPU.
+bool print_copy_benchmark(struct cpuInfo* cpu) {
+  void* src = alloc_bench_buffer(COPY_MAX_SIZE);
+  void* dst = alloc_bench_buffer(COPY_MAX_SIZE);
+  if(src == NULL || dst == NULL) {
+    if(src != NULL) free_bench_buffer(src, COPY_MAX_SIZE);
+    if(dst != NULL) free_bench_buffer(dst, COPY_MAX_SIZE);
+    return false;
+  }
+
+  // Random-looking contents, so that a wrong copy is always detected
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  uint64_t* words = (uint64_t *) src;
+  for(size_t i=0; i < COPY_MAX_SIZE / sizeof(uint64_t); i++) {
+    seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+    words[i] = seed;
+  }
+  touch_buffer(dst, COPY_MAX_SIZE);
+
+  printf("cpufetch is measuring memcpy/memset throughput (%lu B to %lu MiB)...\n", COPY_MIN_SIZE, COPY_MAX_SIZE >> 20);
+
+  bool ret = true;
+  for(int m=0; m < get_num_modules(cpu) && ret; m++) {
+    ret = print_copy_module(cpu, m, dst, src);
+  }
+
+  free_bench_buffer(src, COPY_MAX_SIZE);
+  free_bench_buffer(dst, COPY_MAX_SIZE);
+  return ret;
+}
+
+#endif // #ifdef __linux__
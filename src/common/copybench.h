@@ -0,0 +1,8 @@
+#ifndef __COPYBENCH__
+#define __COPYBENCH__
+
+#include "cpu.h"
+
+bool print_copy_benchmark(struct cpuInfo* cpu);
+
+#endif
@@ -244,6 +244,44 @@ char* get_str_ops(int64_t ops) {
   return str;
 }
 
+int get_num_modules(struct cpuInfo* cpu) {
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  return cpu->num_cpus;
+#else
+  UNUSED(cpu);
+  return 1;
+#endif
+}
+
+struct cpuInfo* get_module(struct cpuInfo* cpu, int module) {
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  struct cpuInfo* ptr = cpu;
+  for(int i=0; i < module; i++) ptr = ptr->next_cpu;
+  return ptr;
+#else
+  UNUSED(module);
+  return cpu;
+#endif
+}
+
+// Returns the first logical CPU of the module (hybrid architectures
+// have more than one module, linked through next_cpu)
+int32_t get_module_first_cpu(struct cpuInfo* cpu, int module) {
+#if defined(ARCH_X86)
+  return get_module(cpu, module)->first_core_id;
+#elif defined(ARCH_ARM)
+  // In ARM, modules are built from consecutive cores
+  int32_t first = 0;
+  struct cpuInfo* ptr = cpu;
+  for(int i=0; i < module; ptr = ptr->next_cpu, i++) first += ptr->topo->total_cores;
+  return first;
+#else
+  UNUSED(cpu);
+  UNUSED(module);
+  return 0;
+#endif
+}
+
 void init_topology_struct(struct topology* topo, struct cache* cach) {
   topo->total_cores = 0;
   topo->cach = cach;
@@ -276,6 +314,7 @@ void init_cache_struct(struct cache* cach) {
   cach->L1d->exists = false;
   cach->L2->exists = false;
   cach->L3->exists = false;
+  for(int i=0; i < 4; i++) cach->cach_arr[i]->line_size = UNKNOWN_DATA;
 }
 
 void free_cache_struct(struct cache* cach) {
@@ -284,6 +323,12 @@ void free_cache_struct(struct cache* cach) {
   free(cach);
 }
 
+void free_tlb_struct(struct tlb* tlb) {
+  if(tlb == NULL) return;
+  free(tlb->levels);
+  free(tlb);
+}
+
 void free_freq_struct(struct frequency* freq) {
   free(freq);
 }
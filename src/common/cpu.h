@@ -76,6 +76,7 @@ struct hypervisor {
 
 struct cach {
   int32_t size;
+  int32_t line_size;
   uint8_t num_caches;
   bool exists;
   // plenty of more properties to include in the future...
@@ -91,6 +92,32 @@ struct cache {
   uint8_t max_cache_level;
 };
 
+enum {
+  TLB_TYPE_DATA,
+  TLB_TYPE_INSTRUCTION,
+  TLB_TYPE_UNIFIED,
+  TLB_TYPE_LOAD,
+  TLB_TYPE_STORE
+};
+
+#define TLB_PAGE_4K (1 << 0)
+#define TLB_PAGE_2M (1 << 1)
+#define TLB_PAGE_4M (1 << 2)
+#define TLB_PAGE_1G (1 << 3)
+
+struct tlb_level {
+  int32_t level;
+  int32_t type;
+  uint32_t page_sizes; // Mask of TLB_PAGE_*
+  int32_t entries;
+  int32_t ways;        // 0 means fully associative
+};
+
+struct tlb {
+  struct tlb_level* levels;
+  int32_t num_levels;
+};
+
 struct topology {
   int32_t total_cores;  
   struct cache* cach;
@@ -123,6 +150,17 @@ struct features {
   bool FMA3;
   bool FMA4;
   bool SHA;
+  bool PCLMUL;
+  bool VAES;
+  bool ERMS;  // Enhanced rep movsb/stosb
+  bool FSRM;  // Fast short rep movsb
+  bool FZRM;  // Fast zero-length rep movsb
+  bool FSRS;  // Fast short rep stosb
+  bool POPCNT;
+  bool LZCNT; // ABM on AMD
+  bool BMI1;
+  bool BMI2;
+  bool AVX512BW;
 #elif ARCH_PPC
   bool altivec;
 #elif ARCH_ARM
@@ -130,9 +168,27 @@ struct features {
   bool SHA1;
   bool SHA2;
   bool CRC32;
+  bool PMULL;
   bool SVE;
   bool SVE2;
+  bool MOPS;  // memcpy/memset instructions (FEAT_MOPS)
+  bool LSE;   // Large System Extensions atomics (FEAT_LSE)
+  bool LSE2;  // Unaligned single-copy atomicity (FEAT_LSE2)
+  bool RCPC;  // Load-acquire RCpc instructions (FEAT_LRCPC)
+  bool FP16;  // Half precision arithmetic (FEAT_FP16)
+  bool FHM;   // FP16 multiply-add into FP32 (FEAT_FHM)
+  bool DOTPROD; // Int8 dot product (FEAT_DotProd)
+  bool I8MM;  // Int8 matrix multiply (FEAT_I8MM)
+  bool BF16;  // BFloat16 dot product and matrix multiply (FEAT_BF16)
+  bool SVEI8MM; // I8MM in SVE
+  bool SVEBF16; // BF16 in SVE
+  bool SME;   // Scalable Matrix Extension (FEAT_SME)
+  bool SME2;
+  bool MTE;   // Memory Tagging Extension (FEAT_MTE2)
+  bool PAC;   // Pointer authentication (FEAT_PAuth)
+  bool BTI;   // Branch Target Identification (FEAT_BTI)
   uint64_t cntb;
+  uint64_t svl; // SME streaming vector length, in bytes
 #endif  
 };
 
@@ -151,6 +207,7 @@ struct cpuInfo {
   int64_t peak_performance;
   int64_t vis_ops_performance; // SPARC: VIS byte ops throughput when requested
   int64_t gpu_ops_performance; // macOS ARM: Metal integer ops throughput when requested
+  int64_t int8_ops_performance; // ARM: int8 throughput modelled from DotProd/I8MM
 
   // Similar but not exactly equal
   // to struct features
@@ -224,10 +281,15 @@ char* get_str_freq(struct frequency* freq);
 char* get_str_peak_performance(int64_t flops);
 char* get_str_ops(int64_t ops);
 
+int get_num_modules(struct cpuInfo* cpu);
+struct cpuInfo* get_module(struct cpuInfo* cpu, int module);
+int32_t get_module_first_cpu(struct cpuInfo* cpu, int module);
+
 void init_topology_struct(struct topology* topo, struct cache* cach);
 void init_cache_struct(struct cache* cach);
 
 void free_cache_struct(struct cache* cach);
+void free_tlb_struct(struct tlb* tlb);
 void free_freq_struct(struct frequency* freq);
 void free_cpuinfo_struct(struct cpuInfo* cpu);
 
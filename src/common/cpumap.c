@@ -0,0 +1,346 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <sched.h>
+#include <string.h>
+#include <errno.h>
+
+#include "global.h"
+#include "udev.h"
+#include "cpumap.h"
+
+#define _PATH_CACHE_LEVEL "/level"
+#define _PATH_PROC_CGROUP "/proc/self/cgroup"
+#define _PATH_CGROUP_ROOT "/sys/fs/cgroup"
+// cgroup v2 and v1 names of the effective cpuset
+#define _PATH_CGROUP_CPUSET_V2 "/cpuset.cpus.effective"
+#define _PATH_CGROUP_CPUSET_V1 "/cpuset.effective_cpus"
+
+static const char* cpu_relation_str[] = {
+  [CPU_RELATION_SAME]         = "Same CPU",
+  [CPU_RELATION_SMT]          = "SMT sibling",
+  [CPU_RELATION_L3]           = "Same L3",
+  [CPU_RELATION_SOCKET]       = "Same socket",
+  [CPU_RELATION_CROSS_SOCKET] = "Cross socket",
+  [CPU_RELATION_INVALID]      = STRING_UNKNOWN
+};
+
+// Affinity of the process before cpufetch binds itself to other CPUs
+static cpu_set_t initial_affinity;
+static bool initial_affinity_saved = false;
+
+long get_cpu_topology_value(int cpu, char* file, bool* success) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, cpu, file);
+  return get_value_from_file(path, success);
+}
+
+// Returns the first CPU of the CPU list stored in path, or -1
+int32_t get_first_cpu_from_list(char* path, int ncpus) {
+  char* buf = get_str_from_file(path);
+  if(buf == NULL) return -1;
+
+  bool* cpus = emalloc(sizeof(bool) * ncpus);
+  int32_t first = -1;
+  if(parse_cpu_list(buf, cpus, ncpus) > 0) {
+    for(int i=0; i < ncpus && first == -1; i++) {
+      if(cpus[i]) first = i;
+    }
+  }
+
+  free(cpus);
+  free(buf);
+  return first;
+}
+
+// Returns an identifier of the L3 cache used by the CPU. Newer kernels
+// expose the cache id directly; otherwise, the first CPU sharing the
+// cache is used as the identifier.
+int32_t get_l3_id(int cpu, int ncpus) {
+  bool success;
+  char path[_PATH_SYSFS_MAX_LEN];
+
+  long level = get_cpu_topology_value(cpu, _PATH_CACHE_L3 _PATH_CACHE_LEVEL, &success);
+  if(!success || level != 3) return -1;
+
+  long id = get_cpu_topology_value(cpu, _PATH_CACHE_L3 _PATH_CACHE_ID, &success);
+  if(success) return id;
+
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, cpu, _PATH_CACHE_L3, _PATH_CACHE_SHARED_LIST);
+  return get_first_cpu_from_list(path, ncpus);
+}
+
+// Returns an identifier of the physical core of the CPU, which is the
+// first CPU of its core. core_id cannot be used for this because it is
+// only unique within a cluster or die (e.g., it repeats per cluster in ARM)
+int32_t get_smt_id(int cpu, int ncpus) {
+  char path[_PATH_SYSFS_MAX_LEN];
+
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, cpu, _PATH_TOPO_CORE_CPUS_LIST);
+  int32_t first = get_first_cpu_from_list(path, ncpus);
+  if(first != -1) return first;
+
+  // Older kernels only provide thread_siblings_list
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, cpu, _PATH_TOPO_THREAD_SIBLINGS_LIST);
+  first = get_first_cpu_from_list(path, ncpus);
+  return first != -1 ? first : cpu;
+}
+
+int count_distinct(int32_t* values, int n) {
+  int count = 0;
+  for(int i=0; i < n; i++) {
+    bool seen = false;
+    for(int j=0; j < i && !seen; j++) {
+      if(values[j] == values[i]) seen = true;
+    }
+    if(!seen) count++;
+  }
+  return count;
+}
+
+void fill_nodes(struct cpu_map* map) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  int max_nodes = 1024;
+  bool* nodes = emalloc(sizeof(bool) * max_nodes);
+  bool* cpus = emalloc(sizeof(bool) * map->num_cpus);
+  char* buf;
+
+  map->num_nodes = 1;
+  if((buf = get_str_from_file(_PATH_NODES_ONLINE)) == NULL) {
+    printWarn("Could not open '%s', assuming a single NUMA node", _PATH_NODES_ONLINE);
+    free(nodes);
+    free(cpus);
+    return;
+  }
+
+  map->num_nodes = parse_cpu_list(buf, nodes, max_nodes);
+  free(buf);
+
+  for(int n=0; n < max_nodes; n++) {
+    if(!nodes[n]) continue;
+
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/node%d%s", _PATH_SYS_SYSTEM, _PATH_SYS_NODE, n, _PATH_NODE_CPULIST);
+    if((buf = get_str_from_file(path)) == NULL) {
+      printWarn("Could not open '%s'", path);
+      continue;
+    }
+    if(parse_cpu_list(buf, cpus, map->num_cpus) > 0) {
+      for(int c=0; c < map->num_cpus; c++) {
+        if(cpus[c]) map->cpus[c].node = n;
+      }
+    }
+    free(buf);
+  }
+
+  free(nodes);
+  free(cpus);
+}
+
+// Builds the location of every logical CPU (socket, core, L3 and
+// NUMA node) using sysfs. This complements the per-module topology
+// (which only contains counts) when we need to place threads.
+struct cpu_map* get_cpu_map(void) {
+  int ncpus = get_ncores_from_cpuinfo();
+  if(ncpus <= 0) return NULL;
+
+  struct cpu_map* map = emalloc(sizeof(struct cpu_map));
+  map->num_cpus = ncpus;
+  map->cpus = emalloc(sizeof(struct cpu_location) * ncpus);
+
+  bool* online = emalloc(sizeof(bool) * ncpus);
+  char* buf = get_str_from_file(_PATH_CPUS_ONLINE);
+  if(buf == NULL || parse_cpu_list(buf, online, ncpus) <= 0) {
+    printWarn("Could not read online CPUs from '%s', assuming all CPUs are online", _PATH_CPUS_ONLINE);
+    for(int i=0; i < ncpus; i++) online[i] = true;
+  }
+  free(buf);
+
+  bool l3_warned = false;
+  int32_t* packages = emalloc(sizeof(int32_t) * ncpus);
+  int num_online = 0;
+
+  for(int i=0; i < ncpus; i++) {
+    bool success;
+    struct cpu_location* loc = &map->cpus[i];
+    loc->online = online[i];
+    loc->package = 0;
+    loc->core = i;
+    loc->smt_id = i;
+    loc->l3 = -1;
+    loc->node = 0;
+    if(!loc->online) continue;
+
+    long value = get_cpu_topology_value(i, _PATH_TOPO_PACKAGE_ID, &success);
+    if(success && value >= 0) loc->package = value;
+    value = get_cpu_topology_value(i, _PATH_TOPO_CORE_ID, &success);
+    if(success && value >= 0) loc->core = value;
+    loc->smt_id = get_smt_id(i, ncpus);
+
+    if((loc->l3 = get_l3_id(i, ncpus)) == -1) {
+      // Without L3 information, assume the whole socket shares it
+      if(!l3_warned) printWarn("Unable to find L3 information for CPU %d, assuming it is shared by the whole socket", i);
+      l3_warned = true;
+      loc->l3 = loc->package;
+    }
+
+    packages[num_online++] = loc->package;
+  }
+
+  map->num_packages = count_distinct(packages, num_online);
+  fill_nodes(map);
+
+  free(packages);
+  free(online);
+  return map;
+}
+
+int get_cpu_relation(struct cpu_map* map, int cpu1, int cpu2) {
+  if(cpu1 < 0 || cpu2 < 0 || cpu1 >= map->num_cpus || cpu2 >= map->num_cpus)
+    return CPU_RELATION_INVALID;
+
+  struct cpu_location* l1 = &map->cpus[cpu1];
+  struct cpu_location* l2 = &map->cpus[cpu2];
+
+  if(cpu1 == cpu2) return CPU_RELATION_SAME;
+  if(l1->package != l2->package) return CPU_RELATION_CROSS_SOCKET;
+  if(l1->smt_id == l2->smt_id) return CPU_RELATION_SMT;
+  if(l1->l3 == l2->l3) return CPU_RELATION_L3;
+  return CPU_RELATION_SOCKET;
+}
+
+// Finds the first pair of online CPUs with the relation specified that
+// this process is allowed to run on
+bool find_cpu_pair(struct cpu_map* map, int relation, int* cpu1, int* cpu2) {
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  if(!get_allowed_cpus(allowed, map->num_cpus)) {
+    free(allowed);
+    return false;
+  }
+
+  for(int i=0; i < map->num_cpus; i++) {
+    if(!map->cpus[i].online || !allowed[i]) continue;
+    for(int j=i+1; j < map->num_cpus; j++) {
+      if(map->cpus[j].online && allowed[j] && get_cpu_relation(map, i, j) == relation) {
+        *cpu1 = i;
+        *cpu2 = j;
+        free(allowed);
+        return true;
+      }
+    }
+  }
+  free(allowed);
+  return false;
+}
+
+const char* get_str_cpu_relation(int relation) {
+  if(relation < 0 || relation > CPU_RELATION_INVALID) relation = CPU_RELATION_INVALID;
+  return cpu_relation_str[relation];
+}
+
+// Returns the path of the effective cpuset of the cgroup of this
+// process, supporting both the unified (v2) and the v1 hierarchies
+char* get_cgroup_cpuset_path(void) {
+  char* buf = get_str_from_file(_PATH_PROC_CGROUP);
+  if(buf == NULL) return NULL;
+
+  char* path = NULL;
+  char* saveptr;
+  for(char* line = strtok_r(buf, "\n", &saveptr); line != NULL && path == NULL; line = strtok_r(NULL, "\n", &saveptr)) {
+    // Format is hierarchy-ID:controller-list:cgroup-path
+    char* controllers = strchr(line, ':');
+    char* cgroup = controllers != NULL ? strchr(controllers + 1, ':') : NULL;
+    if(cgroup == NULL) continue;
+    *controllers++ = '\0';
+    *cgroup++ = '\0';
+
+    int len = strlen(_PATH_CGROUP_ROOT) + strlen("/cpuset") + strlen(cgroup) + strlen(_PATH_CGROUP_CPUSET_V2) + 1;
+    if(strcmp(line, "0") == 0 && controllers[0] == '\0') {
+      path = emalloc(sizeof(char) * len);
+      snprintf(path, len, "%s%s%s", _PATH_CGROUP_ROOT, cgroup, _PATH_CGROUP_CPUSET_V2);
+    }
+    else if(strstr(controllers, "cpuset") != NULL) {
+      path = emalloc(sizeof(char) * len);
+      snprintf(path, len, "%s/cpuset%s%s", _PATH_CGROUP_ROOT, cgroup, _PATH_CGROUP_CPUSET_V1);
+    }
+
+    // In v2, the file only exists if the cpuset controller is enabled
+    if(path != NULL && access(path, R_OK) != 0) {
+      free(path);
+      path = NULL;
+    }
+  }
+
+  free(buf);
+  return path;
+}
+
+// Must be called before anything calls bind_to_cpu (e.g., get_cpu_info
+// binds to every CPU to detect the topology on x86)
+void save_initial_affinity(void) {
+  if(sched_getaffinity(0, sizeof(cpu_set_t), &initial_affinity) == -1) {
+    printWarn("sched_getaffinity: %s", strerror(errno));
+    return;
+  }
+  initial_affinity_saved = true;
+}
+
+// Fills the CPUs this process is allowed to run on, which is the
+// intersection of its affinity mask and the cpuset of its cgroup
+bool get_allowed_cpus(bool* allowed, int ncpus) {
+  cpu_set_t mask;
+  if(initial_affinity_saved) {
+    mask = initial_affinity;
+  }
+  else if(sched_getaffinity(0, sizeof(cpu_set_t), &mask) == -1) {
+    printErr("sched_getaffinity: %s", strerror(errno));
+    return false;
+  }
+  for(int i=0; i < ncpus; i++) allowed[i] = i < CPU_SETSIZE && CPU_ISSET(i, &mask);
+
+  char* path = get_cgroup_cpuset_path();
+  if(path == NULL) return true;
+
+  char* buf = get_str_from_file(path);
+  if(buf != NULL) {
+    bool* cpuset = emalloc(sizeof(bool) * ncpus);
+    if(parse_cpu_list(buf, cpuset, ncpus) > 0) {
+      for(int i=0; i < ncpus; i++) allowed[i] = allowed[i] && cpuset[i];
+    }
+    free(cpuset);
+    free(buf);
+  }
+
+  free(path);
+  return true;
+}
+
+// Returns the CPUs in the kernel cpulist format (e.g., "0-3,8,10-11")
+char* get_str_cpu_list(bool* cpus, int ncpus) {
+  int size = 1;
+  char* str = ecalloc(size, sizeof(char));
+  char range[32];
+
+  for(int i=0; i < ncpus; i++) {
+    if(!cpus[i]) continue;
+    int j = i;
+    while(j + 1 < ncpus && cpus[j+1]) j++;
+
+    if(j == i) snprintf(range, sizeof(range), "%s%d", str[0] == '\0' ? "" : ",", i);
+    else snprintf(range, sizeof(range), "%s%d-%d", str[0] == '\0' ? "" : ",", i, j);
+
+    size += strlen(range);
+    str = erealloc(str, sizeof(char) * size);
+    strcat(str, range);
+    i = j;
+  }
+
+  return str;
+}
+
+void free_cpu_map(struct cpu_map* map) {
+  free(map->cpus);
+  free(map);
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,43 @@
+#ifndef __CPUMAP__
+#define __CPUMAP__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Relation between two logical CPUs, from the closest to the farthest
+enum {
+  CPU_RELATION_SAME,         // Same logical CPU
+  CPU_RELATION_SMT,          // SMT siblings (same physical core)
+  CPU_RELATION_L3,           // Different cores sharing the L3
+  CPU_RELATION_SOCKET,       // Same socket, different L3
+  CPU_RELATION_CROSS_SOCKET, // Different sockets
+  CPU_RELATION_INVALID
+};
+
+// Location of a logical CPU in the topology
+struct cpu_location {
+  bool online;
+  int32_t package;
+  int32_t core;
+  int32_t smt_id;  // First logical CPU of its physical core
+  int32_t l3;
+  int32_t node;
+};
+
+struct cpu_map {
+  struct cpu_location* cpus;
+  int num_cpus;
+  int num_packages;
+  int num_nodes;
+};
+
+struct cpu_map* get_cpu_map(void);
+int get_cpu_relation(struct cpu_map* map, int cpu1, int cpu2);
+bool find_cpu_pair(struct cpu_map* map, int relation, int* cpu1, int* cpu2);
+const char* get_str_cpu_relation(int relation);
+void save_initial_affinity(void);
+bool get_allowed_cpus(bool* allowed, int ncpus);
+char* get_str_cpu_list(bool* cpus, int ncpus);
+void free_cpu_map(struct cpu_map* map);
+
+#endif
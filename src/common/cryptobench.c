@@ -0,0 +1,436 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "global.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "cryptobench.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+  #include "../x86/crypto/crypto.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+  #include "../arm/crypto/crypto.h"
+#endif
+
+// Size of a TLS record
+#define CRYPTO_BUFFER_SIZE   (16 * 1024)
+#define CRYPTO_TIME_NS       (200ULL * 1000 * 1000)
+#define CRYPTO_MAX_KERNELS   16
+// Extra room in the output buffer for the GCM tag
+#define CRYPTO_TAG_SIZE      16
+
+enum {
+  CRYPTO_AES_CTR,
+  CRYPTO_AES_GCM,
+  CRYPTO_SHA256,
+  CRYPTO_CRC32C,
+  CRYPTO_GHASH
+};
+
+static const char* crypto_algo_str[] = {
+  [CRYPTO_AES_CTR] = "AES-128-CTR",
+  [CRYPTO_AES_GCM] = "AES-128-GCM",
+  [CRYPTO_SHA256]  = "SHA-256",
+  [CRYPTO_CRC32C]  = "CRC32C",
+  [CRYPTO_GHASH]   = "GHASH (clmul)",
+};
+
+typedef void (*aes_expand_fn)(const uint8_t* key, uint8_t* round_keys);
+typedef void (*aes_ctr_fn)(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n);
+typedef void (*ghash_fn)(const uint8_t* h, uint8_t* y, const uint8_t* in, size_t n);
+typedef void (*sha256_fn)(uint32_t* state, const uint8_t* data, size_t nblocks);
+typedef uint32_t (*crc32c_fn)(uint32_t crc, const uint8_t* data, size_t n);
+
+// An algorithm built from the primitives of one implementation
+struct crypto_kernel {
+  int algo;
+  const char* impl;
+  aes_expand_fn expand;
+  aes_ctr_fn ctr;
+  ghash_fn ghash;
+  sha256_fn sha256;
+  crc32c_fn crc32c;
+};
+
+struct crypto_worker {
+  struct crypto_kernel* kernel;
+  uint8_t* in;
+  uint8_t* out;
+  volatile bool* start;
+  volatile bool* stop;
+  uint64_t bytes;
+  uint64_t ns;
+  char pad[64];
+};
+
+// Test vectors: NIST SP 800-38A F.5.1 (CTR), test case 2 of the GCM
+// specification (GCM and GHASH) and FIPS 180-2 (SHA-256)
+static const char* kat_ctr_key   = "2b7e151628aed2a6abf7158809cf4f3c";
+static const char* kat_ctr_iv    = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+static const char* kat_ctr_in    = "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51";
+static const char* kat_ctr_out   = "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff";
+static const char* kat_gcm_out   = "0388dace60b6a392f328c2b971b2fe78ab6e47d42cec13bdf53a67b21257bddf";
+static const char* kat_ghash_h   = "66e94bd4ef8a2c3b884cfa59ca342b2e";
+static const char* kat_ghash_out = "f38cbb1ad69223dcc3457ae5b6b0f885";
+static const char* kat_sha_in    = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+static const char* kat_sha_out   = "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1";
+// CRC32C of the 4 KiB built by fill_kat_buffer (long enough for the 3-way versions)
+static const uint32_t kat_crc    = 0xE1C2F7E8;
+
+static const uint32_t sha256_iv[8] = {
+  0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19
+};
+
+int get_crypto_kernels(struct cpuInfo* cpu, struct crypto_kernel* k) {
+  int n = 0;
+
+#ifdef ARCH_X86
+  struct features* feat = cpu->feat;
+  bool vaes = feat->VAES && feat->AVX2 && feat->AES;
+
+  if(feat->AES)
+    k[n++] = (struct crypto_kernel) { CRYPTO_AES_CTR, "AES-NI", aes128_expand_key_aesni, aes128_ctr_aesni, NULL, NULL, NULL };
+  if(vaes)
+    k[n++] = (struct crypto_kernel) { CRYPTO_AES_CTR, "VAES", aes128_expand_key_aesni, aes128_ctr_vaes, NULL, NULL, NULL };
+  if(feat->AES && feat->PCLMUL)
+    k[n++] = (struct crypto_kernel) { CRYPTO_AES_GCM, "AES-NI + PCLMUL", aes128_expand_key_aesni, aes128_ctr_aesni, ghash_pclmul, NULL, NULL };
+  if(vaes && feat->PCLMUL)
+    k[n++] = (struct crypto_kernel) { CRYPTO_AES_GCM, "VAES + PCLMUL", aes128_expand_key_aesni, aes128_ctr_vaes, ghash_pclmul, NULL, NULL };
+  if(feat->SHA)
+    k[n++] = (struct crypto_kernel) { CRYPTO_SHA256, "SHA-NI", NULL, NULL, NULL, sha256_blocks_shani, NULL };
+  if(feat->SSE4_2)
+    k[n++] = (struct crypto_kernel) { CRYPTO_CRC32C, "SSE4.2", NULL, NULL, NULL, NULL, crc32c_sse42 };
+  if(feat->SSE4_2 && feat->PCLMUL)
+    k[n++] = (struct crypto_kernel) { CRYPTO_CRC32C, "SSE4.2 x3 + PCLMUL", NULL, NULL, NULL, NULL, crc32c_sse42_3way };
+  if(feat->PCLMUL)
+    k[n++] = (struct crypto_kernel) { CRYPTO_GHASH, "PCLMUL", NULL, NULL, ghash_pclmul, NULL, NULL };
+#elif ARCH_ARM
+  struct features* feat = cpu->feat;
+
+  if(!crypto_ce_compiled()) {
+    if(feat->AES || feat->SHA2 || feat->CRC32)
+      printWarn("CPU supports the crypto extensions, but they were not enabled by the compiler");
+    return 0;
+  }
+
+  if(feat->AES)
+    k[n++] = (struct crypto_kernel) { CRYPTO_AES_CTR, "ARMv8 CE", aes128_expand_key_ce, aes128_ctr_ce, NULL, NULL, NULL };
+  if(feat->AES && feat->PMULL)
+    k[n++] = (struct crypto_kernel) { CRYPTO_AES_GCM, "ARMv8 CE + PMULL", aes128_expand_key_ce, aes128_ctr_ce, ghash_pmull, NULL, NULL };
+  if(feat->SHA2)
+    k[n++] = (struct crypto_kernel) { CRYPTO_SHA256, "ARMv8 SHA2", NULL, NULL, NULL, sha256_blocks_ce, NULL };
+  if(feat->CRC32)
+    k[n++] = (struct crypto_kernel) { CRYPTO_CRC32C, "ARMv8 CRC32", NULL, NULL, NULL, NULL, crc32c_armv8 };
+  if(feat->CRC32 && feat->PMULL)
+    k[n++] = (struct crypto_kernel) { CRYPTO_CRC32C, "ARMv8 CRC32 x3 + PMULL", NULL, NULL, NULL, NULL, crc32c_armv8_3way };
+  if(feat->PMULL)
+    k[n++] = (struct crypto_kernel) { CRYPTO_GHASH, "PMULL", NULL, NULL, ghash_pmull, NULL, NULL };
+#else
+  UNUSED(cpu);
+  UNUSED(k);
+#endif
+
+  return n;
+}
+
+void run_aes_gcm(struct crypto_kernel* k, const uint8_t* key, const uint8_t* iv, const uint8_t* in, uint8_t* out, size_t n) {
+  uint8_t rk[176];
+  uint8_t zero[16] = { 0 };
+  uint8_t h[16] = { 0 };
+  uint8_t y[16] = { 0 };
+  uint8_t ctr[16] = { 0 };
+  uint8_t ek0[16];
+  uint8_t len[16] = { 0 };
+  uint64_t bits = (uint64_t) n * 8;
+
+  k->expand(key, rk);
+  // H = E(K, 0)
+  k->ctr(rk, zero, zero, h, 16);
+  // J0 = IV || 1, and the plaintext is encrypted from J0 + 1
+  memcpy(ctr, iv, 12);
+  ctr[15] = 1;
+  k->ctr(rk, ctr, zero, ek0, 16);
+  ctr[15] = 2;
+  k->ctr(rk, ctr, in, out, n);
+
+  // No additional data, so the length block only has the ciphertext length
+  for(int i=0; i < 8; i++) len[15-i] = (uint8_t) (bits >> (8*i));
+  k->ghash(h, y, out, n);
+  k->ghash(h, y, len, 16);
+  for(int i=0; i < 16; i++) out[n+i] = y[i] ^ ek0[i];
+}
+
+void run_sha256(struct crypto_kernel* k, const uint8_t* in, uint8_t* out, size_t n) {
+  uint32_t state[8];
+  uint8_t last[128] = { 0 };
+  size_t full = n / 64;
+  size_t rem = n % 64;
+  size_t nlast = rem < 56 ? 1 : 2;
+  uint64_t bits = (uint64_t) n * 8;
+
+  memcpy(state, sha256_iv, sizeof(state));
+  k->sha256(state, in, full);
+
+  memcpy(last, in + full * 64, rem);
+  last[rem] = 0x80;
+  for(int i=0; i < 8; i++) last[nlast*64 - 1 - i] = (uint8_t) (bits >> (8*i));
+  k->sha256(state, last, nlast);
+
+  for(int i=0; i < 8; i++) {
+    out[4*i]   = (uint8_t) (state[i] >> 24);
+    out[4*i+1] = (uint8_t) (state[i] >> 16);
+    out[4*i+2] = (uint8_t) (state[i] >> 8);
+    out[4*i+3] = (uint8_t) state[i];
+  }
+}
+
+// Runs the algorithm of the kernel over n bytes of in. The result (the
+// ciphertext followed by the tag, the digest or the checksum) is stored in out
+void run_crypto_kernel(struct crypto_kernel* k, const uint8_t* key, const uint8_t* iv, const uint8_t* in, uint8_t* out, size_t n) {
+  uint8_t rk[176];
+  uint32_t crc;
+
+  switch(k->algo) {
+    case CRYPTO_AES_CTR:
+      k->expand(key, rk);
+      k->ctr(rk, iv, in, out, n);
+      break;
+    case CRYPTO_AES_GCM:
+      run_aes_gcm(k, key, iv, in, out, n);
+      break;
+    case CRYPTO_SHA256:
+      run_sha256(k, in, out, n);
+      break;
+    case CRYPTO_CRC32C:
+      crc = ~k->crc32c(~0U, in, n);
+      out[0] = (uint8_t) (crc >> 24);
+      out[1] = (uint8_t) (crc >> 16);
+      out[2] = (uint8_t) (crc >> 8);
+      out[3] = (uint8_t) crc;
+      break;
+    case CRYPTO_GHASH:
+      memset(out, 0, 16);
+      k->ghash(key, out, in, n);
+      break;
+    default:
+      printBug("Invalid crypto algorithm: %d", k->algo);
+      break;
+  }
+}
+
+int hex_to_bytes(const char* hex, uint8_t* bytes) {
+  int n = strlen(hex) / 2;
+  for(int i=0; i < n; i++) {
+    unsigned int b;
+    sscanf(hex + 2*i, "%2x", &b);
+    bytes[i] = (uint8_t) b;
+  }
+  return n;
+}
+
+void fill_kat_buffer(uint8_t* buf, size_t n) {
+  for(size_t i=0; i < n; i++) buf[i] = (uint8_t) (i * 31 + 7);
+}
+
+// Checks the kernel against the test vectors, so that a broken
+// kernel is not reported as a fast one
+bool check_crypto_kernel(struct crypto_kernel* k) {
+  uint8_t key[16] = { 0 };
+  uint8_t iv[16] = { 0 };
+  uint8_t in[4096];
+  uint8_t out[4096 + CRYPTO_TAG_SIZE];
+  uint8_t expected[64];
+  int n = 0;
+  int len = 0;
+
+  switch(k->algo) {
+    case CRYPTO_AES_CTR:
+      hex_to_bytes(kat_ctr_key, key);
+      hex_to_bytes(kat_ctr_iv, iv);
+      n = hex_to_bytes(kat_ctr_in, in);
+      len = hex_to_bytes(kat_ctr_out, expected);
+      break;
+    case CRYPTO_AES_GCM:
+      memset(in, 0, 16);
+      n = 16;
+      len = hex_to_bytes(kat_gcm_out, expected);
+      break;
+    case CRYPTO_SHA256:
+      n = strlen(kat_sha_in);
+      memcpy(in, kat_sha_in, n);
+      len = hex_to_bytes(kat_sha_out, expected);
+      break;
+    case CRYPTO_CRC32C:
+      n = sizeof(in);
+      fill_kat_buffer(in, n);
+      expected[0] = (uint8_t) (kat_crc >> 24);
+      expected[1] = (uint8_t) (kat_crc >> 16);
+      expected[2] = (uint8_t) (kat_crc >> 8);
+      expected[3] = (uint8_t) kat_crc;
+      len = 4;
+      break;
+    case CRYPTO_GHASH:
+      hex_to_bytes(kat_ghash_h, key);
+      n = hex_to_bytes(kat_gcm_out, in) - 16;
+      memset(in + n, 0, 16);
+      in[n + 15] = (uint8_t) (n * 8);
+      n += 16;
+      len = hex_to_bytes(kat_ghash_out, expected);
+      break;
+    default:
+      printBug("Invalid crypto algorithm: %d", k->algo);
+      return false;
+  }
+
+  run_crypto_kernel(k, key, iv, in, out, n);
+  if(memcmp(out, expected, len) != 0) {
+    printBug("%s (%s) does not match the test vectors", crypto_algo_str[k->algo], k->impl);
+    return false;
+  }
+  return true;
+}
+
+void* crypto_thread(void* arg) {
+  struct crypto_worker* w = (struct crypto_worker*) arg;
+  uint8_t key[16] = { 0 };
+  uint8_t iv[16] = { 0 };
+
+  while(!*w->start) cpu_relax();
+
+  uint64_t t0 = get_time_ns();
+  do {
+    run_crypto_kernel(w->kernel, key, iv, w->in, w->out, CRYPTO_BUFFER_SIZE);
+    w->bytes += CRYPTO_BUFFER_SIZE;
+  } while(!*w->stop);
+  w->ns = get_time_ns() - t0;
+
+  return NULL;
+}
+
+// Runs the kernel in all the CPUs in cpus at the same time,
+// returning the aggregated throughput (in bytes/s)
+double measure_crypto_kernel(struct crypto_kernel* k, int* cpus, int ncpus) {
+  struct crypto_worker* workers = ecalloc(ncpus, sizeof(struct crypto_worker));
+  pthread_t* threads = emalloc(sizeof(pthread_t) * ncpus);
+  volatile bool start = false;
+  volatile bool stop = false;
+  double throughput = 0.0;
+  int created = 0;
+
+  for(int i=0; i < ncpus; i++) {
+    workers[i].kernel = k;
+    workers[i].in = emalloc(CRYPTO_BUFFER_SIZE);
+    workers[i].out = emalloc(CRYPTO_BUFFER_SIZE + CRYPTO_TAG_SIZE);
+    workers[i].start = &start;
+    workers[i].stop = &stop;
+    fill_kat_buffer(workers[i].in, CRYPTO_BUFFER_SIZE);
+  }
+
+  for(int i=0; i < ncpus; i++) {
+    if(!create_thread_on_cpu(&threads[i], cpus[i], crypto_thread, &workers[i])) break;
+    created++;
+  }
+
+  start = true;
+  sleep_us(CRYPTO_TIME_NS / 1000);
+  stop = true;
+
+  for(int i=0; i < created; i++) pthread_join(threads[i], NULL);
+
+  if(created == ncpus) {
+    for(int i=0; i < ncpus; i++) {
+      if(workers[i].ns > 0) throughput += (double) workers[i].bytes / (workers[i].ns / 1e9);
+    }
+  }
+  else {
+    throughput = -1.0;
+  }
+
+  for(int i=0; i < ncpus; i++) {
+    free(workers[i].in);
+    free(workers[i].out);
+  }
+  free(workers);
+  free(threads);
+  return throughput;
+}
+
+// Measures the throughput of the AES (CTR and GCM), SHA-256, CRC32C and
+// GHASH implementations supported by the CPU over CRYPTO_BUFFER_SIZE
+// buffers, in one core of each module (core type) and in all the CPUs.
+bool print_crypto_benchmark(struct cpuInfo* cpu) {
+  struct crypto_kernel kernels[CRYPTO_MAX_KERNELS];
+  int nkernels = get_crypto_kernels(cpu, kernels);
+  int nmodules = get_num_modules(cpu);
+
+  if(nkernels == 0) {
+    printErr("No supported crypto or checksum instructions were found in this CPU");
+    return false;
+  }
+
+  for(int i=0; i < nkernels; i++) {
+    if(!check_crypto_kernel(&kernels[i])) return false;
+  }
+
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) return false;
+
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  int* cpus = emalloc(sizeof(int) * map->num_cpus);
+  int ncpus = 0;
+  if(!get_allowed_cpus(allowed, map->num_cpus)) {
+    free(allowed);
+    free(cpus);
+    free_cpu_map(map);
+    return false;
+  }
+  for(int i=0; i < map->num_cpus; i++) {
+    if(allowed[i] && map->cpus[i].online) cpus[ncpus++] = i;
+  }
+
+  printf("cpufetch is measuring crypto and checksum throughput (%d KiB buffers)...\n\n", CRYPTO_BUFFER_SIZE / 1024);
+
+  char all[32];
+  snprintf(all, sizeof(all), "All cores (%d)", ncpus);
+  printf("  %-14s %-23s", "Algorithm", "Implementation");
+  for(int m=0; m < nmodules; m++) {
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+    printf(" %16s", get_str_uarch(get_module(cpu, m)));
+#else
+    printf(" %16s", "1 core");
+#endif
+  }
+  printf(" %16s\n", all);
+
+  bool ret = true;
+  for(int i=0; i < nkernels && ret; i++) {
+    printf("  %-14s %-23s", crypto_algo_str[kernels[i].algo], kernels[i].impl);
+    for(int m=0; m < nmodules && ret; m++) {
+      int first_cpu = get_module_first_cpu(cpu, m);
+      double t = measure_crypto_kernel(&kernels[i], &first_cpu, 1);
+      printf(" %11.2f GB/s", t / 1e9);
+      ret = t >= 0;
+    }
+
+    double t = ret ? measure_crypto_kernel(&kernels[i], cpus, ncpus) : -1.0;
+    printf(" %11.2f GB/s\n", t / 1e9);
+    ret = ret && t >= 0;
+  }
+
+  if(!ret) printErr("Failed to run the crypto benchmark in all the CPUs");
+
+  free(allowed);
+  free(cpus);
+  free_cpu_map(map);
+  return ret;
+}
+
+#endif // #ifdef __linux__
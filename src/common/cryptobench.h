@@ -0,0 +1,8 @@
+#ifndef __CRYPTOBENCH__
+#define __CRYPTOBENCH__
+
+#include "cpu.h"
+
+bool print_crypto_benchmark(struct cpuInfo* cpu);
+
+#endif
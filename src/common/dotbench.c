@@ -0,0 +1,253 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "global.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "dotbench.h"
+
+#ifdef ARCH_ARM
+  #include "../arm/uarch.h"
+  #include "../arm/dotprod/dotprod.h"
+#endif
+
+#if defined(ARCH_ARM) && defined(__aarch64__)
+
+#define DOT_TIME_NS       (200ULL * 1000 * 1000)
+// Iterations between two checks of the stop flag
+#define DOT_CHUNK_ITERS   (64 * 1024)
+#define DOT_MAX_KERNELS   16
+
+struct dot_worker {
+  const struct dot_kernel* kernel;
+  volatile bool* start;
+  volatile bool* stop;
+  uint64_t iters;
+  uint64_t ns;
+  char pad[64];
+};
+
+bool dot_supported(struct features* feat, const struct dot_kernel* k) {
+  switch(k->requires) {
+    case DOT_REQ_DOTPROD: return feat->DOTPROD;
+    case DOT_REQ_I8MM:    return feat->I8MM;
+    case DOT_REQ_BF16:    return feat->BF16;
+    case DOT_REQ_SVE:     return feat->SVE && feat->cntb > 0;
+    case DOT_REQ_SVEI8MM: return feat->SVE && feat->SVEI8MM && feat->cntb > 0;
+    case DOT_REQ_SVEBF16: return feat->SVE && feat->SVEBF16 && feat->cntb > 0;
+    default:              return false;
+  }
+}
+
+// Returns the kernels supported by any of the modules, warning about
+// the features the CPU has but the compiler could not build
+int get_dot_kernels(struct cpuInfo* cpu, const struct dot_kernel** k) {
+  int n = 0;
+  bool dotprod = false;
+  bool sve = false;
+
+  for(int m=0; m < get_num_modules(cpu); m++) {
+    struct features* feat = get_module(cpu, m)->feat;
+    dotprod |= feat->DOTPROD || feat->I8MM || feat->BF16;
+    sve |= feat->SVE;
+  }
+
+  if(dotprod && dot_num_kernels_neon == 0)
+    printWarn("CPU supports the NEON dot product instructions, but they were not enabled by the compiler");
+  if(sve && dot_num_kernels_sve == 0)
+    printWarn("CPU supports SVE, but it was not enabled by the compiler");
+
+  for(int i=0; i < dot_num_kernels_neon + dot_num_kernels_sve && n < DOT_MAX_KERNELS; i++) {
+    const struct dot_kernel* kernel = i < dot_num_kernels_neon ? &dot_kernels_neon[i] : &dot_kernels_sve[i - dot_num_kernels_neon];
+    bool supported = false;
+    for(int m=0; m < get_num_modules(cpu) && !supported; m++) {
+      supported = dot_supported(get_module(cpu, m)->feat, kernel);
+    }
+    if(supported) k[n++] = kernel;
+  }
+
+  return n;
+}
+
+void* dot_thread(void* arg) {
+  struct dot_worker* w = (struct dot_worker*) arg;
+
+  while(!*w->start) cpu_relax();
+
+  uint64_t t0 = get_time_ns();
+  do {
+    w->kernel->fn(DOT_CHUNK_ITERS);
+    w->iters += DOT_CHUNK_ITERS;
+  } while(!*w->stop);
+  w->ns = get_time_ns() - t0;
+
+  return NULL;
+}
+
+// Runs the kernel in all the CPUs in cpus at the same time, returning
+// the aggregated operations per second (or -1 on error). cntb has the
+// SVE vector length (in bytes) of each CPU, since modules may differ
+double measure_dot_kernel(const struct dot_kernel* k, int* cpus, uint64_t* cntb, int ncpus) {
+  struct dot_worker* workers = ecalloc(ncpus, sizeof(struct dot_worker));
+  pthread_t* threads = emalloc(sizeof(pthread_t) * ncpus);
+  volatile bool start = false;
+  volatile bool stop = false;
+  double throughput = 0.0;
+  int created = 0;
+
+  for(int i=0; i < ncpus; i++) {
+    workers[i].kernel = k;
+    workers[i].start = &start;
+    workers[i].stop = &stop;
+  }
+
+  for(int i=0; i < ncpus; i++) {
+    if(!create_thread_on_cpu(&threads[i], cpus[i], dot_thread, &workers[i])) break;
+    created++;
+  }
+
+  start = true;
+  sleep_us(DOT_TIME_NS / 1000);
+  stop = true;
+
+  for(int i=0; i < created; i++) pthread_join(threads[i], NULL);
+
+  if(created == ncpus) {
+    for(int i=0; i < ncpus; i++) {
+      double ops_per_iter = (double) DOT_PER_ITER * k->ops * (k->scalable ? cntb[i] / 16.0 : 1.0);
+      if(workers[i].ns > 0) throughput += workers[i].iters * ops_per_iter / (workers[i].ns / 1e9);
+    }
+  }
+  else {
+    throughput = -1.0;
+  }
+
+  free(workers);
+  free(threads);
+  return throughput;
+}
+
+// Fills cpus with the allowed CPUs of the module (which, in ARM, are
+// consecutive), returning how many there are
+int get_dot_module_cpus(struct cpuInfo* cpu, int module, bool* allowed, struct cpu_map* map, int* cpus) {
+  int first = get_module_first_cpu(cpu, module);
+  int last = first + get_module(cpu, module)->topo->total_cores;
+  int n = 0;
+
+  for(int i=first; i < last && i < map->num_cpus; i++) {
+    if(allowed[i] && map->cpus[i].online) cpus[n++] = i;
+  }
+  return n;
+}
+
+void print_dot_value(double ops) {
+  if(ops < 0) printf(" %12s", "-");
+  else printf(" %7.3f TOPS", ops / 1e12);
+}
+
+// Measures the throughput of the int8 and BF16 dot product and matrix
+// multiply instructions supported by the CPU (NEON DotProd, I8MM and
+// BF16 and their SVE versions) in one core, in all the cores of each
+// module (cluster) and in all the cores at the same time.
+bool print_dotprod_benchmark(struct cpuInfo* cpu) {
+  const struct dot_kernel* kernels[DOT_MAX_KERNELS];
+  int nkernels = get_dot_kernels(cpu, kernels);
+  int nmodules = get_num_modules(cpu);
+
+  if(nkernels == 0) {
+    printErr("No supported int8 or BF16 dot product instructions were found in this CPU");
+    return false;
+  }
+
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) return false;
+
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  int* cpus = emalloc(sizeof(int) * map->num_cpus);
+  uint64_t* cntb = emalloc(sizeof(uint64_t) * map->num_cpus);
+  if(!get_allowed_cpus(allowed, map->num_cpus)) {
+    free(allowed);
+    free(cpus);
+    free(cntb);
+    free_cpu_map(map);
+    return false;
+  }
+
+  printf("cpufetch is measuring int8 and BF16 dot product throughput...\n");
+  printf("TOPS count multiplies and adds as separate operations\n\n");
+
+  printf("  %-12s %-5s", "Instruction", "Type");
+  for(int m=0; m < nmodules; m++) {
+    char cluster[32];
+    snprintf(cluster, sizeof(cluster), "x%d", get_dot_module_cpus(cpu, m, allowed, map, cpus));
+    printf(" %12.12s %12s", get_str_uarch(get_module(cpu, m)), cluster);
+  }
+  // With a single module, all the cores are the cluster
+  if(nmodules > 1) printf(" %12s", "All cores");
+  printf("\n");
+
+  bool ret = true;
+  for(int i=0; i < nkernels && ret; i++) {
+    const struct dot_kernel* k = kernels[i];
+    bool all_supported = true;
+    int ncpus = 0;
+
+    printf("  %-12s %-5s", k->name, k->type);
+    for(int m=0; m < nmodules && ret; m++) {
+      struct features* feat = get_module(cpu, m)->feat;
+      // The CPUs of this module are appended to the ones of the
+      // previous modules, to be used in the all-core measurement
+      int n = get_dot_module_cpus(cpu, m, allowed, map, cpus + ncpus);
+
+      if(!dot_supported(feat, k) || n == 0) {
+        print_dot_value(-1.0);
+        print_dot_value(-1.0);
+        all_supported = false;
+        continue;
+      }
+
+      for(int c=ncpus; c < ncpus + n; c++) cntb[c] = feat->cntb;
+      double single = measure_dot_kernel(k, cpus + ncpus, cntb + ncpus, 1);
+      double cluster = measure_dot_kernel(k, cpus + ncpus, cntb + ncpus, n);
+      print_dot_value(single);
+      print_dot_value(cluster);
+      fflush(stdout);
+      ret = single >= 0 && cluster >= 0;
+      ncpus += n;
+    }
+
+    if(ret && nmodules > 1) {
+      double all = -1.0;
+      if(all_supported) {
+        all = measure_dot_kernel(k, cpus, cntb, ncpus);
+        ret = all >= 0;
+      }
+      print_dot_value(all);
+    }
+    printf("\n");
+  }
+
+  free(allowed);
+  free(cpus);
+  free(cntb);
+  free_cpu_map(map);
+  return ret;
+}
+
+#else
+
+bool print_dotprod_benchmark(struct cpuInfo* cpu) {
+  UNUSED(cpu);
+  printErr("The dot product benchmark is only supported in AArch64");
+  return false;
+}
+
+#endif // #if defined(ARCH_ARM) && defined(__aarch64__)
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __DOTBENCH__
+#define __DOTBENCH__
+
+#include "cpu.h"
+
+bool print_dotprod_benchmark(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,676 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+
+#include "global.h"
+#include "udev.h"
+#include "cpumap.h"
+#include "membench.h"
+#include "numa.h"
+#include "dram.h"
+
+#define _PATH_DMI_ENTRIES "/sys/firmware/dmi/entries"
+
+// SMBIOS structure types
+#define DMI_MEMORY_ARRAY_MAPPED   19
+#define DMI_MEMORY_DEVICE         17
+#define DMI_MEMORY_DEVICE_MAPPED  20
+
+// Offsets of the fields of the Memory Device (type 17)
+#define DMI17_ARRAY_HANDLE        0x04
+#define DMI17_TOTAL_WIDTH         0x08
+#define DMI17_DATA_WIDTH          0x0A
+#define DMI17_SIZE                0x0C
+#define DMI17_DEVICE_LOCATOR      0x10
+#define DMI17_BANK_LOCATOR        0x11
+#define DMI17_MEMORY_TYPE         0x12
+#define DMI17_SPEED               0x15
+#define DMI17_MANUFACTURER        0x17
+#define DMI17_PART_NUMBER         0x1A
+#define DMI17_ATTRIBUTES          0x1B
+#define DMI17_EXTENDED_SIZE       0x1C
+#define DMI17_CONFIGURED_SPEED    0x20
+#define DMI17_EXTENDED_SPEED      0x54
+#define DMI17_EXTENDED_CONF_SPEED 0x58
+
+// Offsets of the Memory Array Mapped Address (type 19)
+#define DMI19_START               0x04
+#define DMI19_END                 0x08
+#define DMI19_EXTENDED_START      0x0F
+#define DMI19_EXTENDED_END        0x17
+
+// Offsets of the Memory Device Mapped Address (type 20)
+#define DMI20_DEVICE_HANDLE       0x0C
+#define DMI20_INTERLEAVE_POS      0x11
+#define DMI20_INTERLEAVE_DEPTH    0x12
+
+// A socket is flagged if its measured bandwidth is below this
+// fraction of the theoretical one
+#define DRAM_LOW_FRACTION         0.6
+
+// Memory device (DIMM slot) from SMBIOS
+struct dimm {
+  uint16_t handle;
+  uint16_t array;
+  char* locator;
+  char* bank;
+  char* manufacturer;
+  char* part;
+  uint64_t size_mb;   // 0 if the slot is empty
+  int type;
+  int total_width;
+  int data_width;
+  uint32_t speed;     // Rated speed (MT/s)
+  uint32_t conf_speed; // Configured speed (MT/s)
+  int ranks;
+  int socket;
+  char* channel;      // Channel parsed from the locators, if any
+  bool mapped;        // Has a type 20 record
+  int interleave_pos;
+  int interleave_depth;
+};
+
+struct dmi_memory {
+  struct dimm* dimms;
+  int ndimms;
+  uint64_t mapped_kb; // Total of the type 19 ranges
+  int nranges;
+  bool has_device_mapped;
+  bool denied;
+};
+
+// Per socket summary
+struct dram_socket {
+  int ndimms;
+  int nslots;
+  uint64_t size_mb;
+  int nchannels;        // Channels with at least one slot
+  int populated;        // Channels with at least one DIMM
+  int min_dimms, max_dimms;
+  uint64_t min_size, max_size;
+  uint32_t min_speed, max_rated;
+  double bandwidth;     // Theoretical, bytes/s
+  double measured;      // Measured, bytes/s (-1 if not measured)
+  bool inferred;        // Some channels could not be parsed
+};
+
+static const struct {
+  int type;
+  const char* name;
+} dmi_memory_types[] = {
+  { 0x12, "DDR"    },
+  { 0x13, "DDR2"   },
+  { 0x18, "DDR3"   },
+  { 0x1A, "DDR4"   },
+  { 0x1B, "LPDDR"  },
+  { 0x1C, "LPDDR2" },
+  { 0x1D, "LPDDR3" },
+  { 0x1E, "LPDDR4" },
+  { 0x20, "HBM"    },
+  { 0x21, "HBM2"   },
+  { 0x22, "DDR5"   },
+  { 0x23, "LPDDR5" },
+  { 0x24, "HBM3"   },
+};
+
+const char* get_str_memory_type(int type) {
+  for(size_t i=0; i < sizeof(dmi_memory_types) / sizeof(dmi_memory_types[0]); i++) {
+    if(dmi_memory_types[i].type == type) return dmi_memory_types[i].name;
+  }
+  return STRING_UNKNOWN;
+}
+
+// SMBIOS is little endian; fields beyond the length of the structure
+// (older versions of the specification) read as 0
+uint64_t dmi_field(const uint8_t* raw, int len, int offset, int size) {
+  uint64_t v = 0;
+  if(offset + size > raw[1] || offset + size > len) return 0;
+  for(int i=size-1; i >= 0; i--) v = (v << 8) | raw[offset + i];
+  return v;
+}
+
+// Returns a copy of the string n (1-based) of the structure, which are
+// stored after the formatted area, or NULL if it is not set
+char* dmi_string(const uint8_t* raw, int len, int offset) {
+  int n = (int) dmi_field(raw, len, offset, 1);
+  if(n == 0) return NULL;
+
+  int pos = raw[1];
+  for(int i=1; i < n && pos < len; i++) {
+    while(pos < len && raw[pos] != '\0') pos++;
+    pos++;
+  }
+  if(pos >= len || raw[pos] == '\0') return NULL;
+
+  const char* str = (const char *) raw + pos;
+  int slen = strnlen(str, len - pos);
+  while(slen > 0 && isspace((unsigned char) str[slen-1])) slen--;
+  while(slen > 0 && isspace((unsigned char) *str)) {
+    str++;
+    slen--;
+  }
+  if(slen == 0) return NULL;
+
+  char* ret = emalloc(sizeof(char) * (slen + 1));
+  memcpy(ret, str, slen);
+  ret[slen] = '\0';
+  return ret;
+}
+
+// Reads the structure index of the given type. Returns NULL when there
+// are no more, setting denied if the file exists but cannot be read
+// (the raw entries are only readable by root)
+uint8_t* get_dmi_entry(int type, int index, int* len, bool* denied) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%d-%d/raw", _PATH_DMI_ENTRIES, type, index);
+  errno = 0;
+  uint8_t* raw = (uint8_t *) read_file(path, len);
+  if(raw == NULL) {
+    if(errno == EACCES || errno == EPERM) *denied = true;
+    return NULL;
+  }
+  if(*len < 4 || raw[1] < 4 || raw[0] != type) {
+    free(raw);
+    return NULL;
+  }
+  return raw;
+}
+
+uint64_t get_dimm_size_mb(const uint8_t* raw, int len) {
+  uint64_t size = dmi_field(raw, len, DMI17_SIZE, 2);
+  if(size == 0 || size == 0xFFFF) return 0;
+  if(size == 0x7FFF) return dmi_field(raw, len, DMI17_EXTENDED_SIZE, 4) & 0x7FFFFFFF;
+  if(size & 0x8000) return (size & 0x7FFF) / 1024;
+  return size;
+}
+
+uint32_t get_dimm_speed(const uint8_t* raw, int len, int offset, int ext_offset) {
+  uint32_t speed = (uint32_t) dmi_field(raw, len, offset, 2);
+  if(speed == 0xFFFF) speed = (uint32_t) dmi_field(raw, len, ext_offset, 4) & 0x7FFFFFFF;
+  return speed;
+}
+
+// Looks for a socket number in a locator, e.g., "CPU1_DIMM_A1",
+// "P0 CHANNEL A", "PROC 2 DIMM 4" or "Node0_Dimm1"
+bool parse_locator_socket(const char* str, int* socket) {
+  static const char* prefixes[] = { "SOCKET", "PROC", "CPU", "NODE", "P" };
+  if(str == NULL) return false;
+
+  for(const char* s = str; *s != '\0'; s++) {
+    if(s != str && isalpha((unsigned char) s[-1])) continue;
+    for(size_t p=0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+      size_t plen = strlen(prefixes[p]);
+      if(strncasecmp(s, prefixes[p], plen) != 0) continue;
+      const char* d = s + plen;
+      // A single "P" must be followed directly by the number
+      if(plen > 1) while(*d == ' ' || *d == '_' || *d == '-') d++;
+      if(isdigit((unsigned char) *d)) {
+        *socket = atoi(d);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+char* copy_token(const char* s) {
+  int n = 0;
+  while(isalnum((unsigned char) s[n])) n++;
+  if(n == 0) return NULL;
+  char* ret = emalloc(sizeof(char) * (n + 1));
+  memcpy(ret, s, n);
+  ret[n] = '\0';
+  return ret;
+}
+
+const char* find_nocase(const char* str, const char* needle) {
+  size_t n = strlen(needle);
+  for(const char* s = str; *s != '\0'; s++) {
+    if(strncasecmp(s, needle, n) == 0) return s;
+  }
+  return NULL;
+}
+
+// Looks for the memory controller of a DIMM, e.g., "Controller1" in
+// "Controller1-ChannelA-DIMM0" (Intel) or "IMC0"/"MC0" in other
+// locators. Returns -1 if there is none
+int parse_locator_controller(const char* locator, const char* bank) {
+  static const char* prefixes[] = { "CONTROLLER", "IMC", "MC" };
+  const char* strs[] = { locator, bank };
+
+  for(int i=0; i < 2; i++) {
+    if(strs[i] == NULL) continue;
+    for(const char* s = strs[i]; *s != '\0'; s++) {
+      if(s != strs[i] && isalpha((unsigned char) s[-1])) continue;
+      for(size_t p=0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+        size_t plen = strlen(prefixes[p]);
+        if(strncasecmp(s, prefixes[p], plen) != 0) continue;
+        const char* d = s + plen;
+        while(*d == ' ' || *d == '_' || *d == '-') d++;
+        if(isdigit((unsigned char) *d)) return atoi(d);
+      }
+    }
+  }
+  return -1;
+}
+
+// Looks for the channel of a DIMM, e.g., "P0 CHANNEL A" or
+// "ChannelB-DIMM0" (explicit), or "CPU0_DIMM_C2" and "DIMMC1" (the
+// letter of the slot is the channel, the number the DIMM within it)
+char* parse_locator_channel_name(const char* locator, const char* bank) {
+  const char* strs[] = { bank, locator };
+  for(int i=0; i < 2; i++) {
+    if(strs[i] == NULL) continue;
+    const char* s = find_nocase(strs[i], "CHANNEL");
+    if(s == NULL) continue;
+    s += strlen("CHANNEL");
+    while(*s == ' ' || *s == '_' || *s == '-') s++;
+    char* ch = copy_token(s);
+    if(ch != NULL) return ch;
+  }
+
+  if(locator == NULL) return NULL;
+  const char* s = find_nocase(locator, "DIMM");
+  s = s == NULL ? locator : s + strlen("DIMM");
+  while(*s == ' ' || *s == '_' || *s == '-') s++;
+  if(isalpha((unsigned char) s[0]) && isdigit((unsigned char) s[1])) {
+    char* ch = emalloc(sizeof(char) * 2);
+    ch[0] = toupper((unsigned char) s[0]);
+    ch[1] = '\0';
+    return ch;
+  }
+  return NULL;
+}
+
+// Returns the channel key of a DIMM, prefixed with its memory controller
+// if the locators name one, since channel names repeat across
+// controllers (e.g., "Controller0-ChannelA-DIMM0" and
+// "Controller1-ChannelA-DIMM0" become MC0-A and MC1-A). DIMMs are only
+// compared within a socket, which completes the key
+char* parse_locator_channel(const char* locator, const char* bank) {
+  char* ch = parse_locator_channel_name(locator, bank);
+  int mc = parse_locator_controller(locator, bank);
+  if(ch == NULL || mc < 0) return ch;
+
+  int len = strlen(ch) + 16;
+  char* key = emalloc(sizeof(char) * len);
+  snprintf(key, len, "MC%d-%s", mc, ch);
+  free(ch);
+  return key;
+}
+
+void free_dmi_memory(struct dmi_memory* mem) {
+  for(int i=0; i < mem->ndimms; i++) {
+    free(mem->dimms[i].locator);
+    free(mem->dimms[i].bank);
+    free(mem->dimms[i].manufacturer);
+    free(mem->dimms[i].part);
+    free(mem->dimms[i].channel);
+  }
+  free(mem->dimms);
+  free(mem);
+}
+
+int compare_handles(const void* a, const void* b) {
+  return *(const int *) a - *(const int *) b;
+}
+
+// Assigns each DIMM to a socket using the locators if all of them have
+// a socket number; otherwise, using the memory array (type 16), since
+// firmwares usually describe one array per socket
+void assign_sockets(struct dmi_memory* mem, int npackages) {
+  int min_socket = -1;
+  bool all = mem->ndimms > 0;
+  for(int i=0; i < mem->ndimms && all; i++) {
+    struct dimm* d = &mem->dimms[i];
+    all = parse_locator_socket(d->locator, &d->socket) || parse_locator_socket(d->bank, &d->socket);
+    if(all && (min_socket == -1 || d->socket < min_socket)) min_socket = d->socket;
+  }
+  if(all) {
+    // Some firmwares number the sockets from 1
+    for(int i=0; i < mem->ndimms; i++) {
+      mem->dimms[i].socket -= min_socket;
+      if(mem->dimms[i].socket >= npackages) mem->dimms[i].socket = -1;
+    }
+    return;
+  }
+
+  int* arrays = emalloc(sizeof(int) * mem->ndimms);
+  int narrays = 0;
+  for(int i=0; i < mem->ndimms; i++) {
+    bool found = false;
+    for(int j=0; j < narrays && !found; j++) found = arrays[j] == mem->dimms[i].array;
+    if(!found) arrays[narrays++] = mem->dimms[i].array;
+  }
+  qsort(arrays, narrays, sizeof(int), compare_handles);
+
+  for(int i=0; i < mem->ndimms; i++) {
+    struct dimm* d = &mem->dimms[i];
+    d->socket = npackages == 1 ? 0 : -1;
+    if(narrays == npackages) {
+      for(int j=0; j < narrays; j++) if(arrays[j] == d->array) d->socket = j;
+    }
+  }
+  free(arrays);
+}
+
+struct dmi_memory* get_dmi_memory(int npackages) {
+  struct dmi_memory* mem = emalloc(sizeof(struct dmi_memory));
+  int capacity = 16;
+  mem->dimms = emalloc(sizeof(struct dimm) * capacity);
+  mem->ndimms = 0;
+  mem->mapped_kb = 0;
+  mem->nranges = 0;
+  mem->has_device_mapped = false;
+  mem->denied = false;
+
+  uint8_t* raw;
+  int len;
+  for(int i=0; (raw = get_dmi_entry(DMI_MEMORY_DEVICE, i, &len, &mem->denied)) != NULL; i++) {
+    if(mem->ndimms == capacity) {
+      capacity *= 2;
+      mem->dimms = erealloc(mem->dimms, sizeof(struct dimm) * capacity);
+    }
+    struct dimm* d = &mem->dimms[mem->ndimms++];
+    d->handle = (uint16_t) dmi_field(raw, len, 2, 2);
+    d->array = (uint16_t) dmi_field(raw, len, DMI17_ARRAY_HANDLE, 2);
+    d->locator = dmi_string(raw, len, DMI17_DEVICE_LOCATOR);
+    d->bank = dmi_string(raw, len, DMI17_BANK_LOCATOR);
+    d->manufacturer = dmi_string(raw, len, DMI17_MANUFACTURER);
+    d->part = dmi_string(raw, len, DMI17_PART_NUMBER);
+    d->size_mb = get_dimm_size_mb(raw, len);
+    d->type = (int) dmi_field(raw, len, DMI17_MEMORY_TYPE, 1);
+    d->total_width = (int) dmi_field(raw, len, DMI17_TOTAL_WIDTH, 2);
+    d->data_width = (int) dmi_field(raw, len, DMI17_DATA_WIDTH, 2);
+    d->speed = get_dimm_speed(raw, len, DMI17_SPEED, DMI17_EXTENDED_SPEED);
+    d->conf_speed = get_dimm_speed(raw, len, DMI17_CONFIGURED_SPEED, DMI17_EXTENDED_CONF_SPEED);
+    d->ranks = (int) dmi_field(raw, len, DMI17_ATTRIBUTES, 1) & 0xF;
+    d->channel = parse_locator_channel(d->locator, d->bank);
+    d->socket = -1;
+    d->mapped = false;
+    d->interleave_pos = 0;
+    d->interleave_depth = 0;
+    // Width 0xFFFF means unknown
+    if(d->total_width == 0xFFFF) d->total_width = 0;
+    if(d->data_width == 0xFFFF) d->data_width = 0;
+    free(raw);
+  }
+
+  for(int i=0; (raw = get_dmi_entry(DMI_MEMORY_ARRAY_MAPPED, i, &len, &mem->denied)) != NULL; i++) {
+    uint64_t start = dmi_field(raw, len, DMI19_START, 4);
+    uint64_t end = dmi_field(raw, len, DMI19_END, 4);
+    if(start == 0xFFFFFFFF) {
+      // Extended addresses are in bytes
+      start = dmi_field(raw, len, DMI19_EXTENDED_START, 8) / 1024;
+      end = dmi_field(raw, len, DMI19_EXTENDED_END, 8) / 1024;
+    }
+    if(end >= start) {
+      mem->mapped_kb += end - start + 1;
+      mem->nranges++;
+    }
+    free(raw);
+  }
+
+  for(int i=0; (raw = get_dmi_entry(DMI_MEMORY_DEVICE_MAPPED, i, &len, &mem->denied)) != NULL; i++) {
+    uint16_t handle = (uint16_t) dmi_field(raw, len, DMI20_DEVICE_HANDLE, 2);
+    mem->has_device_mapped = true;
+    for(int j=0; j < mem->ndimms; j++) {
+      if(mem->dimms[j].handle != handle) continue;
+      mem->dimms[j].mapped = true;
+      mem->dimms[j].interleave_pos = (int) dmi_field(raw, len, DMI20_INTERLEAVE_POS, 1);
+      mem->dimms[j].interleave_depth = (int) dmi_field(raw, len, DMI20_INTERLEAVE_DEPTH, 1);
+    }
+    free(raw);
+  }
+
+  assign_sockets(mem, npackages);
+  return mem;
+}
+
+// Computes the summary of the socket: the channels are the distinct
+// channel names of its slots (or one per slot if they are unknown), and
+// the theoretical bandwidth is the sum over the populated channels of
+// the configured speed times the data width. DIMMs in the same channel
+// share its bandwidth.
+void get_dram_socket(struct dmi_memory* mem, int socket, struct dram_socket* s) {
+  memset(s, 0, sizeof(struct dram_socket));
+  s->measured = -1.0;
+  s->min_dimms = -1;
+  bool* seen = ecalloc(mem->ndimms, sizeof(bool));
+
+  for(int i=0; i < mem->ndimms; i++) {
+    struct dimm* d = &mem->dimms[i];
+    if(d->socket != socket || seen[i]) continue;
+
+    // Collect the slots of the channel of d
+    int dimms = 0;
+    uint64_t size = 0;
+    uint32_t speed = 0;
+    int width = 0;
+    if(d->channel == NULL) s->inferred = true;
+    for(int j=i; j < mem->ndimms; j++) {
+      struct dimm* e = &mem->dimms[j];
+      bool same = j == i || (d->socket == e->socket && d->channel != NULL && e->channel != NULL && strcmp(d->channel, e->channel) == 0);
+      if(e->socket != socket || seen[j] || !same) continue;
+      seen[j] = true;
+      s->nslots++;
+      if(e->size_mb == 0) continue;
+
+      uint32_t conf = e->conf_speed > 0 ? e->conf_speed : e->speed;
+      dimms++;
+      size += e->size_mb;
+      if(conf > 0 && (speed == 0 || conf < speed)) speed = conf;
+      width = max(width, e->data_width);
+      if(conf > 0 && (s->min_speed == 0 || conf < s->min_speed)) s->min_speed = conf;
+      s->max_rated = max(s->max_rated, e->speed);
+    }
+
+    s->nchannels++;
+    if(dimms == 0) continue;
+    s->populated++;
+    s->ndimms += dimms;
+    s->size_mb += size;
+    s->bandwidth += (double) speed * 1e6 * width / 8;
+    if(s->min_dimms == -1 || dimms < s->min_dimms) s->min_dimms = dimms;
+    s->max_dimms = max(s->max_dimms, dimms);
+    if(s->min_size == 0 || size < s->min_size) s->min_size = size;
+    s->max_size = max(s->max_size, size);
+  }
+
+  free(seen);
+}
+
+// Measures the read bandwidth of the socket, running the streaming
+// threads in all its allowed CPUs with the memory of their own node
+// (one node after the other if the socket is split in several)
+double measure_socket_bandwidth(struct cpu_map* map, bool* allowed, int socket) {
+  int* cpus = emalloc(sizeof(int) * map->num_cpus);
+  bool* done = ecalloc(map->num_cpus, sizeof(bool));
+  double total = 0.0;
+  bool any = false;
+
+  for(int c=0; c < map->num_cpus; c++) {
+    struct cpu_location* loc = &map->cpus[c];
+    if(!loc->online || !allowed[c] || loc->package != socket || done[c]) continue;
+
+    int node = loc->node;
+    int ncpus = 0;
+    for(int k=c; k < map->num_cpus; k++) {
+      struct cpu_location* l = &map->cpus[k];
+      if(l->online && allowed[k] && l->package == socket && l->node == node && !done[k]) {
+        cpus[ncpus++] = k;
+        done[k] = true;
+      }
+    }
+
+    double bw;
+    if(!run_stream_workers(map, cpus, ncpus, node < 0 ? 0 : node, NULL, NULL, &bw)) {
+      free(cpus);
+      free(done);
+      return -1.0;
+    }
+    total += bw;
+    any = true;
+  }
+
+  free(cpus);
+  free(done);
+  return any ? total : -1.0;
+}
+
+void print_dimm_table(struct dmi_memory* mem) {
+  printf("  %-6s %-7s %-26s %-24s %8s %-6s %6s %6s %7s %5s %-6s %s\n", "Socket", "Channel", "Locator", "Bank",
+         "Size", "Type", "Speed", "Conf", "Width", "Ranks", "Ilv", "Part");
+
+  int empty = 0;
+  for(int i=0; i < mem->ndimms; i++) {
+    struct dimm* d = &mem->dimms[i];
+    if(d->size_mb == 0) {
+      empty++;
+      continue;
+    }
+
+    char socket[16];
+    char width[16];
+    char ilv[16];
+    if(d->socket >= 0) snprintf(socket, sizeof(socket), "%d", d->socket);
+    else snprintf(socket, sizeof(socket), "?");
+    snprintf(width, sizeof(width), "%d/%d", d->data_width, d->total_width);
+    if(!mem->has_device_mapped) snprintf(ilv, sizeof(ilv), "-");
+    else if(!d->mapped) snprintf(ilv, sizeof(ilv), "none");
+    else snprintf(ilv, sizeof(ilv), "%d/%d", d->interleave_pos, d->interleave_depth);
+
+    printf("  %-6s %-7s %-26s %-24s %5lu GB %-6s %6u %6u %7s %5d %-6s %s\n", socket,
+           d->channel == NULL ? "?" : d->channel, d->locator == NULL ? "-" : d->locator,
+           d->bank == NULL ? "-" : d->bank, (unsigned long) (d->size_mb / 1024), get_str_memory_type(d->type),
+           d->speed, d->conf_speed, width, d->ranks, ilv, d->part == NULL ? "-" : d->part);
+  }
+  if(empty > 0) printf("  (%d empty slots)\n", empty);
+}
+
+void print_dram_socket(int socket, struct dram_socket* s) {
+  if(s->populated == 0) {
+    char* mbw = get_str_bandwidth(s->measured);
+    printf("Socket %d: measured read bandwidth: %s\n", socket, mbw);
+    free(mbw);
+    return;
+  }
+
+  char* bw = get_str_bandwidth(s->bandwidth > 0 ? s->bandwidth : -1.0);
+  printf("Socket %d: %d DIMMs, %lu GB, %d of %d channels populated%s, %u MT/s, %s theoretical\n", socket, s->ndimms,
+         (unsigned long) (s->size_mb / 1024), s->populated, s->nchannels, s->inferred ? " (one per slot)" : "",
+         s->min_speed, bw);
+  free(bw);
+
+  if(s->measured > 0) {
+    char* mbw = get_str_bandwidth(s->measured);
+    if(s->bandwidth > 0) {
+      double frac = s->measured / s->bandwidth;
+      printf("  Measured read bandwidth: %s (%.0f%% of the theoretical)\n", mbw, frac * 100);
+      if(frac < DRAM_LOW_FRACTION)
+        printf("  * Low: below %.0f%% of the theoretical bandwidth\n", DRAM_LOW_FRACTION * 100);
+    }
+    else {
+      printf("  Measured read bandwidth: %s\n", mbw);
+    }
+    free(mbw);
+  }
+
+  if(s->populated < s->nchannels && !s->inferred)
+    printf("  * Unbalanced: %d of the %d channels are empty\n", s->nchannels - s->populated, s->nchannels);
+  if(s->min_dimms != s->max_dimms)
+    printf("  * Unbalanced: channels have between %d and %d DIMMs\n", s->min_dimms, s->max_dimms);
+  if(s->min_size != s->max_size)
+    printf("  * Unbalanced: channels have between %lu and %lu GB\n", (unsigned long) (s->min_size / 1024),
+           (unsigned long) (s->max_size / 1024));
+  if(s->min_speed > 0 && s->max_rated > s->min_speed)
+    printf("  DIMMs run at %u MT/s, below their rated %u MT/s\n", s->min_speed, s->max_rated);
+}
+
+// Reads the memory devices described by the firmware (SMBIOS types 17,
+// 19 and 20) and computes the theoretical DRAM bandwidth of each socket
+// from the populated channels. Optionally, it measures the read
+// bandwidth of each socket and reports the fraction achieved. Channels
+// that are empty or populated differently make the memory controller
+// interleave unevenly, which is flagged.
+bool print_dram_info(bool measure) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+
+  struct dmi_memory* mem = get_dmi_memory(map->num_packages);
+  int npopulated = 0;
+  uint64_t total_mb = 0;
+  for(int i=0; i < mem->ndimms; i++) {
+    if(mem->dimms[i].size_mb > 0) npopulated++;
+    total_mb += mem->dimms[i].size_mb;
+  }
+
+  if(npopulated == 0 && measure) {
+    // The bandwidth can still be measured, only the theoretical one is missing
+    if(mem->denied) printWarn("Unable to read %s: root privileges are required", _PATH_DMI_ENTRIES);
+    else printWarn("No memory devices found in %s", _PATH_DMI_ENTRIES);
+  }
+  else if(npopulated == 0) {
+    if(mem->denied) printErr("Unable to read %s: root privileges are required", _PATH_DMI_ENTRIES);
+    else printErr("No memory devices found in %s", _PATH_DMI_ENTRIES);
+    free_dmi_memory(mem);
+    free_cpu_map(map);
+    return false;
+  }
+  else {
+    printf("Memory devices (SMBIOS):\n");
+    print_dimm_table(mem);
+    printf("\nInstalled: %lu GB in %d DIMMs", (unsigned long) (total_mb / 1024), npopulated);
+    if(mem->nranges > 0) printf(", mapped: %lu GB in %d ranges", (unsigned long) (mem->mapped_kb / 1024 / 1024), mem->nranges);
+    printf("\n\n");
+  }
+
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  if(measure && !get_allowed_cpus(allowed, map->num_cpus)) measure = false;
+
+  struct dram_socket* sockets = emalloc(sizeof(struct dram_socket) * map->num_packages);
+  bool ret = true;
+  for(int p=0; p < map->num_packages; p++) {
+    get_dram_socket(mem, p, &sockets[p]);
+    if(measure) {
+      char banner[64];
+      snprintf(banner, sizeof(banner), "cpufetch is measuring the bandwidth of socket %d...", p);
+      printf("%s", banner);
+      fflush(stdout);
+      sockets[p].measured = measure_socket_bandwidth(map, allowed, p);
+      printf("\r%*c\r", (int) strlen(banner), ' ');
+      if(sockets[p].measured < 0) ret = false;
+    }
+    if(npopulated > 0 || measure) print_dram_socket(p, &sockets[p]);
+  }
+
+  bool unassigned = false;
+  for(int i=0; i < mem->ndimms; i++) unassigned = unassigned || (mem->dimms[i].size_mb > 0 && mem->dimms[i].socket < 0);
+  if(unassigned) printf("Some DIMMs could not be assigned to a socket (?)\n");
+
+  // Sockets with different memory are not balanced either
+  for(int p=1; p < map->num_packages && npopulated > 0; p++) {
+    if(sockets[p].size_mb != sockets[0].size_mb || sockets[p].populated != sockets[0].populated) {
+      printf("* Unbalanced: the sockets have different memory configurations\n");
+      break;
+    }
+  }
+
+  free(sockets);
+  free(allowed);
+  free_dmi_memory(mem);
+  free_cpu_map(map);
+  return ret;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __DRAM__
+#define __DRAM__
+
+#include <stdbool.h>
+
+bool print_dram_info(bool measure);
+
+#endif
@@ -0,0 +1,267 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "global.h"
+#include "args.h"
+#include "udev.h"
+#include "emit.h"
+
+#define MAX_CONSTANTS   128
+#define MAX_NODES       1024
+#define CONSTANT_PREFIX "CPUFETCH_"
+
+struct constant {
+  char name[64];
+  int64_t value;
+};
+
+struct constant_list {
+  struct constant list[MAX_CONSTANTS];
+  int num;
+};
+
+void add_constant(struct constant_list* cl, const char* prefix, const char* name, int64_t value) {
+  if(cl->num >= MAX_CONSTANTS) {
+    printBug("Too many constants to emit (max is %d)", MAX_CONSTANTS);
+    return;
+  }
+  snprintf(cl->list[cl->num].name, sizeof(cl->list[cl->num].name), "%s%s", prefix, name);
+  cl->list[cl->num].value = value;
+  cl->num++;
+}
+
+int32_t get_logical_cores(struct topology* topo) {
+  return topo->total_cores;
+}
+
+int32_t get_physical_cores(struct topology* topo) {
+#if defined(ARCH_X86) || defined(ARCH_PPC) || defined(ARCH_SPARC) || defined(ARCH_PARISC) || defined(ARCH_ALPHA)
+  return topo->physical_cores * topo->sockets;
+#else
+  return topo->total_cores;
+#endif
+}
+
+int32_t get_smt_width(struct topology* topo) {
+#ifdef ARCH_X86
+  return topo->smt_available;
+#elif defined(ARCH_PPC) || defined(ARCH_SPARC) || defined(ARCH_PARISC) || defined(ARCH_ALPHA)
+  return topo->smt_supported;
+#else
+  UNUSED(topo);
+  return 1;
+#endif
+}
+
+// Logical cores sharing each L3
+int32_t get_cores_per_l3(struct topology* topo, struct cache* cach) {
+  if(!cach->L3->exists || cach->L3->num_caches == 0) return 0;
+#ifdef ARCH_X86
+  // In x86, num_caches is counted per socket
+  return topo->logical_cores / cach->L3->num_caches;
+#else
+  return topo->total_cores / cach->L3->num_caches;
+#endif
+}
+
+// Widest vector register, in bits
+int32_t get_vector_width(struct cpuInfo* cpu) {
+#ifdef ARCH_X86
+  if(cpu->feat->AVX512) return 512;
+  if(cpu->feat->AVX) return 256;
+  if(cpu->feat->SSE) return 128;
+#elif ARCH_ARM
+  if(cpu->feat->SVE) return cpu->feat->cntb * 8;
+  if(cpu->feat->NEON) return 128;
+#elif ARCH_PPC
+  if(cpu->feat->altivec) return 128;
+#else
+  UNUSED(cpu);
+#endif
+  return 0;
+}
+
+int32_t get_num_numa_nodes(void) {
+#ifdef __linux__
+  char* buf = get_str_from_file(_PATH_NODES_ONLINE);
+  if(buf == NULL) return 1;
+
+  bool* nodes = emalloc(sizeof(bool) * MAX_NODES);
+  int num_nodes = parse_cpu_list(buf, nodes, MAX_NODES);
+  free(nodes);
+  free(buf);
+  return num_nodes > 0 ? num_nodes : 1;
+#else
+  return 1;
+#endif
+}
+
+void add_cache_constants(struct constant_list* cl, const char* prefix, struct cache* cach) {
+  const char* names[] = { "L1I_SIZE", "L1D_SIZE", "L2_SIZE", "L3_SIZE" };
+
+  for(int i=0; i < 4; i++) {
+    struct cach* c = cach->cach_arr[i];
+    add_constant(cl, prefix, names[i], c->exists && c->size > 0 ? c->size : 0);
+  }
+}
+
+// Builds the constants from the first module, which are used as the
+// default ones. If the CPU is hybrid, the constants of each module
+// are also added with a MODULE<n>_ prefix.
+void fill_constants(struct cpuInfo* cpu, struct constant_list* cl) {
+  int32_t logical_cores = 0;
+  int32_t physical_cores = 0;
+  int num_modules = get_num_modules(cpu);
+  char prefix[32];
+
+  for(int m=0; m < num_modules; m++) {
+    logical_cores += get_logical_cores(get_module(cpu, m)->topo);
+    physical_cores += get_physical_cores(get_module(cpu, m)->topo);
+  }
+
+  int32_t line_size = cpu->cach->L1d->line_size;
+  add_constant(cl, CONSTANT_PREFIX, "CACHE_LINE_SIZE", line_size > 0 ? line_size : 0);
+  add_cache_constants(cl, CONSTANT_PREFIX, cpu->cach);
+  add_constant(cl, CONSTANT_PREFIX, "LOGICAL_CORES", logical_cores);
+  add_constant(cl, CONSTANT_PREFIX, "PHYSICAL_CORES", physical_cores);
+  add_constant(cl, CONSTANT_PREFIX, "CORES_PER_L3", get_cores_per_l3(cpu->topo, cpu->cach));
+  add_constant(cl, CONSTANT_PREFIX, "SMT_WIDTH", get_smt_width(cpu->topo));
+  add_constant(cl, CONSTANT_PREFIX, "VECTOR_WIDTH", get_vector_width(cpu));
+#ifdef ARCH_X86
+  add_constant(cl, CONSTANT_PREFIX, "HAS_AVX512", cpu->feat->AVX512);
+#else
+  add_constant(cl, CONSTANT_PREFIX, "HAS_AVX512", 0);
+#endif
+#ifdef ARCH_ARM
+  add_constant(cl, CONSTANT_PREFIX, "HAS_SVE", cpu->feat->SVE);
+  add_constant(cl, CONSTANT_PREFIX, "SVE_VECTOR_LENGTH", cpu->feat->SVE ? (int64_t) cpu->feat->cntb * 8 : 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_SME", cpu->feat->SME);
+  add_constant(cl, CONSTANT_PREFIX, "SME_VECTOR_LENGTH", cpu->feat->SME ? (int64_t) cpu->feat->svl * 8 : 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_DOTPROD", cpu->feat->DOTPROD);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_I8MM", cpu->feat->I8MM);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_BF16", cpu->feat->BF16);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_FP16", cpu->feat->FP16);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_LSE", cpu->feat->LSE);
+  add_constant(cl, CONSTANT_PREFIX, "PEAK_INT8_OPS", cpu->int8_ops_performance > 0 ? cpu->int8_ops_performance : 0);
+#else
+  add_constant(cl, CONSTANT_PREFIX, "HAS_SVE", 0);
+  add_constant(cl, CONSTANT_PREFIX, "SVE_VECTOR_LENGTH", 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_SME", 0);
+  add_constant(cl, CONSTANT_PREFIX, "SME_VECTOR_LENGTH", 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_DOTPROD", 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_I8MM", 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_BF16", 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_FP16", 0);
+  add_constant(cl, CONSTANT_PREFIX, "HAS_LSE", 0);
+  add_constant(cl, CONSTANT_PREFIX, "PEAK_INT8_OPS", 0);
+#endif
+  add_constant(cl, CONSTANT_PREFIX, "NUMA_NODES", get_num_numa_nodes());
+  add_constant(cl, CONSTANT_PREFIX, "NUM_MODULES", num_modules);
+
+  if(num_modules < 2) return;
+
+  for(int m=0; m < num_modules; m++) {
+    struct cpuInfo* ptr = get_module(cpu, m);
+    snprintf(prefix, sizeof(prefix), "%sMODULE%d_", CONSTANT_PREFIX, m);
+    add_constant(cl, prefix, "LOGICAL_CORES", get_logical_cores(ptr->topo));
+    add_cache_constants(cl, prefix, ptr->cach);
+    add_constant(cl, prefix, "CORES_PER_L3", get_cores_per_l3(ptr->topo, ptr->cach));
+    add_constant(cl, prefix, "SMT_WIDTH", get_smt_width(ptr->topo));
+    add_constant(cl, prefix, "VECTOR_WIDTH", get_vector_width(ptr));
+  }
+}
+
+// CPUFETCH_CACHE_LINE_SIZE -> cache_line_size
+void get_lowercase_name(char* dst, size_t len, const char* name) {
+  const char* src = name + strlen(CONSTANT_PREFIX);
+  size_t i = 0;
+  for(; src[i] != '\0' && i < len - 1; i++) dst[i] = tolower((unsigned char) src[i]);
+  dst[i] = '\0';
+}
+
+void print_header_c(struct constant_list* cl) {
+  printf("/* Machine constants generated by cpufetch. Do not edit. */\n");
+  printf("#ifndef CPUFETCH_MACHINE_H\n");
+  printf("#define CPUFETCH_MACHINE_H\n\n");
+
+  for(int i=0; i < cl->num; i++) {
+    printf("#define %s %lld\n", cl->list[i].name, (long long) cl->list[i].value);
+  }
+
+  printf("\n#ifdef __cplusplus\n");
+  printf("namespace cpufetch {\n");
+  for(int i=0; i < cl->num; i++) {
+    char name[64];
+    get_lowercase_name(name, sizeof(name), cl->list[i].name);
+    printf("  constexpr long long %s = %s;\n", name, cl->list[i].name);
+  }
+  printf("}\n");
+  printf("#endif\n\n");
+  printf("#endif\n");
+}
+
+void print_header_cmake(struct constant_list* cl) {
+  printf("# Machine constants generated by cpufetch. Do not edit.\n");
+  for(int i=0; i < cl->num; i++) {
+    printf("set(%s %lld)\n", cl->list[i].name, (long long) cl->list[i].value);
+  }
+
+  printf("set(CPUFETCH_COMPILE_DEFINITIONS\n");
+  for(int i=0; i < cl->num; i++) {
+    printf("  %s=%lld\n", cl->list[i].name, (long long) cl->list[i].value);
+  }
+  printf(")\n");
+}
+
+void print_header_pkgconfig(struct constant_list* cl) {
+  printf("# Machine constants generated by cpufetch. Do not edit.\n");
+  for(int i=0; i < cl->num; i++) {
+    char name[64];
+    get_lowercase_name(name, sizeof(name), cl->list[i].name);
+    printf("%s=%lld\n", name, (long long) cl->list[i].value);
+  }
+
+  printf("\nName: cpufetch-machine\n");
+  printf("Description: Constants of the machine detected by cpufetch\n");
+  printf("Version: 1.0\n");
+  printf("Cflags:");
+  for(int i=0; i < cl->num; i++) {
+    printf(" -D%s=%lld", cl->list[i].name, (long long) cl->list[i].value);
+  }
+  printf("\n");
+}
+
+// Prints the constants of the machine, so that blocking factors or
+// thread counts can be fixed at compile time. Sizes that could not be
+// detected are emitted as 0
+bool print_machine_header(struct cpuInfo* cpu, int format) {
+  if(cpu->cach == NULL || cpu->topo == NULL) {
+    printErr("Cache or topology information is not available");
+    return false;
+  }
+
+  struct constant_list* cl = emalloc(sizeof(struct constant_list));
+  cl->num = 0;
+  fill_constants(cpu, cl);
+
+  switch(format) {
+    case EMIT_C:
+      print_header_c(cl);
+      break;
+    case EMIT_CMAKE:
+      print_header_cmake(cl);
+      break;
+    case EMIT_PKGCONFIG:
+      print_header_pkgconfig(cl);
+      break;
+    default:
+      printBug("Invalid emit format: %d", format);
+      free(cl);
+      return false;
+  }
+
+  free(cl);
+  return true;
+}
@@ -0,0 +1,8 @@
+#ifndef __EMIT__
+#define __EMIT__
+
+#include "cpu.h"
+
+bool print_machine_header(struct cpuInfo* cpu, int format);
+
+#endif
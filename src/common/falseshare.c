@@ -0,0 +1,169 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "global.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "membench.h"
+#include "falseshare.h"
+
+#define FS_ITERS        (2UL * 1024 * 1024)
+#define FS_REPS         3
+// Strides above the page size cannot share any line or prefetch pair
+#define FS_MAX_STRIDE   4096
+// Slowdown (relative to FS_MAX_STRIDE) still considered interference
+#define FS_THRESHOLD    1.5
+
+struct fs_state {
+  volatile uint64_t* counter;
+  volatile uint32_t ready;
+  volatile uint32_t start;
+  uint64_t ns;
+};
+
+static void increment_counter(volatile uint64_t* counter) {
+  for(uint64_t i=0; i < FS_ITERS; i++) (*counter)++;
+}
+
+void* fs_thread(void* arg) {
+  struct fs_state* st = (struct fs_state*) arg;
+
+  __atomic_store_n(&st->ready, 1, __ATOMIC_RELEASE);
+  while(!__atomic_load_n(&st->start, __ATOMIC_ACQUIRE)) cpu_relax();
+
+  uint64_t t0 = get_time_ns();
+  increment_counter(st->counter);
+  st->ns = get_time_ns() - t0;
+
+  return NULL;
+}
+
+// The current thread and a thread running in cpu increment two
+// counters placed stride bytes apart. Returns the time (in ns) per increment of the slowest thread.
+double measure_stride(char* buf, int cpu, int stride) {
+  struct fs_state* st = ecalloc(1, sizeof(struct fs_state));
+  volatile uint64_t* counter = (volatile uint64_t *) buf;
+  pthread_t thread;
+
+  *counter = 0;
+  st->counter = (volatile uint64_t *) (buf + stride);
+  *st->counter = 0;
+
+  if(!create_thread_on_cpu(&thread, cpu, fs_thread, st)) {
+    free(st);
+    return -1.0;
+  }
+
+  while(!__atomic_load_n(&st->ready, __ATOMIC_ACQUIRE)) cpu_relax();
+  __atomic_store_n(&st->start, 1, __ATOMIC_RELEASE);
+
+  uint64_t t0 = get_time_ns();
+  increment_counter(counter);
+  uint64_t ns = get_time_ns() - t0;
+
+  pthread_join(thread, NULL);
+  if(st->ns > ns) ns = st->ns;
+  free(st);
+
+  return (double) ns / FS_ITERS;
+}
+
+bool find_fs_pair(struct cpu_map* map, int* cpu1, int* cpu2) {
+  // SMT siblings share the L1, so they are the last option
+  int relations[] = { CPU_RELATION_L3, CPU_RELATION_SOCKET, CPU_RELATION_CROSS_SOCKET, CPU_RELATION_SMT };
+  int nrelations = sizeof(relations) / sizeof(relations[0]);
+
+  for(int r=0; r < nrelations; r++) {
+    if(find_cpu_pair(map, relations[r], cpu1, cpu2)) {
+      printf("Using CPUs %d and %d (%s)\n", *cpu1, *cpu2, get_str_cpu_relation(relations[r]));
+      return true;
+    }
+  }
+  return false;
+}
+
+void print_line_sizes(struct cache* cach) {
+  const char* names[] = { "L1i", "L1d", "L2", "L3" };
+
+  bool first = true;
+
+  printf("Cache line size:");
+  for(int i=0; i < 4; i++) {
+    if(!cach->cach_arr[i]->exists) continue;
+    if(cach->cach_arr[i]->line_size > 0) printf("%s %s %d B", first ? "" : ",", names[i], cach->cach_arr[i]->line_size);
+    else printf("%s %s %s", first ? "" : ",", names[i], STRING_UNKNOWN);
+    first = false;
+  }
+  printf("\n");
+}
+
+// Finds the destructive interference size empirically: two cores
+// write to counters at increasing distances until the writes stop
+// interfering. Besides the line size, this captures effects such as
+// the adjacent-line prefetcher, which make it bigger than one line.
+bool print_false_sharing(struct cpuInfo* cpu) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+
+  if(cpu->cach != NULL) print_line_sizes(cpu->cach);
+
+  int cpu1, cpu2;
+  if(!find_fs_pair(map, &cpu1, &cpu2)) {
+    printErr("Unable to find a pair of online CPUs to measure false sharing");
+    free_cpu_map(map);
+    return false;
+  }
+  free_cpu_map(map);
+
+  if(!bind_to_cpu(cpu1)) {
+    printErr("Failed binding the process to CPU %d", cpu1);
+    return false;
+  }
+
+  // Page aligned, so that stride 0 is the start of any line or line pair
+  char* buf = alloc_bench_buffer(2 * FS_MAX_STRIDE);
+  if(buf == NULL) return false;
+
+  int nstrides = 0;
+  for(int stride=8; stride <= FS_MAX_STRIDE; stride *= 2) nstrides++;
+  double* times = emalloc(sizeof(double) * nstrides);
+
+  printf("\n  %8s %12s\n", "Stride", "Increment");
+  int s = 0;
+  for(int stride=8; stride <= FS_MAX_STRIDE; stride *= 2, s++) {
+    times[s] = -1.0;
+    for(int r=0; r < FS_REPS; r++) {
+      double t = measure_stride(buf, cpu2, stride);
+      if(t < 0) {
+        free(times);
+        free_bench_buffer(buf, 2 * FS_MAX_STRIDE);
+        return false;
+      }
+      if(times[s] < 0 || t < times[s]) times[s] = t;
+    }
+    printf("  %6d B %9.2f ns\n", stride, times[s]);
+  }
+
+  // The smallest stride from which every bigger stride is free of interference
+  double baseline = times[nstrides - 1];
+  int size = FS_MAX_STRIDE;
+  s = nstrides - 1;
+  for(int stride=FS_MAX_STRIDE; stride >= 8 && times[s] <= baseline * FS_THRESHOLD; stride /= 2, s--) {
+    size = stride;
+  }
+
+  printf("\nDestructive interference size: %d bytes\n", size);
+
+  free(times);
+  free_bench_buffer(buf, 2 * FS_MAX_STRIDE);
+  return true;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __FALSESHARE__
+#define __FALSESHARE__
+
+#include "cpu.h"
+
+bool print_false_sharing(struct cpuInfo* cpu);
+
+#endif
@@ -14,8 +14,9 @@
 
 #include "global.h"
 #include "cpu.h"
+#include "freq.h"
 
-static long
+long
 perf_event_open(struct perf_event_attr *hw_event, pid_t pid,
                 int cpu, int group_fd, unsigned long flags) {
     int ret;
@@ -70,14 +71,10 @@ void nop_function(uint64_t iters) {
   }
 }
 
-// Run the nop_function with the number of iterations specified and
-// measure both the time and number of cycles
-int measure_freq_iters(uint64_t iters, uint32_t core, double* freq) {
-  clockid_t clock = CLOCK_PROCESS_CPUTIME_ID;
-  struct timespec start, end;
+// Opens a (disabled) counter of the user space cycles of this
+// process in the core specified. Returns -1 on error (see errno)
+int open_cycles_counter(uint32_t core) {
   struct perf_event_attr pe;
-  uint64_t cycles;
-  int fd;
   int pid = 0;
   memset(&pe, 0, sizeof(struct perf_event_attr));
   pe.type = PERF_TYPE_HARDWARE;
@@ -87,7 +84,43 @@ int measure_freq_iters(uint64_t iters, uint32_t core, double* freq) {
   pe.exclude_kernel = 1;
   pe.exclude_hv = 1;
 
-  fd = perf_event_open(&pe, pid, core, -1, 0);
+  return perf_event_open(&pe, pid, core, -1, 0);
+}
+
+bool start_cycles_counter(int fd) {
+  if(ioctl(fd, PERF_EVENT_IOC_RESET, 0) == -1) {
+    perror("ioctl");
+    return false;
+  }
+  if(ioctl(fd, PERF_EVENT_IOC_ENABLE, 0) == -1) {
+    perror("ioctl");
+    return false;
+  }
+  return true;
+}
+
+bool read_cycles_counter(int fd, uint64_t* cycles) {
+  ssize_t ret = read(fd, cycles, sizeof(uint64_t));
+  if (ret == -1) {
+    perror("read");
+    return false;
+  }
+  if (ret != sizeof(uint64_t)) {
+    printErr("Read returned %d, expected %d", ret, sizeof(uint64_t));
+    return false;
+  }
+  return true;
+}
+
+// Run the nop_function with the number of iterations specified and
+// measure both the time and number of cycles
+int measure_freq_iters(uint64_t iters, uint32_t core, double* freq) {
+  clockid_t clock = CLOCK_PROCESS_CPUTIME_ID;
+  struct timespec start, end;
+  uint64_t cycles;
+  int fd;
+
+  fd = open_cycles_counter(core);
   if (fd == -1) {
     perror("perf_event_open");
     if (errno == EPERM || errno == EACCES) {
@@ -101,26 +134,13 @@ int measure_freq_iters(uint64_t iters, uint32_t core, double* freq) {
     perror("clock_gettime");
     return -1;
   }
-  if(ioctl(fd, PERF_EVENT_IOC_RESET, 0) == -1) {
-    perror("ioctl");
+  if(!start_cycles_counter(fd))
     return -1;
-  }
-  if(ioctl(fd, PERF_EVENT_IOC_ENABLE, 0) == -1) {
-    perror("ioctl");
-    return -1;
-  }
 
   nop_function(iters);
 
-  ssize_t ret = read(fd, &cycles, sizeof(uint64_t));
-  if (ret == -1) {
-    perror("read");
+  if(!read_cycles_counter(fd, &cycles))
     return -1;
-  }
-  if (ret != sizeof(uint64_t)) {
-    printErr("Read returned %d, expected %d", ret, sizeof(uint64_t));
-    return -1;
-  }
   if(ioctl(fd, PERF_EVENT_IOC_DISABLE, 0) == -1) {
     perror("ioctl");
     return -1;
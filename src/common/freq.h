@@ -1,6 +1,17 @@
 #ifndef __COMMON_FREQ__
 #define __COMMON_FREQ__
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+struct perf_event_attr;
+
+long perf_event_open(struct perf_event_attr *hw_event, pid_t pid,
+                     int cpu, int group_fd, unsigned long flags);
+int open_cycles_counter(uint32_t core);
+bool start_cycles_counter(int fd);
+bool read_cycles_counter(int fd, uint64_t* cycles);
 int64_t measure_max_frequency(uint32_t core);
 
 #endif
@@ -0,0 +1,310 @@
+#ifdef __linux__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "udev.h"
+#include "cpumap.h"
+#include "freqpolicy.h"
+
+#define _PATH_CPUFREQ_BOOST      _PATH_SYS_SYSTEM _PATH_SYS_CPU _PATH_FREQUENCY "/boost"
+#define _PATH_INTEL_PSTATE       _PATH_SYS_SYSTEM _PATH_SYS_CPU "/intel_pstate"
+#define _PATH_INTEL_NO_TURBO     _PATH_INTEL_PSTATE "/no_turbo"
+#define _PATH_INTEL_STATUS       _PATH_INTEL_PSTATE "/status"
+#define _PATH_INTEL_MAX_PERF_PCT _PATH_INTEL_PSTATE "/max_perf_pct"
+#define _PATH_AMD_PSTATE_STATUS  _PATH_SYS_SYSTEM _PATH_SYS_CPU "/amd_pstate/status"
+#define _PATH_POLICY_BOOST       "/boost"
+#define _PATH_CPPC_NOMINAL_FREQ  "/acpi_cppc/nominal_freq"
+
+// Frequency policy of one CPU. Frequencies are in kHz, and -1
+// means that the file is not available
+struct freq_policy {
+  char* driver;
+  char* governor;
+  char* epp;
+  long hw_max;
+  long scaling_min;
+  long scaling_max;
+  long base;
+  long boost;      // Per policy boost switch (newer kernels)
+  long achievable; // Max frequency allowed by the current policy
+};
+
+// Global switches that affect every CPU
+struct freq_switches {
+  long boost;
+  long no_turbo;
+  long max_perf_pct;
+  char* intel_status;
+  char* amd_status;
+};
+
+enum {
+  FREQ_FLAG_CAPPED,
+  FREQ_FLAG_POWERSAVE,
+  FREQ_FLAG_EPP,
+  FREQ_FLAG_NO_TURBO,
+  FREQ_NUM_FLAGS
+};
+
+static const char* freq_flag_str[] = {
+  [FREQ_FLAG_CAPPED]    = "capped",
+  [FREQ_FLAG_POWERSAVE] = "powersave",
+  [FREQ_FLAG_EPP]       = "epp",
+  [FREQ_FLAG_NO_TURBO]  = "no-turbo",
+};
+
+static const char* freq_flag_desc[] = {
+  [FREQ_FLAG_CAPPED]    = "scaling_max_freq below the hardware maximum",
+  [FREQ_FLAG_POWERSAVE] = "powersave governor (runs at scaling_min_freq)",
+  [FREQ_FLAG_EPP]       = "energy performance preference favors power",
+  [FREQ_FLAG_NO_TURBO]  = "turbo/boost disabled",
+};
+
+long read_switch(char* path) {
+  bool success = true;
+  long ret = get_value_from_file(path, &success);
+  return success ? ret : -1;
+}
+
+// With intel_pstate and amd-pstate-epp in active mode, the driver picks
+// the frequency itself and the governor is just a hint (powersave is the
+// default), so EPP must be checked instead
+bool is_active_driver(const char* driver) {
+  return driver != NULL && (strcmp(driver, "intel_pstate") == 0 || strcmp(driver, "amd-pstate-epp") == 0);
+}
+
+bool is_turbo_off(struct freq_switches* sw, struct freq_policy* p) {
+  return sw->no_turbo == 1 || sw->boost == 0 || p->boost == 0;
+}
+
+void get_flags(struct freq_switches* sw, struct freq_policy* p, bool* flags) {
+  bool active = is_active_driver(p->driver);
+  flags[FREQ_FLAG_CAPPED] = p->hw_max > 0 && p->scaling_max > 0 && p->scaling_max < p->hw_max;
+  flags[FREQ_FLAG_POWERSAVE] = !active && p->governor != NULL && strcmp(p->governor, "powersave") == 0;
+  flags[FREQ_FLAG_EPP] = active && p->epp != NULL && (strcmp(p->epp, "power") == 0 || strcmp(p->epp, "balance_power") == 0);
+  flags[FREQ_FLAG_NO_TURBO] = is_turbo_off(sw, p);
+}
+
+// The max frequency a CPU can reach under the current policy: the
+// hardware max limited by scaling_max_freq, by the base frequency if
+// turbo is disabled, by intel_pstate max_perf_pct, or scaling_min_freq
+// with the powersave governor of the passive drivers
+long get_achievable_freq(struct freq_switches* sw, struct freq_policy* p) {
+  long ach = p->hw_max;
+  if(ach <= 0) return -1;
+
+  if(p->scaling_max > 0 && p->scaling_max < ach) ach = p->scaling_max;
+  if(is_turbo_off(sw, p) && p->base > 0 && p->base < ach) ach = p->base;
+  if(sw->max_perf_pct > 0 && sw->max_perf_pct < 100 && p->driver != NULL && strcmp(p->driver, "intel_pstate") == 0) {
+    ach = min(ach, p->hw_max * sw->max_perf_pct / 100);
+  }
+  if(!is_active_driver(p->driver) && p->governor != NULL && strcmp(p->governor, "powersave") == 0 && p->scaling_min > 0) {
+    ach = min(ach, p->scaling_min);
+  }
+  return ach;
+}
+
+void get_freq_policy(struct freq_policy* p, struct freq_switches* sw, int cpu, int32_t base_mhz) {
+  p->driver = get_cpu_sysfs_str(cpu, _PATH_FREQUENCY, _PATH_FREQUENCY_DRIVER);
+  p->governor = get_str_governor(cpu);
+  p->epp = get_str_epp(cpu);
+  p->hw_max = get_cpu_sysfs_value(cpu, _PATH_FREQUENCY, _PATH_FREQUENCY_MAX);
+  p->scaling_min = get_cpu_sysfs_value(cpu, _PATH_FREQUENCY, _PATH_SCALING_MIN);
+  p->scaling_max = get_cpu_sysfs_value(cpu, _PATH_FREQUENCY, _PATH_SCALING_MAX);
+  p->boost = get_cpu_sysfs_value(cpu, _PATH_FREQUENCY, _PATH_POLICY_BOOST);
+
+  // intel_pstate reports the base frequency; otherwise use the CPPC
+  // nominal frequency (in MHz) or the one we got from the CPU
+  p->base = get_cpu_sysfs_value(cpu, _PATH_FREQUENCY, _PATH_FREQUENCY_BASE);
+  if(p->base <= 0) {
+    long nominal = get_cpu_sysfs_value(cpu, "", _PATH_CPPC_NOMINAL_FREQ);
+    p->base = nominal > 0 ? nominal * 1000 : (base_mhz > 0 ? (long) base_mhz * 1000 : -1);
+  }
+
+  p->achievable = get_achievable_freq(sw, p);
+}
+
+bool str_equal(const char* a, const char* b) {
+  if(a == NULL || b == NULL) return a == b;
+  return strcmp(a, b) == 0;
+}
+
+bool same_policy(struct freq_policy* a, struct freq_policy* b) {
+  return str_equal(a->driver, b->driver) && str_equal(a->governor, b->governor) && str_equal(a->epp, b->epp) &&
+         a->hw_max == b->hw_max && a->scaling_min == b->scaling_min && a->scaling_max == b->scaling_max &&
+         a->base == b->base && a->boost == b->boost;
+}
+
+void free_freq_policy(struct freq_policy* p) {
+  free(p->driver);
+  free(p->governor);
+  free(p->epp);
+}
+
+void print_freq_mhz(long khz, int width) {
+  if(khz <= 0) printf(" %*s", width, "-");
+  else printf(" %*ld", width, khz / 1000);
+}
+
+void print_switch(const char* name, long value, const char* on, const char* off) {
+  if(value >= 0) printf("  %-26s %s\n", name, value != 0 ? on : off);
+}
+
+// The frequency used by the peak performance model: the AVX one in
+// x86 if it is known. With several modules (hybrid CPUs) each one has
+// its own, so we return -1 and scale the peak by the max frequency.
+int64_t get_peak_freq(struct cpuInfo* cpu) {
+  if(get_num_modules(cpu) > 1) return -1;
+#ifdef ARCH_X86
+  if(get_freq_pp(cpu->freq) > 0) return get_freq_pp(cpu->freq);
+#endif
+  return get_freq(cpu->freq);
+}
+
+// Reports the cpufreq policy of every CPU (driver, governor, EPP,
+// scaling limits and boost), grouping the CPUs that share it, and flags
+// the ones that cannot reach their max frequency: capped, in powersave,
+// with an EPP that favors power, or with turbo disabled. The peak
+// performance is then scaled to the frequency achievable under the
+// current policy.
+bool print_freq_policy(struct cpuInfo* cpu) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+  int ncpus = map->num_cpus;
+
+  struct freq_switches sw;
+  sw.boost = read_switch(_PATH_CPUFREQ_BOOST);
+  sw.no_turbo = read_switch(_PATH_INTEL_NO_TURBO);
+  sw.max_perf_pct = read_switch(_PATH_INTEL_MAX_PERF_PCT);
+  sw.intel_status = get_str_from_file(_PATH_INTEL_STATUS);
+  sw.amd_status = get_str_from_file(_PATH_AMD_PSTATE_STATUS);
+
+  int32_t base_mhz = cpu->freq != NULL ? cpu->freq->base : -1;
+  struct freq_policy* policies = emalloc(sizeof(struct freq_policy) * ncpus);
+  int* group = emalloc(sizeof(int) * ncpus);
+  int ngroups = 0;
+  bool any_cpufreq = false;
+
+  for(int i=0; i < ncpus; i++) {
+    group[i] = -1;
+    if(!map->cpus[i].online) continue;
+    get_freq_policy(&policies[i], &sw, i, base_mhz);
+    if(policies[i].hw_max > 0 || policies[i].driver != NULL) any_cpufreq = true;
+
+    for(int j=0; j < i && group[i] == -1; j++) {
+      if(group[j] != -1 && same_policy(&policies[i], &policies[j])) group[i] = group[j];
+    }
+    if(group[i] == -1) group[i] = ngroups++;
+  }
+
+  printf("Global switches:\n");
+  print_switch("cpufreq boost", sw.boost, "enabled", "disabled");
+  print_switch("intel_pstate no_turbo", sw.no_turbo, "1 (turbo disabled)", "0");
+  if(sw.intel_status != NULL) printf("  %-26s %s\n", "intel_pstate status", sw.intel_status);
+  if(sw.max_perf_pct >= 0) printf("  %-26s %ld%%\n", "intel_pstate max_perf_pct", sw.max_perf_pct);
+  if(sw.amd_status != NULL) printf("  %-26s %s\n", "amd_pstate status", sw.amd_status);
+  if(sw.boost < 0 && sw.no_turbo < 0 && sw.intel_status == NULL && sw.amd_status == NULL) printf("  none\n");
+  printf("\n");
+
+  bool* flagged = ecalloc((size_t) FREQ_NUM_FLAGS * ncpus, sizeof(bool));
+  long ach_sum = 0;
+  long max_sum = 0;
+  int64_t peak_freq = get_peak_freq(cpu);
+
+  if(!any_cpufreq) {
+    printf("cpufreq is not available: the frequency is not managed by the kernel\n");
+  }
+  else {
+    printf("  %-12s %-16s %-12s %-22s %6s %6s %6s %6s %6s  %s\n", "CPUs", "Driver", "Governor", "EPP",
+           "Min", "Max", "HWMax", "Base", "Achiev", "Flags");
+
+    bool* cpus = emalloc(sizeof(bool) * ncpus);
+    for(int g=0; g < ngroups; g++) {
+      struct freq_policy* p = NULL;
+      for(int i=0; i < ncpus; i++) {
+        cpus[i] = group[i] == g;
+        if(cpus[i] && p == NULL) p = &policies[i];
+      }
+
+      bool flags[FREQ_NUM_FLAGS];
+      get_flags(&sw, p, flags);
+      char* list = get_str_cpu_list(cpus, ncpus);
+      printf("  %-12s %-16s %-12s %-22s", list, p->driver == NULL ? "-" : p->driver,
+             p->governor == NULL ? "-" : p->governor, p->epp == NULL ? "-" : p->epp);
+      print_freq_mhz(p->scaling_min, 6);
+      print_freq_mhz(p->scaling_max, 6);
+      print_freq_mhz(p->hw_max, 6);
+      print_freq_mhz(p->base, 6);
+      print_freq_mhz(p->achievable, 6);
+
+      bool first = true;
+      for(int f=0; f < FREQ_NUM_FLAGS; f++) {
+        if(!flags[f]) continue;
+        printf("%s%s", first ? "  " : ",", freq_flag_str[f]);
+        first = false;
+        for(int i=0; i < ncpus; i++) if(cpus[i]) flagged[f * ncpus + i] = true;
+      }
+      if(first) printf("  -");
+      printf("\n");
+      free(list);
+    }
+    free(cpus);
+
+    bool any_flag = false;
+    printf("\n");
+    for(int f=0; f < FREQ_NUM_FLAGS; f++) {
+      char* list = get_str_cpu_list(flagged + f * ncpus, ncpus);
+      if(list[0] != '\0') {
+        printf("%-9s %s: %s\n", freq_flag_str[f], freq_flag_desc[f], list);
+        any_flag = true;
+      }
+      free(list);
+    }
+    if(!any_flag) printf("No CPU is capped, in powersave, or running without turbo\n");
+
+    // Average the achievable frequency among the CPUs, limited by the
+    // frequency of the peak performance model (e.g., the AVX one)
+    for(int i=0; i < ncpus; i++) {
+      if(group[i] == -1 || policies[i].hw_max <= 0 || policies[i].achievable <= 0) continue;
+      long hw = policies[i].hw_max;
+      long ach = policies[i].achievable;
+      if(peak_freq > 0) {
+        hw = min(hw, peak_freq * 1000);
+        ach = min(ach, peak_freq * 1000);
+      }
+      max_sum += hw;
+      ach_sum += ach;
+    }
+  }
+
+  char* pp = get_str_peak_performance(cpu->peak_performance);
+  printf("\nPeak performance: %s", pp);
+  if(peak_freq > 0) printf(" (at %ld MHz)", (long) peak_freq);
+  printf("\n");
+  if(cpu->peak_performance > 0 && max_sum > 0) {
+    double ratio = (double) ach_sum / max_sum;
+    char* pp_ach = get_str_peak_performance((int64_t) (cpu->peak_performance * ratio));
+    printf("Achievable under the current policy: %s (%.0f%% of the peak", pp_ach, ratio * 100);
+    if(peak_freq > 0) printf(", avg %ld MHz", (long) (peak_freq * ratio));
+    printf(")\n");
+    free(pp_ach);
+  }
+  free(pp);
+
+  for(int i=0; i < ncpus; i++) if(group[i] != -1) free_freq_policy(&policies[i]);
+  free(policies);
+  free(group);
+  free(flagged);
+  free(sw.intel_status);
+  free(sw.amd_status);
+  free_cpu_map(map);
+  return true;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __FREQPOLICY__
+#define __FREQPOLICY__
+
+#include "cpu.h"
+
+bool print_freq_policy(struct cpuInfo* cpu);
+
+#endif
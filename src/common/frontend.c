@@ -0,0 +1,316 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "global.h"
+#include "bench.h"
+#include "insnbench.h"
+#include "frontend.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+#endif
+
+#if defined(__x86_64__) || defined(__aarch64__)
+
+// Code footprints from FRONTEND_MIN_SIZE to FRONTEND_MAX_SIZE, with
+// FRONTEND_STEPS sizes per power of two to locate the knees
+#define FRONTEND_MIN_SIZE      1024UL
+#define FRONTEND_MAX_SIZE      (8UL * 1024 * 1024)
+#define FRONTEND_STEPS         4
+// Instructions executed in each sample
+#define FRONTEND_INSNS         (16ULL * 1000 * 1000)
+#define FRONTEND_REPS          3
+// A knee starts when the IPC falls (and stays) below FRONTEND_KNEE
+// times the best IPC seen since the previous knee, and spans the
+// following sizes while each one keeps dropping below FRONTEND_SLOPE
+// times the previous one
+#define FRONTEND_KNEE          0.85
+#define FRONTEND_SLOPE         0.95
+// Both kinds of blocks are made of 16 byte groups
+#define FRONTEND_GROUP_BYTES   16
+
+enum {
+  BLOCK_STRAIGHT,
+  BLOCK_BRANCHY,
+  BLOCK_COUNT
+};
+
+static const char* block_str[BLOCK_COUNT] = {
+  [BLOCK_STRAIGHT] = "straight-line",
+  [BLOCK_BRANCHY]  = "branchy",
+};
+
+typedef void (*jit_fn)(uint64_t iters);
+
+struct jit_code {
+  uint8_t* buf;
+  size_t len;
+  uint64_t insns;      // Instructions of the body (excluding the loop)
+  uint64_t branches;   // Taken branches of the body
+};
+
+/*
+ * The generated function runs the body iters times. The body is made
+ * of independent adds over 8 registers (so that the backend is never
+ * the bottleneck) and, in the branchy blocks, an unconditional jump to
+ * the next group every FRONTEND_GROUP_BYTES bytes, which needs one
+ * BTB entry per group.
+ *
+ * x86_64: each group is two 7 byte "add r64, imm32" and a 2 byte jmp
+ * (branchy) or two adds and a 2 byte nop (straight-line), so that both
+ * kinds have the same decode width per byte.
+ * AArch64: each group is four adds, or three adds and a "b" to the
+ * next instruction.
+ */
+#ifdef __x86_64__
+// add rax/rcx/rdx/rsi/r8/r9/r10/r11, imm32 (all of them caller-saved)
+static const uint8_t x86_add_rex[8]   = { 0x48, 0x48, 0x48, 0x48, 0x49, 0x49, 0x49, 0x49 };
+static const uint8_t x86_add_modrm[8] = { 0xC0, 0xC1, 0xC2, 0xC6, 0xC0, 0xC1, 0xC2, 0xC3 };
+
+uint8_t* emit_x86_add(uint8_t* p, int reg) {
+  *p++ = x86_add_rex[reg];
+  *p++ = 0x81;
+  *p++ = x86_add_modrm[reg];
+  uint32_t imm = 1;
+  memcpy(p, &imm, sizeof(imm));
+  return p + sizeof(imm);
+}
+
+void emit_body(struct jit_code* jc, size_t size, int kind) {
+  uint8_t* p = jc->buf;
+  int reg = 0;
+
+  for(size_t g=0; g < size / FRONTEND_GROUP_BYTES; g++) {
+    p = emit_x86_add(p, reg); reg = (reg + 1) % 8;
+    p = emit_x86_add(p, reg); reg = (reg + 1) % 8;
+    if(kind == BLOCK_BRANCHY) {
+      *p++ = 0xEB; *p++ = 0x00;    // jmp to the next instruction
+      jc->branches++;
+    }
+    else {
+      *p++ = 0x66; *p++ = 0x90;    // 2 byte nop
+    }
+    jc->insns += 3;
+  }
+
+  // dec rdi; jnz body; ret
+  *p++ = 0x48; *p++ = 0xFF; *p++ = 0xCF;
+  *p++ = 0x0F; *p++ = 0x85;
+  int32_t rel = (int32_t) (jc->buf - (p + 4));
+  memcpy(p, &rel, sizeof(rel));
+  p += sizeof(rel);
+  *p++ = 0xC3;
+
+  jc->len = p - jc->buf;
+}
+#else
+void emit_a64(uint8_t** p, uint32_t insn) {
+  memcpy(*p, &insn, sizeof(insn));
+  *p += sizeof(insn);
+}
+
+void emit_body(struct jit_code* jc, size_t size, int kind) {
+  uint8_t* p = jc->buf;
+  int reg = 0;
+
+  for(size_t g=0; g < size / FRONTEND_GROUP_BYTES; g++) {
+    for(int i=0; i < 4; i++) {
+      if(i == 3 && kind == BLOCK_BRANCHY) {
+        emit_a64(&p, 0x14000001);                                 // b to the next instruction
+        jc->branches++;
+      }
+      else {
+        uint32_t x = 9 + reg;                                     // x9-x16
+        emit_a64(&p, 0x91000400 | (x << 5) | x);                  // add x, x, #1
+        reg = (reg + 1) % 8;
+      }
+      jc->insns++;
+    }
+  }
+
+  // subs x0, x0, #1; b.eq ret; b body; ret
+  emit_a64(&p, 0xF1000400);
+  emit_a64(&p, 0x54000040);
+  int32_t rel = (int32_t) ((jc->buf - p) / 4);
+  emit_a64(&p, 0x14000000 | ((uint32_t) rel & 0x3FFFFFF));
+  emit_a64(&p, 0xD65F03C0);
+
+  jc->len = p - jc->buf;
+}
+#endif
+
+// Generates the code in a writable mapping and then makes it executable
+bool jit_compile(struct jit_code* jc, size_t size, int kind) {
+  jc->insns = 0;
+  jc->branches = 0;
+
+  if(mprotect(jc->buf, FRONTEND_MAX_SIZE + 4096, PROT_READ | PROT_WRITE) == -1) {
+    printErr("mprotect: %s", strerror(errno));
+    return false;
+  }
+  emit_body(jc, size, kind);
+  if(mprotect(jc->buf, FRONTEND_MAX_SIZE + 4096, PROT_READ | PROT_EXEC) == -1) {
+    printErr("mprotect: %s", strerror(errno));
+    return false;
+  }
+  __builtin___clear_cache((char *) jc->buf, (char *) jc->buf + jc->len);
+  return true;
+}
+
+// Returns the best IPC out of FRONTEND_REPS samples, or -1 on error
+double measure_jit_ipc(struct cycle_clock* clk, struct jit_code* jc) {
+  jit_fn fn;
+  uint8_t* code = jc->buf;
+  memcpy(&fn, &code, sizeof(fn));
+
+  uint64_t iters = FRONTEND_INSNS / jc->insns;
+  if(iters == 0) iters = 1;
+  fn(iters / 8 + 1);
+
+  double best = -1.0;
+  for(int r=0; r < FRONTEND_REPS; r++) {
+    double cycles = get_clock_cycles(clk, fn, iters);
+    if(cycles < 0.0) return -1.0;
+    double ipc = (double) jc->insns * iters / cycles;
+    if(ipc > best) best = ipc;
+  }
+  return best;
+}
+
+void get_str_code_size(char* str, size_t len, size_t bytes) {
+  if(bytes >= (1UL << 20))
+    snprintf(str, len, "%.1f MiB", (double) bytes / (1UL << 20));
+  else
+    snprintf(str, len, "%.1f KiB", (double) bytes / (1UL << 10));
+}
+
+void print_frontend_knees(size_t* sizes, double ipc[][BLOCK_COUNT], int nsizes, int kind) {
+  char from[32];
+  char to[32];
+  double ref = ipc[0][kind];
+  bool found = false;
+
+  printf("  %s knees:", block_str[kind]);
+  for(int s=1; s < nsizes; s++) {
+    bool drop = ipc[s][kind] < ref * FRONTEND_KNEE &&
+                (s+1 == nsizes || ipc[s+1][kind] < ref * FRONTEND_KNEE);
+    if(!drop) {
+      if(ipc[s][kind] > ref) ref = ipc[s][kind];
+      continue;
+    }
+
+    int e = s;
+    while(e+1 < nsizes && ipc[e+1][kind] < ipc[e][kind] * FRONTEND_SLOPE) e++;
+    get_str_code_size(from, sizeof(from), sizes[s-1]);
+    get_str_code_size(to, sizeof(to), sizes[e]);
+    printf("\n    %s - %s: %.2f -> %.2f IPC", from, to, ref, ipc[e][kind]);
+    ref = ipc[e][kind];
+    found = true;
+    s = e;
+  }
+  printf("%s\n", found ? "" : " none");
+}
+
+bool print_frontend_module(struct cpuInfo* cpu, int module, struct jit_code* jc) {
+  struct cpuInfo* ptr = get_module(cpu, module);
+  int32_t first_cpu = get_module_first_cpu(cpu, module);
+  int nsizes = 0;
+  size_t sizes[128];
+  double ipc[128][BLOCK_COUNT];
+  struct cycle_clock clk;
+  char size_str[32];
+
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    return false;
+  }
+
+  printf("\n%s (CPU %d):\n", get_str_uarch(ptr), first_cpu);
+  if(ptr->cach != NULL && ptr->cach->L1i != NULL && ptr->cach->L1i->exists) {
+    get_str_code_size(size_str, sizeof(size_str), ptr->cach->L1i->size);
+    printf("  L1i: %s\n", size_str);
+  }
+  init_cycle_clock(&clk, first_cpu);
+
+  printf("  %-10s %14s %14s %10s   (IPC)\n", "Footprint", block_str[BLOCK_STRAIGHT], block_str[BLOCK_BRANCHY], "Branches");
+
+  bool ret = true;
+  for(size_t base=FRONTEND_MIN_SIZE; base < FRONTEND_MAX_SIZE && ret; base *= 2) {
+    for(int st=0; st < FRONTEND_STEPS && ret; st++) {
+      // Sizes between base and 2*base, rounded to the group size
+      size_t size = base + base * st / FRONTEND_STEPS;
+      size -= size % FRONTEND_GROUP_BYTES;
+      sizes[nsizes] = size;
+
+      get_str_code_size(size_str, sizeof(size_str), size);
+      printf("  %-10s", size_str);
+      for(int k=0; k < BLOCK_COUNT && ret; k++) {
+        if(clk.fd == -1) calibrate_cycle_clock(&clk);
+        if(!jit_compile(jc, size, k)) {
+          ret = false;
+          break;
+        }
+        ipc[nsizes][k] = measure_jit_ipc(&clk, jc);
+        if(ipc[nsizes][k] < 0.0) ret = false;
+        else printf(" %14.2f", ipc[nsizes][k]);
+      }
+      printf(" %10lu\n", (unsigned long) jc->branches);
+      fflush(stdout);
+      nsizes++;
+    }
+  }
+
+  if(ret) {
+    printf("\n");
+    for(int k=0; k < BLOCK_COUNT; k++) print_frontend_knees(sizes, ipc, nsizes, k);
+  }
+
+  close_cycle_clock(&clk);
+  return ret;
+}
+
+// Generates straight-line and branchy code blocks with footprints
+// from FRONTEND_MIN_SIZE to FRONTEND_MAX_SIZE, runs them in a loop and
+// reports the IPC for each size, so that the capacity of the L1i, the
+// uop/MOP cache and the BTB show up as knees, for each module (core
+// type) of the CPU.
+bool print_frontend_benchmark(struct cpuInfo* cpu) {
+  struct jit_code jc;
+  jc.buf = mmap(NULL, FRONTEND_MAX_SIZE + 4096, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(jc.buf == MAP_FAILED) {
+    printErr("mmap: %s", strerror(errno));
+    return false;
+  }
+
+  printf("cpufetch is measuring IPC versus code footprint (%lu KiB to %lu MiB)...\n",
+         FRONTEND_MIN_SIZE >> 10, FRONTEND_MAX_SIZE >> 20);
+
+  bool ret = true;
+  for(int m=0; m < get_num_modules(cpu) && ret; m++) {
+    ret = print_frontend_module(cpu, m, &jc);
+  }
+
+  munmap(jc.buf, FRONTEND_MAX_SIZE + 4096);
+  return ret;
+}
+
+#else
+
+bool print_frontend_benchmark(struct cpuInfo* cpu) {
+  UNUSED(cpu);
+  printErr("The frontend benchmark is only supported in x86_64 and AArch64");
+  return false;
+}
+
+#endif // #if defined(__x86_64__) || defined(__aarch64__)
+
+#endif // #ifdef __linux__
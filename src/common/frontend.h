@@ -0,0 +1,8 @@
+#ifndef __FRONTEND__
+#define __FRONTEND__
+
+#include "cpu.h"
+
+bool print_frontend_benchmark(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,355 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "bench.h"
+#include "udev.h"
+#include "gatherbench.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+  #include "../x86/gather/gather.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+  #include "../arm/gather/gather.h"
+#endif
+
+// Elements touched in each call. The tables (16 KiB and 32 KiB) and
+// the index arrays stay in L1/L2, so that the instructions themselves
+// are measured and not the memory subsystem
+#define GATHER_ELEMS        4096
+#define GATHER_TIME_NS      (100 * 1000 * 1000)
+#define GATHER_REPS         3
+#define GATHER_MAX_IMPLS    3
+// A vector path must be this much faster than scalar to be recommended
+#define GATHER_MIN_SPEEDUP  1.2
+
+enum gather_op {
+  OP_GATHER,
+  OP_SCATTER,
+  OP_MASKED,
+  OP_COUNT
+};
+
+static const char* gather_op_str[OP_COUNT] = {
+  [OP_GATHER]  = "gather",
+  [OP_SCATTER] = "scatter",
+  [OP_MASKED]  = "masked ld/st",
+};
+
+typedef uint32_t (*gather32_fn)(const int32_t* table, const int32_t* idx, size_t n);
+typedef uint64_t (*gather64_fn)(const int64_t* table, const int64_t* idx, size_t n);
+typedef void (*scatter32_fn)(int32_t* table, const int32_t* idx, const int32_t* val, size_t n);
+typedef void (*scatter64_fn)(int64_t* table, const int64_t* idx, const int64_t* val, size_t n);
+typedef void (*masked32_fn)(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n);
+typedef void (*masked64_fn)(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n);
+
+// Kernels of one ISA. A NULL kernel means the ISA has no instruction
+// for that operation (e.g., there is no scatter in AVX2)
+struct gather_impl {
+  const char* name;
+  gather32_fn gather32;
+  gather64_fn gather64;
+  scatter32_fn scatter32;
+  scatter64_fn scatter64;
+  masked32_fn masked32;
+  masked64_fn masked64;
+};
+
+struct gather_data {
+  int32_t* table32;
+  int32_t* idx32;
+  int32_t* val32;
+  int32_t* mask32;
+  int32_t* out32;
+  int64_t* table64;
+  int64_t* idx64;
+  int64_t* val64;
+  int64_t* mask64;
+  int64_t* out64;
+};
+
+uint32_t gather32_scalar(const int32_t* table, const int32_t* idx, size_t n) {
+  uint32_t sum = 0;
+  for(size_t i=0; i < n; i++) sum += (uint32_t) table[idx[i]];
+  return sum;
+}
+
+uint64_t gather64_scalar(const int64_t* table, const int64_t* idx, size_t n) {
+  uint64_t sum = 0;
+  for(size_t i=0; i < n; i++) sum += (uint64_t) table[idx[i]];
+  return sum;
+}
+
+void scatter32_scalar(int32_t* table, const int32_t* idx, const int32_t* val, size_t n) {
+  for(size_t i=0; i < n; i++) table[idx[i]] = val[i];
+}
+
+void scatter64_scalar(int64_t* table, const int64_t* idx, const int64_t* val, size_t n) {
+  for(size_t i=0; i < n; i++) table[idx[i]] = val[i];
+}
+
+void masked32_scalar(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n) {
+  for(size_t i=0; i < n; i++) {
+    if(mask[i]) dst[i] = src[i];
+  }
+}
+
+void masked64_scalar(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n) {
+  for(size_t i=0; i < n; i++) {
+    if(mask[i]) dst[i] = src[i];
+  }
+}
+
+// Fills the implementations supported by the CPU (scalar is always the first one)
+int get_gather_impls(struct cpuInfo* cpu, struct gather_impl* im) {
+  int n = 0;
+  im[n++] = (struct gather_impl) { "scalar", gather32_scalar, gather64_scalar, scatter32_scalar,
+                                   scatter64_scalar, masked32_scalar, masked64_scalar };
+
+#ifdef ARCH_X86
+  if(cpu->feat->AVX2)
+    im[n++] = (struct gather_impl) { "AVX2", gather32_avx2, gather64_avx2, NULL, NULL, masked32_avx2, masked64_avx2 };
+  if(cpu->feat->AVX512)
+    im[n++] = (struct gather_impl) { "AVX-512", gather32_avx512, gather64_avx512, scatter32_avx512,
+                                     scatter64_avx512, masked32_avx512, masked64_avx512 };
+#elif ARCH_ARM
+  if(cpu->feat->SVE) {
+    if(gather_sve_compiled())
+      im[n++] = (struct gather_impl) { "SVE", gather32_sve, gather64_sve, scatter32_sve,
+                                       scatter64_sve, masked32_sve, masked64_sve };
+    else
+      printWarn("CPU supports SVE, but it was not enabled by the compiler");
+  }
+#else
+  UNUSED(cpu);
+#endif
+
+  return n;
+}
+
+bool has_gather_kernel(struct gather_impl* im, enum gather_op op, int width) {
+  switch(op) {
+    case OP_GATHER:  return width == 32 ? im->gather32 != NULL : im->gather64 != NULL;
+    case OP_SCATTER: return width == 32 ? im->scatter32 != NULL : im->scatter64 != NULL;
+    case OP_MASKED:  return width == 32 ? im->masked32 != NULL : im->masked64 != NULL;
+    default: return false;
+  }
+}
+
+// Runs the kernel once over GATHER_ELEMS elements. Gathers return their
+// sum, the rest write to out32/out64
+uint64_t run_gather_kernel(struct gather_impl* im, enum gather_op op, int width, struct gather_data* d) {
+  switch(op) {
+    case OP_GATHER:
+      if(width == 32) return im->gather32(d->table32, d->idx32, GATHER_ELEMS);
+      return im->gather64(d->table64, d->idx64, GATHER_ELEMS);
+    case OP_SCATTER:
+      if(width == 32) im->scatter32(d->out32, d->idx32, d->val32, GATHER_ELEMS);
+      else im->scatter64(d->out64, d->idx64, d->val64, GATHER_ELEMS);
+      return 0;
+    case OP_MASKED:
+      if(width == 32) im->masked32(d->out32, d->val32, d->mask32, GATHER_ELEMS);
+      else im->masked64(d->out64, d->val64, d->mask64, GATHER_ELEMS);
+      return 0;
+    default:
+      return 0;
+  }
+}
+
+// Runs the kernel on a cleared output and returns a checksum of the result
+uint64_t get_gather_result(struct gather_impl* im, enum gather_op op, int width, struct gather_data* d) {
+  memset(d->out32, 0, GATHER_ELEMS * sizeof(int32_t));
+  memset(d->out64, 0, GATHER_ELEMS * sizeof(int64_t));
+
+  uint64_t sum = run_gather_kernel(im, op, width, d);
+  if(op == OP_GATHER) return sum;
+
+  for(int i=0; i < GATHER_ELEMS; i++) {
+    uint64_t v = width == 32 ? (uint64_t) (uint32_t) d->out32[i] : (uint64_t) d->out64[i];
+    sum = sum * 31 + v;
+  }
+  return sum;
+}
+
+// Returns the best throughput (in elements/s) out of GATHER_REPS samples
+double measure_gather_kernel(struct gather_impl* im, enum gather_op op, int width, struct gather_data* d) {
+  volatile uint64_t sink = 0;
+  double best = 0.0;
+
+  for(int r=0; r < GATHER_REPS; r++) {
+    uint64_t calls = 0;
+    uint64_t t0 = get_time_ns();
+    uint64_t t1;
+    do {
+      for(int i=0; i < 64; i++) {
+        sink += run_gather_kernel(im, op, width, d);
+        __asm volatile("" ::: "memory");
+      }
+      calls += 64;
+      t1 = get_time_ns();
+    } while(t1 - t0 < GATHER_TIME_NS / GATHER_REPS);
+
+    double eps = (double) calls * GATHER_ELEMS / ((double) (t1 - t0) / 1e9);
+    if(eps > best) best = eps;
+  }
+
+  UNUSED(sink);
+  return best;
+}
+
+void print_gather_recommendation(struct gather_impl* im, int nim, double tp[OP_COUNT][2][GATHER_MAX_IMPLS]) {
+  printf("\n  Recommendation:\n");
+
+  for(int op=0; op < OP_COUNT; op++) {
+    for(int w=0; w < 2; w++) {
+      int best = -1;
+      for(int k=1; k < nim; k++) {
+        if(tp[op][w][k] > 0.0 && (best == -1 || tp[op][w][k] > tp[op][w][best])) best = k;
+      }
+
+      printf("    %-12s %d-bit: ", gather_op_str[op], w == 0 ? 32 : 64);
+      if(best == -1) {
+        printf("scalar (no vector instruction available)\n");
+      }
+      else {
+        double speedup = tp[op][w][best] / tp[op][w][0];
+        if(speedup >= GATHER_MIN_SPEEDUP)
+          printf("%s (%.1fx faster than scalar)\n", im[best].name, speedup);
+        else
+          printf("scalar (%s runs at %.2fx scalar)\n", im[best].name, speedup);
+      }
+    }
+  }
+}
+
+bool print_gather_module(struct cpuInfo* cpu, int module, struct gather_data* d) {
+  struct cpuInfo* ptr = get_module(cpu, module);
+  int32_t first_cpu = get_module_first_cpu(cpu, module);
+  struct gather_impl im[GATHER_MAX_IMPLS];
+  double tp[OP_COUNT][2][GATHER_MAX_IMPLS];
+
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    return false;
+  }
+
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  printf("\n%s (CPU %d):\n", get_str_uarch(ptr), first_cpu);
+#else
+  printf("\nCPU %d:\n", first_cpu);
+#endif
+
+  int nim = get_gather_impls(ptr, im);
+  printf("  %-12s %-6s", "Operation", "Width");
+  for(int k=0; k < nim; k++) printf(" %10s", im[k].name);
+  printf("   (Gelem/s)\n");
+
+  for(int op=0; op < OP_COUNT; op++) {
+    for(int w=0; w < 2; w++) {
+      int width = w == 0 ? 32 : 64;
+      uint64_t expected = get_gather_result(&im[0], op, width, d);
+
+      printf("  %-12s %d-bit ", gather_op_str[op], width);
+      for(int k=0; k < nim; k++) {
+        tp[op][w][k] = 0.0;
+        if(!has_gather_kernel(&im[k], op, width)) {
+          printf(" %10s", "-");
+          continue;
+        }
+        if(get_gather_result(&im[k], op, width, d) != expected) {
+          printf("\n");
+          printBug("%s %d-bit %s produced a wrong result", im[k].name, width, gather_op_str[op]);
+          return false;
+        }
+        tp[op][w][k] = measure_gather_kernel(&im[k], op, width, d);
+        printf(" %10.2f", tp[op][w][k] / 1e9);
+        fflush(stdout);
+      }
+      printf("\n");
+    }
+  }
+
+  print_gather_recommendation(im, nim, tp);
+  return true;
+}
+
+// Random permutation of [0, n), so that every index is used once and
+// scatters never write the same element twice in the same call
+void fill_gather_indices(int32_t* idx32, int64_t* idx64, uint64_t* seed) {
+  for(int i=0; i < GATHER_ELEMS; i++) idx32[i] = i;
+  for(int i=GATHER_ELEMS-1; i > 0; i--) {
+    *seed ^= *seed << 13; *seed ^= *seed >> 7; *seed ^= *seed << 17;
+    int j = (int) (*seed % (uint64_t) (i+1));
+    int32_t tmp = idx32[i];
+    idx32[i] = idx32[j];
+    idx32[j] = tmp;
+  }
+  for(int i=0; i < GATHER_ELEMS; i++) idx64[i] = idx32[i];
+}
+
+// Measures gather, scatter and masked load/store throughput at 32 and
+// 64-bit element widths with each vector ISA supported by the CPU and
+// compares them with the scalar loops, for each module (core type) of
+// the CPU, to tell whether gather-based code paths are worth it.
+bool print_gather_benchmark(struct cpuInfo* cpu) {
+  struct gather_data d;
+  d.table32 = emalloc(GATHER_ELEMS * sizeof(int32_t));
+  d.idx32 = emalloc(GATHER_ELEMS * sizeof(int32_t));
+  d.val32 = emalloc(GATHER_ELEMS * sizeof(int32_t));
+  d.mask32 = emalloc(GATHER_ELEMS * sizeof(int32_t));
+  d.out32 = emalloc(GATHER_ELEMS * sizeof(int32_t));
+  d.table64 = emalloc(GATHER_ELEMS * sizeof(int64_t));
+  d.idx64 = emalloc(GATHER_ELEMS * sizeof(int64_t));
+  d.val64 = emalloc(GATHER_ELEMS * sizeof(int64_t));
+  d.mask64 = emalloc(GATHER_ELEMS * sizeof(int64_t));
+  d.out64 = emalloc(GATHER_ELEMS * sizeof(int64_t));
+
+  // Random contents and a random mask with half of the lanes enabled,
+  // which also makes the branch of the scalar masked loop unpredictable
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+  fill_gather_indices(d.idx32, d.idx64, &seed);
+  for(int i=0; i < GATHER_ELEMS; i++) {
+    seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+    d.table32[i] = (int32_t) seed;
+    d.table64[i] = (int64_t) seed;
+    d.val32[i] = (int32_t) (seed >> 32);
+    d.val64[i] = (int64_t) (seed * 0x9E3779B97F4A7C15ULL);
+    d.mask32[i] = (seed >> 17) & 1 ? -1 : 0;
+    d.mask64[i] = d.mask32[i];
+  }
+
+  printf("cpufetch is measuring gather/scatter and masked load/store throughput...\n");
+#ifdef ARCH_X86
+  // The Downfall microcode mitigation makes gathers much slower
+  char* gds = get_str_vulnerability("gather_data_sampling");
+  if(gds != NULL) {
+    printf("Gather Data Sampling: %s\n", gds);
+    free(gds);
+  }
+#endif
+
+  bool ret = true;
+  for(int m=0; m < get_num_modules(cpu) && ret; m++) {
+    ret = print_gather_module(cpu, m, &d);
+  }
+
+  free(d.table32);
+  free(d.idx32);
+  free(d.val32);
+  free(d.mask32);
+  free(d.out32);
+  free(d.table64);
+  free(d.idx64);
+  free(d.val64);
+  free(d.mask64);
+  free(d.out64);
+  return ret;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __GATHERBENCH__
+#define __GATHERBENCH__
+
+#include "cpu.h"
+
+bool print_gather_benchmark(struct cpuInfo* cpu);
+
+#endif
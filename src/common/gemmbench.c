@@ -0,0 +1,615 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <pthread.h>
+
+#include "global.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "gemmbench.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+  #include "../x86/gemm/gemm.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+  #include "../arm/gemm/gemm.h"
+#endif
+
+#if defined(ARCH_X86) || (defined(ARCH_ARM) && defined(__aarch64__))
+
+// C += A * B with square matrices of GEMM_N (rounded up so that every
+// thread gets the same block), large enough not to fit in the caches
+#define GEMM_N            2048
+#define GEMM_TIME_NS      (500ULL * 1000 * 1000)
+#define GEMM_ALIGN        64
+#define GEMM_KC_MIN       32
+#define GEMM_KC_MAX       1024
+#define GEMM_NC_MAX       4096
+// Used when the cache size is unknown
+#define GEMM_L1D_DEFAULT  (32 * 1024)
+#define GEMM_L2_DEFAULT   (256 * 1024)
+
+enum {
+  GEMM_SINGLE,
+  GEMM_DOUBLE,
+  GEMM_NUM_TYPES
+};
+
+enum {
+  GEMM_REQ_AVX2_FMA,
+  GEMM_REQ_AVX512,
+  GEMM_REQ_NEON,
+  GEMM_REQ_SVE
+};
+
+static const char* gemm_type_str[GEMM_NUM_TYPES] = {
+  [GEMM_SINGLE] = "SGEMM",
+  [GEMM_DOUBLE] = "DGEMM"
+};
+
+typedef void (*sgemm_fn)(int kc, const float* a, const float* b, float* c, size_t ldc);
+typedef void (*dgemm_fn)(int kc, const double* a, const double* b, double* c, size_t ldc);
+
+// The microkernels of one ISA. vector_bytes is 0 in SVE, where the
+// vector length is only known at runtime
+struct gemm_kernel {
+  const char* name;
+  int requires;
+  int mr;
+  int vector_bytes;
+  sgemm_fn sgemm;
+  dgemm_fn dgemm;
+};
+
+struct gemm_blocking {
+  int kc;
+  int mc;
+  int nc;
+};
+
+// A block of the problem: C[m][n] += A[m][k] * B[k][n], row major
+struct gemm_work {
+  const struct gemm_kernel* kernel;
+  int type;
+  int nr;
+  struct gemm_blocking bl;
+  const void* a;
+  const void* b;
+  void* c;
+  int m;
+  int n;
+  int k;
+  size_t lda;
+  size_t ldb;
+  size_t ldc;
+  // Packed blocks of A and B and the scratch tile for the edges of C
+  void* pa;
+  void* pb;
+  void* tile;
+};
+
+struct gemm_worker {
+  struct gemm_work work;
+  volatile bool* start;
+  volatile bool* stop;
+  uint64_t reps;
+  uint64_t ns;
+  char pad[64];
+};
+
+#ifdef ARCH_X86
+static const struct gemm_kernel gemm_kernels[] = {
+  { "AVX2+FMA", GEMM_REQ_AVX2_FMA, GEMM_MR_AVX2,   32, sgemm_avx2,   dgemm_avx2   },
+  { "AVX-512",  GEMM_REQ_AVX512,   GEMM_MR_AVX512, 64, sgemm_avx512, dgemm_avx512 }
+};
+#else
+static const struct gemm_kernel gemm_kernels[] = {
+  { "NEON", GEMM_REQ_NEON, GEMM_MR_NEON, 16, sgemm_neon, dgemm_neon },
+  { "SVE",  GEMM_REQ_SVE,  GEMM_MR_SVE,  0,  sgemm_sve,  dgemm_sve  }
+};
+#endif
+
+#define GEMM_NUM_KERNELS ((int) (sizeof(gemm_kernels) / sizeof(gemm_kernels[0])))
+#define GEMM_MIN(a, b)   ((a) < (b) ? (a) : (b))
+#define GEMM_ROUND_UP(x, m) ((((x) + (m) - 1) / (m)) * (m))
+
+bool gemm_supported(struct features* feat, const struct gemm_kernel* k) {
+  switch(k->requires) {
+#ifdef ARCH_X86
+    case GEMM_REQ_AVX2_FMA: return feat->AVX2 && feat->FMA3;
+    case GEMM_REQ_AVX512:   return feat->AVX512;
+#else
+    case GEMM_REQ_NEON:     return gemm_neon_compiled();
+    case GEMM_REQ_SVE:      return feat->SVE && feat->cntb > 0 && gemm_sve_compiled();
+#endif
+    default:                return false;
+  }
+}
+
+size_t get_gemm_elem_size(int type) {
+  return type == GEMM_SINGLE ? sizeof(float) : sizeof(double);
+}
+
+// The tile is two vectors wide
+int get_gemm_nr(struct features* feat, const struct gemm_kernel* k, int type) {
+  int vector_bytes = k->vector_bytes;
+#ifdef ARCH_ARM
+  if(vector_bytes == 0) vector_bytes = (int) feat->cntb;
+#else
+  UNUSED(feat);
+#endif
+  return 2 * vector_bytes / (int) get_gemm_elem_size(type);
+}
+
+// Returns the part of the cache available to each thread when nthreads
+// threads are spread over all the instances of the cache
+int64_t get_gemm_cache_share(struct cach* cach, int nthreads) {
+  if(cach == NULL || !cach->exists || cach->size <= 0) return -1;
+  int instances = cach->num_caches > 0 ? cach->num_caches : 1;
+  int sharing = (nthreads + instances - 1) / instances;
+  return cach->size / (sharing > 0 ? sharing : 1);
+}
+
+// Derives the blocking from the caches, following the analytical model
+// of BLIS: the kc x NR panel of B fills half of the L1d while the MR x kc
+// panels of A stream through it, the mc x kc block of A fills half of
+// the L2 and the kc x nc block of B half of the L3. Without L3, B is
+// not blocked for it.
+struct gemm_blocking get_gemm_blocking(struct cpuInfo* ptr, int mr, int nr, int type, int nthreads) {
+  struct gemm_blocking bl;
+  int64_t elem = (int64_t) get_gemm_elem_size(type);
+  int64_t l1d = get_gemm_cache_share(ptr->cach->L1d, 1);
+  int64_t l2 = get_gemm_cache_share(ptr->cach->L2, nthreads);
+  int64_t l3 = get_gemm_cache_share(ptr->cach->L3, nthreads);
+  if(l1d <= 0) l1d = GEMM_L1D_DEFAULT;
+  if(l2 <= 0) l2 = GEMM_L2_DEFAULT;
+
+  int64_t kc = l1d / 2 / (nr * elem);
+  kc -= kc % 8;
+  bl.kc = (int) (kc < GEMM_KC_MIN ? GEMM_KC_MIN : GEMM_MIN(kc, GEMM_KC_MAX));
+
+  int64_t mc = l2 / 2 / (bl.kc * elem);
+  mc -= mc % mr;
+  bl.mc = (int) (mc < mr ? mr : GEMM_MIN(mc, GEMM_ROUND_UP(GEMM_N, mr)));
+
+  int64_t nc = l3 > 0 ? l3 / 2 / (bl.kc * elem) : GEMM_NC_MAX;
+  nc -= nc % nr;
+  bl.nc = (int) (nc < nr ? nr : GEMM_MIN(nc, GEMM_NC_MAX));
+
+  return bl;
+}
+
+// Theoretical FP32 FLOPS of one core of the module, with the same model
+// used by get_peak_performance
+double get_gemm_core_peak(struct cpuInfo* ptr) {
+  int64_t freq = get_freq(ptr->freq);
+  if(freq == UNKNOWN_DATA || freq <= 0) return -1.0;
+
+  double flops = (double) freq * 1000000 * get_number_of_vpus(ptr);
+#ifdef ARCH_X86
+  struct features* feat = ptr->feat;
+  if(feat->FMA3 || feat->FMA4) flops *= 2;
+  if(feat->AVX512 && vpus_are_AVX512(ptr)) flops *= 16;
+  else if(feat->AVX || feat->AVX2) flops *= 8;
+  else if(feat->SSE) flops *= 4;
+  if(is_knights_landing(ptr)) flops = flops * 6 / 7;
+#else
+  flops *= get_vpus_width(ptr) / 32;
+  if(has_fma_support(ptr)) flops *= 2;
+#endif
+  return flops;
+}
+
+void* gemm_alloc(size_t size) {
+  void* ptr = aligned_alloc(GEMM_ALIGN, GEMM_ROUND_UP(size, GEMM_ALIGN));
+
+  if(ptr == NULL) {
+    printErr("aligned_alloc failed");
+    exit(1);
+  }
+
+  return ptr;
+}
+
+void gemm_alloc_buffers(struct gemm_work* w) {
+  size_t elem = get_gemm_elem_size(w->type);
+  int mr = w->kernel->mr;
+  w->pa = gemm_alloc(GEMM_ROUND_UP(w->bl.mc, mr) * w->bl.kc * elem);
+  w->pb = gemm_alloc(GEMM_ROUND_UP(w->bl.nc, w->nr) * w->bl.kc * elem);
+  w->tile = gemm_alloc(mr * w->nr * elem);
+}
+
+void gemm_free_buffers(struct gemm_work* w) {
+  free(w->pa);
+  free(w->pb);
+  free(w->tile);
+}
+
+// Generates, for the type T, the packing routines and the loops around
+// the microkernel, as well as the reference used to check the result.
+// The panels of A and B are padded with zeros, so the microkernel
+// always computes full tiles; at the edges of C it writes to the
+// scratch tile, which is then added to the valid part of C.
+#define DEFINE_GEMM(T, sfx, ukr, eps)                                                      \
+void gemm_pack_a_##sfx(const T* a, size_t lda, int mc, int kc, int mr, T* pa) {            \
+  for(int ir=0; ir < mc; ir += mr) {                                                       \
+    for(int p=0; p < kc; p++) {                                                            \
+      for(int i=0; i < mr; i++) *pa++ = ir+i < mc ? a[(size_t) (ir+i) * lda + p] : (T) 0;  \
+    }                                                                                      \
+  }                                                                                        \
+}                                                                                          \
+                                                                                           \
+void gemm_pack_b_##sfx(const T* b, size_t ldb, int kc, int nc, int nr, T* pb) {            \
+  for(int jr=0; jr < nc; jr += nr) {                                                       \
+    for(int p=0; p < kc; p++) {                                                            \
+      for(int j=0; j < nr; j++) *pb++ = jr+j < nc ? b[(size_t) p * ldb + jr+j] : (T) 0;    \
+    }                                                                                      \
+  }                                                                                        \
+}                                                                                          \
+                                                                                           \
+void gemm_run_##sfx(struct gemm_work* w) {                                                 \
+  const T* a = w->a;                                                                       \
+  const T* b = w->b;                                                                       \
+  T* c = w->c;                                                                             \
+  T* pa = w->pa;                                                                           \
+  T* pb = w->pb;                                                                           \
+  T* tile = w->tile;                                                                       \
+  int mr = w->kernel->mr;                                                                  \
+  int nr = w->nr;                                                                          \
+                                                                                           \
+  for(int jc=0; jc < w->n; jc += w->bl.nc) {                                               \
+    int nc = GEMM_MIN(w->bl.nc, w->n - jc);                                                \
+    for(int pc=0; pc < w->k; pc += w->bl.kc) {                                             \
+      int kc = GEMM_MIN(w->bl.kc, w->k - pc);                                              \
+      gemm_pack_b_##sfx(b + (size_t) pc * w->ldb + jc, w->ldb, kc, nc, nr, pb);            \
+      for(int ic=0; ic < w->m; ic += w->bl.mc) {                                           \
+        int mc = GEMM_MIN(w->bl.mc, w->m - ic);                                            \
+        gemm_pack_a_##sfx(a + (size_t) ic * w->lda + pc, w->lda, mc, kc, mr, pa);          \
+        for(int jr=0; jr < nc; jr += nr) {                                                 \
+          for(int ir=0; ir < mc; ir += mr) {                                               \
+            T* ct = c + (size_t) (ic+ir) * w->ldc + jc+jr;                                 \
+            if(ir + mr <= mc && jr + nr <= nc) {                                           \
+              w->kernel->ukr(kc, pa + (size_t) ir * kc, pb + (size_t) jr * kc, ct, w->ldc);\
+              continue;                                                                    \
+            }                                                                              \
+            memset(tile, 0, sizeof(T) * mr * nr);                                          \
+            w->kernel->ukr(kc, pa + (size_t) ir * kc, pb + (size_t) jr * kc, tile, nr);    \
+            for(int i=0; i < GEMM_MIN(mr, mc - ir); i++) {                                 \
+              for(int j=0; j < GEMM_MIN(nr, nc - jr); j++) ct[(size_t) i * w->ldc + j] += tile[i*nr + j]; \
+            }                                                                              \
+          }                                                                                \
+        }                                                                                  \
+      }                                                                                    \
+    }                                                                                      \
+  }                                                                                        \
+}                                                                                          \
+                                                                                           \
+void gemm_fill_##sfx(void* ptr, size_t n, uint64_t* seed) {                                \
+  T* x = ptr;                                                                              \
+  for(size_t i=0; i < n; i++) {                                                            \
+    *seed ^= *seed << 13; *seed ^= *seed >> 7; *seed ^= *seed << 17;                       \
+    x[i] = (T) ((double) (*seed >> 11) / (double) (1ULL << 53) * 2.0 - 1.0);               \
+  }                                                                                        \
+}                                                                                          \
+                                                                                           \
+/* c0 is C before running the kernel. The elements of A and B are in */                    \
+/* [-1, 1], so the error of each dot product is bounded by k * eps */                      \
+bool gemm_check_##sfx(struct gemm_work* w, const void* c0) {                               \
+  const T* a = w->a;                                                                       \
+  const T* b = w->b;                                                                       \
+  const T* c = w->c;                                                                       \
+  const T* ci = c0;                                                                        \
+  for(int i=0; i < w->m; i++) {                                                            \
+    for(int j=0; j < w->n; j++) {                                                          \
+      double ref = ci[(size_t) i * w->ldc + j];                                            \
+      for(int p=0; p < w->k; p++) ref += (double) a[(size_t) i * w->lda + p] * b[(size_t) p * w->ldb + j]; \
+      double err = c[(size_t) i * w->ldc + j] - ref;                                       \
+      if(err > 4 * w->k * eps || -err > 4 * w->k * eps) return false;                      \
+    }                                                                                      \
+  }                                                                                        \
+  return true;                                                                             \
+}
+
+DEFINE_GEMM(float, s, sgemm, FLT_EPSILON)
+DEFINE_GEMM(double, d, dgemm, DBL_EPSILON)
+
+void gemm_run(struct gemm_work* w) {
+  if(w->type == GEMM_SINGLE) gemm_run_s(w);
+  else gemm_run_d(w);
+}
+
+void gemm_fill(int type, void* ptr, size_t n, uint64_t* seed) {
+  if(type == GEMM_SINGLE) gemm_fill_s(ptr, n, seed);
+  else gemm_fill_d(ptr, n, seed);
+}
+
+// Checks the kernel against a plain triple loop on a small problem,
+// with sizes and blocking chosen to go through every loop more than
+// once and to hit all the edge cases
+bool check_gemm_kernel(const struct gemm_kernel* k, int type, int nr) {
+  struct gemm_work w;
+  size_t elem = get_gemm_elem_size(type);
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+
+  w.kernel = k;
+  w.type = type;
+  w.nr = nr;
+  w.bl = (struct gemm_blocking) { 40, 3 * k->mr, 2 * nr };
+  w.m = 7 * k->mr + 3;
+  w.n = 5 * nr + 1;
+  w.k = 101;
+  w.lda = w.k;
+  w.ldb = w.n;
+  w.ldc = w.n;
+
+  void* a = gemm_alloc(w.m * w.lda * elem);
+  void* b = gemm_alloc(w.k * w.ldb * elem);
+  void* c = gemm_alloc(w.m * w.ldc * elem);
+  void* c0 = gemm_alloc(w.m * w.ldc * elem);
+  gemm_fill(type, a, w.m * w.lda, &seed);
+  gemm_fill(type, b, w.k * w.ldb, &seed);
+  gemm_fill(type, c0, w.m * w.ldc, &seed);
+  memcpy(c, c0, w.m * w.ldc * elem);
+  w.a = a;
+  w.b = b;
+  w.c = c;
+
+  gemm_alloc_buffers(&w);
+  gemm_run(&w);
+  bool ok = type == GEMM_SINGLE ? gemm_check_s(&w, c0) : gemm_check_d(&w, c0);
+  gemm_free_buffers(&w);
+
+  if(!ok) printBug("%s %s produced a wrong result", k->name, gemm_type_str[type]);
+
+  free(a);
+  free(b);
+  free(c);
+  free(c0);
+  return ok;
+}
+
+void* gemm_thread(void* arg) {
+  struct gemm_worker* wk = (struct gemm_worker*) arg;
+
+  // The packing buffers are allocated (and first touched) by the thread
+  gemm_alloc_buffers(&wk->work);
+  while(!*wk->start) cpu_relax();
+
+  uint64_t t0 = get_time_ns();
+  do {
+    gemm_run(&wk->work);
+    wk->reps++;
+  } while(!*wk->stop);
+  wk->ns = get_time_ns() - t0;
+
+  gemm_free_buffers(&wk->work);
+  return NULL;
+}
+
+// Runs the kernel in all the CPUs in cpus at the same time, returning
+// the aggregated FLOPS (or -1 on error). The threads are arranged in a
+// grid over C, as square as possible, and each one computes its own
+// block with the whole k, so there is no synchronization between them.
+double measure_gemm_kernel(const struct gemm_kernel* k, int type, int nr, struct gemm_blocking bl, int* cpus, int ncpus) {
+  size_t elem = get_gemm_elem_size(type);
+  int pr = 1;
+  for(int d=1; d * d <= ncpus; d++) {
+    if(ncpus % d == 0) pr = d;
+  }
+  int pc = ncpus / pr;
+  int mb = GEMM_ROUND_UP((GEMM_N + pr - 1) / pr, k->mr);
+  int nb = GEMM_ROUND_UP((GEMM_N + pc - 1) / pc, nr);
+  size_t m = (size_t) mb * pr;
+  size_t n = (size_t) nb * pc;
+  size_t kk = GEMM_N;
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+  char* a = gemm_alloc(m * kk * elem);
+  char* b = gemm_alloc(kk * n * elem);
+  char* c = gemm_alloc(m * n * elem);
+  gemm_fill(type, a, m * kk, &seed);
+  gemm_fill(type, b, kk * n, &seed);
+  memset(c, 0, m * n * elem);
+
+  struct gemm_worker* workers = ecalloc(ncpus, sizeof(struct gemm_worker));
+  pthread_t* threads = emalloc(sizeof(pthread_t) * ncpus);
+  volatile bool start = false;
+  volatile bool stop = false;
+  double throughput = 0.0;
+  int created = 0;
+
+  for(int i=0; i < ncpus; i++) {
+    struct gemm_work* w = &workers[i].work;
+    size_t row = (size_t) (i / pc) * mb;
+    size_t col = (size_t) (i % pc) * nb;
+    w->kernel = k;
+    w->type = type;
+    w->nr = nr;
+    w->bl = bl;
+    w->m = mb;
+    w->n = nb;
+    w->k = (int) kk;
+    w->lda = kk;
+    w->ldb = n;
+    w->ldc = n;
+    w->a = a + row * kk * elem;
+    w->b = b + col * elem;
+    w->c = c + (row * n + col) * elem;
+    workers[i].start = &start;
+    workers[i].stop = &stop;
+  }
+
+  for(int i=0; i < ncpus; i++) {
+    if(!create_thread_on_cpu(&threads[i], cpus[i], gemm_thread, &workers[i])) break;
+    created++;
+  }
+
+  start = true;
+  sleep_us(GEMM_TIME_NS / 1000);
+  stop = true;
+
+  for(int i=0; i < created; i++) pthread_join(threads[i], NULL);
+
+  if(created == ncpus) {
+    double flops_per_rep = 2.0 * mb * nb * kk;
+    for(int i=0; i < ncpus; i++) {
+      if(workers[i].ns > 0) throughput += workers[i].reps * flops_per_rep / (workers[i].ns / 1e9);
+    }
+  }
+  else {
+    throughput = -1.0;
+  }
+
+  free(workers);
+  free(threads);
+  free(a);
+  free(b);
+  free(c);
+  return throughput;
+}
+
+void print_gemm_header(void) {
+  printf("  %-10s %-6s %6s %5s %5s %5s %9s %6s\n", "Kernel", "Type", "Tile", "KC", "MC", "NC", "GFLOPS", "Peak");
+}
+
+// peak is the FP32 peak of the CPUs used (DGEMM runs at half of it)
+bool print_gemm_row(const struct gemm_kernel* k, int type, int nr, struct gemm_blocking bl, int* cpus, int ncpus, double peak) {
+  char tile[16];
+  snprintf(tile, sizeof(tile), "%dx%d", k->mr, nr);
+  printf("  %-10s %-6s %6s %5d %5d %5d", k->name, gemm_type_str[type], tile, bl.kc, bl.mc, bl.nc);
+  fflush(stdout);
+
+  double flops = measure_gemm_kernel(k, type, nr, bl, cpus, ncpus);
+  if(flops < 0) {
+    printf("\n");
+    return false;
+  }
+
+  if(type == GEMM_DOUBLE) peak /= 2;
+  printf(" %9.2f", flops / 1e9);
+  if(peak > 0) printf(" %5.1f%%\n", flops * 100.0 / peak);
+  else printf(" %6s\n", "-");
+  return true;
+}
+
+bool print_gemm_module(struct cpuInfo* cpu, int module) {
+  struct cpuInfo* ptr = get_module(cpu, module);
+  int first_cpu = get_module_first_cpu(cpu, module);
+  bool any = false;
+  bool ret = true;
+
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    return false;
+  }
+
+  printf("\n%s (CPU %d):\n", get_str_uarch(ptr), first_cpu);
+  print_gemm_header();
+  for(int i=0; i < GEMM_NUM_KERNELS && ret; i++) {
+    const struct gemm_kernel* k = &gemm_kernels[i];
+    if(!gemm_supported(ptr->feat, k)) continue;
+    any = true;
+
+    for(int t=0; t < GEMM_NUM_TYPES && ret; t++) {
+      int nr = get_gemm_nr(ptr->feat, k, t);
+      struct gemm_blocking bl = get_gemm_blocking(ptr, k->mr, nr, t, 1);
+      ret = check_gemm_kernel(k, t, nr) && print_gemm_row(k, t, nr, bl, &first_cpu, 1, get_gemm_core_peak(ptr));
+    }
+  }
+
+  if(!any) printf("  No supported kernel in this core\n");
+  return ret;
+}
+
+// Same as print_gemm_module for all the allowed CPUs, with the kernels
+// supported by all the modules. The blocking is computed from the
+// caches of the first module, shared among the threads
+bool print_gemm_all_cores(struct cpuInfo* cpu, int* cpus, int ncpus, int nonline) {
+  // Scale the peak of the whole CPU down if only some CPUs are allowed
+  double peak = cpu->peak_performance > 0 ? (double) cpu->peak_performance * ncpus / nonline : -1.0;
+  bool ret = true;
+
+  printf("\nAll cores (%d CPUs):\n", ncpus);
+  print_gemm_header();
+  for(int i=0; i < GEMM_NUM_KERNELS && ret; i++) {
+    const struct gemm_kernel* k = &gemm_kernels[i];
+    bool supported = true;
+    for(int m=0; m < get_num_modules(cpu) && supported; m++) {
+      supported = gemm_supported(get_module(cpu, m)->feat, k);
+    }
+    if(!supported) continue;
+
+    for(int t=0; t < GEMM_NUM_TYPES && ret; t++) {
+      int nr = get_gemm_nr(cpu->feat, k, t);
+      struct gemm_blocking bl = get_gemm_blocking(cpu, k->mr, nr, t, ncpus);
+      ret = print_gemm_row(k, t, nr, bl, cpus, ncpus, peak);
+    }
+  }
+
+  return ret;
+}
+
+// Measures the FLOPS achieved by a blocked SGEMM and DGEMM (the loops of
+// BLIS around a register-blocked microkernel for each ISA, with the
+// cache blocking derived from the detected caches) in one core of each
+// module and in all the cores, compared with the theoretical peak.
+bool print_gemm_benchmark(struct cpuInfo* cpu) {
+#ifdef ARCH_ARM
+  bool sve = false;
+  for(int m=0; m < get_num_modules(cpu); m++) sve |= get_module(cpu, m)->feat->SVE;
+  if(sve && !gemm_sve_compiled())
+    printWarn("CPU supports SVE, but it was not enabled by the compiler");
+#endif
+
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) return false;
+
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  int* cpus = emalloc(sizeof(int) * map->num_cpus);
+  int ncpus = 0;
+  int nonline = 0;
+  if(!get_allowed_cpus(allowed, map->num_cpus)) {
+    free(allowed);
+    free(cpus);
+    free_cpu_map(map);
+    return false;
+  }
+  for(int i=0; i < map->num_cpus; i++) {
+    if(map->cpus[i].online) nonline++;
+    if(allowed[i] && map->cpus[i].online) cpus[ncpus++] = i;
+  }
+
+  printf("cpufetch is measuring sustained SGEMM and DGEMM throughput (C += A * B, %dx%d matrices)...\n", GEMM_N, GEMM_N);
+  printf("Tile is the register blocking and KC, MC and NC the cache blocking; Peak is relative to the theoretical peak\n");
+
+  bool ret = true;
+  for(int m=0; m < get_num_modules(cpu) && ret; m++) {
+    ret = print_gemm_module(cpu, m);
+  }
+  if(ret && ncpus > 1) ret = print_gemm_all_cores(cpu, cpus, ncpus, nonline);
+
+  if(!ret) printErr("Failed to run the GEMM benchmark");
+
+  free(allowed);
+  free(cpus);
+  free_cpu_map(map);
+  return ret;
+}
+
+#else
+
+bool print_gemm_benchmark(struct cpuInfo* cpu) {
+  UNUSED(cpu);
+  printErr("The GEMM benchmark is only supported in x86 and AArch64");
+  return false;
+}
+
+#endif // #if defined(ARCH_X86) || (defined(ARCH_ARM) && defined(__aarch64__))
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __GEMMBENCH__
+#define __GEMMBENCH__
+
+#include "cpu.h"
+
+bool print_gemm_benchmark(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef __IBRANCH_KERNEL__
+#define __IBRANCH_KERNEL__
+
+#include <stdint.h>
+
+#include "mitigations.h"
+
+// Kernel of the indirect call benchmark. It is static inline so that
+// each file including this header gets its own copy, compiled with
+// its own flags: this is how x86 builds a version that goes through
+// retpolines (see x86/retpoline/retpoline.c).
+
+#define IBRANCH_TARGET(n) static inline uint64_t ibranch_target_##n(uint64_t x) { return x + n; }
+IBRANCH_TARGET(0)  IBRANCH_TARGET(1)  IBRANCH_TARGET(2)  IBRANCH_TARGET(3)
+IBRANCH_TARGET(4)  IBRANCH_TARGET(5)  IBRANCH_TARGET(6)  IBRANCH_TARGET(7)
+IBRANCH_TARGET(8)  IBRANCH_TARGET(9)  IBRANCH_TARGET(10) IBRANCH_TARGET(11)
+IBRANCH_TARGET(12) IBRANCH_TARGET(13) IBRANCH_TARGET(14) IBRANCH_TARGET(15)
+#undef IBRANCH_TARGET
+
+// Performs iters indirect calls, in the order given by seq
+static inline uint64_t ibranch_kernel(const uint8_t* seq, uint64_t iters) {
+  static uint64_t (* const targets[IBRANCH_TARGETS])(uint64_t) = {
+    ibranch_target_0,  ibranch_target_1,  ibranch_target_2,  ibranch_target_3,
+    ibranch_target_4,  ibranch_target_5,  ibranch_target_6,  ibranch_target_7,
+    ibranch_target_8,  ibranch_target_9,  ibranch_target_10, ibranch_target_11,
+    ibranch_target_12, ibranch_target_13, ibranch_target_14, ibranch_target_15
+  };
+
+  uint64_t acc = 0;
+  for(uint64_t i=0; i < iters; i++)
+    acc = targets[seq[i & (IBRANCH_SEQ_LEN-1)]](acc);
+  return acc;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "global.h"
+#include "bench.h"
+#include "freq.h"
+#include "insnbench.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+  #include "../x86/insn/insn.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+  #include "../arm/insn/insn.h"
+#endif
+
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+
+// Time of each sample and number of samples (the fastest one is kept)
+#define INSN_SAMPLE_NS  (2 * 1000 * 1000)
+#define INSN_REPS       5
+
+// Returns the cycles (or -1 on error) taken by fn(iters)
+double get_clock_cycles(struct cycle_clock* clk, void (*fn)(uint64_t iters), uint64_t iters) {
+  if(clk->fd != -1) {
+    uint64_t c0, c1;
+    if(!read_cycles_counter(clk->fd, &c0)) return -1.0;
+    fn(iters);
+    if(!read_cycles_counter(clk->fd, &c1)) return -1.0;
+    return (double) (c1 - c0);
+  }
+
+  uint64_t t0 = get_time_ns();
+  fn(iters);
+  uint64_t t1 = get_time_ns();
+  return (double) (t1 - t0) * clk->cycles_per_ns;
+}
+
+// Returns the number of iterations that takes at least INSN_SAMPLE_NS
+uint64_t get_insn_iters(insn_fn fn) {
+  uint64_t iters = 256;
+
+  while(true) {
+    uint64_t t0 = get_time_ns();
+    fn(iters);
+    uint64_t t1 = get_time_ns();
+    if(t1 - t0 >= INSN_SAMPLE_NS || iters >= (1ULL << 40)) return iters;
+    iters *= 2;
+  }
+}
+
+// Returns the cycles per instruction of the kernel (the best out of
+// INSN_REPS samples), or -1 on error
+double measure_insn_kernel(struct cycle_clock* clk, insn_fn fn) {
+  uint64_t iters = get_insn_iters(fn);
+  double best = -1.0;
+
+  for(int r=0; r < INSN_REPS; r++) {
+    double cycles = get_clock_cycles(clk, fn, iters);
+    if(cycles < 0.0) return -1.0;
+    double cpi = cycles / ((double) iters * INSN_PER_ITER);
+    if(best < 0.0 || cpi < best) best = cpi;
+  }
+
+  return best;
+}
+
+// The add chain runs at one instruction per cycle
+void calibrate_cycle_clock(struct cycle_clock* clk) {
+  insn_fn fn = insn_tests[0].lat;
+  uint64_t iters = get_insn_iters(fn);
+
+  clk->cycles_per_ns = 0.0;
+  for(int r=0; r < INSN_REPS; r++) {
+    uint64_t t0 = get_time_ns();
+    fn(iters);
+    uint64_t t1 = get_time_ns();
+    if(t1 == t0) t1++;
+    double cpns = (double) iters * INSN_PER_ITER / (double) (t1 - t0);
+    if(cpns > clk->cycles_per_ns) clk->cycles_per_ns = cpns;
+  }
+}
+
+// Cycles are read from the same perf counter used to measure the
+// frequency. If it is not available (e.g., in most VMs), they are
+// derived from the time, using the first test (an integer add, with
+// a latency of one cycle in every core) to compute the frequency
+void init_cycle_clock(struct cycle_clock* clk, uint32_t core) {
+  clk->fd = open_cycles_counter(core);
+  clk->cycles_per_ns = 0.0;
+
+  if(clk->fd != -1) {
+    if(start_cycles_counter(clk->fd)) {
+      printf("  Cycles: measured with the cycle counter\n");
+      return;
+    }
+    close(clk->fd);
+    clk->fd = -1;
+  }
+  else {
+    printWarn("perf_event_open: %s", strerror(errno));
+  }
+
+  calibrate_cycle_clock(clk);
+  printf("  Cycles: cycle counter not available, derived from the time (%.2f GHz with %s)\n",
+         clk->cycles_per_ns, insn_tests[0].name);
+}
+
+void close_cycle_clock(struct cycle_clock* clk) {
+  if(clk->fd != -1) close(clk->fd);
+  clk->fd = -1;
+}
+
+bool print_insn_module(struct cpuInfo* cpu, int module) {
+  struct cpuInfo* ptr = get_module(cpu, module);
+  int32_t first_cpu = get_module_first_cpu(cpu, module);
+  struct cycle_clock clk;
+
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    return false;
+  }
+
+  printf("\n%s (CPU %d):\n", get_str_uarch(ptr), first_cpu);
+#ifdef ARCH_ARM
+  if(ptr->feat->SVE && ptr->feat->cntb > 0)
+    printf("  SVE vector length: %d bits\n", (int) ptr->feat->cntb * 8);
+#endif
+  init_cycle_clock(&clk, first_cpu);
+
+  printf("  %-20s %10s %12s\n", "Instruction", "Latency", "Throughput");
+  bool ret = true;
+  for(int i=0; i < insn_num_tests && ret; i++) {
+    const struct insn_test* t = &insn_tests[i];
+    if(!insn_supported(ptr->feat, t->isa)) continue;
+    // Follow the frequency, which may change between tests
+    if(clk.fd == -1) calibrate_cycle_clock(&clk);
+
+    double lat = measure_insn_kernel(&clk, t->lat);
+    double tput = measure_insn_kernel(&clk, t->tput);
+    if(lat < 0.0 || tput < 0.0) {
+      ret = false;
+      break;
+    }
+    printf("  %-20s %10.2f %12.2f\n", t->name, lat, tput);
+    fflush(stdout);
+  }
+
+  close_cycle_clock(&clk);
+  return ret;
+}
+
+// Measures the latency (a single dependency chain) and the reciprocal
+// throughput (INSN_CHAINS independent chains) in cycles of a curated
+// list of instructions, for each module (core type) of the CPU.
+bool print_insn_table(struct cpuInfo* cpu) {
+  if(insn_num_tests == 0) {
+    printErr("The instruction table is not supported in this architecture");
+    return false;
+  }
+
+  printf("cpufetch is measuring instruction latencies and throughputs...\n");
+  printf("Latency and reciprocal throughput are given in cycles per instruction\n");
+
+  bool ret = true;
+  for(int m=0; m < get_num_modules(cpu) && ret; m++) {
+    ret = print_insn_module(cpu, m);
+  }
+  return ret;
+}
+
+#else
+
+bool print_insn_table(struct cpuInfo* cpu) {
+  UNUSED(cpu);
+  printErr("The instruction table is not supported in this architecture");
+  return false;
+}
+
+#endif // #if defined(ARCH_X86) || defined(ARCH_ARM)
+
+#endif // #ifdef __linux__
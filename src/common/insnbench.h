@@ -0,0 +1,20 @@
+#ifndef __INSNBENCH__
+#define __INSNBENCH__
+
+#include "cpu.h"
+
+// Cycle clock shared with other benchmarks that report cycles. It uses
+// the perf cycle counter if available, or the time otherwise
+struct cycle_clock {
+  int fd;
+  double cycles_per_ns;
+};
+
+void init_cycle_clock(struct cycle_clock* clk, uint32_t core);
+void calibrate_cycle_clock(struct cycle_clock* clk);
+double get_clock_cycles(struct cycle_clock* clk, void (*fn)(uint64_t iters), uint64_t iters);
+void close_cycle_clock(struct cycle_clock* clk);
+
+bool print_insn_table(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,344 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <dirent.h>
+
+#include "global.h"
+#include "udev.h"
+#include "cpumap.h"
+#include "isolation.h"
+
+#define _PATH_IRQ_AFFINITY   "/smp_affinity_list"
+#define _PATH_IRQ_EFFECTIVE  "/effective_affinity_list"
+// Maximum number of IRQs landing on isolated CPUs that are listed
+#define ISOL_MAX_IRQS_SHOWN  10
+
+// Interrupt line from /proc/irq/N
+struct irq_info {
+  int irq;
+  char* name;      // Actions registered in the line (comma separated)
+  bool* affinity;  // CPUs the line may be routed to (smp_affinity_list)
+  bool* effective; // CPUs the line is routed to (effective_affinity_list)
+};
+
+// CPU lists specified in the kernel command line. The sysfs files are
+// preferred when available, since they show what the kernel applied
+struct cmdline_sets {
+  bool* isolcpus;
+  bool* nohz_full;
+  bool* rcu_nocbs;
+  bool* irqaffinity;
+  char* isolcpus_flags;
+  bool has_isolcpus;
+  bool has_nohz_full;
+  bool has_rcu_nocbs;
+  bool has_irqaffinity;
+};
+
+// Parses the CPU list of a kernel parameter. isolcpus accepts flags
+// before the list (e.g., isolcpus=nohz,domain,managed_irq,2-7), which
+// are returned in flags, and some parameters accept "all"
+bool parse_cmdline_cpu_list(char* value, bool* cpus, int ncpus, char** flags) {
+  if(flags != NULL) {
+    char* list = value;
+    char* comma;
+    while(isalpha((unsigned char) *list) && (comma = strchr(list, ',')) != NULL) list = comma + 1;
+    if(list != value) {
+      *flags = emalloc(sizeof(char) * (list - value));
+      memcpy(*flags, value, list - value - 1);
+      (*flags)[list - value - 1] = '\0';
+    }
+    value = list;
+  }
+
+  if(strcmp(value, "all") == 0) {
+    for(int i=0; i < ncpus; i++) cpus[i] = true;
+    return true;
+  }
+  return parse_cpu_list(value, cpus, ncpus) >= 0;
+}
+
+struct cmdline_sets* get_cmdline_sets(int ncpus) {
+  struct cmdline_sets* cs = emalloc(sizeof(struct cmdline_sets));
+  cs->isolcpus = ecalloc(ncpus, sizeof(bool));
+  cs->nohz_full = ecalloc(ncpus, sizeof(bool));
+  cs->rcu_nocbs = ecalloc(ncpus, sizeof(bool));
+  cs->irqaffinity = ecalloc(ncpus, sizeof(bool));
+  cs->isolcpus_flags = NULL;
+  cs->has_isolcpus = false;
+  cs->has_nohz_full = false;
+  cs->has_rcu_nocbs = false;
+  cs->has_irqaffinity = false;
+
+  char* cmdline = get_str_from_file(_PATH_CMDLINE);
+  if(cmdline == NULL) {
+    printWarn("Unable to read %s", _PATH_CMDLINE);
+    return cs;
+  }
+
+  char* saveptr;
+  for(char* tok = strtok_r(cmdline, " \n", &saveptr); tok != NULL; tok = strtok_r(NULL, " \n", &saveptr)) {
+    // Parameters after "--" are passed to init
+    if(strcmp(tok, "--") == 0) break;
+
+    if(strncmp(tok, "isolcpus=", 9) == 0) {
+      cs->has_isolcpus = parse_cmdline_cpu_list(tok + 9, cs->isolcpus, ncpus, &cs->isolcpus_flags);
+    }
+    else if(strncmp(tok, "nohz_full=", 10) == 0) {
+      cs->has_nohz_full = parse_cmdline_cpu_list(tok + 10, cs->nohz_full, ncpus, NULL);
+    }
+    else if(strncmp(tok, "rcu_nocbs=", 10) == 0) {
+      cs->has_rcu_nocbs = parse_cmdline_cpu_list(tok + 10, cs->rcu_nocbs, ncpus, NULL);
+    }
+    else if(strcmp(tok, "rcu_nocbs") == 0) {
+      // Without a list, the offloading can be enabled later per CPU
+      // using cpusets, so there are no CPUs to report
+      cs->has_rcu_nocbs = true;
+    }
+    else if(strncmp(tok, "irqaffinity=", 12) == 0) {
+      cs->has_irqaffinity = parse_cmdline_cpu_list(tok + 12, cs->irqaffinity, ncpus, NULL);
+    }
+  }
+
+  free(cmdline);
+  return cs;
+}
+
+void free_cmdline_sets(struct cmdline_sets* cs) {
+  free(cs->isolcpus);
+  free(cs->nohz_full);
+  free(cs->rcu_nocbs);
+  free(cs->irqaffinity);
+  free(cs->isolcpus_flags);
+  free(cs);
+}
+
+// Returns the names of the actions of the interrupt line, which are
+// the directories under /proc/irq/N
+char* get_irq_name(char* path) {
+  DIR* dir = opendir(path);
+  if(dir == NULL) return NULL;
+
+  char* name = NULL;
+  int len = 0;
+  struct dirent* ent;
+  while((ent = readdir(dir)) != NULL) {
+    if(ent->d_name[0] == '.' || ent->d_type != DT_DIR) continue;
+    int add = strlen(ent->d_name);
+    name = erealloc(name, sizeof(char) * (len + add + 2));
+    if(len > 0) name[len++] = ',';
+    strcpy(name + len, ent->d_name);
+    len += add;
+  }
+  closedir(dir);
+  return name;
+}
+
+int compare_irqs(const void* a, const void* b) {
+  return ((const struct irq_info *) a)->irq - ((const struct irq_info *) b)->irq;
+}
+
+// Reads the affinity of every interrupt line in /proc/irq. Lines
+// without effective_affinity_list (older kernels) are assumed to be
+// routed to any CPU in smp_affinity_list
+struct irq_info* get_irq_affinities(int ncpus, int* nirqs) {
+  *nirqs = 0;
+  DIR* dir = opendir(_PATH_IRQ);
+  if(dir == NULL) {
+    printWarn("opendir: %s: %s", _PATH_IRQ, strerror(errno));
+    return NULL;
+  }
+
+  int capacity = 64;
+  struct irq_info* irqs = emalloc(sizeof(struct irq_info) * capacity);
+  char path[_PATH_SYSFS_MAX_LEN];
+  struct dirent* ent;
+
+  while((ent = readdir(dir)) != NULL) {
+    if(!isdigit((unsigned char) ent->d_name[0])) continue;
+
+    struct irq_info irq;
+    irq.irq = atoi(ent->d_name);
+    irq.affinity = emalloc(sizeof(bool) * ncpus);
+    irq.effective = emalloc(sizeof(bool) * ncpus);
+
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%d%s", _PATH_IRQ, irq.irq, _PATH_IRQ_AFFINITY);
+    if(!get_cpu_list_from_file(path, irq.affinity, ncpus)) {
+      free(irq.affinity);
+      free(irq.effective);
+      continue;
+    }
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%d%s", _PATH_IRQ, irq.irq, _PATH_IRQ_EFFECTIVE);
+    if(!get_cpu_list_from_file(path, irq.effective, ncpus)) {
+      memcpy(irq.effective, irq.affinity, sizeof(bool) * ncpus);
+    }
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%d", _PATH_IRQ, irq.irq);
+    irq.name = get_irq_name(path);
+
+    if(*nirqs == capacity) {
+      capacity *= 2;
+      irqs = erealloc(irqs, sizeof(struct irq_info) * capacity);
+    }
+    irqs[(*nirqs)++] = irq;
+  }
+
+  closedir(dir);
+  qsort(irqs, *nirqs, sizeof(struct irq_info), compare_irqs);
+  return irqs;
+}
+
+void free_irq_affinities(struct irq_info* irqs, int nirqs) {
+  if(irqs == NULL) return;
+  for(int i=0; i < nirqs; i++) {
+    free(irqs[i].name);
+    free(irqs[i].affinity);
+    free(irqs[i].effective);
+  }
+  free(irqs);
+}
+
+void print_isolation_set(const char* name, bool* cpus, int ncpus, bool exists, const char* missing) {
+  char* str = get_str_cpu_list(cpus, ncpus);
+  printf("  %-26s %s\n", name, !exists ? missing : str[0] == '\0' ? "none" : str);
+  free(str);
+}
+
+static inline const char* mark(bool b) {
+  return b ? "yes" : "-";
+}
+
+// Shows how the kernel partitions the CPUs: the isolated CPUs
+// (isolcpus), the ones without the periodic tick (nohz_full), the
+// ones whose RCU callbacks are offloaded (rcu_nocbs) and where each
+// interrupt line may be and is actually routed, next to the topology
+// of each CPU. The remaining CPUs are the housekeeping ones, which run
+// the kernel threads, timers and interrupts the isolated CPUs avoid.
+bool print_cpu_isolation(void) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+  int ncpus = map->num_cpus;
+
+  bool* isolated = emalloc(sizeof(bool) * ncpus);
+  bool* nohz = emalloc(sizeof(bool) * ncpus);
+  bool has_isolated = get_cpu_list_from_file(_PATH_CPUS_ISOLATED, isolated, ncpus);
+  bool has_nohz = get_cpu_list_from_file(_PATH_CPUS_NOHZ_FULL, nohz, ncpus);
+  struct cmdline_sets* cs = get_cmdline_sets(ncpus);
+
+  // The sysfs files show what the kernel applied, but if they are
+  // missing we fallback to the command line
+  if(!has_isolated && cs->has_isolcpus) memcpy(isolated, cs->isolcpus, sizeof(bool) * ncpus);
+  if(!has_nohz && cs->has_nohz_full) memcpy(nohz, cs->nohz_full, sizeof(bool) * ncpus);
+
+  // nohz_full implies rcu_nocbs
+  bool* nocbs = emalloc(sizeof(bool) * ncpus);
+  for(int i=0; i < ncpus; i++) nocbs[i] = cs->rcu_nocbs[i] || nohz[i];
+
+  int nirqs;
+  struct irq_info* irqs = get_irq_affinities(ncpus, &nirqs);
+  int* irq_affinity = ecalloc(ncpus, sizeof(int));
+  int* irq_effective = ecalloc(ncpus, sizeof(int));
+  for(int i=0; i < nirqs; i++) {
+    for(int c=0; c < ncpus; c++) {
+      if(irqs[i].affinity[c]) irq_affinity[c]++;
+      if(irqs[i].effective[c]) irq_effective[c]++;
+    }
+  }
+
+  bool* housekeeping = ecalloc(ncpus, sizeof(bool));
+  bool* isolated_online = ecalloc(ncpus, sizeof(bool));
+  for(int i=0; i < ncpus; i++) {
+    if(!map->cpus[i].online) continue;
+    if(isolated[i] || nohz[i]) isolated_online[i] = true;
+    else housekeeping[i] = true;
+  }
+
+  printf("Kernel CPU partitioning:\n");
+  print_isolation_set("Isolated (isolcpus)", isolated, ncpus, has_isolated || cs->has_isolcpus, "not supported by the kernel");
+  if(cs->isolcpus_flags != NULL) printf("  %-26s %s\n", "isolcpus flags", cs->isolcpus_flags);
+  print_isolation_set("Tickless (nohz_full)", nohz, ncpus, has_nohz || cs->has_nohz_full, "not supported by the kernel");
+  print_isolation_set("RCU offload (rcu_nocbs)", nocbs, ncpus, true, "");
+  print_isolation_set("IRQ default (irqaffinity)", cs->irqaffinity, ncpus, cs->has_irqaffinity, "not set");
+  printf("\n");
+
+  printf("  %4s %6s %5s %5s %5s  %-12s %4s %4s %4s %8s %8s\n", "CPU", "Socket", "Core", "L3", "Node",
+         "Role", "Isol", "NOHZ", "NOCB", "IRQ-Aff", "IRQ-Eff");
+  bool warn_irqs = false;
+  for(int i=0; i < ncpus; i++) {
+    struct cpu_location* loc = &map->cpus[i];
+    if(!loc->online) {
+      printf("  %4d %6s %5s %5s %5s  %-12s\n", i, "-", "-", "-", "-", "offline");
+      continue;
+    }
+    bool noisy = isolated_online[i] && irq_effective[i] > 0;
+    warn_irqs = warn_irqs || noisy;
+    printf("  %4d %6d %5d %5d %5d  %-12s %4s %4s %4s %8d %7d%s\n", i, loc->package, loc->core, loc->l3, loc->node,
+           housekeeping[i] ? "housekeeping" : "isolated", mark(isolated[i]), mark(nohz[i]), mark(nocbs[i]),
+           irq_affinity[i], irq_effective[i], noisy ? "*" : " ");
+  }
+  printf("\n");
+
+  char* str = get_str_cpu_list(housekeeping, ncpus);
+  printf("Housekeeping CPUs: %s\n", str[0] == '\0' ? "none" : str);
+  free(str);
+  str = get_str_cpu_list(isolated_online, ncpus);
+  printf("Isolated CPUs:     %s\n", str[0] == '\0' ? "none" : str);
+  free(str);
+
+  // The tick is still running in CPUs isolated only from the scheduler
+  bool* ticking = ecalloc(ncpus, sizeof(bool));
+  bool any_ticking = false;
+  for(int i=0; i < ncpus; i++) {
+    ticking[i] = isolated_online[i] && !nohz[i];
+    any_ticking = any_ticking || ticking[i];
+  }
+  if(any_ticking) {
+    str = get_str_cpu_list(ticking, ncpus);
+    printf("Isolated CPUs with the periodic tick (not in nohz_full): %s\n", str);
+    free(str);
+  }
+  free(ticking);
+
+  if(warn_irqs) {
+    printf("\nInterrupts routed to isolated CPUs (*):\n");
+    int shown = 0;
+    for(int i=0; i < nirqs; i++) {
+      bool* cpus = ecalloc(ncpus, sizeof(bool));
+      bool hit = false;
+      for(int c=0; c < ncpus; c++) {
+        cpus[c] = irqs[i].effective[c] && isolated_online[c];
+        hit = hit || cpus[c];
+      }
+      if(hit && shown < ISOL_MAX_IRQS_SHOWN) {
+        str = get_str_cpu_list(cpus, ncpus);
+        printf("  IRQ %-5d %-30s CPU %s\n", irqs[i].irq, irqs[i].name == NULL ? "-" : irqs[i].name, str);
+        free(str);
+      }
+      if(hit) shown++;
+      free(cpus);
+    }
+    if(shown > ISOL_MAX_IRQS_SHOWN) printf("  ... and %d more\n", shown - ISOL_MAX_IRQS_SHOWN);
+  }
+
+  free(housekeeping);
+  free(isolated_online);
+  free(irq_affinity);
+  free(irq_effective);
+  free_irq_affinities(irqs, nirqs);
+  free(nocbs);
+  free_cmdline_sets(cs);
+  free(nohz);
+  free(isolated);
+  free_cpu_map(map);
+  return true;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __ISOLATION__
+#define __ISOLATION__
+
+#include <stdbool.h>
+
+bool print_cpu_isolation(void);
+
+#endif
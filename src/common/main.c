@@ -5,6 +5,34 @@
 #include "args.h"
 #include "printer.h"
 #include "global.h"
+#include "emit.h"
+
+#ifdef __linux__
+  #include "wakeup.h"
+  #include "pci.h"
+  #include "dram.h"
+  #include "freqpolicy.h"
+  #include "ranking.h"
+  #include "isolation.h"
+  #include "noise.h"
+  #include "gemmbench.h"
+  #include "dotbench.h"
+  #include "atomics.h"
+  #include "mitigations.h"
+  #include "perfcaps.h"
+  #include "resctrl.h"
+  #include "frontend.h"
+  #include "insnbench.h"
+  #include "gatherbench.h"
+  #include "cryptobench.h"
+  #include "cpumap.h"
+  #include "copybench.h"
+  #include "falseshare.h"
+  #include "plan.h"
+  #include "mlp.h"
+  #include "tlb.h"
+  #include "numa.h"
+#endif
 
 void print_help(char *argv[]) {
   const char **t = args_str;
@@ -57,6 +85,37 @@ void print_help(char *argv[]) {
   printf("      --%s %*s Measure FP32 FLOP/s + NEON OPS + (macOS) Metal GPU OPS and append all\n", t[ARG_ACCURATE_PP_ALL], (int) (max_len-strlen(t[ARG_ACCURATE_PP_ALL])), "");
 #endif
 #endif
+#ifdef __linux__
+  printf("      --%s %*s Measure the wake-up latency between pairs of cores and show it next to the idle states\n", t[ARG_WAKEUP_LATENCY], (int) (max_len-strlen(t[ARG_WAKEUP_LATENCY])), "");
+  printf("      --%s %*s Measure the latency and bandwidth between every pair of NUMA nodes and compare them with the SLIT\n", t[ARG_NUMA_MATRIX], (int) (max_len-strlen(t[ARG_NUMA_MATRIX])), "");
+  printf("      --%s %*s Show the TLB geometry and measure the TLB reach with base and huge pages\n", t[ARG_TLB_BENCH], (int) (max_len-strlen(t[ARG_TLB_BENCH])), "");
+  printf("      --%s %*s Measure the memory-level parallelism and the max bandwidth per core\n", t[ARG_MLP], (int) (max_len-strlen(t[ARG_MLP])), "");
+  printf("      --%s %*s Measure the false-sharing granularity (destructive interference size) between two cores\n", t[ARG_FALSE_SHARING], (int) (max_len-strlen(t[ARG_FALSE_SHARING])), "");
+  printf("      --%s %*s Print the CPUs where N worker threads should be pinned (see --%s)\n", t[ARG_PLAN_THREADS], (int) (max_len-strlen(t[ARG_PLAN_THREADS])), "", t[ARG_POLICY]);
+  printf("      --%s %*s Set the policy used by --%s (spread by default)\n", t[ARG_POLICY], (int) (max_len-strlen(t[ARG_POLICY])), "", t[ARG_PLAN_THREADS]);
+  printf("      --%s %*s Measure memcpy/memset throughput of each copy strategy (rep string, AVX2, NEON, SVE, MOPS...) from 16 B to 64 MiB\n", t[ARG_COPY_BENCH], (int) (max_len-strlen(t[ARG_COPY_BENCH])), "");
+  printf("      --%s %*s Measure AES-CTR/GCM, SHA-256, CRC32C and GHASH throughput in one core and in all cores\n", t[ARG_CRYPTO_BENCH], (int) (max_len-strlen(t[ARG_CRYPTO_BENCH])), "");
+  printf("      --%s %*s Measure gather, scatter and masked load/store throughput of each vector ISA (AVX2, AVX-512, SVE) against scalar loops\n", t[ARG_GATHER_BENCH], (int) (max_len-strlen(t[ARG_GATHER_BENCH])), "");
+  printf("      --%s %*s Measure the latency and throughput (in cycles) of a list of integer, FP, vector and shuffle instructions\n", t[ARG_INSN_TABLE], (int) (max_len-strlen(t[ARG_INSN_TABLE])), "");
+  printf("      --%s %*s Measure IPC of generated straight-line and branchy code of increasing size (L1i, uop cache and BTB knees)\n", t[ARG_FRONTEND_BENCH], (int) (max_len-strlen(t[ARG_FRONTEND_BENCH])), "");
+  printf("      --%s %*s Show the cache/memory bandwidth allocation and monitoring capabilities (Intel RDT, AMD PQoS, resctrl)\n", t[ARG_RDT], (int) (max_len-strlen(t[ARG_RDT])), "");
+  printf("      --%s %*s Measure the L3 bandwidth in a resctrl group restricted to this hex bitmask (implies --%s, needs root)\n", t[ARG_CAT_MASK], (int) (max_len-strlen(t[ARG_CAT_MASK])), "", t[ARG_RDT]);
+  printf("      --%s %*s Show the profiling capabilities: PMU counters, LBR/PEBS/IBS/SPE, perf_event_paranoid and what this user can access\n", t[ARG_PMU], (int) (max_len-strlen(t[ARG_PMU])), "");
+  printf("      --%s %*s Show the CPU vulnerability mitigations and measure their cost (syscall, context switch, indirect calls)\n", t[ARG_MITIGATIONS], (int) (max_len-strlen(t[ARG_MITIGATIONS])), "");
+  printf("      --%s %*s Measure fetch_add, CAS, exchange and ticket lock scaling with threads in the same core, L3, socket and across sockets\n", t[ARG_ATOMICS_BENCH], (int) (max_len-strlen(t[ARG_ATOMICS_BENCH])), "");
+  printf("      --%s %*s Measure int8/BF16 dot product and matrix multiply throughput (SDOT, SMMLA, BFDOT, BFMMLA and SVE) per core, cluster and all cores\n", t[ARG_DOTPROD_BENCH], (int) (max_len-strlen(t[ARG_DOTPROD_BENCH])), "");
+  printf("      --%s %*s Measure sustained SGEMM/DGEMM FLOPS with a cache-blocked microkernel per ISA (AVX2, AVX-512, NEON, SVE) in one core and all cores, compared with the peak\n", t[ARG_GEMM_BENCH], (int) (max_len-strlen(t[ARG_GEMM_BENCH])), "");
+  printf("      --%s %*s Measure OS noise (interruptions of a fixed work loop) in every CPU and relate it to the interrupts and isolcpus/nohz_full\n", t[ARG_OS_NOISE], (int) (max_len-strlen(t[ARG_OS_NOISE])), "");
+  printf("      --%s %*s Run --%s for this many seconds (%d by default)\n", t[ARG_NOISE_TIME], (int) (max_len-strlen(t[ARG_NOISE_TIME])), "", t[ARG_OS_NOISE], DEFAULT_NOISE_TIME);
+  printf("      --%s %*s Show the isolated, tickless and housekeeping CPUs and the IRQ affinities\n", t[ARG_CPU_ISOLATION], (int) (max_len-strlen(t[ARG_CPU_ISOLATION])), "");
+  printf("      --%s %*s Rank the cores by their CPPC, amd_pstate and cpufreq capabilities to find the fastest ones\n", t[ARG_CORE_RANKING], (int) (max_len-strlen(t[ARG_CORE_RANKING])), "");
+  printf("      --%s %*s Measure the single thread speed of each core in --%s\n", t[ARG_RANK_SCAN], (int) (max_len-strlen(t[ARG_RANK_SCAN])), "", t[ARG_CORE_RANKING]);
+  printf("      --%s %*s Show the cpufreq governor, EPP, boost and frequency caps of each CPU and the achievable peak performance\n", t[ARG_FREQ_POLICY], (int) (max_len-strlen(t[ARG_FREQ_POLICY])), "");
+  printf("      --%s %*s Show the memory devices from SMBIOS and the theoretical DRAM bandwidth of each socket\n", t[ARG_DRAM_INFO], (int) (max_len-strlen(t[ARG_DRAM_INFO])), "");
+  printf("      --%s %*s Measure the read bandwidth of each socket in --%s and compare it with the theoretical one\n", t[ARG_DRAM_BENCH], (int) (max_len-strlen(t[ARG_DRAM_BENCH])), "", t[ARG_DRAM_INFO]);
+  printf("      --%s %*s Print the PCIe link, NUMA node and IRQ locality of network, storage and accelerator devices\n", t[ARG_PCI_REPORT], (int) (max_len-strlen(t[ARG_PCI_REPORT])), "");
+#endif
+  printf("      --%s %*s Print the machine constants as a C/C++ header, a CMake or a pkg-config file\n", t[ARG_EMIT_HEADER], (int) (max_len-strlen(t[ARG_EMIT_HEADER])), "");
   printf("  -%c, --%s %*s Print this help and exit\n", c[ARG_HELP], t[ARG_HELP], (int) (max_len-strlen(t[ARG_HELP])), "");
   printf("  -%c, --%s %*s Print cpufetch version and exit\n", c[ARG_VERSION], t[ARG_VERSION], (int) (max_len-strlen(t[ARG_VERSION])), "");
 
@@ -77,6 +136,19 @@ void print_help(char *argv[]) {
   printf("  * \"retro\":     Old cpufetch style\n");
   printf("  * \"legacy\":    Fallback style for terminals that do not support colors\n");
 
+  printf("\nHEADER FORMATS: \n");
+  printf("  * \"c\":         C header with #define values (and constexpr values for C++)\n");
+  printf("  * \"cmake\":     CMake fragment with set() values and a list of compile definitions\n");
+  printf("  * \"pkgconfig\": pkg-config file with the values as variables and Cflags\n");
+
+#ifdef __linux__
+  printf("\nPOLICIES: \n");
+  printf("  * \"spread\":        Interleave sockets and L3 domains, using SMT siblings last\n");
+  printf("  * \"compact\":       Pack threads in as few cores and L3 domains as possible\n");
+  printf("  * \"per-l3\":        Fill one L3 domain at a time, using SMT siblings last within each domain\n");
+  printf("  * \"p-cores-first\": Performance cores first, then efficiency cores and finally SMT siblings\n");
+#endif
+
   printf("\nLOGOS: \n");
   printf("    cpufetch will try to adapt the logo size and the text to the terminal width. When the output (logo and text) is wider than\n");
   printf("    the terminal width, cpufetch will print a smaller version of the logo (if it exists). This behavior can be overridden by\n");
@@ -124,6 +196,10 @@ int main(int argc, char* argv[]) {
 
   set_log_level(verbose_enabled());
 
+#ifdef __linux__
+  save_initial_affinity();
+#endif
+
   struct cpuInfo* cpu = get_cpu_info();
   if(cpu == NULL)
     return EXIT_FAILURE;
@@ -146,6 +222,106 @@ int main(int argc, char* argv[]) {
   #endif
   }
 
+  if(get_emit_format() != EMIT_NONE) {
+    return print_machine_header(cpu, get_emit_format()) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+#ifdef __linux__
+  if(wakeup_latency_flag()) {
+    print_version(stdout);
+    return print_wakeup_latency() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(numa_matrix_flag()) {
+    print_version(stdout);
+    return print_numa_matrix() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(tlb_bench_flag()) {
+    print_version(stdout);
+    return print_tlb_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(mlp_flag()) {
+    print_version(stdout);
+    return print_mlp(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(get_plan_threads() > 0) {
+    print_version(stdout);
+    int policy = get_policy() == POLICY_INVALID ? POLICY_SPREAD : get_policy();
+    return print_thread_plan(get_plan_threads(), policy) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(false_sharing_flag()) {
+    print_version(stdout);
+    return print_false_sharing(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(copy_bench_flag()) {
+    print_version(stdout);
+    return print_copy_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(crypto_bench_flag()) {
+    print_version(stdout);
+    return print_crypto_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(gather_bench_flag()) {
+    print_version(stdout);
+    return print_gather_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(insn_table_flag()) {
+    print_version(stdout);
+    return print_insn_table(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(frontend_bench_flag()) {
+    print_version(stdout);
+    return print_frontend_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(rdt_flag()) {
+    print_version(stdout);
+    return print_rdt(cpu, get_cat_mask()) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(pmu_flag()) {
+    print_version(stdout);
+    return print_pmu_report(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(mitigations_flag()) {
+    print_version(stdout);
+    return print_mitigations(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(atomics_bench_flag()) {
+    print_version(stdout);
+    return print_atomics_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(dotprod_bench_flag()) {
+    print_version(stdout);
+    return print_dotprod_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(gemm_bench_flag()) {
+    print_version(stdout);
+    return print_gemm_benchmark(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(os_noise_flag()) {
+    print_version(stdout);
+    return print_os_noise(get_noise_time()) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(cpu_isolation_flag()) {
+    print_version(stdout);
+    return print_cpu_isolation() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(core_ranking_flag()) {
+    print_version(stdout);
+    return print_core_ranking(rank_scan_flag()) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(freq_policy_flag()) {
+    print_version(stdout);
+    return print_freq_policy(cpu) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(dram_info_flag()) {
+    print_version(stdout);
+    return print_dram_info(dram_bench_flag()) ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+  if(pci_report_flag()) {
+    print_version(stdout);
+    return print_pci_report() ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+#endif
+
   if(print_cpufetch(cpu, get_style(), get_colors(), show_full_cpu_name())) {
     return EXIT_SUCCESS;
   }
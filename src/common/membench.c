@@ -0,0 +1,146 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include "global.h"
+#include "bench.h"
+#include "membench.h"
+
+#define BITS_PER_LONG (8 * sizeof(unsigned long))
+
+volatile uint64_t membench_sink;
+
+// Simple xorshift generator; we do not need a good random
+// generator, only an order the hardware prefetchers cannot predict
+static uint64_t xorshift64(uint64_t* state) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+void* alloc_bench_buffer(size_t size) {
+  void* buf = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(buf == MAP_FAILED) {
+    printErr("mmap of %zu bytes failed: %s", size, strerror(errno));
+    return NULL;
+  }
+  return buf;
+}
+
+void free_bench_buffer(void* buf, size_t size) {
+  munmap(buf, size);
+}
+
+// Binds the (not yet touched) buffer to the NUMA node specified.
+// We use the syscall directly to avoid depending on libnuma.
+bool bind_buffer_to_node(void* buf, size_t size, int node) {
+  int maxnode = node + 1;
+  int nlongs = (maxnode + BITS_PER_LONG - 1) / BITS_PER_LONG;
+  unsigned long* nodemask = ecalloc(nlongs, sizeof(unsigned long));
+  nodemask[node / BITS_PER_LONG] |= 1UL << (node % BITS_PER_LONG);
+
+  // maxnode is off by one in the kernel implementation
+  if(syscall(SYS_mbind, buf, size, MPOL_BIND, nodemask, maxnode + 1, MPOL_MF_STRICT | MPOL_MF_MOVE) == -1) {
+    printErr("mbind to node %d: %s", node, strerror(errno));
+    free(nodemask);
+    return false;
+  }
+
+  free(nodemask);
+  return true;
+}
+
+void touch_buffer(void* buf, size_t size) {
+  long page_size = sysconf(_SC_PAGESIZE);
+  char* ptr = (char *) buf;
+  for(size_t i=0; i < size; i += page_size) ptr[i] = 1;
+}
+
+// Builds a random cyclic pointer chain with one element every stride
+// bytes and returns the first element of the chain
+void** build_chase(void* buf, size_t size, size_t stride) {
+  size_t n = size / stride;
+  size_t* order = emalloc(sizeof(size_t) * n);
+  uint64_t seed = 0x9E3779B97F4A7C15ULL;
+  char* base = (char *) buf;
+
+  for(size_t i=0; i < n; i++) order[i] = i;
+  for(size_t i=n-1; i > 0; i--) {
+    size_t j = xorshift64(&seed) % (i + 1);
+    size_t tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+  for(size_t i=0; i < n; i++) {
+    *(void **) (base + order[i] * stride) = base + order[(i+1) % n] * stride;
+  }
+
+  void** start = (void **) (base + order[0] * stride);
+  free(order);
+  return start;
+}
+
+// Returns the average latency (in ns) of the dependent loads
+double measure_chase_latency(void** start, uint64_t loads) {
+  void** p = start;
+
+  // Warm up (TLB, caches)
+  for(uint64_t i=0; i < loads / 10; i++) p = (void **) *p;
+
+  uint64_t t0 = get_time_ns();
+  for(uint64_t i=0; i < loads; i++) p = (void **) *p;
+  uint64_t t1 = get_time_ns();
+
+  membench_sink = (uint64_t) (uintptr_t) p;
+  return (double) (t1 - t0) / loads;
+}
+
+// Returns the read bandwidth (in bytes/s) of reading the buffer reps times
+double measure_read_bandwidth(void* buf, size_t size, int reps) {
+  uint64_t* ptr = (uint64_t *) buf;
+  size_t n = size / sizeof(uint64_t);
+  uint64_t acc0 = 0, acc1 = 0, acc2 = 0, acc3 = 0;
+
+  uint64_t t0 = get_time_ns();
+  for(int r=0; r < reps; r++) {
+    for(size_t i=0; i + 3 < n; i += 4) {
+      acc0 += ptr[i];
+      acc1 += ptr[i+1];
+      acc2 += ptr[i+2];
+      acc3 += ptr[i+3];
+    }
+  }
+  uint64_t t1 = get_time_ns();
+
+  membench_sink = acc0 + acc1 + acc2 + acc3;
+  if(t1 == t0) return -1.0;
+  return (double) size * reps / ((t1 - t0) / 1e9);
+}
+
+char* get_str_bandwidth(double bytes_per_second) {
+  const size_t max_size = 16;
+  char* str = ecalloc(max_size, sizeof(char));
+
+  if(bytes_per_second < 0)
+    snprintf(str, max_size, "%s", STRING_UNKNOWN);
+  else if(bytes_per_second >= 1e9)
+    snprintf(str, max_size, "%.1f GB/s", bytes_per_second / 1e9);
+  else
+    snprintf(str, max_size, "%.1f MB/s", bytes_per_second / 1e6);
+
+  return str;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,24 @@
+#ifndef __MEMBENCH__
+#define __MEMBENCH__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define CHASE_STRIDE 64
+
+// Prevents the compiler from removing the benchmark loops
+extern volatile uint64_t membench_sink;
+
+// Memory kernels shared by the benchmark modes (Linux only)
+
+void* alloc_bench_buffer(size_t size);
+void free_bench_buffer(void* buf, size_t size);
+bool bind_buffer_to_node(void* buf, size_t size, int node);
+void touch_buffer(void* buf, size_t size);
+void** build_chase(void* buf, size_t size, size_t stride);
+double measure_chase_latency(void** start, uint64_t loads);
+double measure_read_bandwidth(void* buf, size_t size, int reps);
+char* get_str_bandwidth(double bytes_per_second);
+
+#endif
@@ -0,0 +1,315 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/syscall.h>
+
+#include "global.h"
+#include "bench.h"
+#include "udev.h"
+#include "mitigations.h"
+#include "ibranchkernel.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+  #include "../x86/insn/insn.h"
+  #include "../x86/retpoline/retpoline.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+  #include "../arm/insn/insn.h"
+#endif
+
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  #include "insnbench.h"
+#endif
+
+#define SYSCALL_ITERS   (1000 * 1000)
+#define CTXSW_ITERS     (100 * 1000)
+#define IBRANCH_ITERS   (20 * 1000 * 1000)
+// Each benchmark is run MITIG_REPS times and the fastest run is kept
+#define MITIG_REPS      3
+
+// Kernel parameters that change the mitigations
+static const char* mitig_params[] = {
+  "mitigations=", "nospectre_v1", "nospectre_v2", "spectre_v2=", "spectre_v2_user=", "spectre_bhi=",
+  "retbleed=", "nopti", "pti=", "mds=", "tsx=", "tsx_async_abort=", "mmio_stale_data=", "l1tf=",
+  "srbds=", "gather_data_sampling=", "spec_rstack_overflow=", "spec_store_bypass_disable=",
+  "nospec_store_bypass_disable", "reg_file_data_sampling=", "indirect_target_selection=",
+};
+
+enum {
+  IBRANCH_PLAIN,
+  IBRANCH_RETPOLINE
+};
+
+struct ctxsw_args {
+  int fd_in;
+  int fd_out;
+  uint64_t iters;
+};
+
+volatile uint64_t mitig_sink;
+
+uint64_t run_ibranch(const uint8_t* seq, uint64_t iters) {
+  return ibranch_kernel(seq, iters);
+}
+
+// Returns the ns per indirect call of the kernel
+double measure_ibranch(const uint8_t* seq, int kind) {
+  double best = -1.0;
+
+  for(int r=0; r < MITIG_REPS; r++) {
+    uint64_t t0 = get_time_ns();
+#ifdef ARCH_X86
+    if(kind == IBRANCH_RETPOLINE) mitig_sink = run_ibranch_retpoline(seq, IBRANCH_ITERS);
+    else mitig_sink = run_ibranch(seq, IBRANCH_ITERS);
+#else
+    UNUSED(kind);
+    mitig_sink = run_ibranch(seq, IBRANCH_ITERS);
+#endif
+    uint64_t t1 = get_time_ns();
+    double ns = (double) (t1 - t0) / IBRANCH_ITERS;
+    if(best < 0.0 || ns < best) best = ns;
+  }
+
+  return best;
+}
+
+// Returns the ns per system call. getppid does almost no work (and
+// glibc does not cache it), so this is the cost of entering and
+// leaving the kernel, which is where most mitigations are applied
+double measure_syscall(void) {
+  double best = -1.0;
+
+  for(int r=0; r < MITIG_REPS; r++) {
+    uint64_t t0 = get_time_ns();
+    for(int i=0; i < SYSCALL_ITERS; i++) mitig_sink = syscall(SYS_getppid);
+    uint64_t t1 = get_time_ns();
+    double ns = (double) (t1 - t0) / SYSCALL_ITERS;
+    if(best < 0.0 || ns < best) best = ns;
+  }
+
+  return best;
+}
+
+void* ctxsw_thread(void* arg) {
+  struct ctxsw_args* args = (struct ctxsw_args *) arg;
+  char c;
+
+  for(uint64_t i=0; i < args->iters; i++) {
+    if(read(args->fd_in, &c, 1) != 1) break;
+    if(write(args->fd_out, &c, 1) != 1) break;
+  }
+  return NULL;
+}
+
+// Returns the ns per context switch (or -1 on error). Both threads are
+// pinned to the same CPU and exchange a byte through two pipes, so each
+// round trip forces two context switches
+double measure_ctxsw(int cpu) {
+  double best = -1.0;
+
+  for(int r=0; r < MITIG_REPS; r++) {
+    int ab[2], ba[2];
+    if(pipe(ab) == -1) {
+      printErr("pipe: %s", strerror(errno));
+      return -1.0;
+    }
+    if(pipe(ba) == -1) {
+      printErr("pipe: %s", strerror(errno));
+      close(ab[0]);
+      close(ab[1]);
+      return -1.0;
+    }
+
+    struct ctxsw_args args = { ab[0], ba[1], CTXSW_ITERS };
+    pthread_t thread;
+    bool created = create_thread_on_cpu(&thread, cpu, ctxsw_thread, &args);
+    bool ok = created;
+    char c = 0;
+
+    uint64_t t0 = get_time_ns();
+    for(uint64_t i=0; i < CTXSW_ITERS && ok; i++) {
+      ok = write(ab[1], &c, 1) == 1 && read(ba[0], &c, 1) == 1;
+    }
+    uint64_t t1 = get_time_ns();
+
+    close(ab[1]);
+    close(ba[0]);
+    if(created) pthread_join(thread, NULL);
+    close(ab[0]);
+    close(ba[1]);
+    if(!ok) {
+      printErr("Context switch benchmark failed");
+      return -1.0;
+    }
+
+    double ns = (double) (t1 - t0) / (2.0 * CTXSW_ITERS);
+    if(best < 0.0 || ns < best) best = ns;
+  }
+
+  return best;
+}
+
+int compare_names(const void* a, const void* b) {
+  return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+// Prints the files in the vulnerabilities directory in
+// alphabetical order, skipping the ones that do not apply
+void print_vulnerabilities(void) {
+  DIR* dir = opendir(_PATH_VULNERABILITIES);
+  if(dir == NULL) {
+    printWarn("opendir: %s: %s", _PATH_VULNERABILITIES, strerror(errno));
+    return;
+  }
+
+  int num = 0;
+  int max = 32;
+  char** names = emalloc(sizeof(char *) * max);
+  struct dirent* ent;
+  while((ent = readdir(dir)) != NULL) {
+    if(ent->d_name[0] == '.') continue;
+    if(num == max) {
+      max *= 2;
+      names = erealloc(names, sizeof(char *) * max);
+    }
+    names[num++] = strdup(ent->d_name);
+  }
+  closedir(dir);
+  qsort(names, num, sizeof(char *), compare_names);
+
+  int not_affected = 0;
+  printf("Vulnerabilities (%s):\n", _PATH_VULNERABILITIES);
+  for(int i=0; i < num; i++) {
+    char* status = get_str_vulnerability(names[i]);
+    if(status != NULL && strcmp(status, "Not affected") == 0) {
+      not_affected++;
+    }
+    else {
+      printf("  %-26s %s\n", names[i], status == NULL ? STRING_UNKNOWN : status);
+    }
+    free(status);
+    free(names[i]);
+  }
+  if(not_affected > 0)
+    printf("  Not affected by the other %d\n", not_affected);
+  free(names);
+
+  char* cmdline = get_str_from_file(_PATH_CMDLINE);
+  if(cmdline == NULL) return;
+  bool first = true;
+  for(char* tok = strtok(cmdline, " "); tok != NULL; tok = strtok(NULL, " ")) {
+    for(size_t i=0; i < sizeof(mitig_params) / sizeof(mitig_params[0]); i++) {
+      if(strncmp(tok, mitig_params[i], strlen(mitig_params[i])) == 0) {
+        printf("%s %s", first ? "Kernel parameters:" : "", tok);
+        first = false;
+        break;
+      }
+    }
+  }
+  if(!first) printf("\n");
+  free(cmdline);
+}
+
+#ifdef PR_SPEC_INDIRECT_BRANCH
+const char* get_str_spec_ctrl(int state) {
+  if(state < 0) return strerror(errno);
+  if(state == PR_SPEC_NOT_AFFECTED) return "not affected";
+  if(state & PR_SPEC_FORCE_DISABLE) return "disabled (forced)";
+  if(state & PR_SPEC_DISABLE) return "disabled";
+  if(state & PR_SPEC_PRCTL) return "enabled (controllable with prctl)";
+  return "enabled";
+}
+#endif
+
+void print_mitig_row(const char* name, double ns, double cycles_per_ns) {
+  if(ns < 0.0) return;
+  if(cycles_per_ns > 0.0)
+    printf("  %-40s %10.1f %10.0f\n", name, ns, ns * cycles_per_ns);
+  else
+    printf("  %-40s %10.1f %10s\n", name, ns, "-");
+}
+
+// Reports the mitigations applied by the kernel and measures the cost
+// of the operations that they slow down: entering the kernel (syscall),
+// switching between threads and indirect branches in user space (with
+// retpolines and with indirect branch speculation disabled)
+bool print_mitigations(struct cpuInfo* cpu) {
+  int32_t first_cpu = get_module_first_cpu(cpu, 0);
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    return false;
+  }
+
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  printf("Microarchitecture: %s\n", get_str_uarch(get_module(cpu, 0)));
+#endif
+  print_vulnerabilities();
+
+  double cycles_per_ns = 0.0;
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  if(insn_num_tests > 0) {
+    struct cycle_clock clk;
+    clk.fd = -1;
+    calibrate_cycle_clock(&clk);
+    cycles_per_ns = clk.cycles_per_ns;
+  }
+#endif
+
+  uint8_t* seq_one = ecalloc(IBRANCH_SEQ_LEN, sizeof(uint8_t));
+  uint8_t* seq_rand = emalloc(IBRANCH_SEQ_LEN * sizeof(uint8_t));
+  uint64_t state = 0x9E3779B97F4A7C15ULL;
+  for(int i=0; i < IBRANCH_SEQ_LEN; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    seq_rand[i] = state % IBRANCH_TARGETS;
+  }
+
+  printf("\ncpufetch is measuring the cost of the mitigations (CPU %d", first_cpu);
+  if(cycles_per_ns > 0.0) printf(", %.2f GHz", cycles_per_ns);
+  printf(")...\n");
+  printf("  %-40s %10s %10s\n", "Benchmark", "ns", "cycles");
+
+  print_mitig_row("syscall (getppid)", measure_syscall(), cycles_per_ns);
+  fflush(stdout);
+  double ctxsw = measure_ctxsw(first_cpu);
+  print_mitig_row("context switch (pipe, same CPU)", ctxsw, cycles_per_ns);
+  fflush(stdout);
+  double ib_one = measure_ibranch(seq_one, IBRANCH_PLAIN);
+  print_mitig_row("indirect call, 1 target", ib_one, cycles_per_ns);
+  print_mitig_row("indirect call, 16 random targets", measure_ibranch(seq_rand, IBRANCH_PLAIN), cycles_per_ns);
+
+#ifdef ARCH_X86
+  if(retpoline_compiled())
+    print_mitig_row("indirect call, 1 target (retpoline)", measure_ibranch(seq_one, IBRANCH_RETPOLINE), cycles_per_ns);
+#endif
+
+#ifdef PR_SPEC_INDIRECT_BRANCH
+  // With spectre_v2_user=prctl (or seccomp), a task can disable indirect
+  // branch speculation for itself, which enables STIBP and IBPB for it
+  int spec = prctl(PR_GET_SPECULATION_CTRL, PR_SPEC_INDIRECT_BRANCH, 0, 0, 0);
+  if(spec >= 0 && (spec & PR_SPEC_PRCTL) && !(spec & (PR_SPEC_DISABLE | PR_SPEC_FORCE_DISABLE))) {
+    if(prctl(PR_SET_SPECULATION_CTRL, PR_SPEC_INDIRECT_BRANCH, PR_SPEC_DISABLE, 0, 0) == 0) {
+      print_mitig_row("indirect call, 1 target (IB spec. off)", measure_ibranch(seq_one, IBRANCH_PLAIN), cycles_per_ns);
+      print_mitig_row("context switch (IB spec. off)", measure_ctxsw(first_cpu), cycles_per_ns);
+      prctl(PR_SET_SPECULATION_CTRL, PR_SPEC_INDIRECT_BRANCH, PR_SPEC_ENABLE, 0, 0);
+    }
+  }
+  printf("Indirect branch speculation: %s\n", get_str_spec_ctrl(spec));
+#endif
+
+  free(seq_one);
+  free(seq_rand);
+  return ctxsw >= 0.0;
+}
+
+#endif // #ifdef __linux__
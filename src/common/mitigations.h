@@ -0,0 +1,13 @@
+#ifndef __MITIGATIONS__
+#define __MITIGATIONS__
+
+#include "cpu.h"
+
+// Indirect call kernel: IBRANCH_SEQ_LEN (a power of two) calls to
+// IBRANCH_TARGETS functions, in the order given by a sequence
+#define IBRANCH_TARGETS 16
+#define IBRANCH_SEQ_LEN 4096
+
+bool print_mitigations(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,159 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+
+#include "global.h"
+#include "bench.h"
+#include "membench.h"
+#include "mlp.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+#elif ARCH_ARM
+  #include "../arm/uarch.h"
+#endif
+
+// Must be much bigger than the LLC, so that every load misses
+#define MLP_BUFFER_SIZE  (512UL * 1024 * 1024)
+#define MLP_LOADS        (4UL * 1024 * 1024)
+#define MLP_MAX_CHAINS   32
+
+static const int mlp_chains[] = { 1, 2, 3, 4, 6, 8, 10, 12, 16, 20, 24, 32 };
+#define MLP_NUM_STEPS    (int) (sizeof(mlp_chains) / sizeof(mlp_chains[0]))
+// Fraction of the max bandwidth considered saturated
+#define MLP_SATURATION   0.9
+
+size_t* build_random_order(size_t n) {
+  size_t* order = emalloc(sizeof(size_t) * n);
+  uint64_t seed = 0x2545F4914F6CDD1DULL;
+
+  for(size_t i=0; i < n; i++) order[i] = i;
+  for(size_t i=n-1; i > 0; i--) {
+    seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+    size_t j = seed % (i + 1);
+    size_t tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+  return order;
+}
+
+// Splits the random order of the lines of the buffer into nchains
+// independent cyclic chains, so that the loads of different chains
+// can be in flight at the same time
+void build_chains(void* buf, size_t* order, size_t n, int nchains, void*** starts) {
+  size_t per_chain = n / nchains;
+  char* base = (char *) buf;
+
+  for(int c=0; c < nchains; c++) {
+    size_t* chain = order + c * per_chain;
+    for(size_t i=0; i < per_chain; i++) {
+      *(void **) (base + chain[i] * CHASE_STRIDE) = base + chain[(i+1) % per_chain] * CHASE_STRIDE;
+    }
+    starts[c] = (void **) (base + chain[0] * CHASE_STRIDE);
+  }
+}
+
+// Returns the time (in ns) per step, where a step is one load in each chain
+double measure_chains(void*** starts, int nchains, uint64_t steps) {
+  void** p[MLP_MAX_CHAINS];
+  for(int c=0; c < nchains; c++) p[c] = starts[c];
+
+  uint64_t t0 = get_time_ns();
+  for(uint64_t i=0; i < steps; i++) {
+    for(int c=0; c < nchains; c++) p[c] = (void **) *p[c];
+  }
+  uint64_t t1 = get_time_ns();
+
+  uint64_t sink = 0;
+  for(int c=0; c < nchains; c++) sink += (uint64_t) (uintptr_t) p[c];
+  membench_sink = sink;
+
+  return (double) (t1 - t0) / steps;
+}
+
+bool print_mlp_module(struct cpuInfo* cpu, int module, void* buf, size_t* order) {
+  int32_t first_cpu = get_module_first_cpu(cpu, module);
+  void** starts[MLP_MAX_CHAINS];
+  double bandwidth[MLP_NUM_STEPS];
+  double latency = 0.0;
+  double max_bw = 0.0;
+  double max_mlp = 0.0;
+
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    return false;
+  }
+
+#if defined(ARCH_X86) || defined(ARCH_ARM)
+  printf("\n%s (CPU %d):\n", get_str_uarch(get_module(cpu, module)), first_cpu);
+#else
+  printf("\nCPU %d:\n", first_cpu);
+#endif
+  printf("  %6s %12s %12s %8s\n", "Chains", "ns/step", "Bandwidth", "MLP");
+
+  for(int s=0; s < MLP_NUM_STEPS; s++) {
+    int k = mlp_chains[s];
+    build_chains(buf, order, MLP_BUFFER_SIZE / CHASE_STRIDE, k, starts);
+    // Warm up the TLB and the page tables
+    measure_chains(starts, k, MLP_LOADS / k / 10);
+    double t = measure_chains(starts, k, MLP_LOADS / k);
+    if(k == 1) latency = t;
+
+    // Little's law: loads in flight = throughput * latency
+    double mlp = k * latency / t;
+    bandwidth[s] = k * CHASE_STRIDE / (t / 1e9);
+    if(bandwidth[s] > max_bw) max_bw = bandwidth[s];
+    if(mlp > max_mlp) max_mlp = mlp;
+
+    char* bw = get_str_bandwidth(bandwidth[s]);
+    printf("  %6d %9.1f ns %12s %8.1f\n", k, t, bw, mlp);
+    free(bw);
+  }
+
+  int saturation = MLP_MAX_CHAINS;
+  for(int s=MLP_NUM_STEPS-1; s >= 0; s--) {
+    if(bandwidth[s] >= max_bw * MLP_SATURATION) saturation = mlp_chains[s];
+  }
+
+  double stream_bw = measure_read_bandwidth(buf, MLP_BUFFER_SIZE, 2);
+  char* max_bw_str = get_str_bandwidth(max_bw);
+  char* stream_bw_str = get_str_bandwidth(stream_bw);
+  printf("  Idle latency: %.1f ns\n", latency);
+  printf("  Max MLP: %.1f outstanding misses (saturates at %d chains)\n", max_mlp, saturation);
+  printf("  Max bandwidth per core: %s (random), %s (sequential)\n", max_bw_str, stream_bw_str);
+  free(max_bw_str);
+  free(stream_bw_str);
+
+  return true;
+}
+
+// Measures the memory-level parallelism (number of cache misses that a
+// core can keep in flight) running 1..MLP_MAX_CHAINS independent pointer
+// chases from a single thread, for each module (core type) of the CPU.
+bool print_mlp(struct cpuInfo* cpu) {
+  void* buf = alloc_bench_buffer(MLP_BUFFER_SIZE);
+  if(buf == NULL) return false;
+  // Huge pages (if available) keep TLB misses out of the measurement
+  madvise(buf, MLP_BUFFER_SIZE, MADV_HUGEPAGE);
+  touch_buffer(buf, MLP_BUFFER_SIZE);
+
+  printf("cpufetch is measuring the memory-level parallelism (%lu MiB buffer)...\n", MLP_BUFFER_SIZE >> 20);
+
+  size_t* order = build_random_order(MLP_BUFFER_SIZE / CHASE_STRIDE);
+  bool ret = true;
+  for(int m=0; m < get_num_modules(cpu) && ret; m++) {
+    ret = print_mlp_module(cpu, m, buf, order);
+  }
+
+  free(order);
+  free_bench_buffer(buf, MLP_BUFFER_SIZE);
+  return ret;
+}
+
+#endif // #ifdef __linux__
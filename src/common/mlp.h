@@ -0,0 +1,8 @@
+#ifndef __MLP__
+#define __MLP__
+
+#include "cpu.h"
+
+bool print_mlp(struct cpuInfo* cpu);
+
+#endif
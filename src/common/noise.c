@@ -0,0 +1,467 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+
+#include "global.h"
+#include "udev.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "noise.h"
+
+// Length of each fixed work quantum. Every quantum that takes longer
+// than the fastest one by more than NOISE_THRESHOLD_NS is counted as
+// an interruption of the difference
+#define NOISE_QUANTUM_NS      1000
+#define NOISE_THRESHOLD_NS    1000
+#define NOISE_WARMUP_QUANTA   10000
+#define NOISE_CALIBRATE_NS    (20 * 1000 * 1000)
+// A core is noisy if it loses at least this many times the median and
+// at least NOISE_NOISY_MIN_PCT of the time, or NOISE_NOISY_MAX_PCT in
+// any case (when all the cores are equally noisy)
+#define NOISE_NOISY_FACTOR    2.0
+#define NOISE_NOISY_MIN_PCT   0.01
+#define NOISE_NOISY_MAX_PCT   1.0
+#define NOISE_TOP_IRQS        10
+#define NOISE_TOP_CORES       5
+
+// Histogram of the interruption length, in decades from 1us
+enum {
+  NOISE_BUCKET_1US,
+  NOISE_BUCKET_10US,
+  NOISE_BUCKET_100US,
+  NOISE_BUCKET_1MS,
+  NOISE_BUCKETS
+};
+
+static const char* noise_bucket_str[NOISE_BUCKETS] = {
+  [NOISE_BUCKET_1US]   = "1-10us",
+  [NOISE_BUCKET_10US]  = "10-100us",
+  [NOISE_BUCKET_100US] = "0.1-1ms",
+  [NOISE_BUCKET_1MS]   = ">1ms"
+};
+
+struct noise_worker {
+  int cpu;
+  uint64_t iters;       // Iterations of the work loop in a quantum
+  uint64_t duration;    // In cycles
+  uint64_t bucket_limit[NOISE_BUCKETS];
+  volatile bool* start;
+  // Results
+  uint64_t quanta;
+  uint64_t min_quantum;
+  uint64_t events;
+  uint64_t lost;
+  uint64_t max_lost;
+  uint64_t hist[NOISE_BUCKETS];
+  uint64_t sink;
+  char pad[64];
+};
+
+// Counts of each interrupt source (a line of /proc/interrupts) per CPU
+struct irq_stats {
+  int nirqs;
+  int ncpus;
+  char** labels;
+  uint64_t* counts;   // nirqs x ncpus
+};
+
+// The fixed amount of work: a dependency chain that the compiler
+// cannot vectorize nor remove
+static inline uint64_t noise_work(uint64_t iters, uint64_t x) {
+  for(uint64_t i=0; i < iters; i++) {
+    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    __asm volatile("" : "+r"(x));
+  }
+  return x;
+}
+
+void* noise_thread(void* arg) {
+  struct noise_worker* w = (struct noise_worker*) arg;
+  uint64_t x = (uint64_t) w->cpu;
+
+  while(!*w->start) cpu_relax();
+
+  // The fastest quantum (the one without interruptions) is the reference
+  uint64_t prev = get_cycles();
+  uint64_t min = UINT64_MAX;
+  for(int i=0; i < NOISE_WARMUP_QUANTA; i++) {
+    x = noise_work(w->iters, x);
+    uint64_t now = get_cycles();
+    if(now - prev < min) min = now - prev;
+    prev = now;
+  }
+
+  uint64_t end = prev + w->duration;
+  while(prev < end) {
+    x = noise_work(w->iters, x);
+    uint64_t now = get_cycles();
+    uint64_t t = now - prev;
+    prev = now;
+    w->quanta++;
+
+    if(t < min) {
+      min = t;
+      continue;
+    }
+    uint64_t lost = t - min;
+    if(lost < w->bucket_limit[0]) continue;
+
+    int b = 0;
+    while(b < NOISE_BUCKETS - 1 && lost >= w->bucket_limit[b+1]) b++;
+    w->hist[b]++;
+    w->events++;
+    w->lost += lost;
+    if(lost > w->max_lost) w->max_lost = lost;
+  }
+
+  w->min_quantum = min;
+  w->sink = x;
+  return NULL;
+}
+
+// Returns the cycle counter ticks per nanosecond
+double calibrate_cycles(void) {
+  uint64_t t0 = get_time_ns();
+  uint64_t c0 = get_cycles();
+  uint64_t t1;
+  do {
+    t1 = get_time_ns();
+  } while(t1 - t0 < NOISE_CALIBRATE_NS);
+  uint64_t c1 = get_cycles();
+  return (double) (c1 - c0) / (double) (t1 - t0);
+}
+
+// Returns the iterations of noise_work that take NOISE_QUANTUM_NS
+uint64_t calibrate_quantum(void) {
+  uint64_t iters = 1000;
+  uint64_t best = UINT64_MAX;
+  volatile uint64_t sink = 0;
+
+  for(int i=0; i < 100; i++) {
+    uint64_t t0 = get_time_ns();
+    sink += noise_work(iters * 100, sink);
+    uint64_t t = get_time_ns() - t0;
+    if(t < best) best = t;
+  }
+
+  uint64_t ret = best > 0 ? (uint64_t) ((double) NOISE_QUANTUM_NS * iters * 100 / best) : iters;
+  return ret > 0 ? ret : 1;
+}
+
+void free_irq_stats(struct irq_stats* st) {
+  if(st == NULL) return;
+  for(int i=0; i < st->nirqs; i++) free(st->labels[i]);
+  free(st->labels);
+  free(st->counts);
+  free(st);
+}
+
+// Builds the label of an interrupt source: the name of the line
+// followed by the device (the last field) for numbered IRQs, or the
+// description for the architecture specific ones (e.g., "LOC Local
+// timer interrupts")
+char* get_irq_label(const char* name, char* desc) {
+  while(isspace((unsigned char) *desc)) desc++;
+  int len = strlen(desc);
+  while(len > 0 && isspace((unsigned char) desc[len-1])) desc[--len] = '\0';
+
+  if(isdigit((unsigned char) name[0])) {
+    char* last = strrchr(desc, ' ');
+    if(last != NULL) desc = last + 1;
+  }
+
+  char* label = emalloc(sizeof(char) * (strlen(name) + strlen(desc) + 2));
+  sprintf(label, "%s%s%s", name, desc[0] == '\0' ? "" : " ", desc);
+
+  // Collapse the column padding
+  char* dst = label;
+  for(char* src = label; *src != '\0'; src++) {
+    if(*src == ' ' && dst > label && dst[-1] == ' ') continue;
+    *dst++ = *src;
+  }
+  *dst = '\0';
+  return label;
+}
+
+// Parses /proc/interrupts. The header lists the online CPUs (CPU0 CPU1
+// ...), and each line has the name of the source, one count per CPU
+// (some lines, like ERR, have just one) and its description
+struct irq_stats* get_irq_stats(int ncpus) {
+  int len;
+  char* buf = read_file(_PATH_INTERRUPTS, &len);
+  if(buf == NULL) {
+    printWarn("Unable to read %s", _PATH_INTERRUPTS);
+    return NULL;
+  }
+
+  struct irq_stats* st = emalloc(sizeof(struct irq_stats));
+  int* columns = emalloc(sizeof(int) * ncpus);
+  int ncolumns = 0;
+  int capacity = 64;
+  st->nirqs = 0;
+  st->ncpus = ncpus;
+  st->labels = emalloc(sizeof(char*) * capacity);
+  st->counts = emalloc(sizeof(uint64_t) * capacity * ncpus);
+
+  char* saveptr;
+  char* line = strtok_r(buf, "\n", &saveptr);
+  if(line != NULL) {
+    char* ptr = line;
+    while((ptr = strstr(ptr, "CPU")) != NULL && ncolumns < ncpus) {
+      columns[ncolumns++] = atoi(ptr + 3);
+      ptr += 3;
+    }
+    line = strtok_r(NULL, "\n", &saveptr);
+  }
+
+  for(; line != NULL; line = strtok_r(NULL, "\n", &saveptr)) {
+    char* colon = strchr(line, ':');
+    if(colon == NULL) continue;
+    *colon = '\0';
+    char* name = line;
+    while(isspace((unsigned char) *name)) name++;
+
+    if(st->nirqs == capacity) {
+      capacity *= 2;
+      st->labels = erealloc(st->labels, sizeof(char*) * capacity);
+      st->counts = erealloc(st->counts, sizeof(uint64_t) * capacity * ncpus);
+    }
+    uint64_t* counts = st->counts + (size_t) st->nirqs * ncpus;
+    memset(counts, 0, sizeof(uint64_t) * ncpus);
+
+    char* ptr = colon + 1;
+    for(int c=0; c < ncolumns; c++) {
+      char* end;
+      unsigned long long v = strtoull(ptr, &end, 10);
+      if(end == ptr) break;
+      if(columns[c] >= 0 && columns[c] < ncpus) counts[columns[c]] = v;
+      ptr = end;
+    }
+
+    st->labels[st->nirqs++] = get_irq_label(name, ptr);
+  }
+
+  free(columns);
+  free(buf);
+  return st;
+}
+
+// Returns the increment of the count of the source irq of after in
+// cpu, looking for the same source in before
+uint64_t get_irq_delta(struct irq_stats* before, struct irq_stats* after, int irq, int cpu) {
+  uint64_t now = after->counts[(size_t) irq * after->ncpus + cpu];
+  int i = irq < before->nirqs && strcmp(before->labels[irq], after->labels[irq]) == 0 ? irq : -1;
+  for(int j=0; j < before->nirqs && i == -1; j++) {
+    if(strcmp(before->labels[j], after->labels[irq]) == 0) i = j;
+  }
+  uint64_t prev = i == -1 ? 0 : before->counts[(size_t) i * before->ncpus + cpu];
+  return now >= prev ? now - prev : 0;
+}
+
+void print_noise_cpu_set(const char* name, bool* cpus, int ncpus, bool exists) {
+  char* str = get_str_cpu_list(cpus, ncpus);
+  printf("%-16s %s\n", name, !exists ? "not supported by the kernel" : str[0] == '\0' ? "none" : str);
+  free(str);
+}
+
+int compare_doubles(const void* a, const void* b) {
+  double x = *(const double *) a;
+  double y = *(const double *) b;
+  return (x > y) - (x < y);
+}
+
+// Runs a fixed-work-quantum (FWQ) loop pinned to every allowed CPU at
+// the same time for the given time. Quanta that take longer than the
+// fastest one are interruptions (interrupts, timer ticks, kernel
+// threads, other tasks), whose frequency and length are reported per
+// CPU, together with the interrupts received during the run and the
+// isolcpus and nohz_full settings, to find the noisy CPUs and sources.
+bool print_os_noise(int seconds) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) return false;
+
+  int ncpus = map->num_cpus;
+  bool* allowed = emalloc(sizeof(bool) * ncpus);
+  bool* isolated = emalloc(sizeof(bool) * ncpus);
+  bool* nohz = emalloc(sizeof(bool) * ncpus);
+  if(!get_allowed_cpus(allowed, ncpus)) {
+    free(allowed);
+    free(isolated);
+    free(nohz);
+    free_cpu_map(map);
+    return false;
+  }
+  bool has_isolated = get_cpu_list_from_file(_PATH_CPUS_ISOLATED, isolated, ncpus);
+  bool has_nohz = get_cpu_list_from_file(_PATH_CPUS_NOHZ_FULL, nohz, ncpus);
+
+  int nworkers = 0;
+  for(int i=0; i < ncpus; i++) {
+    if(allowed[i] && map->cpus[i].online) nworkers++;
+  }
+  if(nworkers == 0) {
+    printErr("No online CPU in the affinity mask of cpufetch");
+    free(allowed);
+    free(isolated);
+    free(nohz);
+    free_cpu_map(map);
+    return false;
+  }
+
+  printf("cpufetch is measuring OS noise on %d CPUs for %d seconds...\n", nworkers, seconds);
+  double cycles_per_ns = calibrate_cycles();
+  uint64_t iters = calibrate_quantum();
+
+  struct noise_worker* workers = ecalloc(nworkers, sizeof(struct noise_worker));
+  pthread_t* threads = emalloc(sizeof(pthread_t) * nworkers);
+  volatile bool start = false;
+  int created = 0;
+
+  for(int i=0, n=0; i < ncpus; i++) {
+    if(!allowed[i] || !map->cpus[i].online) continue;
+    struct noise_worker* w = &workers[n++];
+    w->cpu = i;
+    w->iters = iters;
+    w->duration = (uint64_t) (seconds * 1e9 * cycles_per_ns);
+    w->start = &start;
+    for(int b=0; b < NOISE_BUCKETS; b++) {
+      uint64_t ns = NOISE_THRESHOLD_NS;
+      for(int d=0; d < b; d++) ns *= 10;
+      w->bucket_limit[b] = (uint64_t) (ns * cycles_per_ns);
+    }
+  }
+
+  struct irq_stats* before = get_irq_stats(ncpus);
+  for(int i=0; i < nworkers; i++) {
+    if(!create_thread_on_cpu(&threads[i], workers[i].cpu, noise_thread, &workers[i])) break;
+    created++;
+  }
+  start = true;
+  for(int i=0; i < created; i++) pthread_join(threads[i], NULL);
+  struct irq_stats* after = get_irq_stats(ncpus);
+
+  bool ret = created == nworkers;
+  if(!ret) printErr("Failed to run the OS noise benchmark in all the CPUs");
+
+  if(ret) {
+    printf("Quantum of %.2f us; interruptions are quanta at least %d us longer than the fastest one\n\n",
+           workers[0].min_quantum / cycles_per_ns / 1000.0, NOISE_THRESHOLD_NS / 1000);
+    print_noise_cpu_set("Isolated CPUs:", isolated, ncpus, has_isolated);
+    print_noise_cpu_set("nohz_full CPUs:", nohz, ncpus, has_nohz);
+
+    double* lost = emalloc(sizeof(double) * nworkers);
+    for(int i=0; i < nworkers; i++) {
+      lost[i] = (double) workers[i].lost * 100.0 / (double) (workers[i].duration > 0 ? workers[i].duration : 1);
+    }
+    double* sorted = emalloc(sizeof(double) * nworkers);
+    memcpy(sorted, lost, sizeof(double) * nworkers);
+    qsort(sorted, nworkers, sizeof(double), compare_doubles);
+    double median = sorted[nworkers / 2];
+    double noisy_limit = median * NOISE_NOISY_FACTOR > NOISE_NOISY_MIN_PCT ? median * NOISE_NOISY_FACTOR : NOISE_NOISY_MIN_PCT;
+    if(noisy_limit > NOISE_NOISY_MAX_PCT) noisy_limit = NOISE_NOISY_MAX_PCT;
+
+    printf("\n  %5s %-5s %9s %8s %9s", "CPU", "Mode", "Events/s", "Lost", "Max (us)");
+    for(int b=0; b < NOISE_BUCKETS; b++) printf(" %9s", noise_bucket_str[b]);
+    printf(" %8s  %s\n", "IRQs/s", "Top IRQ source");
+
+    for(int i=0; i < nworkers; i++) {
+      struct noise_worker* w = &workers[i];
+      const char* mode = isolated[w->cpu] && nohz[w->cpu] ? "iso+N" : isolated[w->cpu] ? "iso" : nohz[w->cpu] ? "nohz" : "-";
+      uint64_t irqs = 0;
+      uint64_t top = 0;
+      int top_irq = -1;
+      for(int q=0; before != NULL && after != NULL && q < after->nirqs; q++) {
+        uint64_t d = get_irq_delta(before, after, q, w->cpu);
+        irqs += d;
+        if(d > top) {
+          top = d;
+          top_irq = q;
+        }
+      }
+
+      printf("%c %5d %-5s %9.1f %7.3f%% %9.1f", lost[i] >= noisy_limit ? '*' : ' ', w->cpu, mode,
+             w->events / (double) seconds, lost[i], w->max_lost / cycles_per_ns / 1000.0);
+      for(int b=0; b < NOISE_BUCKETS; b++) printf(" %9llu", (unsigned long long) w->hist[b]);
+      if(before != NULL && after != NULL) printf(" %8.1f  %s\n", irqs / (double) seconds, top_irq == -1 ? "-" : after->labels[top_irq]);
+      else printf(" %8s  -\n", "-");
+    }
+
+    // Isolated CPUs are expected to be quieter than the housekeeping ones
+    if(has_isolated || has_nohz) {
+      double sum[2] = { 0.0, 0.0 };
+      int count[2] = { 0, 0 };
+      for(int i=0; i < nworkers; i++) {
+        int c = isolated[workers[i].cpu] || nohz[workers[i].cpu];
+        sum[c] += workers[i].events / (double) seconds;
+        count[c]++;
+      }
+      if(count[0] > 0 && count[1] > 0) {
+        printf("\nIsolated/nohz_full CPUs: %.1f events/s on average, %.1f in the rest\n", sum[1] / count[1], sum[0] / count[0]);
+      }
+    }
+
+    printf("\nNoisiest CPUs (* above):");
+    bool* shown = ecalloc(nworkers, sizeof(bool));
+    int printed = 0;
+    for(; printed < NOISE_TOP_CORES; printed++) {
+      int top = -1;
+      for(int i=0; i < nworkers; i++) {
+        if(!shown[i] && lost[i] >= noisy_limit && (top == -1 || lost[i] > lost[top])) top = i;
+      }
+      if(top == -1) break;
+      shown[top] = true;
+      printf("%s CPU %d (%.3f%%)", printed == 0 ? "" : ",", workers[top].cpu, lost[top]);
+    }
+    printf("%s\n", printed == 0 ? " none" : "");
+    free(shown);
+
+    if(before != NULL && after != NULL) {
+      uint64_t* totals = ecalloc(after->nirqs, sizeof(uint64_t));
+      for(int q=0; q < after->nirqs; q++) {
+        for(int i=0; i < nworkers; i++) totals[q] += get_irq_delta(before, after, q, workers[i].cpu);
+      }
+
+      printf("\nInterrupt sources during the run (measured CPUs):\n");
+      bool* cpus = emalloc(sizeof(bool) * ncpus);
+      for(int k=0; k < NOISE_TOP_IRQS; k++) {
+        int top = -1;
+        for(int q=0; q < after->nirqs; q++) {
+          if(totals[q] > 0 && (top == -1 || totals[q] > totals[top])) top = q;
+        }
+        if(top == -1) {
+          if(k == 0) printf("  none\n");
+          break;
+        }
+
+        memset(cpus, 0, sizeof(bool) * ncpus);
+        for(int i=0; i < nworkers; i++) cpus[workers[i].cpu] = get_irq_delta(before, after, top, workers[i].cpu) > 0;
+        char* str = get_str_cpu_list(cpus, ncpus);
+        printf("  %10.1f/s  %-40.40s CPUs %s\n", totals[top] / (double) seconds, after->labels[top], str);
+        free(str);
+        totals[top] = 0;
+      }
+      free(cpus);
+      free(totals);
+    }
+
+    free(lost);
+    free(sorted);
+  }
+
+  free_irq_stats(before);
+  free_irq_stats(after);
+  free(workers);
+  free(threads);
+  free(allowed);
+  free(isolated);
+  free(nohz);
+  free_cpu_map(map);
+  return ret;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __NOISE__
+#define __NOISE__
+
+#include <stdbool.h>
+
+bool print_os_noise(int seconds);
+
+#endif
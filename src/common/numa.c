@@ -0,0 +1,441 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "global.h"
+#include "udev.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "membench.h"
+#include "numa.h"
+
+#define MAX_NODES          1024
+// The chase buffer must be much bigger than the LLC so that
+// (almost) every load goes to memory
+#define CHASE_BUFFER_SIZE  (256UL * 1024 * 1024)
+#define CHASE_LOADS        (4UL * 1024 * 1024)
+// The streaming threads slice one buffer, which is several times the
+// LLC of the CPUs (but at least STREAM_MIN_SIZE), and never more than
+// STREAM_BUFFER_SIZE per thread or half of the free memory of the node
+#define STREAM_BUFFER_SIZE (64UL * 1024 * 1024)
+#define STREAM_MIN_SIZE    (256UL * 1024 * 1024)
+#define STREAM_LLC_FACTOR  4
+#define STREAM_TIME_US     500000
+
+enum {
+  NUMA_IDLE_LATENCY,
+  NUMA_LOADED_LATENCY,
+  NUMA_BANDWIDTH,
+  NUMA_RELATIVE_LATENCY
+};
+
+struct numa_info {
+  int num_nodes;
+  int* nodes;        // Online node ids
+  bool* has_memory;  // Indexed by position in nodes
+  bool* has_cpus;    // Indexed by position in nodes
+  int* slit;         // num_nodes x num_nodes firmware distances (-1 if unknown)
+};
+
+struct stream_worker {
+  int cpu;
+  void* buf;
+  size_t size;
+  volatile bool* stop;
+  volatile bool* start;
+  uint64_t bytes;
+  uint64_t ns;
+  char pad[64];
+};
+
+struct numa_result {
+  double idle_latency;
+  double loaded_latency;
+  double bandwidth;
+};
+
+// Streams its buffer until told to stop, accumulating the bytes read
+void* stream_thread(void* arg) {
+  struct stream_worker* w = (struct stream_worker*) arg;
+
+  while(!*w->start) cpu_relax();
+
+  uint64_t t0 = get_time_ns();
+  do {
+    measure_read_bandwidth(w->buf, w->size, 1);
+    w->bytes += w->size;
+  } while(!*w->stop);
+  w->ns = get_time_ns() - t0;
+
+  return NULL;
+}
+
+bool fill_slit(struct numa_info* info) {
+  char path[_PATH_SYSFS_MAX_LEN];
+
+  for(int i=0; i < info->num_nodes * info->num_nodes; i++) info->slit[i] = -1;
+
+  for(int i=0; i < info->num_nodes; i++) {
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/node%d%s", _PATH_SYS_SYSTEM, _PATH_SYS_NODE, info->nodes[i], _PATH_NODE_DISTANCE);
+    char* buf = get_str_from_file(path);
+    if(buf == NULL) {
+      printWarn("Could not open '%s'", path);
+      continue;
+    }
+
+    // The kernel prints one distance per online node, in order
+    char* ptr = buf;
+    char* end;
+    for(int j=0; j < info->num_nodes; j++) {
+      long dist = strtol(ptr, &end, 10);
+      if(end == ptr) break;
+      info->slit[i * info->num_nodes + j] = dist;
+      ptr = end;
+    }
+    free(buf);
+  }
+
+  return true;
+}
+
+struct numa_info* get_numa_info(struct cpu_map* map) {
+  bool* online = ecalloc(MAX_NODES, sizeof(bool));
+  bool* memory = ecalloc(MAX_NODES, sizeof(bool));
+  char* buf;
+
+  if((buf = get_str_from_file(_PATH_NODES_ONLINE)) == NULL || parse_cpu_list(buf, online, MAX_NODES) <= 0) {
+    printErr("Could not read the online NUMA nodes from '%s'", _PATH_NODES_ONLINE);
+    free(buf);
+    free(online);
+    free(memory);
+    return NULL;
+  }
+  free(buf);
+
+  if((buf = get_str_from_file(_PATH_NODES_HAS_MEMORY)) == NULL || parse_cpu_list(buf, memory, MAX_NODES) <= 0) {
+    printWarn("Could not read the memory NUMA nodes from '%s', assuming all nodes have memory", _PATH_NODES_HAS_MEMORY);
+    memcpy(memory, online, sizeof(bool) * MAX_NODES);
+  }
+  free(buf);
+
+  struct numa_info* info = emalloc(sizeof(struct numa_info));
+  info->num_nodes = 0;
+  for(int n=0; n < MAX_NODES; n++) {
+    if(online[n]) info->num_nodes++;
+  }
+
+  info->nodes = emalloc(sizeof(int) * info->num_nodes);
+  info->has_memory = emalloc(sizeof(bool) * info->num_nodes);
+  info->has_cpus = ecalloc(info->num_nodes, sizeof(bool));
+  info->slit = emalloc(sizeof(int) * info->num_nodes * info->num_nodes);
+
+  for(int n=0, i=0; n < MAX_NODES; n++) {
+    if(!online[n]) continue;
+    info->nodes[i] = n;
+    info->has_memory[i] = memory[n];
+    for(int c=0; c < map->num_cpus; c++) {
+      if(map->cpus[c].online && map->cpus[c].node == n) info->has_cpus[i] = true;
+    }
+    i++;
+  }
+
+  fill_slit(info);
+
+  free(online);
+  free(memory);
+  return info;
+}
+
+void free_numa_info(struct numa_info* info) {
+  free(info->nodes);
+  free(info->has_memory);
+  free(info->has_cpus);
+  free(info->slit);
+  free(info);
+}
+
+void* alloc_node_buffer(size_t size, int node) {
+  void* buf = alloc_bench_buffer(size);
+  if(buf == NULL) return NULL;
+
+  if(!bind_buffer_to_node(buf, size, node)) {
+    free_bench_buffer(buf, size);
+    return NULL;
+  }
+  touch_buffer(buf, size);
+  return buf;
+}
+
+// Returns the free memory of the node in bytes, or 0 if it is unknown
+uint64_t get_node_free_memory(int node) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/node%d%s", _PATH_SYS_SYSTEM, _PATH_SYS_NODE, node, _PATH_NODE_MEMINFO);
+  char* buf = get_str_from_file(path);
+  if(buf == NULL) return 0;
+
+  // Format is "Node N MemFree:   123456 kB"
+  uint64_t ret = 0;
+  char* field = strstr(buf, "MemFree:");
+  if(field != NULL) ret = strtoull(field + strlen("MemFree:"), NULL, 10) * 1024;
+  free(buf);
+  return ret;
+}
+
+// Returns the size of the buffer shared by the streaming threads
+// running in cpus with the memory of mem_node
+size_t get_stream_size(struct cpu_map* map, int* cpus, int ncpus, int mem_node) {
+  // Sum of the LLCs used by the CPUs (one per distinct L3)
+  uint64_t llc = 0;
+  for(int i=0; i < ncpus; i++) {
+    bool seen = false;
+    for(int j=0; j < i && !seen; j++) seen = map->cpus[cpus[j]].l3 == map->cpus[cpus[i]].l3;
+    if(seen) continue;
+    long size = get_l3_cache_size(cpus[i]);
+    if(size <= 0) size = get_l2_cache_size(cpus[i]);
+    if(size > 0) llc += size;
+  }
+
+  uint64_t size = llc * STREAM_LLC_FACTOR;
+  if(size < STREAM_MIN_SIZE) size = STREAM_MIN_SIZE;
+  if(size > (uint64_t) ncpus * STREAM_BUFFER_SIZE) size = (uint64_t) ncpus * STREAM_BUFFER_SIZE;
+
+  uint64_t free_mem = get_node_free_memory(mem_node);
+  if(free_mem > 0 && size > free_mem / 2) {
+    size = free_mem / 2;
+    if(size < llc * 2) printWarn("Node %d has %lu MiB free, the bandwidth may include cache hits", mem_node, (unsigned long) (free_mem >> 20));
+  }
+
+  // Every thread gets the same number of whole pages
+  long page_size = sysconf(_SC_PAGESIZE);
+  uint64_t slice = size / ncpus / page_size * page_size;
+  if(slice < (uint64_t) page_size) slice = page_size;
+  return slice * ncpus;
+}
+
+// Runs the streaming threads in the CPUs specified, each one reading its
+// slice of a buffer bound to mem_node. If chase is not NULL, the latency is measured from
+// the current thread while the streaming threads are running; otherwise
+// it just waits and returns the aggregated bandwidth.
+bool run_stream_workers(struct cpu_map* map, int* cpus, int ncpus, int mem_node, void** chase, double* latency, double* bandwidth) {
+  size_t size = get_stream_size(map, cpus, ncpus, mem_node);
+  char* buf = alloc_node_buffer(size, mem_node);
+  if(buf == NULL) return false;
+
+  struct stream_worker* workers = ecalloc(ncpus, sizeof(struct stream_worker));
+  pthread_t* threads = emalloc(sizeof(pthread_t) * ncpus);
+  volatile bool start = false;
+  volatile bool stop = false;
+  bool ret = true;
+  int created = 0;
+
+  for(int i=0; i < ncpus; i++) {
+    workers[i].cpu = cpus[i];
+    workers[i].size = size / ncpus;
+    workers[i].buf = buf + i * workers[i].size;
+    workers[i].start = &start;
+    workers[i].stop = &stop;
+  }
+
+  for(int i=0; i < ncpus && ret; i++) {
+    if(!create_thread_on_cpu(&threads[i], cpus[i], stream_thread, &workers[i])) ret = false;
+    else created++;
+  }
+
+  start = true;
+  if(ret && chase != NULL) {
+    *latency = measure_chase_latency(chase, CHASE_LOADS);
+  }
+  else {
+    sleep_us(STREAM_TIME_US);
+  }
+  stop = true;
+
+  for(int i=0; i < created; i++) pthread_join(threads[i], NULL);
+
+  if(ret && bandwidth != NULL) {
+    *bandwidth = 0.0;
+    for(int i=0; i < ncpus; i++) {
+      if(workers[i].ns > 0) *bandwidth += (double) workers[i].bytes / (workers[i].ns / 1e9);
+    }
+  }
+
+  free_bench_buffer(buf, size);
+  free(workers);
+  free(threads);
+  return ret;
+}
+
+// Measures the idle latency, the loaded latency (while the rest of the
+// CPUs of the node are streaming) and the aggregated read bandwidth of
+// the allowed CPUs of cpu_node accessing the memory of mem_node. If no
+// CPU of the node is allowed, the results are left as unknown (-1).
+bool measure_numa_pair(struct cpu_map* map, bool* allowed, int cpu_node, int mem_node, struct numa_result* res) {
+  int* cpus = emalloc(sizeof(int) * map->num_cpus);
+  int ncpus = 0;
+
+  for(int c=0; c < map->num_cpus; c++) {
+    if(map->cpus[c].online && allowed[c] && map->cpus[c].node == cpu_node) cpus[ncpus++] = c;
+  }
+
+  res->idle_latency = -1.0;
+  res->loaded_latency = -1.0;
+  res->bandwidth = -1.0;
+  if(ncpus == 0) {
+    free(cpus);
+    return true;
+  }
+
+  if(!bind_to_cpu(cpus[0])) {
+    printErr("Failed binding the process to CPU %d", cpus[0]);
+    free(cpus);
+    return false;
+  }
+
+  void* buf = alloc_bench_buffer(CHASE_BUFFER_SIZE);
+  if(buf == NULL) {
+    free(cpus);
+    return false;
+  }
+  // Huge pages (if available) keep TLB misses out of the measured latency
+  madvise(buf, CHASE_BUFFER_SIZE, MADV_HUGEPAGE);
+  if(!bind_buffer_to_node(buf, CHASE_BUFFER_SIZE, mem_node)) {
+    free_bench_buffer(buf, CHASE_BUFFER_SIZE);
+    free(cpus);
+    return false;
+  }
+
+  void** chase = build_chase(buf, CHASE_BUFFER_SIZE, CHASE_STRIDE);
+  res->idle_latency = measure_chase_latency(chase, CHASE_LOADS);
+
+  bool ret = true;
+  if(ncpus > 1) {
+    ret = run_stream_workers(map, cpus + 1, ncpus - 1, mem_node, chase, &res->loaded_latency, NULL);
+  }
+  if(ret) {
+    ret = run_stream_workers(map, cpus, ncpus, mem_node, NULL, NULL, &res->bandwidth);
+  }
+
+  free_bench_buffer(buf, CHASE_BUFFER_SIZE);
+  free(cpus);
+  return ret;
+}
+
+void print_matrix_header(struct numa_info* info, const char* title) {
+  printf("\n%s:\n", title);
+  printf("  %-8s", "CPU\\Mem");
+  for(int j=0; j < info->num_nodes; j++) {
+    if(info->has_memory[j]) printf(" %10s%d", "node", info->nodes[j]);
+  }
+  printf("\n");
+}
+
+// Prints one of the measured matrices. NUMA_RELATIVE_LATENCY scales
+// the latency as the SLIT does (local access = 10)
+void print_numa_results(struct numa_info* info, struct numa_result* res, const char* title, int kind) {
+  print_matrix_header(info, title);
+
+  for(int i=0; i < info->num_nodes; i++) {
+    if(!info->has_cpus[i]) continue;
+    printf("  node%-4d", info->nodes[i]);
+
+    for(int j=0; j < info->num_nodes; j++) {
+      if(!info->has_memory[j]) continue;
+      struct numa_result* r = &res[i * info->num_nodes + j];
+      struct numa_result* local = info->has_memory[i] ? &res[i * info->num_nodes + i] : NULL;
+
+      if(r->idle_latency < 0) {
+        // None of the CPUs of the node can be used by this process
+        printf(" %11s", "-");
+      }
+      else if(kind == NUMA_IDLE_LATENCY) {
+        printf(" %8.1f ns", r->idle_latency);
+      }
+      else if(kind == NUMA_LOADED_LATENCY) {
+        if(r->loaded_latency < 0) printf(" %11s", "-");
+        else printf(" %8.1f ns", r->loaded_latency);
+      }
+      else if(kind == NUMA_BANDWIDTH) {
+        char* bw = get_str_bandwidth(r->bandwidth);
+        printf(" %11s", bw);
+        free(bw);
+      }
+      else {
+        int slit = info->slit[i * info->num_nodes + j];
+        if(local == NULL || local->idle_latency <= 0) printf(" %11s", "-");
+        else printf(" %5.0f (%3d)", 10.0 * r->idle_latency / local->idle_latency, slit);
+      }
+    }
+    printf("\n");
+  }
+}
+
+// Measures the memory latency and bandwidth between every pair of
+// (CPU node, memory node) and prints them next to the distances
+// reported by the firmware (SLIT), which are frequently inaccurate.
+bool print_numa_matrix(void) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+
+  struct numa_info* info = get_numa_info(map);
+  if(info == NULL) {
+    free_cpu_map(map);
+    return false;
+  }
+
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  if(!get_allowed_cpus(allowed, map->num_cpus)) {
+    free(allowed);
+    free_numa_info(info);
+    free_cpu_map(map);
+    return false;
+  }
+
+  int n = info->num_nodes;
+  struct numa_result* res = ecalloc(n * n, sizeof(struct numa_result));
+  bool ret = true;
+
+  printf("cpufetch is measuring the NUMA latency and bandwidth (%d nodes)...\n", n);
+
+  for(int i=0; i < n && ret; i++) {
+    if(!info->has_cpus[i]) continue;
+    for(int j=0; j < n && ret; j++) {
+      if(!info->has_memory[j]) continue;
+      ret = measure_numa_pair(map, allowed, info->nodes[i], info->nodes[j], &res[i * n + j]);
+    }
+  }
+
+  if(ret) {
+    print_matrix_header(info, "Firmware distances (SLIT)");
+    for(int i=0; i < n; i++) {
+      if(!info->has_cpus[i]) continue;
+      printf("  node%-4d", info->nodes[i]);
+      for(int j=0; j < n; j++) {
+        if(info->has_memory[j]) printf(" %11d", info->slit[i * n + j]);
+      }
+      printf("\n");
+    }
+
+    print_numa_results(info, res, "Idle latency", NUMA_IDLE_LATENCY);
+    print_numa_results(info, res, "Loaded latency (rest of the node streaming)", NUMA_LOADED_LATENCY);
+    print_numa_results(info, res, "Read bandwidth (all CPUs of the node)", NUMA_BANDWIDTH);
+    print_numa_results(info, res, "Measured distance, SLIT scale (firmware value)", NUMA_RELATIVE_LATENCY);
+  }
+
+  free(res);
+  free(allowed);
+  free_numa_info(info);
+  free_cpu_map(map);
+  return ret;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,11 @@
+#ifndef __NUMA__
+#define __NUMA__
+
+#include <stdbool.h>
+
+#include "cpumap.h"
+
+bool run_stream_workers(struct cpu_map* map, int* cpus, int ncpus, int mem_node, void** chase, double* latency, double* bandwidth);
+bool print_numa_matrix(void);
+
+#endif
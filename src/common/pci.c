@@ -41,8 +41,8 @@ struct pci_devices * get_pci_paths(void) {
 
   struct pci_devices * pci = emalloc(sizeof(struct pci_devices));
   pci->num_devices = numDirs;
-  pci->devices = emalloc(sizeof(struct pci_device) * pci->num_devices);
-  char * full_path = emalloc(PATH_MAX * sizeof(char));
+  pci->devices = emalloc(sizeof(struct pci_device *) * pci->num_devices);
+  char full_path[PATH_MAX];
   struct stat stbuf;
   int i = 0;
 
@@ -55,8 +55,7 @@ struct pci_devices * get_pci_paths(void) {
       return NULL;
     }
 
-    memset(full_path, 0, PATH_MAX * sizeof(char));
-    snprintf(full_path, min(strlen(PCI_PATH) + strlen(dp->d_name) + 1, PATH_MAX), "%s%s", PCI_PATH, dp->d_name);    
+    snprintf(full_path, PATH_MAX, "%s%s", PCI_PATH, dp->d_name);
 
     if (stat(full_path, &stbuf) == -1) {
       perror("stat");
@@ -76,6 +75,8 @@ struct pci_devices * get_pci_paths(void) {
     return NULL;
   }
 
+  closedir(dirp);
+  pci->num_devices = i;
   return pci;
 }
 
@@ -99,6 +100,7 @@ void populate_pci_devices(struct pci_devices * pci) {
     }
     else {
       dev->vendor_id = strtol(buf, NULL, 16);
+      free(buf);
     }
 
     // Read device_id
@@ -111,6 +113,7 @@ void populate_pci_devices(struct pci_devices * pci) {
     }
     else {
       dev->device_id = strtol(buf, NULL, 16);
+      free(buf);
     }
 
     free(vendor_id_path);
@@ -131,3 +134,372 @@ struct pci_devices * get_pci_devices(void) {
 
   return pci;
 }
+
+#ifdef __linux__
+
+#include <ctype.h>
+#include <unistd.h>
+#include <limits.h>
+#include "cpumap.h"
+#include "membench.h"
+
+#define PCI_CLASS_STORAGE      0x01
+#define PCI_CLASS_NETWORK      0x02
+#define PCI_CLASS_DISPLAY      0x03
+#define PCI_CLASS_COPROCESSOR  0x0B
+#define PCI_CLASS_ACCELERATOR  0x12
+
+#define PCI_MAX_IRQS           4096
+
+// Subclasses (class code without the programming interface) that are
+// relevant for performance
+static const struct {
+  uint16_t class;
+  const char* name;
+} pci_classes[] = {
+  { 0x0100, "SCSI"        },
+  { 0x0104, "RAID"        },
+  { 0x0106, "SATA"        },
+  { 0x0107, "SAS"         },
+  { 0x0108, "NVMe"        },
+  { 0x0180, "Storage"     },
+  { 0x0200, "Ethernet"    },
+  { 0x0207, "InfiniBand"  },
+  { 0x0280, "Network"     },
+  { 0x0300, "VGA"         },
+  { 0x0302, "3D"          },
+  { 0x0380, "Display"     },
+  { 0x0B40, "Coprocessor" },
+  { 0x1200, "Accelerator" },
+};
+
+// Link of a PCIe function, or of the port it is connected to
+struct pci_link {
+  double cur_speed;  // GT/s (0 if unknown)
+  double max_speed;
+  int cur_width;
+  int max_width;
+};
+
+enum {
+  PCI_FLAG_DOWNTRAINED,
+  PCI_FLAG_SLOT,
+  PCI_FLAG_REMOTE_IRQ,
+  PCI_FLAG_NO_NODE,
+  PCI_NUM_FLAGS
+};
+
+static const char* pci_flag_str[] = {
+  [PCI_FLAG_DOWNTRAINED] = "downtrained",
+  [PCI_FLAG_SLOT]        = "slot",
+  [PCI_FLAG_REMOTE_IRQ]  = "remote-irq",
+  [PCI_FLAG_NO_NODE]     = "no-node",
+};
+
+static const char* pci_flag_desc[] = {
+  [PCI_FLAG_DOWNTRAINED] = "link running below what both the device and the port support",
+  [PCI_FLAG_SLOT]        = "device supports a slower or narrower link than its slot",
+  [PCI_FLAG_REMOTE_IRQ]  = "interrupts handled by CPUs of another NUMA node",
+  [PCI_FLAG_NO_NODE]     = "the firmware does not report the NUMA node of the device",
+};
+
+const char* get_str_pci_class(uint32_t class) {
+  for(size_t i=0; i < sizeof(pci_classes) / sizeof(pci_classes[0]); i++) {
+    if(pci_classes[i].class == (class >> 8)) return pci_classes[i].name;
+  }
+  return NULL;
+}
+
+bool is_performance_pci_class(uint32_t class) {
+  int base = class >> 16;
+  return base == PCI_CLASS_STORAGE || base == PCI_CLASS_NETWORK || base == PCI_CLASS_DISPLAY ||
+         base == PCI_CLASS_COPROCESSOR || base == PCI_CLASS_ACCELERATOR;
+}
+
+char* get_pci_attr(const char* dir, const char* attr) {
+  char path[PATH_MAX];
+  if(snprintf(path, PATH_MAX, "%s/%s", dir, attr) >= PATH_MAX) return NULL;
+  return get_str_from_file(path);
+}
+
+long get_pci_value(const char* dir, const char* attr, int base) {
+  char* str = get_pci_attr(dir, attr);
+  if(str == NULL) return -1;
+  char* end;
+  long ret = strtol(str, &end, base);
+  if(end == str) ret = -1;
+  free(str);
+  return ret;
+}
+
+// Link speeds are reported as "16.0 GT/s PCIe" (or "Unknown")
+double get_pci_speed(const char* dir, const char* attr) {
+  char* str = get_pci_attr(dir, attr);
+  if(str == NULL) return 0.0;
+  double ret = atof(str);
+  free(str);
+  return ret;
+}
+
+bool get_pci_link(const char* dir, struct pci_link* link) {
+  link->cur_speed = get_pci_speed(dir, "current_link_speed");
+  link->max_speed = get_pci_speed(dir, "max_link_speed");
+  link->cur_width = (int) get_pci_value(dir, "current_link_width", 10);
+  link->max_width = (int) get_pci_value(dir, "max_link_width", 10);
+  return link->max_speed > 0 && link->max_width > 0;
+}
+
+int get_pcie_gen(double speed) {
+  static const double speeds[] = { 2.5, 5.0, 8.0, 16.0, 32.0, 64.0 };
+  for(int i=0; i < 6; i++) {
+    if(speed < speeds[i] * 1.01) return i+1;
+  }
+  return 0;
+}
+
+// Bandwidth per direction (bytes/s), after the line encoding: 8b/10b
+// up to Gen2, 128b/130b in Gen3-5 and FLIT mode (242/256) in Gen6
+double get_pcie_bandwidth(double speed, int width) {
+  double efficiency = speed <= 5.0 ? 8.0 / 10 : (speed <= 32.0 ? 128.0 / 130 : 242.0 / 256);
+  return speed * 1e9 * width * efficiency / 8;
+}
+
+void format_pcie_link(char* buf, size_t size, double speed, int width) {
+  if(speed <= 0 || width <= 0) snprintf(buf, size, "-");
+  else snprintf(buf, size, "Gen%d x%d", get_pcie_gen(speed), width);
+}
+
+// Returns the name of the interface of the device (e.g., eth0, nvme0
+// or vda), which is also looked for under virtio devices
+char* get_pci_iface(const char* dir, int depth) {
+  static const char* subdirs[] = { "net", "nvme", "block", "drm" };
+  char path[PATH_MAX];
+
+  for(size_t i=0; i < sizeof(subdirs) / sizeof(subdirs[0]); i++) {
+    if(snprintf(path, PATH_MAX, "%s/%s", dir, subdirs[i]) >= PATH_MAX) continue;
+    DIR* d = opendir(path);
+    if(d == NULL) continue;
+    struct dirent* ent;
+    char* name = NULL;
+    while((ent = readdir(d)) != NULL && name == NULL) {
+      if(ent->d_name[0] != '.') name = strdup(ent->d_name);
+    }
+    closedir(d);
+    if(name != NULL) return name;
+  }
+
+  if(depth > 0) return NULL;
+  DIR* d = opendir(dir);
+  if(d == NULL) return NULL;
+  struct dirent* ent;
+  char* name = NULL;
+  while((ent = readdir(d)) != NULL && name == NULL) {
+    if(strncmp(ent->d_name, "virtio", 6) != 0) continue;
+    if(snprintf(path, PATH_MAX, "%s/%s", dir, ent->d_name) >= PATH_MAX) continue;
+    name = get_pci_iface(path, depth + 1);
+  }
+  closedir(d);
+  return name;
+}
+
+char* get_pci_driver(const char* dir) {
+  char path[PATH_MAX];
+  char target[PATH_MAX];
+  if(snprintf(path, PATH_MAX, "%s/driver", dir) >= PATH_MAX) return NULL;
+  ssize_t len = readlink(path, target, PATH_MAX - 1);
+  if(len <= 0) return NULL;
+  target[len] = '\0';
+  char* slash = strrchr(target, '/');
+  return strdup(slash == NULL ? target : slash + 1);
+}
+
+// Counts the interrupts (MSI/MSI-X vectors, or the legacy one) of the
+// device whose effective affinity is in the node (local) or entirely in
+// other nodes (remote)
+void count_pci_irqs(const char* dir, struct cpu_map* map, int node, int* local, int* remote) {
+  char path[PATH_MAX];
+  bool* cpus = emalloc(sizeof(bool) * map->num_cpus);
+  int* irqs = emalloc(sizeof(int) * PCI_MAX_IRQS);
+  int nirqs = 0;
+  *local = 0;
+  *remote = 0;
+
+  DIR* d = NULL;
+  if(snprintf(path, PATH_MAX, "%s/msi_irqs", dir) < PATH_MAX) d = opendir(path);
+  if(d != NULL) {
+    struct dirent* ent;
+    while((ent = readdir(d)) != NULL && nirqs < PCI_MAX_IRQS) {
+      if(isdigit((unsigned char) ent->d_name[0])) irqs[nirqs++] = atoi(ent->d_name);
+    }
+    closedir(d);
+  }
+  if(nirqs == 0) {
+    long irq = get_pci_value(dir, "irq", 10);
+    if(irq > 0) irqs[nirqs++] = (int) irq;
+  }
+
+  for(int i=0; i < nirqs; i++) {
+    snprintf(path, PATH_MAX, "%s/%d/effective_affinity_list", _PATH_IRQ, irqs[i]);
+    if(!get_cpu_list_from_file(path, cpus, map->num_cpus)) {
+      snprintf(path, PATH_MAX, "%s/%d/smp_affinity_list", _PATH_IRQ, irqs[i]);
+      if(!get_cpu_list_from_file(path, cpus, map->num_cpus)) continue;
+    }
+
+    bool any = false;
+    bool in_node = false;
+    for(int c=0; c < map->num_cpus; c++) {
+      if(!cpus[c]) continue;
+      any = true;
+      if(map->cpus[c].node == node) in_node = true;
+    }
+    if(!any) continue;
+    if(in_node) (*local)++;
+    else (*remote)++;
+  }
+
+  free(irqs);
+  free(cpus);
+}
+
+void free_pci_devices(struct pci_devices* pci) {
+  for(int i=0; i < pci->num_devices; i++) {
+    free(pci->devices[i]->path);
+    free(pci->devices[i]);
+  }
+  free(pci->devices);
+  free(pci);
+}
+
+// Prints the network, storage and accelerator functions with their
+// NUMA node, local CPUs, PCIe link (current, max of the device and max
+// of the port above it) and bandwidth, and where their interrupts are
+// handled. Links running degraded, devices in a faster slot than they
+// support, and devices whose interrupts are handled by CPUs of other
+// nodes are flagged.
+bool print_pci_report(void) {
+  struct pci_devices* pci = get_pci_devices();
+  if(pci == NULL) {
+    printErr("Unable to read the PCI devices from %s", PCI_PATH);
+    return false;
+  }
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    free_pci_devices(pci);
+    return false;
+  }
+
+  bool* flagged = ecalloc((size_t) PCI_NUM_FLAGS * pci->num_devices, sizeof(bool));
+  int shown = 0;
+  char dir[PATH_MAX];
+  char port[PATH_MAX];
+
+  printf("  %-12s %-11s %-22s %4s %-12s %-9s %-9s %-9s %10s %9s  %s\n", "Address", "Class", "Device", "Node",
+         "Local CPUs", "Link", "Max", "Slot", "Bandwidth", "IRQs L/R", "Flags");
+
+  for(int i=0; i < pci->num_devices; i++) {
+    struct pci_device* dev = pci->devices[i];
+    snprintf(dir, PATH_MAX, "%s%s", PCI_PATH, dev->path);
+    long class = get_pci_value(dir, "class", 16);
+    if(class < 0 || !is_performance_pci_class((uint32_t) class)) continue;
+    shown++;
+
+    long node = get_pci_value(dir, "numa_node", 10);
+    char* cpulist = get_pci_attr(dir, "local_cpulist");
+    char* iface = get_pci_iface(dir, 0);
+    char* driver = get_pci_driver(dir);
+    const char* class_name = get_str_pci_class((uint32_t) class);
+
+    // The port is the parent in the sysfs hierarchy (the bridge)
+    struct pci_link link;
+    struct pci_link slot;
+    bool has_link = get_pci_link(dir, &link);
+    bool has_slot = false;
+    if(realpath(dir, port) != NULL) {
+      char* slash = strrchr(port, '/');
+      if(slash != NULL) *slash = '\0';
+      has_slot = get_pci_link(port, &slot);
+    }
+
+    // Without NUMA every CPU is local to the device
+    int irq_node = node < 0 && map->num_nodes <= 1 ? 0 : (int) node;
+    int local_irqs = 0;
+    int remote_irqs = 0;
+    count_pci_irqs(dir, map, irq_node, &local_irqs, &remote_irqs);
+
+    bool* flags = flagged + (size_t) i * PCI_NUM_FLAGS;
+    if(has_link && link.cur_speed > 0 && link.cur_width > 0) {
+      double speed = has_slot ? min(link.max_speed, slot.max_speed) : link.max_speed;
+      int width = has_slot ? min(link.max_width, slot.max_width) : link.max_width;
+      flags[PCI_FLAG_DOWNTRAINED] = link.cur_speed < speed * 0.99 || link.cur_width < width;
+    }
+    if(has_link && has_slot) {
+      flags[PCI_FLAG_SLOT] = link.max_speed < slot.max_speed * 0.99 || link.max_width < slot.max_width;
+    }
+    flags[PCI_FLAG_REMOTE_IRQ] = irq_node >= 0 && remote_irqs > 0;
+    flags[PCI_FLAG_NO_NODE] = node < 0 && map->num_nodes > 1;
+
+    char name[64];
+    char cur[32];
+    char max[32];
+    char slt[32];
+    char irqs[16];
+    snprintf(name, sizeof(name), "%s%s%s%s", iface == NULL ? "" : iface, iface == NULL ? "" : " (",
+             driver == NULL ? "-" : driver, iface == NULL ? "" : ")");
+    format_pcie_link(cur, sizeof(cur), has_link ? link.cur_speed : 0, has_link ? link.cur_width : 0);
+    format_pcie_link(max, sizeof(max), has_link ? link.max_speed : 0, has_link ? link.max_width : 0);
+    format_pcie_link(slt, sizeof(slt), has_slot ? slot.max_speed : 0, has_slot ? slot.max_width : 0);
+    if(irq_node >= 0) snprintf(irqs, sizeof(irqs), "%d/%d", local_irqs, remote_irqs);
+    else snprintf(irqs, sizeof(irqs), "%d/-", local_irqs + remote_irqs);
+
+    char* bw = NULL;
+    if(has_link && link.cur_speed > 0 && link.cur_width > 0)
+      bw = get_str_bandwidth(get_pcie_bandwidth(link.cur_speed, link.cur_width));
+    char node_str[16];
+    if(node >= 0) snprintf(node_str, sizeof(node_str), "%d", (int) node);
+    else snprintf(node_str, sizeof(node_str), "-");
+
+    printf("  %-12s %-11s %-22s %4s %-12s %-9s %-9s %-9s %10s %9s ", dev->path, class_name == NULL ? "Other" : class_name,
+           name, node_str, cpulist == NULL ? "-" : cpulist, cur, max, slt, bw == NULL ? "-" : bw, irqs);
+    bool first = true;
+    for(int f=0; f < PCI_NUM_FLAGS; f++) {
+      if(!flags[f]) continue;
+      printf("%s%s", first ? " " : ",", pci_flag_str[f]);
+      first = false;
+    }
+    printf("%s\n", first ? " -" : "");
+
+    free(bw);
+    free(cpulist);
+    free(iface);
+    free(driver);
+  }
+
+  if(shown == 0) {
+    printf("  No network, storage or accelerator devices found\n");
+  }
+  else {
+    bool any = false;
+    printf("\n");
+    for(int f=0; f < PCI_NUM_FLAGS; f++) {
+      bool first = true;
+      for(int i=0; i < pci->num_devices; i++) {
+        if(!flagged[(size_t) i * PCI_NUM_FLAGS + f]) continue;
+        if(first) printf("%s (%s): ", pci_flag_str[f], pci_flag_desc[f]);
+        printf("%s%s", first ? "" : ", ", pci->devices[i]->path);
+        first = false;
+      }
+      if(!first) printf("\n");
+      any = any || !first;
+    }
+    if(!any) printf("No degraded links or remote devices found\n");
+    printf("Bandwidth is per direction at the current link. Some devices (e.g., GPUs) lower the link speed when idle.\n");
+  }
+
+  free(flagged);
+  free_cpu_map(map);
+  free_pci_devices(pci);
+  return true;
+}
+
+#endif // #ifdef __linux__
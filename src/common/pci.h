@@ -1,6 +1,9 @@
 #ifndef __PCI__
 #define __PCI__
 
+#include <stdint.h>
+#include <stdbool.h>
+
 #define PCI_VENDOR_NVIDIA   0x10de
 #define PCI_VENDOR_AMPERE   0x1def
 
@@ -19,5 +22,8 @@ struct pci_devices {
 };
 
 struct pci_devices * get_pci_devices(void);
+#ifdef __linux__
+bool print_pci_report(void);
+#endif
 
 #endif
@@ -0,0 +1,326 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+
+#include "global.h"
+#include "udev.h"
+#include "freq.h"
+#include "perfcaps.h"
+
+#ifdef ARCH_X86
+  #include "../x86/uarch.h"
+  #include "../x86/pmu.h"
+#endif
+
+#define _PATH_SYSCTL_KERNEL     "/proc/sys/kernel"
+#define _PATH_PMU_DEVICES       "/sys/bus/event_source/devices"
+
+// Max size of the groups opened to count the counters
+#define PMU_MAX_COUNTERS        32
+#define PMU_PROBE_ITERS         (1000 * 1000)
+
+struct pmu_device {
+  const char* name;
+  const char* desc;
+};
+
+// PMUs that provide sampling or tracing beyond the core counters
+static const struct pmu_device pmu_devices[] = {
+  { "intel_pt",  "Intel Processor Trace"         },
+  { "intel_bts", "Intel Branch Trace Store"      },
+  { "ibs_op",    "AMD IBS (op sampling)"         },
+  { "ibs_fetch", "AMD IBS (fetch sampling)"      },
+  { "arm_spe_0", "ARM Statistical Profiling (SPE)" },
+  { "cs_etm",    "ARM CoreSight ETM"             },
+  { "power",     "RAPL energy counters"          },
+};
+
+volatile uint64_t perfcaps_sink;
+
+long get_sysctl_kernel(const char* name, bool* success) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%s", _PATH_SYSCTL_KERNEL, name);
+  return get_value_from_file(path, success);
+}
+
+long get_pmu_value(const char* pmu, const char* file, bool* success) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%s/%s", _PATH_PMU_DEVICES, pmu, file);
+  return get_value_from_file(path, success);
+}
+
+char* get_pmu_str(const char* pmu, const char* file) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%s/%s", _PATH_PMU_DEVICES, pmu, file);
+  return get_str_from_file(path);
+}
+
+bool pmu_device_exists(const char* pmu) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%s", _PATH_PMU_DEVICES, pmu);
+  return access(path, F_OK) == 0;
+}
+
+// Core (not uncore) PMUs: cpu, cpu_core/cpu_atom in hybrid x86 CPUs
+// and one per core type in ARM (e.g., armv8_pmuv3_0, armv8_cortex_a76)
+bool is_core_pmu(const char* name) {
+  return strcmp(name, "cpu") == 0 || strcmp(name, "cpu_core") == 0 || strcmp(name, "cpu_atom") == 0 ||
+         strncmp(name, "armv8_", 6) == 0 || strncmp(name, "armv9_", 6) == 0 || strncmp(name, "apple_", 6) == 0;
+}
+
+const char* get_str_paranoid(long level) {
+  if(level <= -1) return "no restrictions";
+  if(level == 0)  return "no raw tracepoints for unprivileged users";
+  if(level == 1)  return "no CPU-wide events for unprivileged users";
+  if(level == 2)  return "only user-space profiling for unprivileged users";
+  return "no perf events for unprivileged users";
+}
+
+const char* get_str_kptr_restrict(long level) {
+  if(level <= 0) return "kernel symbols visible";
+  if(level == 1) return "kernel symbols need CAP_SYSLOG";
+  return "kernel symbols hidden";
+}
+
+void init_perf_attr(struct perf_event_attr* pe, uint32_t type, uint64_t config) {
+  memset(pe, 0, sizeof(struct perf_event_attr));
+  pe->type = type;
+  pe->size = sizeof(struct perf_event_attr);
+  pe->config = config;
+  pe->disabled = 1;
+  pe->exclude_kernel = 1;
+  pe->exclude_hv = 1;
+}
+
+// Returns NULL if the event can be opened, or the error otherwise
+const char* probe_perf_event(struct perf_event_attr* pe, int pid, int cpu) {
+  int fd = perf_event_open(pe, pid, cpu, -1, 0);
+  if(fd == -1) return strerror(errno);
+  close(fd);
+  return NULL;
+}
+
+void print_probe(const char* name, const char* err) {
+  printf("  %-28s %s\n", name, err == NULL ? "Yes" : err);
+}
+
+// Returns the number of general-purpose counters this process can
+// use at the same time, or -1 if hardware events are not available.
+// Groups of branch events (which, unlike cycles or instructions, have
+// no fixed counter) are opened until one is rejected or never runs.
+// The result is lower than the number of counters in the hardware if
+// some of them are already in use (e.g., by the NMI watchdog)
+int probe_num_counters(void) {
+  int fds[PMU_MAX_COUNTERS];
+  int usable = -1;
+
+  for(int n=1; n <= PMU_MAX_COUNTERS; n++) {
+    struct perf_event_attr pe;
+    int opened = 0;
+    bool ok = true;
+
+    for(int i=0; i < n && ok; i++) {
+      init_perf_attr(&pe, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS);
+      pe.disabled = i == 0;
+      pe.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fds[i] = perf_event_open(&pe, 0, -1, i == 0 ? -1 : fds[0], 0);
+      if(fds[i] == -1) ok = false;
+      else opened++;
+    }
+
+    if(ok) {
+      // nr, time_enabled, time_running and one value per event
+      uint64_t values[3 + PMU_MAX_COUNTERS];
+      ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+      for(uint64_t i=0; i < PMU_PROBE_ITERS; i++) perfcaps_sink += i;
+      ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      ssize_t len = read(fds[0], values, sizeof(uint64_t) * (3 + n));
+      ok = len == (ssize_t) (sizeof(uint64_t) * (3 + n)) && values[2] > 0;
+    }
+
+    for(int i=0; i < opened; i++) close(fds[i]);
+    if(!ok) break;
+    usable = n;
+  }
+
+  return usable;
+}
+
+#ifdef ARCH_X86
+void print_pmu_cpuid(struct cpuInfo* cpu) {
+  for(int m=0; m < get_num_modules(cpu); m++) {
+    struct cpuInfo* ptr = get_module(cpu, m);
+    int32_t first_cpu = get_module_first_cpu(cpu, m);
+    if(!bind_to_cpu(first_cpu)) {
+      printWarn("Failed binding the process to CPU %d", first_cpu);
+      continue;
+    }
+
+    struct pmu* pmu = get_pmu_info(ptr);
+    printf("%s (CPU %d, cpuid):\n", get_str_uarch(ptr), first_cpu);
+    if(pmu->version > 0)
+      printf("  %-28s %u\n", "Architectural perfmon", pmu->version);
+    if(pmu->perfmon_v2)
+      printf("  %-28s %s\n", "PerfMonV2", "Yes");
+    printf("  %-28s %u x %u bits\n", "General-purpose counters", pmu->num_gp, pmu->gp_width);
+    if(pmu->num_fixed > 0)
+      printf("  %-28s %u x %u bits\n", "Fixed counters", pmu->num_fixed, pmu->fixed_width);
+    if(pmu->num_nb > 0)
+      printf("  %-28s %u\n", "Data fabric counters", pmu->num_nb);
+    if(pmu->num_llc > 0)
+      printf("  %-28s %u\n", "L3 counters", pmu->num_llc);
+    if(pmu->events != 0) {
+      printf("  %-28s", "Architectural events");
+      for(int i=0; i < PMU_NUM_ARCH_EVENTS; i++)
+        if(pmu->events & (1U << i)) printf(" %s", pmu_arch_events[i]);
+      printf("\n");
+    }
+    if(ptr->cpu_vendor == CPU_VENDOR_INTEL) {
+      printf("  %-28s %s\n", "Debug store (PEBS/BTS)", pmu->ds ? "Yes" : "No");
+      printf("  %-28s %s\n", "Architectural LBR", pmu->arch_lbr ? "Yes" : "No");
+    }
+    else {
+      printf("  %-28s %s\n", "IBS", pmu->ibs ? "Yes" : "No");
+    }
+    if(pmu->lbr_depth > 0)
+      printf("  %-28s %u entries\n", "LBR depth", pmu->lbr_depth);
+    free(pmu);
+  }
+}
+#endif
+
+// Lists the core PMUs and their capabilities (caps/ in sysfs) and the
+// sampling and tracing PMUs registered in the kernel
+void print_pmu_devices(void) {
+  DIR* dir = opendir(_PATH_PMU_DEVICES);
+  if(dir == NULL) {
+    printWarn("opendir: %s: %s", _PATH_PMU_DEVICES, strerror(errno));
+    return;
+  }
+
+  printf("PMUs (%s):\n", _PATH_PMU_DEVICES);
+  int num_core = 0;
+  struct dirent* ent;
+  while((ent = readdir(dir)) != NULL) {
+    if(!is_core_pmu(ent->d_name)) continue;
+    num_core++;
+
+    printf("  %s:", ent->d_name);
+    char* pmu_name = get_pmu_str(ent->d_name, "caps/pmu_name");
+    if(pmu_name != NULL) {
+      printf(" %s", pmu_name);
+      free(pmu_name);
+    }
+    printf("\n");
+
+    bool success;
+    long max_precise = get_pmu_value(ent->d_name, "caps/max_precise", &success);
+    if(success)
+      printf("    %-26s %ld%s\n", "Max precise level", max_precise,
+             max_precise > 0 ? " (precise sampling available)" : " (no precise sampling)");
+    long branches = get_pmu_value(ent->d_name, "caps/branches", &success);
+    if(success)
+      printf("    %-26s %ld entries\n", "LBR depth", branches);
+    long rdpmc = get_pmu_value(ent->d_name, "rdpmc", &success);
+    if(success)
+      printf("    %-26s %ld (%s)\n", "rdpmc", rdpmc,
+             rdpmc == 0 ? "disabled" : (rdpmc == 1 ? "only for mmapped events" : "always"));
+  }
+  closedir(dir);
+
+  if(num_core == 0)
+    printf("  No core PMU found (hardware events are not available, e.g., in a VM)\n");
+
+  for(size_t i=0; i < sizeof(pmu_devices) / sizeof(pmu_devices[0]); i++) {
+    if(pmu_device_exists(pmu_devices[i].name))
+      printf("  %-28s %s\n", pmu_devices[i].desc, "Yes");
+  }
+}
+
+// Reports what can be profiled in this host and by this user: the
+// counters of the PMU (cpuid on x86, probed with perf on every
+// architecture), the PMUs registered in the kernel and the sysctls
+// that restrict perf, followed by a suggested sampling strategy
+bool print_pmu_report(struct cpuInfo* cpu) {
+#ifdef ARCH_X86
+  print_pmu_cpuid(cpu);
+#else
+  UNUSED(cpu);
+#endif
+  print_pmu_devices();
+
+  bool success;
+  printf("Kernel settings:\n");
+  long paranoid = get_sysctl_kernel("perf_event_paranoid", &success);
+  if(success)
+    printf("  %-28s %ld (%s%s)\n", "perf_event_paranoid", paranoid, get_str_paranoid(paranoid),
+           geteuid() == 0 ? ", running as root" : "");
+  long kptr = get_sysctl_kernel("kptr_restrict", &success);
+  if(success)
+    printf("  %-28s %ld (%s)\n", "kptr_restrict", kptr, get_str_kptr_restrict(kptr));
+  long nmi = get_sysctl_kernel("nmi_watchdog", &success);
+  if(success)
+    printf("  %-28s %ld%s\n", "nmi_watchdog", nmi, nmi != 0 ? " (may take one counter)" : "");
+  long rate = get_sysctl_kernel("perf_event_max_sample_rate", &success);
+  if(success)
+    printf("  %-28s %ld Hz\n", "perf_event_max_sample_rate", rate);
+  long user_access = get_sysctl_kernel("perf_user_access", &success);
+  if(success)
+    printf("  %-28s %ld (%s)\n", "perf_user_access", user_access,
+           user_access != 0 ? "counters readable from user space" : "disabled");
+
+  printf("Access for this user:\n");
+  struct perf_event_attr pe;
+  init_perf_attr(&pe, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  const char* hw_user = probe_perf_event(&pe, 0, -1);
+  print_probe("Hardware events (user)", hw_user);
+
+  pe.exclude_kernel = 0;
+  print_probe("Hardware events (kernel)", probe_perf_event(&pe, 0, -1));
+
+  init_perf_attr(&pe, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  print_probe("CPU-wide events", probe_perf_event(&pe, -1, 0));
+
+  init_perf_attr(&pe, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  pe.sample_period = 1000000;
+  pe.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID;
+  const char* hw_sampling = probe_perf_event(&pe, 0, -1);
+  print_probe("Hardware sampling", hw_sampling);
+
+  pe.sample_type |= PERF_SAMPLE_BRANCH_STACK;
+  pe.branch_sample_type = PERF_SAMPLE_BRANCH_ANY | PERF_SAMPLE_BRANCH_USER;
+  const char* branch_stack = probe_perf_event(&pe, 0, -1);
+  print_probe("Branch stack (LBR/BRBE)", branch_stack);
+
+  init_perf_attr(&pe, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CPU_CLOCK);
+  pe.sample_period = 1000000;
+  pe.sample_type = PERF_SAMPLE_IP | PERF_SAMPLE_TID;
+  const char* sw_sampling = probe_perf_event(&pe, 0, -1);
+  print_probe("Software sampling", sw_sampling);
+
+  int counters = hw_user == NULL ? probe_num_counters() : -1;
+  if(counters > 0)
+    printf("  %-28s %d\n", "Usable counters", counters);
+
+  if(hw_sampling == NULL && branch_stack == NULL)
+    printf("Suggested sampling: hardware events with branch stacks\n");
+  else if(hw_sampling == NULL)
+    printf("Suggested sampling: hardware events (cycles)\n");
+  else if(sw_sampling == NULL)
+    printf("Suggested sampling: software timer (cpu-clock), hardware events are not available\n");
+  else
+    printf("Suggested sampling: none, perf events are not available for this user\n");
+
+  return true;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __PERFCAPS__
+#define __PERFCAPS__
+
+#include "cpu.h"
+
+bool print_pmu_report(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,234 @@
+#ifdef __linux__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "args.h"
+#include "udev.h"
+#include "cpumap.h"
+#include "plan.h"
+
+#define _PATH_CPU_CORE_CPUS  "/sys/devices/cpu_core/cpus"
+#define _PATH_CPU_CAPACITY   "/cpu_capacity"
+// CPUs whose capacity (or max frequency) is below this fraction of
+// the fastest one are considered efficiency cores
+#define PERF_CORE_THRESHOLD  0.9
+
+// Placement of one logical CPU, used to order them for each policy
+struct plan_cpu {
+  int cpu;
+  int package;
+  int node;
+  int l3;
+  int core;
+  int smt_id;
+  bool perf_core;
+  int smt_idx;   // Index of the CPU within its core (0 for the first thread)
+  int core_idx;  // Index of the core within its L3
+  int l3_idx;    // Index of the L3 within its package
+};
+
+static int plan_policy;
+
+// Marks the performance cores. Intel hybrid CPUs list them in the
+// cpu_core PMU; otherwise we fallback to cpu_capacity (ARM) and
+// then to the max frequency.
+void fill_perf_cores(struct plan_cpu* pc, int n, int ncpus) {
+  char* buf = get_str_from_file(_PATH_CPU_CORE_CPUS);
+  if(buf != NULL) {
+    bool* pcores = emalloc(sizeof(bool) * ncpus);
+    int found = parse_cpu_list(buf, pcores, ncpus);
+    for(int i=0; i < n; i++) pc[i].perf_core = found > 0 ? pcores[pc[i].cpu] : true;
+    free(pcores);
+    free(buf);
+    return;
+  }
+
+  char path[_PATH_SYSFS_MAX_LEN];
+  long* value = emalloc(sizeof(long) * n);
+  long max_value = -1;
+  bool success = true;
+
+  for(int i=0; i < n && success; i++) {
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, pc[i].cpu, _PATH_CPU_CAPACITY);
+    value[i] = get_value_from_file(path, &success);
+  }
+  if(!success) {
+    for(int i=0; i < n; i++) value[i] = get_max_freq_from_file(pc[i].cpu);
+  }
+
+  for(int i=0; i < n; i++) if(value[i] > max_value) max_value = value[i];
+  for(int i=0; i < n; i++) {
+    pc[i].perf_core = max_value <= 0 || value[i] >= max_value * PERF_CORE_THRESHOLD;
+  }
+
+  free(value);
+}
+
+// Fills smt_idx, core_idx and l3_idx, which are the ordinals used by the
+// policies to interleave sockets, L3 domains, cores and SMT threads
+void fill_ordinals(struct plan_cpu* pc, int n) {
+  for(int i=0; i < n; i++) {
+    pc[i].smt_idx = 0;
+    pc[i].core_idx = -1;
+    pc[i].l3_idx = -1;
+
+    for(int j=0; j < i; j++) {
+      if(pc[j].package != pc[i].package) continue;
+
+      if(pc[j].l3 == pc[i].l3) pc[i].l3_idx = pc[j].l3_idx;
+      if(pc[j].smt_id == pc[i].smt_id) {
+        pc[i].smt_idx++;
+        pc[i].core_idx = pc[j].core_idx;
+      }
+    }
+
+    // First CPU seen in this L3 or in this core
+    if(pc[i].l3_idx == -1 || pc[i].core_idx == -1) {
+      int max_l3 = -1;
+      int max_core = -1;
+      for(int j=0; j < i; j++) {
+        if(pc[j].package != pc[i].package) continue;
+        max_l3 = max(max_l3, pc[j].l3_idx);
+        if(pc[j].l3 == pc[i].l3) max_core = max(max_core, pc[j].core_idx);
+      }
+      if(pc[i].l3_idx == -1) pc[i].l3_idx = max_l3 + 1;
+      if(pc[i].core_idx == -1) pc[i].core_idx = max_core + 1;
+    }
+  }
+}
+
+#define CMP(a, b) do { if((a) != (b)) return (a) < (b) ? -1 : 1; } while(0)
+
+// Sockets and L3 domains are interleaved first, then cores and
+// SMT siblings are used last
+int compare_spread(const struct plan_cpu* x, const struct plan_cpu* y) {
+  CMP(x->smt_idx, y->smt_idx);
+  CMP(x->core_idx, y->core_idx);
+  CMP(x->l3_idx, y->l3_idx);
+  CMP(x->package, y->package);
+  CMP(x->cpu, y->cpu);
+  return 0;
+}
+
+int compare_plan_cpus(const void* a, const void* b) {
+  const struct plan_cpu* x = (const struct plan_cpu *) a;
+  const struct plan_cpu* y = (const struct plan_cpu *) b;
+
+  switch(plan_policy) {
+    case POLICY_COMPACT:
+      // SMT siblings are next to each other, filling one L3 at a time
+      CMP(x->package, y->package);
+      CMP(x->l3_idx, y->l3_idx);
+      CMP(x->core_idx, y->core_idx);
+      CMP(x->smt_idx, y->smt_idx);
+      break;
+    case POLICY_PER_L3:
+      // Fills one L3 at a time, using the SMT siblings last within the L3
+      CMP(x->package, y->package);
+      CMP(x->l3_idx, y->l3_idx);
+      CMP(x->smt_idx, y->smt_idx);
+      CMP(x->core_idx, y->core_idx);
+      break;
+    case POLICY_P_CORES_FIRST: {
+      // Physical P-cores, then E-cores and finally the SMT siblings
+      int class_x = x->smt_idx > 0 ? 2 : (x->perf_core ? 0 : 1);
+      int class_y = y->smt_idx > 0 ? 2 : (y->perf_core ? 0 : 1);
+      CMP(class_x, class_y);
+      return compare_spread(x, y);
+    }
+    default:
+      return compare_spread(x, y);
+  }
+
+  CMP(x->cpu, y->cpu);
+  return 0;
+}
+
+#undef CMP
+
+// Computes the CPUs where nthreads workers should be pinned following
+// the policy specified, restricted to the CPUs we are allowed to use
+// (affinity and cgroup cpuset), and prints them in different formats
+bool print_thread_plan(int nthreads, int policy) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+
+  bool* allowed = emalloc(sizeof(bool) * map->num_cpus);
+  if(!get_allowed_cpus(allowed, map->num_cpus)) {
+    free(allowed);
+    free_cpu_map(map);
+    return false;
+  }
+
+  struct plan_cpu* pc = emalloc(sizeof(struct plan_cpu) * map->num_cpus);
+  int n = 0;
+  for(int i=0; i < map->num_cpus; i++) {
+    struct cpu_location* loc = &map->cpus[i];
+    if(!loc->online || !allowed[i]) continue;
+    pc[n].cpu = i;
+    pc[n].package = loc->package;
+    pc[n].node = loc->node;
+    pc[n].l3 = loc->l3;
+    pc[n].core = loc->core;
+    pc[n].smt_id = loc->smt_id;
+    n++;
+  }
+
+  if(nthreads > n) {
+    printErr("Requested %d threads, but only %d CPUs are available", nthreads, n);
+    free(pc);
+    free(allowed);
+    free_cpu_map(map);
+    return false;
+  }
+
+  fill_perf_cores(pc, n, map->num_cpus);
+  fill_ordinals(pc, n);
+  plan_policy = policy;
+  qsort(pc, n, sizeof(struct plan_cpu), compare_plan_cpus);
+
+  printf("Policy: %s, %d threads (%d CPUs available)\n\n", get_str_policy(policy), nthreads, n);
+  printf("  %6s %5s %6s %5s %5s %5s %5s\n", "Thread", "CPU", "Socket", "Core", "L3", "Node", "Type");
+
+  // Node ids can be sparse and larger than the number of CPUs, so
+  // the node mask is sized by the highest node id in the plan
+  int num_nodes = 1;
+  for(int t=0; t < nthreads; t++)
+    if(pc[t].node + 1 > num_nodes) num_nodes = pc[t].node + 1;
+
+  bool* selected = ecalloc(map->num_cpus, sizeof(bool));
+  bool* nodes = ecalloc(num_nodes, sizeof(bool));
+  for(int t=0; t < nthreads; t++) {
+    printf("  %6d %5d %6d %5d %5d %5d %5s\n", t, pc[t].cpu, pc[t].package, pc[t].core, pc[t].l3, pc[t].node,
+           pc[t].perf_core ? "P" : "E");
+    selected[pc[t].cpu] = true;
+    if(pc[t].node >= 0) nodes[pc[t].node] = true;
+  }
+
+  printf("\nOrdered list: ");
+  for(int t=0; t < nthreads; t++) printf("%s%d", t == 0 ? "" : ",", pc[t].cpu);
+  printf("\n");
+
+  char* cpulist = get_str_cpu_list(selected, map->num_cpus);
+  char* nodelist = get_str_cpu_list(nodes, num_nodes);
+  printf("taskset:      taskset -c %s\n", cpulist);
+  printf("numactl:      numactl --physcpubind=%s --membind=%s\n", cpulist, nodelist);
+  printf("cpuset:       %s\n", cpulist);
+
+  free(cpulist);
+  free(nodelist);
+  free(selected);
+  free(nodes);
+  free(pc);
+  free(allowed);
+  free_cpu_map(map);
+  return true;
+}
+
+#endif // #ifdef __linux__
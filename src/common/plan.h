@@ -0,0 +1,8 @@
+#ifndef __PLAN__
+#define __PLAN__
+
+#include <stdbool.h>
+
+bool print_thread_plan(int nthreads, int policy);
+
+#endif
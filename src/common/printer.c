@@ -1370,6 +1370,16 @@ bool print_cpufetch_arm(struct cpuInfo* cpu, STYLE s, struct color** cs, struct
     free(ops);
     pp = pp_ext;
   }
+  // Modelled from DotProd/I8MM, so it does not depend on accurate-pp
+  if (cpu->int8_ops_performance > 0) {
+    char* int8 = get_str_ops(cpu->int8_ops_performance);
+    size_t len = strlen(pp) + 2 + strlen(int8) + strlen(" int8") + 1;
+    char* pp_ext = emalloc(len);
+    snprintf(pp_ext, len, "%s, %s int8", pp, int8);
+    free(pp);
+    free(int8);
+    pp = pp_ext;
+  }
   setAttribute(art, ATTRIBUTE_PEAK, pp);
   if(cpu->hv->present) {
     setAttribute(art, ATTRIBUTE_HYPERVISOR, cpu->hv->hv_name);
@@ -0,0 +1,345 @@
+#ifdef __linux__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "global.h"
+#include "udev.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "ranking.h"
+
+#define _PATH_CPPC                 "/acpi_cppc"
+#define _PATH_CPPC_HIGHEST         "/highest_perf"
+#define _PATH_CPPC_NOMINAL         "/nominal_perf"
+#define _PATH_CPPC_LOWEST_NL       "/lowest_nonlinear_perf"
+#define _PATH_CPPC_LOWEST          "/lowest_perf"
+#define _PATH_AMD_PREFCORE_RANKING "/amd_pstate_prefcore_ranking"
+#define _PATH_AMD_HIGHEST_PERF     "/amd_pstate_highest_perf"
+#define _PATH_AMD_MAX_FREQ         "/amd_pstate_max_freq"
+#define _PATH_AMD_PREFCORE         _PATH_SYS_SYSTEM _PATH_SYS_CPU "/amd_pstate/prefcore"
+#define _PATH_ITMT_ENABLED         "/proc/sys/kernel/sched_itmt_enabled"
+
+// Each step of the scan runs the chain for this time, keeping the best
+// of RANK_SCAN_REPS steps after RANK_WARMUP_NS to let the clock ramp up
+#define RANK_SCAN_NS        (20 * 1000 * 1000)
+#define RANK_WARMUP_NS      (50 * 1000 * 1000)
+#define RANK_SCAN_REPS      5
+// Adds per iteration of the dependency chain
+#define RANK_CHAIN_LEN      100
+// Cores within this fraction of the fastest one are reported together
+#define RANK_FASTEST_MARGIN 0.01
+// The measured speed disagrees with the ranking if a core is slower
+// than one ranked below it by more than this fraction
+#define RANK_SCAN_TOLERANCE 0.03
+
+// Performance capabilities of one physical core, taken from its first
+// online CPU, since SMT siblings share them
+struct rank_core {
+  int cpu;
+  bool* siblings;
+  long highest_perf;  // CPPC highest_perf (or the amd_pstate one)
+  long nominal_perf;
+  long lowest_nl_perf;
+  long lowest_perf;
+  long prefcore;      // amd_pstate preferred core ranking
+  long max_freq;      // Max frequency (kHz) allowed by the driver
+  long base_freq;     // Base frequency (kHz) reported by intel_pstate
+  double scan_ghz;    // Measured single thread speed
+};
+
+#if defined(ARCH_X86)
+  #define CHAIN_ADD(x) __asm volatile("add %0, %0" : "+r"(x));
+#elif defined(ARCH_ARM)
+  #define CHAIN_ADD(x) __asm volatile("add %0, %0, %0" : "+r"(x));
+#elif defined(ARCH_RISCV)
+  #define CHAIN_ADD(x) __asm volatile("add %0, %0, %0" : "+r"(x));
+#else
+  #define CHAIN_ADD(x) __asm volatile("" : "+r"(x)); x += x;
+#endif
+
+#define CHAIN_ADD_10(x) \
+  CHAIN_ADD(x) CHAIN_ADD(x) CHAIN_ADD(x) CHAIN_ADD(x) CHAIN_ADD(x) \
+  CHAIN_ADD(x) CHAIN_ADD(x) CHAIN_ADD(x) CHAIN_ADD(x) CHAIN_ADD(x)
+
+// Runs a chain of dependent adds, each of which takes one cycle in
+// every core, so the adds per ns are the frequency of the core in GHz.
+// The adds are register to register, since recent cores can eliminate
+// the adds of small immediates at rename.
+unsigned long add_chain(uint64_t iters) {
+  unsigned long x = 0;
+  for(uint64_t i=0; i < iters; i++) {
+    CHAIN_ADD_10(x) CHAIN_ADD_10(x) CHAIN_ADD_10(x) CHAIN_ADD_10(x) CHAIN_ADD_10(x)
+    CHAIN_ADD_10(x) CHAIN_ADD_10(x) CHAIN_ADD_10(x) CHAIN_ADD_10(x) CHAIN_ADD_10(x)
+  }
+  return x;
+}
+
+void* scan_thread(void* arg) {
+  double* ghz = (double *) arg;
+  volatile unsigned long sink;
+
+  uint64_t start = get_time_ns();
+  uint64_t iters = 0;
+  while(get_time_ns() - start < RANK_WARMUP_NS) {
+    sink = add_chain(1000);
+    iters += 1000;
+  }
+  iters = (uint64_t) ((double) iters * RANK_SCAN_NS / (get_time_ns() - start)) + 1;
+
+  *ghz = 0.0;
+  for(int r=0; r < RANK_SCAN_REPS; r++) {
+    start = get_time_ns();
+    sink = add_chain(iters);
+    uint64_t ns = get_time_ns() - start;
+    double rep_ghz = ns > 0 ? (double) iters * RANK_CHAIN_LEN / ns : 0.0;
+    if(rep_ghz > *ghz) *ghz = rep_ghz;
+  }
+  UNUSED(sink);
+  return NULL;
+}
+
+// Measures the single thread speed of each core, one at a time
+void scan_cores(struct rank_core* cores, int ncores) {
+  const char* banner = "cpufetch is measuring the speed of each core...";
+  printf("%s", banner);
+  fflush(stdout);
+
+  for(int i=0; i < ncores; i++) {
+    pthread_t thread;
+    cores[i].scan_ghz = 0.0;
+    if(create_thread_on_cpu(&thread, cores[i].cpu, scan_thread, &cores[i].scan_ghz)) {
+      pthread_join(thread, NULL);
+    }
+  }
+
+  printf("\r%*c\r", (int) strlen(banner), ' ');
+}
+
+// Key used to rank the cores: the amd_pstate preferred core ranking,
+// the CPPC highest_perf, the max frequency (which differs among cores
+// on Intel CPUs with Turbo Boost Max 3.0) or the measured speed
+enum {
+  RANK_BY_PREFCORE,
+  RANK_BY_HIGHEST_PERF,
+  RANK_BY_MAX_FREQ,
+  RANK_BY_SCAN,
+  RANK_BY_NONE
+};
+
+static const char* rank_by_str[] = {
+  [RANK_BY_PREFCORE]     = "amd_pstate preferred core ranking",
+  [RANK_BY_HIGHEST_PERF] = "CPPC highest_perf",
+  [RANK_BY_MAX_FREQ]     = "max frequency",
+  [RANK_BY_SCAN]         = "measured single thread speed",
+  [RANK_BY_NONE]         = "none",
+};
+
+static int rank_by;
+
+double get_rank_key(const struct rank_core* c) {
+  switch(rank_by) {
+    case RANK_BY_PREFCORE:     return c->prefcore;
+    case RANK_BY_HIGHEST_PERF: return c->highest_perf;
+    case RANK_BY_MAX_FREQ:     return c->max_freq;
+    case RANK_BY_SCAN:         return c->scan_ghz;
+    default:                   return 0;
+  }
+}
+
+int compare_rank_cores(const void* a, const void* b) {
+  const struct rank_core* x = (const struct rank_core *) a;
+  const struct rank_core* y = (const struct rank_core *) b;
+  double kx = get_rank_key(x);
+  double ky = get_rank_key(y);
+  if(kx > ky) return -1;
+  if(kx < ky) return 1;
+  // Ties are broken by the measured speed, if any
+  if(x->scan_ghz > y->scan_ghz) return -1;
+  if(x->scan_ghz < y->scan_ghz) return 1;
+  return x->cpu - y->cpu;
+}
+
+// Picks the first source that is available and distinguishes cores
+int choose_rank_by(struct rank_core* cores, int ncores, bool scan) {
+  int keys[] = { RANK_BY_PREFCORE, RANK_BY_HIGHEST_PERF, RANK_BY_MAX_FREQ, RANK_BY_SCAN };
+  int first_available = RANK_BY_NONE;
+
+  for(size_t k=0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+    if(keys[k] == RANK_BY_SCAN && !scan) continue;
+    rank_by = keys[k];
+    bool available = true;
+    bool differ = false;
+    for(int i=0; i < ncores; i++) {
+      if(get_rank_key(&cores[i]) <= 0) available = false;
+      if(get_rank_key(&cores[i]) > get_rank_key(&cores[0]) || get_rank_key(&cores[i]) < get_rank_key(&cores[0])) differ = true;
+    }
+    if(!available) continue;
+    if(first_available == RANK_BY_NONE) first_available = keys[k];
+    if(differ) return keys[k];
+  }
+  return first_available;
+}
+
+void print_rank_value(long value, int width) {
+  if(value < 0) printf(" %*s", width, "-");
+  else printf(" %*ld", width, value);
+}
+
+void print_rank_freq(long khz, int width) {
+  if(khz <= 0) printf(" %*s", width, "-");
+  else printf(" %*ld", width, khz / 1000);
+}
+
+void print_rank_table(struct rank_core* cores, int ncores, int ncpus, bool scan) {
+  printf("  %4s %-10s %7s %7s %6s %6s %8s %7s %7s", "Rank", "CPUs", "Highest", "Nominal", "LowNL", "Lowest",
+         "Prefcore", "MaxMHz", "BaseMHz");
+  if(scan) printf(" %8s", "Measured");
+  printf("\n");
+
+  for(int i=0; i < ncores; i++) {
+    struct rank_core* c = &cores[i];
+    char* cpus = get_str_cpu_list(c->siblings, ncpus);
+    printf("  %4d %-10s", i+1, cpus);
+    print_rank_value(c->highest_perf, 7);
+    print_rank_value(c->nominal_perf, 7);
+    print_rank_value(c->lowest_nl_perf, 6);
+    print_rank_value(c->lowest_perf, 6);
+    print_rank_value(c->prefcore, 8);
+    print_rank_freq(c->max_freq, 7);
+    print_rank_freq(c->base_freq, 7);
+    if(scan) {
+      // Flag the cores slower than one ranked below them
+      bool slower = false;
+      for(int j=i+1; j < ncores; j++) {
+        if(c->scan_ghz < cores[j].scan_ghz * (1 - RANK_SCAN_TOLERANCE)) slower = true;
+      }
+      printf(" %5.2fGHz%s", c->scan_ghz, slower && rank_by != RANK_BY_SCAN ? " *" : "");
+    }
+    printf("\n");
+    free(cpus);
+  }
+}
+
+// Reads the performance capabilities of every physical core (ACPI CPPC,
+// amd_pstate and intel_pstate sysfs) and ranks them, optionally
+// measuring the speed of each core, to find the fastest ones (preferred
+// cores on AMD, favored cores of Turbo Boost Max 3.0 on Intel, or the
+// big cores on ARM) where the hottest threads should be pinned.
+bool print_core_ranking(bool scan) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+  int ncpus = map->num_cpus;
+
+  bool* allowed = emalloc(sizeof(bool) * ncpus);
+  if(!get_allowed_cpus(allowed, ncpus)) {
+    free(allowed);
+    free_cpu_map(map);
+    return false;
+  }
+
+  struct rank_core* cores = emalloc(sizeof(struct rank_core) * ncpus);
+  int ncores = 0;
+  for(int i=0; i < ncpus; i++) {
+    struct cpu_location* loc = &map->cpus[i];
+    if(!loc->online || !allowed[i]) continue;
+
+    int c = 0;
+    while(c < ncores && map->cpus[cores[c].cpu].smt_id != loc->smt_id) c++;
+    if(c < ncores) {
+      cores[c].siblings[i] = true;
+      continue;
+    }
+
+    struct rank_core* rc = &cores[ncores++];
+    rc->cpu = i;
+    rc->siblings = ecalloc(ncpus, sizeof(bool));
+    rc->siblings[i] = true;
+    rc->highest_perf = get_cpu_sysfs_value(i, _PATH_CPPC, _PATH_CPPC_HIGHEST);
+    rc->nominal_perf = get_cpu_sysfs_value(i, _PATH_CPPC, _PATH_CPPC_NOMINAL);
+    rc->lowest_nl_perf = get_cpu_sysfs_value(i, _PATH_CPPC, _PATH_CPPC_LOWEST_NL);
+    rc->lowest_perf = get_cpu_sysfs_value(i, _PATH_CPPC, _PATH_CPPC_LOWEST);
+    rc->prefcore = get_cpu_sysfs_value(i, _PATH_FREQUENCY, _PATH_AMD_PREFCORE_RANKING);
+    rc->max_freq = get_cpu_sysfs_value(i, _PATH_FREQUENCY, _PATH_AMD_MAX_FREQ);
+    rc->base_freq = get_cpu_sysfs_value(i, _PATH_FREQUENCY, _PATH_FREQUENCY_BASE);
+    rc->scan_ghz = 0.0;
+    if(rc->highest_perf < 0) rc->highest_perf = get_cpu_sysfs_value(i, _PATH_FREQUENCY, _PATH_AMD_HIGHEST_PERF);
+    if(rc->max_freq < 0) rc->max_freq = get_cpu_sysfs_value(i, _PATH_FREQUENCY, _PATH_FREQUENCY_MAX);
+  }
+
+  char* driver = ncores > 0 ? get_cpu_sysfs_str(cores[0].cpu, _PATH_FREQUENCY, _PATH_FREQUENCY_DRIVER) : NULL;
+  char* prefcore = get_str_from_file(_PATH_AMD_PREFCORE);
+  char* itmt = get_str_from_file(_PATH_ITMT_ENABLED);
+
+  printf("Frequency driver:  %s\n", driver == NULL ? "none" : driver);
+  if(prefcore != NULL) printf("AMD preferred core: %s\n", prefcore);
+  if(itmt != NULL) printf("Intel ITMT (favored cores scheduling): %s\n", strcmp(itmt, "1") == 0 ? "enabled" : "disabled");
+
+  if(scan) scan_cores(cores, ncores);
+  rank_by = choose_rank_by(cores, ncores, scan);
+  printf("Ranked by:         %s\n\n", rank_by_str[rank_by]);
+
+  if(rank_by == RANK_BY_NONE) {
+    printWarn("Neither CPPC, amd_pstate nor cpufreq information is available (try --rank-scan)");
+  }
+  else {
+    qsort(cores, ncores, sizeof(struct rank_core), compare_rank_cores);
+  }
+  print_rank_table(cores, ncores, ncpus, scan);
+
+  if(rank_by != RANK_BY_NONE && ncores > 0) {
+    // The fastest cores are the ones with the same key as the first
+    // one (or within RANK_FASTEST_MARGIN if it was measured)
+    double best = get_rank_key(&cores[0]);
+    double margin = rank_by == RANK_BY_SCAN ? RANK_FASTEST_MARGIN : 0.0;
+    bool* fastest = ecalloc(ncpus, sizeof(bool));
+    bool* fastest_first = ecalloc(ncpus, sizeof(bool));
+    int nfastest = 0;
+    for(int i=0; i < ncores && get_rank_key(&cores[i]) >= best * (1 - margin); i++) {
+      for(int c=0; c < ncpus; c++) fastest[c] = fastest[c] || cores[i].siblings[c];
+      fastest_first[cores[i].cpu] = true;
+      nfastest++;
+    }
+
+    char* all = get_str_cpu_list(fastest, ncpus);
+    char* first = get_str_cpu_list(fastest_first, ncpus);
+    printf("\nFastest cores: %d of %d", nfastest, ncores);
+    if(nfastest == ncores) printf(" (all the cores have the same %s)", rank_by_str[rank_by]);
+    printf("\n");
+    printf("  One thread per core: taskset -c %s\n", first);
+    if(strcmp(all, first) != 0) printf("  With SMT siblings:   taskset -c %s\n", all);
+    free(all);
+    free(first);
+    free(fastest);
+    free(fastest_first);
+
+    printf("\nOrdered list: ");
+    for(int i=0; i < ncores; i++) printf("%s%d", i == 0 ? "" : ",", cores[i].cpu);
+    printf("\n");
+  }
+
+  if(scan && rank_by != RANK_BY_SCAN) {
+    bool any = false;
+    for(int i=0; i < ncores && !any; i++) {
+      for(int j=i+1; j < ncores; j++) {
+        if(cores[i].scan_ghz < cores[j].scan_ghz * (1 - RANK_SCAN_TOLERANCE)) any = true;
+      }
+    }
+    if(any) printf("\n* Measured slower than a core ranked below it (busy or the ranking is not accurate)\n");
+  }
+
+  for(int i=0; i < ncores; i++) free(cores[i].siblings);
+  free(cores);
+  free(driver);
+  free(prefcore);
+  free(itmt);
+  free(allowed);
+  free_cpu_map(map);
+  return true;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __RANKING__
+#define __RANKING__
+
+#include <stdbool.h>
+
+bool print_core_ranking(bool scan);
+
+#endif
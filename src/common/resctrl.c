@@ -0,0 +1,387 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "global.h"
+#include "udev.h"
+#include "membench.h"
+#include "resctrl.h"
+
+#ifdef ARCH_X86
+  #include "../x86/rdt.h"
+#endif
+
+#define _PATH_RESCTRL           "/sys/fs/resctrl"
+#define _PATH_RESCTRL_INFO      _PATH_RESCTRL "/info"
+#define _PATH_RESCTRL_SCHEMATA  _PATH_RESCTRL "/schemata"
+#define _PATH_RESCTRL_TASKS     _PATH_RESCTRL "/tasks"
+#define _PATH_RESCTRL_STATUS    _PATH_RESCTRL_INFO "/last_cmd_status"
+
+// Each size is read for at least this many bytes (best of CAT_REPS)
+#define CAT_BYTES     (256 * 1024 * 1024)
+#define CAT_REPS      3
+#define CAT_STEPS     8
+// The partition is considered effective if the bandwidth of the
+// buffers that do not fit in the masked capacity drops below this
+#define CAT_EFFECTIVE 0.8
+
+struct resctrl_file {
+  const char* name;
+  const char* label;
+};
+
+// Files exposed under info/<resource>/ (allocation and monitoring).
+// https://docs.kernel.org/arch/x86/resctrl.html
+static const struct resctrl_file resctrl_files[] = {
+  { "num_closids",             "Classes of service"      },
+  { "cbm_mask",                "Capacity bitmask"        },
+  { "min_cbm_bits",            "Min bitmask bits"        },
+  { "shareable_bits",          "Shareable bits"          },
+  { "sparse_masks",            "Non-contiguous masks"    },
+  { "bandwidth_gran",          "Bandwidth granularity"   },
+  { "min_bandwidth",           "Min bandwidth"           },
+  { "delay_linear",            "Linear delay"            },
+  { "num_rmids",               "RMIDs"                   },
+  { "mon_features",            "Events"                  },
+  { "max_threshold_occupancy", "Max threshold occupancy" },
+};
+
+#ifdef ARCH_X86
+void print_cat_info(const char* name, struct rdt_cat* cat) {
+  if(!cat->supported) {
+    printf("  %-24s %s\n", name, "No");
+    return;
+  }
+  printf("  %-24s %u CLOS, %u-bit mask (shareable 0x%x)%s%s\n", name, cat->num_clos, cat->cbm_len,
+         cat->shareable, cat->cdp ? ", CDP" : "", cat->noncontiguous ? ", non-contiguous" : "");
+}
+
+void print_rdt_cpuid(struct cpuInfo* cpu) {
+  struct rdt* rdt = get_rdt_info(cpu);
+  bool amd = cpu->cpu_vendor == CPU_VENDOR_AMD || cpu->cpu_vendor == CPU_VENDOR_HYGON;
+
+  printf("%s (cpuid):\n", amd ? "AMD PQoS" : "Intel RDT");
+  if(!rdt->monitoring) {
+    printf("  %-24s %s\n", "L3 monitoring", "No");
+  }
+  else {
+    printf("  %-24s %u RMIDs, %u bytes per unit", "L3 monitoring", rdt->num_rmids, rdt->upscale);
+    if(rdt->counter_width > 0) printf(", %u-bit counters", rdt->counter_width);
+    printf("\n");
+    printf("  %-24s %s%s%s\n", "Events",
+           rdt->llc_occupancy ? "llc_occupancy " : "",
+           rdt->mbm_total ? "mbm_total_bytes " : "",
+           rdt->mbm_local ? "mbm_local_bytes" : "");
+  }
+
+  print_cat_info("L3 allocation (CAT)", &rdt->l3);
+  print_cat_info("L2 allocation (CAT)", &rdt->l2);
+  if(!rdt->mba)
+    printf("  %-24s %s\n", "Memory bandwidth (MBA)", "No");
+  else if(rdt->mba_absolute)
+    printf("  %-24s %u CLOS, up to %u (1/8 GB/s units)\n", "Memory bandwidth (MBA)", rdt->mba_clos, rdt->mba_max);
+  else
+    printf("  %-24s %u CLOS, max throttling %u%% (%s)\n", "Memory bandwidth (MBA)", rdt->mba_clos,
+           rdt->mba_max, rdt->mba_linear ? "linear" : "non-linear");
+
+  free(rdt);
+}
+#endif
+
+bool resctrl_mounted(void) {
+  return access(_PATH_RESCTRL_INFO, R_OK) == 0;
+}
+
+char* get_resctrl_str(const char* resource, const char* file) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%s/%s", _PATH_RESCTRL_INFO, resource, file);
+  return get_str_from_file(path);
+}
+
+int compare_str(const void* a, const void* b) {
+  return strcmp(*(char * const *) a, *(char * const *) b);
+}
+
+// Prints the resources (e.g., L3, L3_MON, MB) described in info/
+void print_resctrl_info(void) {
+  DIR* dir = opendir(_PATH_RESCTRL_INFO);
+  if(dir == NULL) {
+    printWarn("opendir: %s: %s", _PATH_RESCTRL_INFO, strerror(errno));
+    return;
+  }
+
+  int num_res = 0;
+  int max_res = 16;
+  char** res = emalloc(sizeof(char *) * max_res);
+  struct dirent* ent;
+  while((ent = readdir(dir)) != NULL) {
+    if(ent->d_name[0] == '.' || ent->d_type != DT_DIR) continue;
+    if(num_res == max_res) {
+      max_res *= 2;
+      res = erealloc(res, sizeof(char *) * max_res);
+    }
+    res[num_res++] = strdup(ent->d_name);
+  }
+  closedir(dir);
+  qsort(res, num_res, sizeof(char *), compare_str);
+
+  for(int i=0; i < num_res; i++) {
+    printf("  %s:\n", res[i]);
+    for(size_t f=0; f < sizeof(resctrl_files) / sizeof(resctrl_files[0]); f++) {
+      char* str = get_resctrl_str(res[i], resctrl_files[f].name);
+      if(str == NULL) continue;
+      // mon_features has one event per line
+      for(char* c = str; *c != '\0'; c++) if(*c == '\n') *c = ' ';
+      printf("    %-24s %s\n", resctrl_files[f].label, str);
+      free(str);
+    }
+    free(res[i]);
+  }
+  free(res);
+
+  char* schemata = get_str_from_file(_PATH_RESCTRL_SCHEMATA);
+  if(schemata != NULL) {
+    printf("  Default group schemata:\n");
+    for(char* line = strtok(schemata, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+      while(*line == ' ') line++;
+      printf("    %s\n", line);
+    }
+    free(schemata);
+  }
+}
+
+bool write_resctrl_file(const char* path, const char* str) {
+  int fd = open(path, O_WRONLY);
+  if(fd == -1) {
+    printErr("open: %s: %s", path, strerror(errno));
+    return false;
+  }
+
+  ssize_t len = strlen(str);
+  if(write(fd, str, len) != len) {
+    printErr("write: %s: %s", path, strerror(errno));
+    // The kernel explains why the write was rejected
+    char* status = get_str_from_file(_PATH_RESCTRL_STATUS);
+    if(status != NULL) {
+      printErr("resctrl: %s", status);
+      free(status);
+    }
+    close(fd);
+    return false;
+  }
+
+  close(fd);
+  return true;
+}
+
+// Builds the schemata of the new group, replacing the bitmask of every
+// L3 domain (and of L3CODE/L3DATA, if CDP is enabled) with mask.
+// Returns NULL if the default schemata has no L3 line
+char* build_cat_schemata(uint64_t mask) {
+  char* schemata = get_str_from_file(_PATH_RESCTRL_SCHEMATA);
+  if(schemata == NULL) return NULL;
+
+  size_t max_len = strlen(schemata) * 2 + 256;
+  char* out = ecalloc(max_len, sizeof(char));
+  size_t len = 0;
+
+  for(char* line = strtok(schemata, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+    while(*line == ' ') line++;
+    char* domains = strchr(line, ':');
+    if(domains == NULL || strncmp(line, "L3", 2) != 0) continue;
+    *domains++ = '\0';
+
+    len += snprintf(out + len, max_len - len, "%s:", line);
+    char* save;
+    bool first = true;
+    for(char* dom = strtok_r(domains, ";", &save); dom != NULL; dom = strtok_r(NULL, ";", &save)) {
+      long id = strtol(dom, NULL, 10);
+      len += snprintf(out + len, max_len - len, "%s%ld=%llx", first ? "" : ";", id, (unsigned long long) mask);
+      first = false;
+    }
+    len += snprintf(out + len, max_len - len, "\n");
+  }
+
+  free(schemata);
+  if(len == 0) {
+    free(out);
+    return NULL;
+  }
+  return out;
+}
+
+double measure_cat_bandwidth(void* buf, size_t size) {
+  int reps = CAT_BYTES / size > 0 ? CAT_BYTES / size : 1;
+  double best = -1.0;
+  for(int r=0; r < CAT_REPS; r++) {
+    double bw = measure_read_bandwidth(buf, size, reps);
+    if(bw > best) best = bw;
+  }
+  return best;
+}
+
+// Measures the read bandwidth of buffers of up to the L3 size, first
+// in the default group and then in a new group restricted to mask.
+// If the partition works, the buffers that do not fit in the masked
+// capacity fall out of the L3 and are served from memory
+bool run_cat_benchmark(struct cpuInfo* cpu, uint64_t mask) {
+  if(cpu->cach == NULL || cpu->cach->L3 == NULL || !cpu->cach->L3->exists) {
+    printErr("The L3 cache size is unknown");
+    return false;
+  }
+  const char* res = access(_PATH_RESCTRL_INFO "/L3", R_OK) == 0 ? "L3" : "L3DATA";
+  char* cbm_str = get_resctrl_str(res, "cbm_mask");
+  if(cbm_str == NULL) {
+    printErr("resctrl does not support L3 allocation");
+    return false;
+  }
+  uint64_t cbm = strtoull(cbm_str, NULL, 16);
+  free(cbm_str);
+  if((mask & ~cbm) != 0) {
+    printErr("The mask 0x%llx is not a subset of the L3 bitmask 0x%llx", (unsigned long long) mask, (unsigned long long) cbm);
+    return false;
+  }
+
+  char* schemata = build_cat_schemata(mask);
+  if(schemata == NULL) {
+    printErr("Unable to find the L3 domains in %s", _PATH_RESCTRL_SCHEMATA);
+    return false;
+  }
+
+  int32_t first_cpu = get_module_first_cpu(cpu, 0);
+  if(!bind_to_cpu(first_cpu)) {
+    printErr("Failed binding the process to CPU %d", first_cpu);
+    free(schemata);
+    return false;
+  }
+
+  size_t l3_size = cpu->cach->L3->size;
+  size_t masked_size = l3_size / __builtin_popcountll(cbm) * __builtin_popcountll(mask);
+  double def_bw[CAT_STEPS];
+  double cat_bw[CAT_STEPS];
+
+  printf("\nL3 CAT benchmark (mask 0x%llx of 0x%llx, %d of %d ways, ~%zu KiB of %zu KiB):\n",
+         (unsigned long long) mask, (unsigned long long) cbm, __builtin_popcountll(mask),
+         __builtin_popcountll(cbm), masked_size / 1024, l3_size / 1024);
+
+  void* def_buf = alloc_bench_buffer(l3_size);
+  if(def_buf == NULL) {
+    free(schemata);
+    return false;
+  }
+  touch_buffer(def_buf, l3_size);
+  for(int i=0; i < CAT_STEPS; i++)
+    def_bw[i] = measure_cat_bandwidth(def_buf, l3_size * (i+1) / CAT_STEPS);
+
+  char group[64];
+  char path[_PATH_SYSFS_MAX_LEN];
+  char pid[32];
+  snprintf(group, sizeof(group), "%s/cpufetch-%d", _PATH_RESCTRL, (int) getpid());
+  snprintf(pid, sizeof(pid), "%d\n", (int) getpid());
+
+  if(mkdir(group, 0755) == -1) {
+    if(errno == ENOSPC) printErr("mkdir: %s: no free class of service left", group);
+    else printErr("mkdir: %s: %s", group, strerror(errno));
+    free_bench_buffer(def_buf, l3_size);
+    free(schemata);
+    return false;
+  }
+
+  bool ret = false;
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/schemata", group);
+  if(write_resctrl_file(path, schemata)) {
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/tasks", group);
+    ret = write_resctrl_file(path, pid);
+  }
+
+  if(ret) {
+    // CAT only restricts where new lines are allocated, so the lines
+    // of def_buf may still hit outside the mask. A new buffer (allocated
+    // while def_buf is alive, so that the pages are not reused) is
+    // filled inside the group and only competes for the masked ways
+    void* cat_buf = alloc_bench_buffer(l3_size);
+    if(cat_buf == NULL) {
+      ret = false;
+    }
+    else {
+      touch_buffer(cat_buf, l3_size);
+      for(int i=0; i < CAT_STEPS; i++)
+        cat_bw[i] = measure_cat_bandwidth(cat_buf, l3_size * (i+1) / CAT_STEPS);
+      free_bench_buffer(cat_buf, l3_size);
+    }
+    write_resctrl_file(_PATH_RESCTRL_TASKS, pid);
+  }
+
+  if(rmdir(group) == -1)
+    printWarn("rmdir: %s: %s", group, strerror(errno));
+  free_bench_buffer(def_buf, l3_size);
+  free(schemata);
+  if(!ret) return false;
+
+  printf("  %-12s %12s %12s\n", "Size", "Default", "Masked");
+  double ratio_sum = 0.0;
+  int ratio_num = 0;
+  for(int i=0; i < CAT_STEPS; i++) {
+    size_t size = l3_size * (i+1) / CAT_STEPS;
+    char* def_str = get_str_bandwidth(def_bw[i]);
+    char* cat_str = get_str_bandwidth(cat_bw[i]);
+    printf("  %8zu KiB %12s %12s\n", size / 1024, def_str, cat_str);
+    free(def_str);
+    free(cat_str);
+    if(size > masked_size && def_bw[i] > 0.0 && cat_bw[i] > 0.0) {
+      ratio_sum += cat_bw[i] / def_bw[i];
+      ratio_num++;
+    }
+  }
+
+  if(ratio_num == 0)
+    printf("The mask covers the whole L3, there is nothing to compare\n");
+  else if(ratio_sum / ratio_num < CAT_EFFECTIVE)
+    printf("The partition takes effect: buffers larger than the masked capacity run at %.0f%% of the default bandwidth\n",
+           100.0 * ratio_sum / ratio_num);
+  else
+    printf("No effect measured (%.0f%% of the default bandwidth): the allocation may not be enforced (e.g., in a VM)\n",
+           100.0 * ratio_sum / ratio_num);
+
+  return true;
+}
+
+// Reports the cache and memory bandwidth allocation and monitoring
+// capabilities (cpuid on x86 and resctrl on every architecture). If
+// cat_mask is not zero, it also measures the L3 bandwidth under that
+// mask, which needs a writable resctrl (i.e., root)
+bool print_rdt(struct cpuInfo* cpu, uint64_t cat_mask) {
+#ifdef ARCH_X86
+  print_rdt_cpuid(cpu);
+#endif
+
+  if(!resctrl_mounted()) {
+    printf("resctrl: not mounted (mount -t resctrl resctrl %s)\n", _PATH_RESCTRL);
+    if(cat_mask != 0) {
+      printErr("The CAT benchmark needs resctrl");
+      return false;
+    }
+    return true;
+  }
+
+  printf("resctrl (%s):\n", _PATH_RESCTRL);
+  print_resctrl_info();
+
+  if(cat_mask == 0) return true;
+  if(access(_PATH_RESCTRL, W_OK) != 0) {
+    printErr("%s is not writable (the CAT benchmark must be run as root)", _PATH_RESCTRL);
+    return false;
+  }
+  return run_cat_benchmark(cpu, cat_mask);
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,10 @@
+#ifndef __RESCTRL__
+#define __RESCTRL__
+
+#include <stdint.h>
+
+#include "cpu.h"
+
+bool print_rdt(struct cpuInfo* cpu, uint64_t cat_mask);
+
+#endif
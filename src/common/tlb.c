@@ -0,0 +1,326 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <linux/mman.h>
+
+#include "global.h"
+#include "udev.h"
+#include "membench.h"
+#include "tlb.h"
+
+#ifdef ARCH_X86
+  #include "../x86/cpuid.h"
+#endif
+
+#define _PATH_HUGEPAGES       "/sys/kernel/mm/hugepages"
+#define _PATH_THP             "/sys/kernel/mm/transparent_hugepage"
+#define _PATH_THP_ENABLED     _PATH_THP "/enabled"
+#define _PATH_THP_DEFRAG      _PATH_THP "/defrag"
+#define _PATH_HUGEPAGES_NR    "/nr_hugepages"
+#define _PATH_HUGEPAGES_FREE  "/free_hugepages"
+
+#define TLB_MIN_SPAN          (64UL * 1024)
+#define TLB_MAX_SPAN          (256UL * 1024 * 1024)
+#define TLB_LOADS             (1UL << 20)
+#define MAX_HUGEPAGE_SIZES    8
+// Latency increase (relative to the smallest span) considered a knee
+#define TLB_KNEE_FACTOR       1.5
+
+enum {
+  PAGES_BASE,
+  PAGES_THP,
+  PAGES_HUGETLB
+};
+
+struct page_kind {
+  int type;
+  uint64_t page_size;   // Hugetlb page size
+  uint64_t max_span;    // Limited by the free hugepages in the pool
+  char name[32];
+};
+
+static const char* tlb_type_str[] = {
+  [TLB_TYPE_DATA]        = "Data",
+  [TLB_TYPE_INSTRUCTION] = "Instruction",
+  [TLB_TYPE_UNIFIED]     = "Unified",
+  [TLB_TYPE_LOAD]        = "Load",
+  [TLB_TYPE_STORE]       = "Store",
+};
+
+void get_str_size(char* str, size_t len, uint64_t bytes) {
+  if(bytes >= (1UL << 30) && bytes % (1UL << 30) == 0)
+    snprintf(str, len, "%lu GiB", (unsigned long) (bytes >> 30));
+  else if(bytes >= (1UL << 20) && bytes % (1UL << 20) == 0)
+    snprintf(str, len, "%lu MiB", (unsigned long) (bytes >> 20));
+  else
+    snprintf(str, len, "%lu KiB", (unsigned long) (bytes >> 10));
+}
+
+void print_tlb_geometry(struct cpuInfo* cpu) {
+  struct tlb* tlb = NULL;
+  char reach[32];
+
+#ifdef ARCH_X86
+  tlb = get_tlb_info(cpu);
+#else
+  UNUSED(cpu);
+#endif
+
+  printf("TLB geometry:\n");
+  if(tlb == NULL) {
+    printf("  Not available\n");
+    return;
+  }
+
+  printf("  %-5s %-11s %-12s %8s %6s %9s\n", "Level", "Type", "Page sizes", "Entries", "Ways", "Reach");
+  for(int i=0; i < tlb->num_levels; i++) {
+    struct tlb_level* t = &tlb->levels[i];
+    char pages[32] = "";
+    uint64_t smallest = 0;
+
+    if(t->page_sizes & TLB_PAGE_4K) { strcat(pages, "4K/"); if(!smallest) smallest = 4096UL; }
+    if(t->page_sizes & TLB_PAGE_2M) { strcat(pages, "2M/"); if(!smallest) smallest = 2UL << 20; }
+    if(t->page_sizes & TLB_PAGE_4M) { strcat(pages, "4M/"); if(!smallest) smallest = 4UL << 20; }
+    if(t->page_sizes & TLB_PAGE_1G) { strcat(pages, "1G/"); if(!smallest) smallest = 1UL << 30; }
+    if(pages[0] != '\0') pages[strlen(pages)-1] = '\0';
+
+    get_str_size(reach, sizeof(reach), smallest * t->entries);
+    if(t->ways == 0)
+      printf("  L%-4d %-11s %-12s %8d %6s %9s\n", t->level, tlb_type_str[t->type], pages, t->entries, "full", reach);
+    else
+      printf("  L%-4d %-11s %-12s %8d %6d %9s\n", t->level, tlb_type_str[t->type], pages, t->entries, t->ways, reach);
+  }
+
+  free_tlb_struct(tlb);
+}
+
+// Returns the option selected in a sysfs file like "always [madvise] never"
+char* get_selected_option(char* path) {
+  char* buf = get_str_from_file(path);
+  if(buf == NULL) return NULL;
+
+  char* start = strchr(buf, '[');
+  char* end = start != NULL ? strchr(start, ']') : NULL;
+  if(start == NULL || end == NULL) return buf;
+
+  *end = '\0';
+  memmove(buf, start + 1, strlen(start + 1) + 1);
+  return buf;
+}
+
+// Prints the THP policy and the hugetlb pools, filling the page kinds
+// that can be benchmarked. Returns the number of kinds filled.
+int get_page_kinds(struct page_kind* kinds) {
+  char path[_PATH_SYSFS_MAX_LEN + 256];
+  int nkinds = 0;
+  bool success;
+
+  kinds[nkinds].type = PAGES_BASE;
+  kinds[nkinds].max_span = TLB_MAX_SPAN;
+  get_str_size(kinds[nkinds].name, sizeof(kinds[nkinds].name), sysconf(_SC_PAGESIZE));
+  nkinds++;
+
+  char* enabled = get_selected_option(_PATH_THP_ENABLED);
+  char* defrag = get_selected_option(_PATH_THP_DEFRAG);
+  printf("Transparent huge pages: %s (defrag: %s)\n", enabled != NULL ? enabled : STRING_UNKNOWN, defrag != NULL ? defrag : STRING_UNKNOWN);
+  if(enabled != NULL && strcmp(enabled, "never") != 0) {
+    kinds[nkinds].type = PAGES_THP;
+    kinds[nkinds].max_span = TLB_MAX_SPAN;
+    strcpy(kinds[nkinds].name, "THP");
+    nkinds++;
+  }
+  free(enabled);
+  free(defrag);
+
+  DIR* dir = opendir(_PATH_HUGEPAGES);
+  if(dir == NULL) {
+    printf("Hugetlb pools: Not available\n");
+    return nkinds;
+  }
+
+  printf("Hugetlb pools:\n");
+  struct dirent* entry;
+  while((entry = readdir(dir)) != NULL) {
+    unsigned long size_kb;
+    if(sscanf(entry->d_name, "hugepages-%lukB", &size_kb) != 1) continue;
+
+    snprintf(path, sizeof(path), "%s/%s%s", _PATH_HUGEPAGES, entry->d_name, _PATH_HUGEPAGES_NR);
+    long total = get_value_from_file(path, &success);
+    if(!success) total = 0;
+    snprintf(path, sizeof(path), "%s/%s%s", _PATH_HUGEPAGES, entry->d_name, _PATH_HUGEPAGES_FREE);
+    long nfree = get_value_from_file(path, &success);
+    if(!success) nfree = 0;
+
+    uint64_t page_size = (uint64_t) size_kb * 1024;
+    char name[32];
+    get_str_size(name, sizeof(name), page_size);
+    printf("  %-8s %6ld total, %6ld free\n", name, total, nfree);
+
+    uint64_t max_span = page_size * nfree;
+    if(max_span > TLB_MAX_SPAN) max_span = TLB_MAX_SPAN;
+    if(nfree > 0 && nkinds < MAX_HUGEPAGE_SIZES + 2) {
+      kinds[nkinds].type = PAGES_HUGETLB;
+      kinds[nkinds].page_size = page_size;
+      kinds[nkinds].max_span = max_span;
+      strcpy(kinds[nkinds].name, name);
+      nkinds++;
+    }
+  }
+  closedir(dir);
+
+  return nkinds;
+}
+
+void* alloc_pages(struct page_kind* kind, size_t* size) {
+  void* buf;
+
+  if(kind->type == PAGES_HUGETLB) {
+    *size = (kind->max_span + kind->page_size - 1) / kind->page_size * kind->page_size;
+    int shift = __builtin_ctzll(kind->page_size);
+    buf = mmap(NULL, *size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT), -1, 0);
+    if(buf == MAP_FAILED) {
+      printWarn("mmap with %s huge pages: %s", kind->name, strerror(errno));
+      return NULL;
+    }
+    return buf;
+  }
+
+  *size = kind->max_span;
+  if((buf = alloc_bench_buffer(*size)) == NULL) return NULL;
+
+  // Explicitly ask for (or avoid) THP, whatever the system policy is
+  if(madvise(buf, *size, kind->type == PAGES_THP ? MADV_HUGEPAGE : MADV_NOHUGEPAGE) != 0) {
+    printWarn("madvise: %s", strerror(errno));
+  }
+  return buf;
+}
+
+// Builds a random chain visiting one cache line per base page, so that
+// the data footprint stays small and the latency is dominated by the TLB.
+// The line within the page is hashed from the page number to avoid
+// conflicts in the caches (mostly with huge pages, where the physical
+// address bits above the page offset are not random).
+void** build_page_chase(void* buf, uint64_t npages, uint64_t page_size) {
+  uint64_t* order = emalloc(sizeof(uint64_t) * npages);
+  uint64_t lines_per_page = page_size / CHASE_STRIDE;
+  uint64_t seed = 88172645463325252ULL;
+  char* base = (char *) buf;
+
+  for(uint64_t i=0; i < npages; i++) order[i] = i;
+  for(uint64_t i=npages-1; i > 0; i--) {
+    seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+    uint64_t j = seed % (i + 1);
+    uint64_t tmp = order[i];
+    order[i] = order[j];
+    order[j] = tmp;
+  }
+
+#define PAGE_ELEM(p) (base + (p) * page_size + ((((p) * 0x9E3779B97F4A7C15ULL) >> 32) % lines_per_page) * CHASE_STRIDE)
+  for(uint64_t i=0; i < npages; i++) {
+    *(void **) PAGE_ELEM(order[i]) = PAGE_ELEM(order[(i+1) % npages]);
+  }
+  void** start = (void **) PAGE_ELEM(order[0]);
+#undef PAGE_ELEM
+
+  free(order);
+  return start;
+}
+
+// Sweeps the working set (span) for every page kind available and
+// reports the latency per load, the knee where the TLB stops covering
+// the span and the speedup obtained with huge pages.
+bool print_tlb_benchmark(struct cpuInfo* cpu) {
+  struct page_kind kinds[MAX_HUGEPAGE_SIZES + 2];
+  uint64_t base_page = sysconf(_SC_PAGESIZE);
+  char str[32];
+
+  print_tlb_geometry(cpu);
+  printf("\n");
+  int nkinds = get_page_kinds(kinds);
+
+  int nspans = 0;
+  for(uint64_t span=TLB_MIN_SPAN; span <= TLB_MAX_SPAN; span *= 2) nspans++;
+  double* lat = emalloc(sizeof(double) * nspans * nkinds);
+  for(int i=0; i < nspans * nkinds; i++) lat[i] = -1.0;
+
+  printf("\ncpufetch is measuring the latency of one load per %lu KiB page...\n", (unsigned long) (base_page >> 10));
+
+  for(int k=0; k < nkinds; k++) {
+    size_t size;
+    void* buf = alloc_pages(&kinds[k], &size);
+    if(buf == NULL) continue;
+
+    int s = 0;
+    for(uint64_t span=TLB_MIN_SPAN; span <= TLB_MAX_SPAN; span *= 2, s++) {
+      if(span > kinds[k].max_span) break;
+      void** start = build_page_chase(buf, span / base_page, base_page);
+      lat[s * nkinds + k] = measure_chase_latency(start, TLB_LOADS);
+    }
+
+    if(kinds[k].type == PAGES_HUGETLB) munmap(buf, size);
+    else free_bench_buffer(buf, size);
+  }
+
+  printf("\n  %-8s", "Span");
+  for(int k=0; k < nkinds; k++) printf(" %10s", kinds[k].name);
+  printf(" %9s\n", "Speedup");
+
+  int s = 0;
+  for(uint64_t span=TLB_MIN_SPAN; span <= TLB_MAX_SPAN; span *= 2, s++) {
+    double best_huge = -1.0;
+    get_str_size(str, sizeof(str), span);
+    printf("  %-8s", str);
+    for(int k=0; k < nkinds; k++) {
+      double l = lat[s * nkinds + k];
+      if(l < 0) printf(" %10s", "-");
+      else printf(" %7.1f ns", l);
+      if(k > 0 && l > 0 && (best_huge < 0 || l < best_huge)) best_huge = l;
+    }
+    if(best_huge > 0 && lat[s * nkinds] > 0) printf(" %8.2fx\n", lat[s * nkinds] / best_huge);
+    else printf(" %9s\n", "-");
+  }
+
+  printf("\n");
+  for(int k=0; k < nkinds; k++) {
+    double first = lat[k];
+    if(first <= 0) continue;
+
+    s = 0;
+    bool found = false;
+    for(uint64_t span=TLB_MIN_SPAN; span <= TLB_MAX_SPAN && !found; span *= 2, s++) {
+      double l = lat[s * nkinds + k];
+      if(l > 0 && l > first * TLB_KNEE_FACTOR) {
+        get_str_size(str, sizeof(str), span);
+        printf("%s pages: latency knee at %s (%.1f ns -> %.1f ns)\n", kinds[k].name, str, first, l);
+        found = true;
+      }
+    }
+    if(!found) printf("%s pages: no knee found\n", kinds[k].name);
+  }
+
+  // The data footprint is the same for every page kind, so the difference
+  // at the biggest span is (approximately) the cost of the TLB misses
+  double largest_base = lat[(nspans - 1) * nkinds];
+  double largest_huge = -1.0;
+  for(int k=1; k < nkinds; k++) {
+    double l = lat[(nspans - 1) * nkinds + k];
+    if(l > 0 && (largest_huge < 0 || l < largest_huge)) largest_huge = l;
+  }
+  if(largest_base > 0 && largest_huge > 0) {
+    get_str_size(str, sizeof(str), TLB_MAX_SPAN);
+    printf("TLB miss cost at %s: %.1f ns per load\n", str, largest_base - largest_huge);
+  }
+
+  free(lat);
+  return true;
+}
+
+#endif // #ifdef __linux__
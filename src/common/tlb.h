@@ -0,0 +1,8 @@
+#ifndef __TLB__
+#define __TLB__
+
+#include "cpu.h"
+
+bool print_tlb_benchmark(struct cpuInfo* cpu);
+
+#endif
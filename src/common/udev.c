@@ -78,6 +78,102 @@ char* read_file(char* path, int* len) {
   return buf;
 }
 
+// Reads a file containing a single integer (e.g., sysfs attributes).
+// Sets success to false if the file does not exist or is not a number
+long get_value_from_file(char* path, bool* success) {
+  int filelen;
+  char* buf;
+  *success = false;
+
+  if((buf = read_file(path, &filelen)) == NULL) {
+    return UNKNOWN_DATA;
+  }
+
+  char* end;
+  errno = 0;
+  long ret = strtol(buf, &end, 0);
+  if(errno != 0 || end == buf) {
+    free(buf);
+    return UNKNOWN_DATA;
+  }
+
+  free(buf);
+  *success = true;
+  return ret;
+}
+
+// Reads a file containing a single line of text,
+// returning it without the trailing newline
+char* get_str_from_file(char* path) {
+  int filelen;
+  char* buf;
+
+  if((buf = read_file(path, &filelen)) == NULL) {
+    return NULL;
+  }
+
+  while(filelen > 0 && (buf[filelen-1] == '\n' || buf[filelen-1] == ' ')) {
+    buf[filelen-1] = '\0';
+    filelen--;
+  }
+
+  return buf;
+}
+
+// Parses a list of CPUs in the kernel cpulist format
+// (e.g., "0-3,8,10-11") and sets the corresponding entries of cpus.
+// https://www.kernel.org/doc/html/latest/admin-guide/cputopology.html
+// Returns the number of CPUs found in the list or -1 on error
+int parse_cpu_list(char* str, bool* cpus, int ncpus) {
+  int count = 0;
+  char* ptr = str;
+
+  for(int i=0; i < ncpus; i++) cpus[i] = false;
+
+  while(*ptr != '\0' && *ptr != '\n') {
+    char* end;
+    errno = 0;
+    long first = strtol(ptr, &end, 10);
+    if(errno != 0 || end == ptr) {
+      printWarn("parse_cpu_list: Invalid cpu list: '%s'", str);
+      return -1;
+    }
+    long last = first;
+    ptr = end;
+
+    if(*ptr == '-') {
+      ptr++;
+      last = strtol(ptr, &end, 10);
+      if(errno != 0 || end == ptr || last < first) {
+        printWarn("parse_cpu_list: Invalid cpu list: '%s'", str);
+        return -1;
+      }
+      ptr = end;
+    }
+
+    for(long c=first; c <= last && c < ncpus; c++) {
+      if(!cpus[c]) count++;
+      cpus[c] = true;
+    }
+
+    if(*ptr == ',') ptr++;
+  }
+
+  return count;
+}
+
+// Reads a CPU list from sysfs, returning false (and an empty list) if
+// the file does not exist, which happens when the kernel does not
+// support the feature
+bool get_cpu_list_from_file(char* path, bool* cpus, int ncpus) {
+  char* str = get_str_from_file(path);
+  memset(cpus, 0, sizeof(bool) * ncpus);
+  if(str == NULL) return false;
+  bool ret = parse_cpu_list(str, cpus, ncpus) >= 0;
+  free(str);
+  return ret;
+}
+
 long get_freq_from_file(char* path) {
   int filelen;
   char* buf;
@@ -177,6 +273,42 @@ long get_min_freq_from_file(uint32_t core) {
   return get_freq_from_file(path);
 }
 
+// Returns the value of cpuN<dir><file> (e.g., cpu0/cpufreq/base_frequency),
+// or -1 if it does not exist
+long get_cpu_sysfs_value(int cpu, const char* dir, const char* file) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  bool success = true;
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, cpu, dir, file);
+  long ret = get_value_from_file(path, &success);
+  return success ? ret : -1;
+}
+
+char* get_cpu_sysfs_str(int cpu, const char* dir, const char* file) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, cpu, dir, file);
+  return get_str_from_file(path);
+}
+
+char* get_str_governor(uint32_t core) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, core, _PATH_FREQUENCY, _PATH_FREQUENCY_GOVERNOR);
+  return get_str_from_file(path);
+}
+
+char* get_str_epp(uint32_t core) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, core, _PATH_FREQUENCY, _PATH_FREQUENCY_EPP);
+  return get_str_from_file(path);
+}
+
+// Returns the kernel status of the given vulnerability
+// (e.g., "gather_data_sampling"), or NULL if it is not reported
+char* get_str_vulnerability(const char* name) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  snprintf(path, _PATH_SYSFS_MAX_LEN, "%s/%s", _PATH_VULNERABILITIES, name);
+  return get_str_from_file(path);
+}
+
 long get_l1i_cache_size(uint32_t core) {
   char path[_PATH_CACHE_MAX_LEN];
   sprintf(path, "%s%s/cpu%d%s%s",  _PATH_SYS_SYSTEM, _PATH_SYS_CPU, core, _PATH_CACHE_L1I, _PATH_CACHE_SIZE);
@@ -201,6 +333,22 @@ long get_l3_cache_size(uint32_t core) {
   return get_cache_size_from_file(path);
 }
 
+// level follows the cach_arr order (0: L1i, 1: L1d, 2: L2, 3: L3)
+long get_cache_line_size(uint32_t core, uint32_t level) {
+  const char* cache_paths[] = { _PATH_CACHE_L1I, _PATH_CACHE_L1D, _PATH_CACHE_L2, _PATH_CACHE_L3 };
+  char path[_PATH_CACHE_MAX_LEN];
+  bool success;
+
+  if(level > 3) {
+    printBug("Found invalid cache level to inspect: %d", level);
+    return -1;
+  }
+
+  snprintf(path, _PATH_CACHE_MAX_LEN, "%s%s/cpu%d%s%s", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, core, cache_paths[level], _PATH_CACHE_LINE_SIZE);
+  long line_size = get_value_from_file(path, &success);
+  return success ? line_size : -1;
+}
+
 void add_shared_map(uint32_t** src, int src_idx, uint32_t** dst, int dst_idx, int n) {
   for(int j=0; j < n; j++) {
     dst[dst_idx][j] = src[src_idx][j];
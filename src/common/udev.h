@@ -24,12 +24,41 @@
 #define _PATH_CACHE_L3          "/cache/index3"
 #define _PATH_CACHE_SIZE        "/size"
 #define _PATH_CACHE_SHARED_MAP  "/shared_cpu_map"
+#define _PATH_CACHE_LINE_SIZE   "/coherency_line_size"
 #define _PATH_CPUS_PRESENT      _PATH_SYS_SYSTEM _PATH_SYS_CPU "/present"
+#define _PATH_CPUS_ONLINE       _PATH_SYS_SYSTEM _PATH_SYS_CPU "/online"
 #define _PATH_TOPO_PACKAGE_CPUS "/topology/package_cpus"
+#define _PATH_TOPO_PACKAGE_ID   "/topology/physical_package_id"
+#define _PATH_TOPO_CORE_ID      "/topology/core_id"
+#define _PATH_TOPO_CORE_CPUS_LIST "/topology/core_cpus_list"
+#define _PATH_TOPO_THREAD_SIBLINGS_LIST "/topology/thread_siblings_list"
+#define _PATH_CACHE_ID          "/id"
+#define _PATH_CACHE_SHARED_LIST "/shared_cpu_list"
+#define _PATH_SYS_NODE          "/node"
+#define _PATH_NODES_ONLINE      _PATH_SYS_SYSTEM _PATH_SYS_NODE "/online"
+#define _PATH_NODE_CPULIST      "/cpulist"
+#define _PATH_NODE_DISTANCE     "/distance"
+#define _PATH_NODE_MEMINFO      "/meminfo"
+#define _PATH_NODES_HAS_MEMORY  _PATH_SYS_SYSTEM _PATH_SYS_NODE "/has_memory"
+#define _PATH_CPUIDLE           "/cpuidle"
+#define _PATH_CPUIDLE_GOVERNOR  _PATH_SYS_SYSTEM _PATH_SYS_CPU _PATH_CPUIDLE "/current_governor_ro"
+#define _PATH_FREQUENCY_GOVERNOR "/scaling_governor"
+#define _PATH_FREQUENCY_EPP     "/energy_performance_preference"
+#define _PATH_FREQUENCY_DRIVER  "/scaling_driver"
+#define _PATH_FREQUENCY_BASE    "/base_frequency"
+#define _PATH_SCALING_MAX       "/scaling_max_freq"
+#define _PATH_SCALING_MIN       "/scaling_min_freq"
+#define _PATH_VULNERABILITIES   _PATH_SYS_SYSTEM _PATH_SYS_CPU "/vulnerabilities"
+#define _PATH_CPUS_ISOLATED     _PATH_SYS_SYSTEM _PATH_SYS_CPU "/isolated"
+#define _PATH_CPUS_NOHZ_FULL    _PATH_SYS_SYSTEM _PATH_SYS_CPU "/nohz_full"
+#define _PATH_INTERRUPTS        "/proc/interrupts"
+#define _PATH_CMDLINE           "/proc/cmdline"
+#define _PATH_IRQ               "/proc/irq"
 
 #define _PATH_FREQUENCY_MAX_LEN 100
 #define _PATH_CACHE_MAX_LEN     200
 #define _PATH_PACKAGE_MAX_LEN   200
+#define _PATH_SYSFS_MAX_LEN     256
 
 struct devtree {
   char* vendor;
@@ -37,15 +66,25 @@ struct devtree {
 };
 
 char* read_file(char* path, int* len);
+long get_value_from_file(char* path, bool* success);
+char* get_str_from_file(char* path);
+int parse_cpu_list(char* str, bool* cpus, int ncpus);
+bool get_cpu_list_from_file(char* path, bool* cpus, int ncpus);
 long get_max_freq_from_file(uint32_t core);
 long get_min_freq_from_file(uint32_t core);
 long get_l1i_cache_size(uint32_t core);
 long get_l1d_cache_size(uint32_t core);
 long get_l2_cache_size(uint32_t core);
 long get_l3_cache_size(uint32_t core);
+long get_cache_line_size(uint32_t core, uint32_t level);
 int get_num_caches_by_level(struct cpuInfo* cpu, uint32_t level);
 int get_num_sockets_package_cpus(struct topology* topo);
 int get_ncores_from_cpuinfo(void);
+long get_cpu_sysfs_value(int cpu, const char* dir, const char* file);
+char* get_cpu_sysfs_str(int cpu, const char* dir, const char* file);
+char* get_str_governor(uint32_t core);
+char* get_str_epp(uint32_t core);
+char* get_str_vulnerability(const char* name);
 char* get_field_from_cpuinfo(char* CPUINFO_FIELD);
 bool is_devtree_compatible(char* str);
 char* get_devtree_compatible(int *filelen);
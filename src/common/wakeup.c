@@ -0,0 +1,281 @@
+#ifdef __linux__
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/futex.h>
+
+#include "global.h"
+#include "udev.h"
+#include "bench.h"
+#include "cpumap.h"
+#include "wakeup.h"
+
+#define WAKEUP_SAMPLES       500
+// Time the woken thread is left idle before each wake-up. It must be long
+// enough for the idle governor to select the deeper idle states.
+#define WAKEUP_IDLE_US      1000
+#define MAX_IDLE_STATES       16
+
+#define _PATH_CPUIDLE_STATE_NAME      "/name"
+#define _PATH_CPUIDLE_STATE_LATENCY   "/latency"
+#define _PATH_CPUIDLE_STATE_RESIDENCY "/residency"
+#define _PATH_CPUIDLE_STATE_DISABLE   "/disable"
+
+enum {
+  WAKEUP_FUTEX,
+  WAKEUP_EVENTFD,
+  WAKEUP_SPIN,
+  WAKEUP_METHODS
+};
+
+static const char* wakeup_method_str[] = {
+  [WAKEUP_FUTEX]   = "futex",
+  [WAKEUP_EVENTFD] = "eventfd",
+  [WAKEUP_SPIN]    = "spin",
+};
+
+// Fields written by different threads are kept in different cache lines
+struct wakeup_state {
+  int method;
+  int efd;
+  int nsamples;
+  uint64_t* samples;
+  char pad0[64];
+  uint32_t seq;
+  uint64_t t_send;
+  char pad1[64];
+  uint32_t ack;
+  bool failed;  // Set by the wakee when it stops early
+};
+
+static long futex(uint32_t* uaddr, int op, uint32_t val) {
+  return syscall(SYS_futex, uaddr, op, val, NULL, NULL, 0);
+}
+
+void* wakee_thread(void* arg) {
+  struct wakeup_state* st = (struct wakeup_state*) arg;
+  uint64_t value;
+
+  for(int i=0; i < st->nsamples; i++) {
+    uint32_t expected = (uint32_t) i;
+
+    switch(st->method) {
+      case WAKEUP_FUTEX:
+        while(__atomic_load_n(&st->seq, __ATOMIC_ACQUIRE) == expected)
+          futex(&st->seq, FUTEX_WAIT_PRIVATE, expected);
+        break;
+      case WAKEUP_EVENTFD:
+        if(read(st->efd, &value, sizeof(uint64_t)) != sizeof(uint64_t)) {
+          printErr("read: %s", strerror(errno));
+          __atomic_store_n(&st->failed, true, __ATOMIC_RELEASE);
+          return NULL;
+        }
+        break;
+      default:
+        while(__atomic_load_n(&st->seq, __ATOMIC_ACQUIRE) == expected)
+          cpu_relax();
+        break;
+    }
+
+    uint64_t now = get_time_ns();
+    st->samples[i] = now - __atomic_load_n(&st->t_send, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&st->ack, expected + 1, __ATOMIC_RELEASE);
+  }
+
+  return NULL;
+}
+
+// Measures the time elapsed since the waker thread (running in cpu_waker)
+// signals the wakee (running in cpu_wakee) until the latter starts running
+bool measure_wakeup(int method, int cpu_waker, int cpu_wakee, uint64_t* samples, int nsamples) {
+  struct wakeup_state* st = ecalloc(1, sizeof(struct wakeup_state));
+  st->method = method;
+  st->nsamples = nsamples;
+  st->samples = samples;
+  st->efd = -1;
+
+  if(method == WAKEUP_EVENTFD && (st->efd = eventfd(0, 0)) == -1) {
+    printErr("eventfd: %s", strerror(errno));
+    free(st);
+    return false;
+  }
+
+  if(!bind_to_cpu(cpu_waker)) {
+    printErr("Failed binding the process to CPU %d", cpu_waker);
+    if(st->efd != -1) close(st->efd);
+    free(st);
+    return false;
+  }
+
+  pthread_t wakee;
+  if(!create_thread_on_cpu(&wakee, cpu_wakee, wakee_thread, st)) {
+    if(st->efd != -1) close(st->efd);
+    free(st);
+    return false;
+  }
+
+  uint64_t one = 1;
+  for(int i=0; i < nsamples; i++) {
+    sleep_us(WAKEUP_IDLE_US);
+
+    __atomic_store_n(&st->t_send, get_time_ns(), __ATOMIC_RELEASE);
+    __atomic_store_n(&st->seq, (uint32_t) i + 1, __ATOMIC_RELEASE);
+    if(method == WAKEUP_FUTEX) {
+      futex(&st->seq, FUTEX_WAKE_PRIVATE, 1);
+    }
+    else if(method == WAKEUP_EVENTFD) {
+      if(write(st->efd, &one, sizeof(uint64_t)) != sizeof(uint64_t)) {
+        printErr("write: %s", strerror(errno));
+        // The wakee is blocked in read, which is a cancellation point
+        pthread_cancel(wakee);
+        pthread_join(wakee, NULL);
+        close(st->efd);
+        free(st);
+        return false;
+      }
+    }
+
+    while(__atomic_load_n(&st->ack, __ATOMIC_ACQUIRE) != (uint32_t) i + 1) {
+      if(__atomic_load_n(&st->failed, __ATOMIC_ACQUIRE)) {
+        pthread_join(wakee, NULL);
+        if(st->efd != -1) close(st->efd);
+        free(st);
+        return false;
+      }
+      cpu_relax();
+    }
+  }
+
+  pthread_join(wakee, NULL);
+  if(st->efd != -1) close(st->efd);
+  free(st);
+
+  return true;
+}
+
+void print_idle_states(int cpu) {
+  char path[_PATH_SYSFS_MAX_LEN];
+  char* governor = get_str_from_file(_PATH_CPUIDLE_GOVERNOR);
+
+  printf("Idle states of CPU %d (cpuidle governor: %s):\n", cpu, governor != NULL ? governor : STRING_UNKNOWN);
+  free(governor);
+
+  int nstates = 0;
+  for(int s=0; s < MAX_IDLE_STATES; s++) {
+    bool success_lat, success_res, success_dis;
+    char* base = emalloc(sizeof(char) * _PATH_SYSFS_MAX_LEN);
+    snprintf(base, _PATH_SYSFS_MAX_LEN, "%s%s/cpu%d%s/state%d", _PATH_SYS_SYSTEM, _PATH_SYS_CPU, cpu, _PATH_CPUIDLE, s);
+
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s", base, _PATH_CPUIDLE_STATE_NAME);
+    char* name = get_str_from_file(path);
+    if(name == NULL) {
+      free(base);
+      break;
+    }
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s", base, _PATH_CPUIDLE_STATE_LATENCY);
+    long latency = get_value_from_file(path, &success_lat);
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s", base, _PATH_CPUIDLE_STATE_RESIDENCY);
+    long residency = get_value_from_file(path, &success_res);
+    snprintf(path, _PATH_SYSFS_MAX_LEN, "%s%s", base, _PATH_CPUIDLE_STATE_DISABLE);
+    long disabled = get_value_from_file(path, &success_dis);
+
+    if(nstates == 0) {
+      printf("  %-10s %14s %18s  %s\n", "State", "Exit latency", "Target residency", "Status");
+    }
+    printf("  %-10s %11ld us %15ld us  %s\n", name, success_lat ? latency : -1L, success_res ? residency : -1L,
+           success_dis && disabled ? "disabled" : "enabled");
+
+    nstates++;
+    free(name);
+    free(base);
+  }
+
+  if(nstates == 0) {
+    printf("  No cpuidle states found\n");
+  }
+
+  char* cpufreq_governor = get_str_governor(cpu);
+  char* epp = get_str_epp(cpu);
+  printf("Frequency governor: %s, EPP: %s\n", cpufreq_governor != NULL ? cpufreq_governor : STRING_UNKNOWN, epp != NULL ? epp : STRING_UNKNOWN);
+  free(cpufreq_governor);
+  free(epp);
+}
+
+bool print_wakeup_latency_pair(int relation, int cpu1, int cpu2) {
+  uint64_t* samples = emalloc(sizeof(uint64_t) * WAKEUP_SAMPLES);
+
+  printf("\n%s (CPU %d -> CPU %d):\n", get_str_cpu_relation(relation), cpu1, cpu2);
+  printf("  %-10s %9s %9s %9s %9s %9s\n", "Method", "min", "p50", "p90", "p99", "max");
+
+  for(int m=0; m < WAKEUP_METHODS; m++) {
+    if(!measure_wakeup(m, cpu1, cpu2, samples, WAKEUP_SAMPLES)) {
+      free(samples);
+      return false;
+    }
+    sort_samples(samples, WAKEUP_SAMPLES);
+    printf("  %-10s %6.1f us %6.1f us %6.1f us %6.1f us %6.1f us\n", wakeup_method_str[m],
+           samples[0] / 1000.0,
+           get_percentile(samples, WAKEUP_SAMPLES, 50) / 1000.0,
+           get_percentile(samples, WAKEUP_SAMPLES, 90) / 1000.0,
+           get_percentile(samples, WAKEUP_SAMPLES, 99) / 1000.0,
+           samples[WAKEUP_SAMPLES-1] / 1000.0);
+  }
+
+  free(samples);
+  return true;
+}
+
+// Measures the wake-up latency between pairs of cores placed at different
+// distances in the topology (SMT siblings, cores sharing the L3 and cores in
+// different sockets) and shows it next to the configured idle states.
+bool print_wakeup_latency(void) {
+  struct cpu_map* map = get_cpu_map();
+  if(map == NULL) {
+    printErr("Unable to build the CPU map");
+    return false;
+  }
+
+  int relations[] = { CPU_RELATION_SMT, CPU_RELATION_L3, CPU_RELATION_SOCKET, CPU_RELATION_CROSS_SOCKET };
+  int nrelations = sizeof(relations) / sizeof(relations[0]);
+  bool idle_printed = false;
+  bool found = false;
+
+  printf("cpufetch is measuring the wake-up latency (%d samples, %d us idle between wake-ups)...\n", WAKEUP_SAMPLES, WAKEUP_IDLE_US);
+
+  for(int r=0; r < nrelations; r++) {
+    int cpu1, cpu2;
+    if(!find_cpu_pair(map, relations[r], &cpu1, &cpu2)) {
+      printWarn("No pair of CPUs found with relation '%s'", get_str_cpu_relation(relations[r]));
+      continue;
+    }
+
+    if(!idle_printed) {
+      printf("\n");
+      print_idle_states(cpu2);
+      idle_printed = true;
+    }
+
+    found = true;
+    if(!print_wakeup_latency_pair(relations[r], cpu1, cpu2)) {
+      free_cpu_map(map);
+      return false;
+    }
+  }
+
+  if(!found) {
+    printErr("Unable to find a pair of online CPUs to measure the wake-up latency");
+  }
+
+  free_cpu_map(map);
+  return found;
+}
+
+#endif // #ifdef __linux__
@@ -0,0 +1,8 @@
+#ifndef __WAKEUP__
+#define __WAKEUP__
+
+#include <stdbool.h>
+
+bool print_wakeup_latency(void);
+
+#endif
@@ -0,0 +1,78 @@
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __SSE2__
+  #include <emmintrin.h>
+#endif
+
+#include "copy.h"
+
+void copy_rep_movsb(void* dst, const void* src, size_t n) {
+  __asm volatile("rep movsb"
+                 : "+D"(dst), "+S"(src), "+c"(n)
+                 :
+                 : "memory");
+}
+
+void set_rep_stosb(void* dst, int c, size_t n) {
+  __asm volatile("rep stosb"
+                 : "+D"(dst), "+c"(n)
+                 : "a"(c)
+                 : "memory");
+}
+
+#ifdef __SSE2__
+// Streaming stores need an aligned destination, so the head and the
+// tail that do not fill a whole 64 byte block are written normally
+void copy_nt(void* dst, const void* src, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+  const uint8_t* s = (const uint8_t *) src;
+  size_t head = (16 - ((uintptr_t) d & 15)) & 15;
+
+  if(n < head + 64) {
+    memcpy(d, s, n);
+    return;
+  }
+
+  memcpy(d, s, head);
+  d += head; s += head; n -= head;
+
+  for(; n >= 64; d += 64, s += 64, n -= 64) {
+    __m128i a = _mm_loadu_si128((const __m128i *) (s +  0));
+    __m128i b = _mm_loadu_si128((const __m128i *) (s + 16));
+    __m128i c = _mm_loadu_si128((const __m128i *) (s + 32));
+    __m128i e = _mm_loadu_si128((const __m128i *) (s + 48));
+    _mm_stream_si128((__m128i *) (d +  0), a);
+    _mm_stream_si128((__m128i *) (d + 16), b);
+    _mm_stream_si128((__m128i *) (d + 32), c);
+    _mm_stream_si128((__m128i *) (d + 48), e);
+  }
+  _mm_sfence();
+
+  memcpy(d, s, n);
+}
+
+void set_nt(void* dst, int c, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+  size_t head = (16 - ((uintptr_t) d & 15)) & 15;
+  __m128i v = _mm_set1_epi8((char) c);
+
+  if(n < head + 64) {
+    memset(d, c, n);
+    return;
+  }
+
+  memset(d, c, head);
+  d += head; n -= head;
+
+  for(; n >= 64; d += 64, n -= 64) {
+    _mm_stream_si128((__m128i *) (d +  0), v);
+    _mm_stream_si128((__m128i *) (d + 16), v);
+    _mm_stream_si128((__m128i *) (d + 32), v);
+    _mm_stream_si128((__m128i *) (d + 48), v);
+  }
+  _mm_sfence();
+
+  memset(d, c, n);
+}
+#endif
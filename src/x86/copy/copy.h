@@ -0,0 +1,24 @@
+#ifndef __COPY_KERNELS__
+#define __COPY_KERNELS__
+
+#include <stddef.h>
+
+// Copy and set kernels used by the memcpy/memset benchmark. The AVX2
+// and AVX-512 versions live in their own files, compiled with the
+// corresponding flags, and must only be called if the CPU supports them.
+
+void copy_rep_movsb(void* dst, const void* src, size_t n);
+void set_rep_stosb(void* dst, int c, size_t n);
+
+#ifdef __SSE2__
+void copy_nt(void* dst, const void* src, size_t n);
+void set_nt(void* dst, int c, size_t n);
+#endif
+
+void copy_avx2(void* dst, const void* src, size_t n);
+void set_avx2(void* dst, int c, size_t n);
+
+void copy_avx512(void* dst, const void* src, size_t n);
+void set_avx512(void* dst, int c, size_t n);
+
+#endif
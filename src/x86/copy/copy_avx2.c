@@ -0,0 +1,72 @@
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "copy.h"
+
+// Sizes that are not a multiple of the vector width are handled
+// with a last (overlapping) vector aligned to the end of the buffer
+void copy_avx2(void* dst, const void* src, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+  const uint8_t* s = (const uint8_t *) src;
+
+  if(n < 32) {
+    if(n >= 16) {
+      __m128i a = _mm_loadu_si128((const __m128i *) s);
+      __m128i b = _mm_loadu_si128((const __m128i *) (s + n - 16));
+      _mm_storeu_si128((__m128i *) d, a);
+      _mm_storeu_si128((__m128i *) (d + n - 16), b);
+    }
+    else {
+      for(size_t i=0; i < n; i++) d[i] = s[i];
+    }
+    return;
+  }
+
+  __m256i last = _mm256_loadu_si256((const __m256i *) (s + n - 32));
+  uint8_t* end = d + n - 32;
+
+  for(; n >= 128; d += 128, s += 128, n -= 128) {
+    __m256i a = _mm256_loadu_si256((const __m256i *) (s +  0));
+    __m256i b = _mm256_loadu_si256((const __m256i *) (s + 32));
+    __m256i c = _mm256_loadu_si256((const __m256i *) (s + 64));
+    __m256i e = _mm256_loadu_si256((const __m256i *) (s + 96));
+    _mm256_storeu_si256((__m256i *) (d +  0), a);
+    _mm256_storeu_si256((__m256i *) (d + 32), b);
+    _mm256_storeu_si256((__m256i *) (d + 64), c);
+    _mm256_storeu_si256((__m256i *) (d + 96), e);
+  }
+  for(; n >= 32; d += 32, s += 32, n -= 32) {
+    _mm256_storeu_si256((__m256i *) d, _mm256_loadu_si256((const __m256i *) s));
+  }
+  _mm256_storeu_si256((__m256i *) end, last);
+}
+
+void set_avx2(void* dst, int c, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+
+  if(n < 32) {
+    if(n >= 16) {
+      __m128i v = _mm_set1_epi8((char) c);
+      _mm_storeu_si128((__m128i *) d, v);
+      _mm_storeu_si128((__m128i *) (d + n - 16), v);
+    }
+    else {
+      for(size_t i=0; i < n; i++) d[i] = (uint8_t) c;
+    }
+    return;
+  }
+
+  __m256i v = _mm256_set1_epi8((char) c);
+  uint8_t* end = d + n - 32;
+
+  for(; n >= 128; d += 128, n -= 128) {
+    _mm256_storeu_si256((__m256i *) (d +  0), v);
+    _mm256_storeu_si256((__m256i *) (d + 32), v);
+    _mm256_storeu_si256((__m256i *) (d + 64), v);
+    _mm256_storeu_si256((__m256i *) (d + 96), v);
+  }
+  for(; n >= 32; d += 32, n -= 32) {
+    _mm256_storeu_si256((__m256i *) d, v);
+  }
+  _mm256_storeu_si256((__m256i *) end, v);
+}
@@ -0,0 +1,58 @@
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "copy.h"
+
+// Only AVX-512F is assumed (byte masks would need AVX-512BW), so
+// small sizes use the AVX2 kernels and the tail is handled with a
+// last (overlapping) vector aligned to the end of the buffer
+void copy_avx512(void* dst, const void* src, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+  const uint8_t* s = (const uint8_t *) src;
+
+  if(n < 64) {
+    copy_avx2(dst, src, n);
+    return;
+  }
+
+  __m512i last = _mm512_loadu_si512((const void *) (s + n - 64));
+  uint8_t* end = d + n - 64;
+
+  for(; n >= 256; d += 256, s += 256, n -= 256) {
+    __m512i a = _mm512_loadu_si512((const void *) (s +   0));
+    __m512i b = _mm512_loadu_si512((const void *) (s +  64));
+    __m512i c = _mm512_loadu_si512((const void *) (s + 128));
+    __m512i e = _mm512_loadu_si512((const void *) (s + 192));
+    _mm512_storeu_si512((void *) (d +   0), a);
+    _mm512_storeu_si512((void *) (d +  64), b);
+    _mm512_storeu_si512((void *) (d + 128), c);
+    _mm512_storeu_si512((void *) (d + 192), e);
+  }
+  for(; n >= 64; d += 64, s += 64, n -= 64) {
+    _mm512_storeu_si512((void *) d, _mm512_loadu_si512((const void *) s));
+  }
+  _mm512_storeu_si512((void *) end, last);
+}
+
+void set_avx512(void* dst, int c, size_t n) {
+  uint8_t* d = (uint8_t *) dst;
+
+  if(n < 64) {
+    set_avx2(dst, c, n);
+    return;
+  }
+
+  __m512i v = _mm512_set1_epi8((char) c);
+  uint8_t* end = d + n - 64;
+
+  for(; n >= 256; d += 256, n -= 256) {
+    _mm512_storeu_si512((void *) (d +   0), v);
+    _mm512_storeu_si512((void *) (d +  64), v);
+    _mm512_storeu_si512((void *) (d + 128), v);
+    _mm512_storeu_si512((void *) (d + 192), v);
+  }
+  for(; n >= 64; d += 64, n -= 64) {
+    _mm512_storeu_si512((void *) d, v);
+  }
+  _mm512_storeu_si512((void *) end, v);
+}
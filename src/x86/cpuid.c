@@ -390,6 +390,8 @@ struct features* get_features_info(struct cpuInfo* cpu) {
     feat->SSE4_2 = (ecx & (1U << 20)) != 0;
 
     feat->AES    = (ecx & (1U << 25)) != 0;
+    feat->PCLMUL = (ecx & (1U <<  1)) != 0;
+    feat->POPCNT = (ecx & (1U << 23)) != 0;
 
     feat->AVX    = (ecx & (1U << 28)) != 0;
     feat->FMA3   = (ecx & (1U << 12)) != 0;
@@ -415,8 +417,15 @@ struct features* get_features_info(struct cpuInfo* cpu) {
     eax = 0x00000007;
     ecx = 0x00000000;
     cpuid(&eax, &ebx, &ecx, &edx);
+    uint32_t max_subleaf = eax;
     feat->AVX2         = (ebx & (1U <<  5)) != 0;
     feat->SHA          = (ebx & (1U << 29)) != 0;
+    feat->ERMS         = (ebx & (1U <<  9)) != 0;
+    feat->FSRM         = (edx & (1U <<  4)) != 0;
+    feat->VAES         = (ecx & (1U <<  9)) != 0;
+    feat->BMI1         = (ebx & (1U <<  3)) != 0;
+    feat->BMI2         = (ebx & (1U <<  8)) != 0;
+    feat->AVX512BW     = (ebx & (1U << 30)) != 0;
     feat->AVX512       = (((ebx & (1U << 16)) != 0) ||
                         ((ebx & (1U << 28)) != 0)  ||
                         ((ebx & (1U << 26)) != 0)  ||
@@ -425,6 +434,14 @@ struct features* get_features_info(struct cpuInfo* cpu) {
                         ((ebx & (1U << 30)) != 0)  ||
                         ((ebx & (1U << 17)) != 0)  ||
                         ((ebx & (1U << 21)) != 0));
+
+    if(max_subleaf >= 1) {
+      eax = 0x00000007;
+      ecx = 0x00000001;
+      cpuid(&eax, &ebx, &ecx, &edx);
+      feat->FZRM = (eax & (1U << 10)) != 0;
+      feat->FSRS = (eax & (1U << 11)) != 0;
+    }
   }
   else {
     printWarn("Can't read features information from cpuid (needed level is 0x%.8X, max is 0x%.8X)", 0x00000007, cpu->maxLevels);
@@ -435,6 +452,7 @@ struct features* get_features_info(struct cpuInfo* cpu) {
     cpuid(&eax, &ebx, &ecx, &edx);
     feat->SSE4a = (ecx & (1U <<  6)) != 0;
     feat->FMA4  = (ecx & (1U << 16)) != 0;
+    feat->LZCNT = (ecx & (1U <<  5)) != 0;
   }
   else {
     printWarn("Can't read features information from cpuid (needed extended level is 0x%.8X, max is 0x%.8X)", 0x80000001, cpu->maxExtendedLevels);
@@ -907,12 +925,16 @@ struct cache* get_cache_info_amd_fallback(struct cache* cach) {
 
   cach->L1d->size = (ecx >> 24) * 1024;
   cach->L1i->size = (edx >> 24) * 1024;
+  cach->L1d->line_size = ecx & 0xFF;
+  cach->L1i->line_size = edx & 0xFF;
 
   eax = 0x80000006;
   cpuid(&eax, &ebx, &ecx, &edx);
 
   cach->L2->size = (ecx >> 16) * 1024;
   cach->L3->size = (edx >> 18) * 512 * 1024;
+  cach->L2->line_size = ecx & 0xFF;
+  cach->L3->line_size = edx & 0xFF;
 
   cach->L1i->exists = cach->L1i->size > 0;
   cach->L1d->exists = cach->L1d->size > 0;
@@ -963,6 +985,7 @@ struct cache* get_cache_info_general(struct cache* cach, uint32_t level) {
             return NULL;
           }
           cach->L1d->size = cache_total_size;
+          cach->L1d->line_size = cache_coherency_line_size;
           cach->L1d->exists = true;
           break;
 
@@ -972,16 +995,19 @@ struct cache* get_cache_info_general(struct cache* cach, uint32_t level) {
             return NULL;
           }
           cach->L1i->size = cache_total_size;
+          cach->L1i->line_size = cache_coherency_line_size;
           cach->L1i->exists = true;
           break;
 
         case 3: // Unified Cache (This may be L2 or L3)
           if(cache_level == 2) {
             cach->L2->size = cache_total_size;
+            cach->L2->line_size = cache_coherency_line_size;
             cach->L2->exists = true;
           }
           else if(cache_level == 3) {
             cach->L3->size = cache_total_size;
+            cach->L3->line_size = cache_coherency_line_size;
             cach->L3->exists = true;
           }
           else {
@@ -1041,6 +1067,139 @@ struct cache* get_cache_info(struct cpuInfo* cpu) {
   return cach;
 }
 
+#define MAX_TLB_LEVELS 32
+
+void add_tlb_level(struct tlb* tlb, int32_t level, int32_t type, uint32_t page_sizes, int32_t entries, int32_t ways) {
+  if(entries <= 0 || tlb->num_levels >= MAX_TLB_LEVELS) return;
+
+  struct tlb_level* t = &tlb->levels[tlb->num_levels++];
+  t->level = level;
+  t->type = type;
+  t->page_sizes = page_sizes;
+  t->entries = entries;
+  t->ways = ways;
+}
+
+// Intel deterministic address translation parameters (leaf 0x18)
+void get_tlb_info_intel(struct tlb* tlb) {
+  uint32_t eax = 0x00000018;
+  uint32_t ebx = 0;
+  uint32_t ecx = 0;
+  uint32_t edx = 0;
+
+  cpuid(&eax, &ebx, &ecx, &edx);
+  uint32_t max_subleaf = eax;
+
+  for(uint32_t i=0; i <= max_subleaf; i++) {
+    eax = 0x00000018;
+    ebx = 0;
+    ecx = i;
+    edx = 0;
+    cpuid(&eax, &ebx, &ecx, &edx);
+
+    uint32_t type = edx & 0x1F;
+    // Invalid subleaf, nothing to decode
+    if(type == 0) continue;
+
+    int32_t level = (edx >> 5) & 0x7;
+    bool fully_assoc = (edx >> 8) & 0x1;
+    uint32_t page_sizes = ebx & 0xF;
+    int32_t ways = (ebx >> 16) & 0xFFFF;
+    int32_t sets = ecx;
+
+    int32_t tlb_type;
+    switch(type) {
+      case 1: tlb_type = TLB_TYPE_DATA; break;
+      case 2: tlb_type = TLB_TYPE_INSTRUCTION; break;
+      case 3: tlb_type = TLB_TYPE_UNIFIED; break;
+      case 4: tlb_type = TLB_TYPE_LOAD; break;
+      case 5: tlb_type = TLB_TYPE_STORE; break;
+      default:
+        printWarn("Unknown TLB type %d found at subleaf %d", type, i);
+        continue;
+    }
+
+    add_tlb_level(tlb, level, tlb_type, page_sizes, ways * sets, fully_assoc ? 0 : ways);
+  }
+}
+
+// Decodes the associativity encoding used by 0x80000006 and 0x80000019
+int32_t get_amd_l2_tlb_ways(uint32_t assoc, int32_t entries) {
+  static const int32_t ways[16] = { 0, 1, 2, 3, 4, 6, 8, -1, 16, -1, 32, 48, 64, 96, 128, 0 };
+  if(assoc == 0xF) return 0;
+  if(ways[assoc] == -1) {
+    printWarn("Unknown TLB associativity encoding: 0x%X", assoc);
+    return entries;
+  }
+  return ways[assoc];
+}
+
+// AMD L1 and L2 TLB identifiers (0x80000005, 0x80000006 and 0x80000019)
+void get_tlb_info_amd(struct cpuInfo* cpu, struct tlb* tlb) {
+  uint32_t eax = 0x80000005;
+  uint32_t ebx = 0;
+  uint32_t ecx = 0;
+  uint32_t edx = 0;
+
+  cpuid(&eax, &ebx, &ecx, &edx);
+  // In L1, 0xFF means fully associative
+  add_tlb_level(tlb, 1, TLB_TYPE_DATA, TLB_PAGE_2M | TLB_PAGE_4M, (eax >> 16) & 0xFF, ((eax >> 24) & 0xFF) == 0xFF ? 0 : (eax >> 24) & 0xFF);
+  add_tlb_level(tlb, 1, TLB_TYPE_INSTRUCTION, TLB_PAGE_2M | TLB_PAGE_4M, eax & 0xFF, ((eax >> 8) & 0xFF) == 0xFF ? 0 : (eax >> 8) & 0xFF);
+  add_tlb_level(tlb, 1, TLB_TYPE_DATA, TLB_PAGE_4K, (ebx >> 16) & 0xFF, ((ebx >> 24) & 0xFF) == 0xFF ? 0 : (ebx >> 24) & 0xFF);
+  add_tlb_level(tlb, 1, TLB_TYPE_INSTRUCTION, TLB_PAGE_4K, ebx & 0xFF, ((ebx >> 8) & 0xFF) == 0xFF ? 0 : (ebx >> 8) & 0xFF);
+
+  if(cpu->maxExtendedLevels >= 0x80000006) {
+    eax = 0x80000006;
+    cpuid(&eax, &ebx, &ecx, &edx);
+    add_tlb_level(tlb, 2, TLB_TYPE_DATA, TLB_PAGE_2M | TLB_PAGE_4M, (eax >> 16) & 0xFFF, get_amd_l2_tlb_ways(eax >> 28, (eax >> 16) & 0xFFF));
+    add_tlb_level(tlb, 2, TLB_TYPE_INSTRUCTION, TLB_PAGE_2M | TLB_PAGE_4M, eax & 0xFFF, get_amd_l2_tlb_ways((eax >> 12) & 0xF, eax & 0xFFF));
+    add_tlb_level(tlb, 2, TLB_TYPE_DATA, TLB_PAGE_4K, (ebx >> 16) & 0xFFF, get_amd_l2_tlb_ways(ebx >> 28, (ebx >> 16) & 0xFFF));
+    add_tlb_level(tlb, 2, TLB_TYPE_INSTRUCTION, TLB_PAGE_4K, ebx & 0xFFF, get_amd_l2_tlb_ways((ebx >> 12) & 0xF, ebx & 0xFFF));
+  }
+
+  if(cpu->maxExtendedLevels >= 0x80000019) {
+    eax = 0x80000019;
+    cpuid(&eax, &ebx, &ecx, &edx);
+    add_tlb_level(tlb, 1, TLB_TYPE_DATA, TLB_PAGE_1G, (eax >> 16) & 0xFFF, get_amd_l2_tlb_ways(eax >> 28, (eax >> 16) & 0xFFF));
+    add_tlb_level(tlb, 1, TLB_TYPE_INSTRUCTION, TLB_PAGE_1G, eax & 0xFFF, get_amd_l2_tlb_ways((eax >> 12) & 0xF, eax & 0xFFF));
+    add_tlb_level(tlb, 2, TLB_TYPE_DATA, TLB_PAGE_1G, (ebx >> 16) & 0xFFF, get_amd_l2_tlb_ways(ebx >> 28, (ebx >> 16) & 0xFFF));
+    add_tlb_level(tlb, 2, TLB_TYPE_INSTRUCTION, TLB_PAGE_1G, ebx & 0xFFF, get_amd_l2_tlb_ways((ebx >> 12) & 0xF, ebx & 0xFFF));
+  }
+}
+
+// Returns the TLB geometry, or NULL if it could not be read.
+// Intel is only supported with leaf 0x18 (the legacy descriptors
+// of leaf 0x2 are not decoded).
+struct tlb* get_tlb_info(struct cpuInfo* cpu) {
+  struct tlb* tlb = emalloc(sizeof(struct tlb));
+  tlb->levels = emalloc(sizeof(struct tlb_level) * MAX_TLB_LEVELS);
+  tlb->num_levels = 0;
+
+  if(cpu->cpu_vendor == CPU_VENDOR_INTEL) {
+    if(cpu->maxLevels < 0x00000018) {
+      printWarn("Can't read TLB information from cpuid (needed level is 0x%.8X, max is 0x%.8X)", 0x00000018, cpu->maxLevels);
+      free_tlb_struct(tlb);
+      return NULL;
+    }
+    get_tlb_info_intel(tlb);
+  }
+  else {
+    if(cpu->maxExtendedLevels < 0x80000005) {
+      printWarn("Can't read TLB information from cpuid (needed extended level is 0x%.8X, max is 0x%.8X)", 0x80000005, cpu->maxExtendedLevels);
+      free_tlb_struct(tlb);
+      return NULL;
+    }
+    get_tlb_info_amd(cpu, tlb);
+  }
+
+  if(tlb->num_levels == 0) {
+    printWarn("cpuid did not report any TLB");
+    free_tlb_struct(tlb);
+    return NULL;
+  }
+  return tlb;
+}
+
 struct frequency* get_frequency_info(struct cpuInfo* cpu) {
   struct frequency* freq = emalloc(sizeof(struct frequency));
   freq->measured = false;
@@ -0,0 +1,28 @@
+#ifndef __CRYPTO_KERNELS__
+#define __CRYPTO_KERNELS__
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Crypto and checksum primitives used by the crypto benchmark. Each
+// file is compiled with the flags of the extension it uses, so these
+// must only be called if the CPU supports it. Sizes passed to the AES
+// and GHASH functions must be a multiple of 16 bytes. aes128_ctr_*
+// increments the last 32 bits of the counter block (as in GCM).
+
+// AES-NI + PCLMULQDQ
+void aes128_expand_key_aesni(const uint8_t* key, uint8_t* round_keys);
+void aes128_ctr_aesni(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n);
+void ghash_pclmul(const uint8_t* h, uint8_t* y, const uint8_t* in, size_t n);
+
+// VAES (256 bit)
+void aes128_ctr_vaes(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n);
+
+// SHA-NI
+void sha256_blocks_shani(uint32_t* state, const uint8_t* data, size_t nblocks);
+
+// SSE4.2 (+ PCLMULQDQ for the 3-way version)
+uint32_t crc32c_sse42(uint32_t crc, const uint8_t* data, size_t n);
+uint32_t crc32c_sse42_3way(uint32_t crc, const uint8_t* data, size_t n);
+
+#endif
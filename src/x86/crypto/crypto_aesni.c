@@ -0,0 +1,156 @@
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "crypto.h"
+
+#define AES_EXPAND_STEP(rk, i, rcon) rk[i] = aes128_expand_step(rk[i-1], _mm_aeskeygenassist_si128(rk[i-1], rcon))
+
+static inline __m128i aes128_expand_step(__m128i key, __m128i gen) {
+  gen = _mm_shuffle_epi32(gen, 0xFF);
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+  return _mm_xor_si128(key, gen);
+}
+
+void aes128_expand_key_aesni(const uint8_t* key, uint8_t* round_keys) {
+  __m128i rk[11];
+
+  rk[0] = _mm_loadu_si128((const __m128i *) key);
+  AES_EXPAND_STEP(rk,  1, 0x01);
+  AES_EXPAND_STEP(rk,  2, 0x02);
+  AES_EXPAND_STEP(rk,  3, 0x04);
+  AES_EXPAND_STEP(rk,  4, 0x08);
+  AES_EXPAND_STEP(rk,  5, 0x10);
+  AES_EXPAND_STEP(rk,  6, 0x20);
+  AES_EXPAND_STEP(rk,  7, 0x40);
+  AES_EXPAND_STEP(rk,  8, 0x80);
+  AES_EXPAND_STEP(rk,  9, 0x1B);
+  AES_EXPAND_STEP(rk, 10, 0x36);
+
+  for(int i=0; i < 11; i++) {
+    _mm_storeu_si128((__m128i *) (round_keys + 16*i), rk[i]);
+  }
+}
+
+static inline __m128i ctr_block(__m128i base, uint32_t ctr) {
+  return _mm_insert_epi32(base, (int) __builtin_bswap32(ctr), 3);
+}
+
+// 8 independent blocks per iteration to hide the latency of aesenc
+void aes128_ctr_aesni(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n) {
+  __m128i rk[11];
+  __m128i b[8];
+  __m128i base = _mm_loadu_si128((const __m128i *) ctr);
+  uint32_t c = __builtin_bswap32((uint32_t) _mm_extract_epi32(base, 3));
+
+  for(int i=0; i < 11; i++) rk[i] = _mm_loadu_si128((const __m128i *) (round_keys + 16*i));
+
+  for(; n >= 128; n -= 128, in += 128, out += 128, c += 8) {
+    for(int j=0; j < 8; j++) b[j] = _mm_xor_si128(ctr_block(base, c + j), rk[0]);
+    for(int r=1; r < 10; r++) {
+      for(int j=0; j < 8; j++) b[j] = _mm_aesenc_si128(b[j], rk[r]);
+    }
+    for(int j=0; j < 8; j++) {
+      b[j] = _mm_aesenclast_si128(b[j], rk[10]);
+      __m128i p = _mm_loadu_si128((const __m128i *) (in + 16*j));
+      _mm_storeu_si128((__m128i *) (out + 16*j), _mm_xor_si128(p, b[j]));
+    }
+  }
+
+  for(; n >= 16; n -= 16, in += 16, out += 16, c++) {
+    __m128i x = _mm_xor_si128(ctr_block(base, c), rk[0]);
+    for(int r=1; r < 10; r++) x = _mm_aesenc_si128(x, rk[r]);
+    x = _mm_aesenclast_si128(x, rk[10]);
+    __m128i p = _mm_loadu_si128((const __m128i *) in);
+    _mm_storeu_si128((__m128i *) out, _mm_xor_si128(p, x));
+  }
+}
+
+// GHASH works in a bit-reflected field. As in the Intel carry-less
+// multiplication white paper, the blocks are byte-reversed and the
+// 256 bit product is shifted left by one bit before the reduction.
+// The multiplication and the reduction are split, so that the products
+// of 4 blocks (by H^4..H) can be added and reduced only once.
+static inline void gf_mul_unreduced(__m128i a, __m128i b, __m128i* lo, __m128i* hi) {
+  __m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+  __m128i t1 = _mm_clmulepi64_si128(a, b, 0x10);
+  __m128i t2 = _mm_clmulepi64_si128(a, b, 0x01);
+  __m128i t3 = _mm_clmulepi64_si128(a, b, 0x11);
+
+  t1 = _mm_xor_si128(t1, t2);
+  *lo = _mm_xor_si128(t0, _mm_slli_si128(t1, 8));
+  *hi = _mm_xor_si128(t3, _mm_srli_si128(t1, 8));
+}
+
+static inline __m128i gf_reduce(__m128i lo, __m128i hi) {
+  __m128i t7 = _mm_srli_epi32(lo, 31);
+  __m128i t8 = _mm_srli_epi32(hi, 31);
+  lo = _mm_slli_epi32(lo, 1);
+  hi = _mm_slli_epi32(hi, 1);
+
+  __m128i t9 = _mm_srli_si128(t7, 12);
+  t8 = _mm_slli_si128(t8, 4);
+  t7 = _mm_slli_si128(t7, 4);
+  lo = _mm_or_si128(lo, t7);
+  hi = _mm_or_si128(hi, t8);
+  hi = _mm_or_si128(hi, t9);
+
+  t7 = _mm_slli_epi32(lo, 31);
+  t8 = _mm_slli_epi32(lo, 30);
+  t9 = _mm_slli_epi32(lo, 25);
+  t7 = _mm_xor_si128(t7, t8);
+  t7 = _mm_xor_si128(t7, t9);
+  t8 = _mm_srli_si128(t7, 4);
+  t7 = _mm_slli_si128(t7, 12);
+  lo = _mm_xor_si128(lo, t7);
+
+  __m128i t2 = _mm_srli_epi32(lo, 1);
+  __m128i t4 = _mm_srli_epi32(lo, 2);
+  __m128i t5 = _mm_srli_epi32(lo, 7);
+  t2 = _mm_xor_si128(t2, t4);
+  t2 = _mm_xor_si128(t2, t5);
+  t2 = _mm_xor_si128(t2, t8);
+  lo = _mm_xor_si128(lo, t2);
+  return _mm_xor_si128(hi, lo);
+}
+
+static inline __m128i gf_mul(__m128i a, __m128i b) {
+  __m128i lo;
+  __m128i hi;
+  gf_mul_unreduced(a, b, &lo, &hi);
+  return gf_reduce(lo, hi);
+}
+
+void ghash_pclmul(const uint8_t* h, uint8_t* y, const uint8_t* in, size_t n) {
+  const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m128i h1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) h), bswap);
+  __m128i h2 = gf_mul(h1, h1);
+  __m128i h3 = gf_mul(h2, h1);
+  __m128i h4 = gf_mul(h3, h1);
+  __m128i x = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) y), bswap);
+
+  for(; n >= 64; n -= 64, in += 64) {
+    __m128i b0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in +  0)), bswap);
+    __m128i b1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + 16)), bswap);
+    __m128i b2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + 32)), bswap);
+    __m128i b3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (in + 48)), bswap);
+    __m128i lo, hi, l, m;
+
+    gf_mul_unreduced(_mm_xor_si128(x, b0), h4, &lo, &hi);
+    gf_mul_unreduced(b1, h3, &l, &m);
+    lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, m);
+    gf_mul_unreduced(b2, h2, &l, &m);
+    lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, m);
+    gf_mul_unreduced(b3, h1, &l, &m);
+    lo = _mm_xor_si128(lo, l); hi = _mm_xor_si128(hi, m);
+    x = gf_reduce(lo, hi);
+  }
+
+  for(; n >= 16; n -= 16, in += 16) {
+    __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) in), bswap);
+    x = gf_mul(_mm_xor_si128(x, b), h1);
+  }
+
+  _mm_storeu_si128((__m128i *) y, _mm_shuffle_epi8(x, bswap));
+}
@@ -0,0 +1,73 @@
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "crypto.h"
+
+// Bytes processed by each of the 3 streams per iteration
+#define CRC_BLOCK  1024
+// x^(8*CRC_BLOCK-33) and x^(16*CRC_BLOCK-33) mod P (bit-reflected),
+// used to shift the CRC of a stream over the bytes of the next ones
+#define CRC_K1     0x170076FA
+#define CRC_K2     0xA51B6135
+
+#ifdef __x86_64__
+  #define CRC_WORD   uint64_t
+  #define crc32_word _mm_crc32_u64
+#else
+  #define CRC_WORD   uint32_t
+  #define crc32_word _mm_crc32_u32
+#endif
+
+uint32_t crc32c_sse42(uint32_t crc, const uint8_t* data, size_t n) {
+  CRC_WORD c = crc;
+  CRC_WORD w;
+
+  for(; n >= sizeof(w); n -= sizeof(w), data += sizeof(w)) {
+    memcpy(&w, data, sizeof(w));
+    c = crc32_word(c, w);
+  }
+
+  crc = (uint32_t) c;
+  for(; n > 0; n--, data++) crc = _mm_crc32_u8(crc, *data);
+  return crc;
+}
+
+// crc * x^(8*len) mod P, where k = x^(8*len-33) mod P. The product is
+// 63 bits long and the crc32 instruction multiplies it by x^32 (plus
+// one more, due to the bit reflection) and reduces it
+static inline uint32_t crc32c_shift(uint32_t crc, uint32_t k) {
+  __m128i p = _mm_clmulepi64_si128(_mm_cvtsi32_si128((int) crc), _mm_cvtsi32_si128((int) k), 0x00);
+#ifdef __x86_64__
+  return (uint32_t) _mm_crc32_u64(0, (uint64_t) _mm_cvtsi128_si64(p));
+#else
+  uint32_t lo = (uint32_t) _mm_cvtsi128_si32(p);
+  uint32_t hi = (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(p, 4));
+  return _mm_crc32_u32(_mm_crc32_u32(0, lo), hi);
+#endif
+}
+
+// crc32 has a latency of 3 cycles but a throughput of 1 per cycle, so
+// 3 independent streams are needed to use the whole throughput
+uint32_t crc32c_sse42_3way(uint32_t crc, const uint8_t* data, size_t n) {
+  CRC_WORD w0, w1, w2;
+
+  for(; n >= 3 * CRC_BLOCK; n -= 3 * CRC_BLOCK, data += 3 * CRC_BLOCK) {
+    CRC_WORD c0 = crc;
+    CRC_WORD c1 = 0;
+    CRC_WORD c2 = 0;
+
+    for(size_t i=0; i < CRC_BLOCK; i += sizeof(CRC_WORD)) {
+      memcpy(&w0, data + i, sizeof(CRC_WORD));
+      memcpy(&w1, data + CRC_BLOCK + i, sizeof(CRC_WORD));
+      memcpy(&w2, data + 2 * CRC_BLOCK + i, sizeof(CRC_WORD));
+      c0 = crc32_word(c0, w0);
+      c1 = crc32_word(c1, w1);
+      c2 = crc32_word(c2, w2);
+    }
+
+    crc = crc32c_shift((uint32_t) c0, CRC_K2) ^ crc32c_shift((uint32_t) c1, CRC_K1) ^ (uint32_t) c2;
+  }
+
+  return crc32c_sse42(crc, data, n);
+}
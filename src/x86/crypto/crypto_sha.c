@@ -0,0 +1,63 @@
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "crypto.h"
+
+static const uint32_t sha256_k[64] = {
+  0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+  0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+  0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+  0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+  0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+  0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+  0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+  0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2
+};
+
+// sha256rnds2 works with the state split in ABEF and CDGH. Each group
+// of 4 rounds g uses the message words in m[g%4], computes the next
+// ones (sha256msg1/sha256msg2) and runs 2+2 rounds. It is a macro so
+// that every index and condition is a constant (m stays in registers).
+#define SHA256_GROUP(g) do {                                                                   \
+  if((g) < 4) m[(g)%4] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *) (data + 16*(g))), bswap); \
+  __m128i msg = _mm_add_epi32(m[(g)%4], _mm_loadu_si128((const __m128i *) &sha256_k[4*(g)])); \
+  s1 = _mm_sha256rnds2_epu32(s1, s0, msg);                                                     \
+  if((g) >= 3 && (g) <= 14) {                                                                  \
+    tmp = _mm_alignr_epi8(m[(g)%4], m[((g)+3)%4], 4);                                          \
+    m[((g)+1)%4] = _mm_sha256msg2_epu32(_mm_add_epi32(m[((g)+1)%4], tmp), m[(g)%4]);           \
+  }                                                                                            \
+  msg = _mm_shuffle_epi32(msg, 0x0E);                                                          \
+  s0 = _mm_sha256rnds2_epu32(s0, s1, msg);                                                     \
+  if((g) >= 1 && (g) <= 12) m[((g)+3)%4] = _mm_sha256msg1_epu32(m[((g)+3)%4], m[(g)%4]);       \
+} while(0)
+
+void sha256_blocks_shani(uint32_t* state, const uint8_t* data, size_t nblocks) {
+  const __m128i bswap = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+  __m128i m[4];
+
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[0]), 0xB1);
+  __m128i s1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *) &state[4]), 0x1B);
+  __m128i s0 = _mm_alignr_epi8(tmp, s1, 8);
+  s1 = _mm_blend_epi16(s1, tmp, 0xF0);
+
+  for(; nblocks > 0; nblocks--, data += 64) {
+    __m128i abef = s0;
+    __m128i cdgh = s1;
+
+    SHA256_GROUP(0);  SHA256_GROUP(1);  SHA256_GROUP(2);  SHA256_GROUP(3);
+    SHA256_GROUP(4);  SHA256_GROUP(5);  SHA256_GROUP(6);  SHA256_GROUP(7);
+    SHA256_GROUP(8);  SHA256_GROUP(9);  SHA256_GROUP(10); SHA256_GROUP(11);
+    SHA256_GROUP(12); SHA256_GROUP(13); SHA256_GROUP(14); SHA256_GROUP(15);
+
+    s0 = _mm_add_epi32(s0, abef);
+    s1 = _mm_add_epi32(s1, cdgh);
+  }
+
+  tmp = _mm_shuffle_epi32(s0, 0x1B);
+  s1 = _mm_shuffle_epi32(s1, 0xB1);
+  s0 = _mm_blend_epi16(tmp, s1, 0xF0);
+  s1 = _mm_alignr_epi8(s1, tmp, 8);
+
+  _mm_storeu_si128((__m128i *) &state[0], s0);
+  _mm_storeu_si128((__m128i *) &state[4], s1);
+}
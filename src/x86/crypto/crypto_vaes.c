@@ -0,0 +1,41 @@
+#include <stdint.h>
+#include <immintrin.h>
+
+#include "crypto.h"
+
+static inline __m256i ctr_blocks(__m128i base, uint32_t ctr) {
+  __m128i lo = _mm_insert_epi32(base, (int) __builtin_bswap32(ctr), 3);
+  __m128i hi = _mm_insert_epi32(base, (int) __builtin_bswap32(ctr + 1), 3);
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+}
+
+// Same as aes128_ctr_aesni, but with two blocks per register
+// (16 blocks per iteration)
+void aes128_ctr_vaes(const uint8_t* round_keys, const uint8_t* ctr, const uint8_t* in, uint8_t* out, size_t n) {
+  __m256i rk[11];
+  __m256i b[8];
+  __m128i base = _mm_loadu_si128((const __m128i *) ctr);
+  uint32_t c = __builtin_bswap32((uint32_t) _mm_extract_epi32(base, 3));
+
+  for(int i=0; i < 11; i++) {
+    rk[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *) (round_keys + 16*i)));
+  }
+
+  for(; n >= 256; n -= 256, in += 256, out += 256, c += 16) {
+    for(int j=0; j < 8; j++) b[j] = _mm256_xor_si256(ctr_blocks(base, c + 2*j), rk[0]);
+    for(int r=1; r < 10; r++) {
+      for(int j=0; j < 8; j++) b[j] = _mm256_aesenc_epi128(b[j], rk[r]);
+    }
+    for(int j=0; j < 8; j++) {
+      b[j] = _mm256_aesenclast_epi128(b[j], rk[10]);
+      __m256i p = _mm256_loadu_si256((const __m256i *) (in + 32*j));
+      _mm256_storeu_si256((__m256i *) (out + 32*j), _mm256_xor_si256(p, b[j]));
+    }
+  }
+
+  if(n > 0) {
+    uint8_t next[16];
+    _mm_storeu_si128((__m128i *) next, _mm_insert_epi32(base, (int) __builtin_bswap32(c), 3));
+    aes128_ctr_aesni(round_keys, next, in, out, n);
+  }
+}
@@ -0,0 +1,28 @@
+#ifndef __GATHER_KERNELS__
+#define __GATHER_KERNELS__
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Gather, scatter and masked load/store kernels used by the gather
+// benchmark. Each one lives in a file compiled with the corresponding
+// flags and must only be called if the CPU supports it. AVX2 has no
+// scatter instruction, so only AVX-512 provides scatter kernels.
+//
+// gather:  returns the (wrapping) sum of table[idx[i]]
+// scatter: table[idx[i]] = val[i]
+// masked:  dst[i] = src[i] for every i where mask[i] is not zero
+
+uint32_t gather32_avx2(const int32_t* table, const int32_t* idx, size_t n);
+uint64_t gather64_avx2(const int64_t* table, const int64_t* idx, size_t n);
+void masked32_avx2(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n);
+void masked64_avx2(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n);
+
+uint32_t gather32_avx512(const int32_t* table, const int32_t* idx, size_t n);
+uint64_t gather64_avx512(const int64_t* table, const int64_t* idx, size_t n);
+void scatter32_avx512(int32_t* table, const int32_t* idx, const int32_t* val, size_t n);
+void scatter64_avx512(int64_t* table, const int64_t* idx, const int64_t* val, size_t n);
+void masked32_avx512(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n);
+void masked64_avx512(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n);
+
+#endif
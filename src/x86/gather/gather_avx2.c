@@ -0,0 +1,77 @@
+#include <immintrin.h>
+
+#include "gather.h"
+
+// Two independent accumulators, so that the latency of the gathers
+// is not hidden behind a single dependency chain
+uint32_t gather32_avx2(const int32_t* table, const int32_t* idx, size_t n) {
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for(; i + 16 <= n; i += 16) {
+    __m256i i0 = _mm256_loadu_si256((const __m256i *) (idx + i));
+    __m256i i1 = _mm256_loadu_si256((const __m256i *) (idx + i + 8));
+    acc0 = _mm256_add_epi32(acc0, _mm256_i32gather_epi32((const int *) table, i0, 4));
+    acc1 = _mm256_add_epi32(acc1, _mm256_i32gather_epi32((const int *) table, i1, 4));
+  }
+
+  uint32_t lanes[8];
+  _mm256_storeu_si256((__m256i *) lanes, _mm256_add_epi32(acc0, acc1));
+  uint32_t sum = 0;
+  for(int l=0; l < 8; l++) sum += lanes[l];
+  for(; i < n; i++) sum += (uint32_t) table[idx[i]];
+  return sum;
+}
+
+uint64_t gather64_avx2(const int64_t* table, const int64_t* idx, size_t n) {
+  __m256i acc0 = _mm256_setzero_si256();
+  __m256i acc1 = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for(; i + 8 <= n; i += 8) {
+    __m256i i0 = _mm256_loadu_si256((const __m256i *) (idx + i));
+    __m256i i1 = _mm256_loadu_si256((const __m256i *) (idx + i + 4));
+    acc0 = _mm256_add_epi64(acc0, _mm256_i64gather_epi64((const long long *) table, i0, 8));
+    acc1 = _mm256_add_epi64(acc1, _mm256_i64gather_epi64((const long long *) table, i1, 8));
+  }
+
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i *) lanes, _mm256_add_epi64(acc0, acc1));
+  uint64_t sum = 0;
+  for(int l=0; l < 4; l++) sum += lanes[l];
+  for(; i < n; i++) sum += (uint64_t) table[idx[i]];
+  return sum;
+}
+
+// vpmaskmov only looks at the sign bit of each mask element,
+// so the mask is normalized to all ones / all zeros first
+void masked32_avx2(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n) {
+  __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for(; i + 8 <= n; i += 8) {
+    __m256i m = _mm256_loadu_si256((const __m256i *) (mask + i));
+    m = _mm256_xor_si256(_mm256_cmpeq_epi32(m, zero), _mm256_set1_epi32(-1));
+    __m256i v = _mm256_maskload_epi32((const int *) (src + i), m);
+    _mm256_maskstore_epi32((int *) (dst + i), m, v);
+  }
+  for(; i < n; i++) {
+    if(mask[i]) dst[i] = src[i];
+  }
+}
+
+void masked64_avx2(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n) {
+  __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for(; i + 4 <= n; i += 4) {
+    __m256i m = _mm256_loadu_si256((const __m256i *) (mask + i));
+    m = _mm256_xor_si256(_mm256_cmpeq_epi64(m, zero), _mm256_set1_epi64x(-1));
+    __m256i v = _mm256_maskload_epi64((const long long *) (src + i), m);
+    _mm256_maskstore_epi64((long long *) (dst + i), m, v);
+  }
+  for(; i < n; i++) {
+    if(mask[i]) dst[i] = src[i];
+  }
+}
@@ -0,0 +1,89 @@
+#include <immintrin.h>
+
+#include "gather.h"
+
+uint32_t gather32_avx512(const int32_t* table, const int32_t* idx, size_t n) {
+  __m512i acc0 = _mm512_setzero_si512();
+  __m512i acc1 = _mm512_setzero_si512();
+  size_t i = 0;
+
+  for(; i + 32 <= n; i += 32) {
+    __m512i i0 = _mm512_loadu_si512((const void *) (idx + i));
+    __m512i i1 = _mm512_loadu_si512((const void *) (idx + i + 16));
+    acc0 = _mm512_add_epi32(acc0, _mm512_i32gather_epi32(i0, (const void *) table, 4));
+    acc1 = _mm512_add_epi32(acc1, _mm512_i32gather_epi32(i1, (const void *) table, 4));
+  }
+
+  uint32_t sum = (uint32_t) _mm512_reduce_add_epi32(_mm512_add_epi32(acc0, acc1));
+  for(; i < n; i++) sum += (uint32_t) table[idx[i]];
+  return sum;
+}
+
+uint64_t gather64_avx512(const int64_t* table, const int64_t* idx, size_t n) {
+  __m512i acc0 = _mm512_setzero_si512();
+  __m512i acc1 = _mm512_setzero_si512();
+  size_t i = 0;
+
+  for(; i + 16 <= n; i += 16) {
+    __m512i i0 = _mm512_loadu_si512((const void *) (idx + i));
+    __m512i i1 = _mm512_loadu_si512((const void *) (idx + i + 8));
+    acc0 = _mm512_add_epi64(acc0, _mm512_i64gather_epi64(i0, (const void *) table, 8));
+    acc1 = _mm512_add_epi64(acc1, _mm512_i64gather_epi64(i1, (const void *) table, 8));
+  }
+
+  uint64_t sum = (uint64_t) _mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1));
+  for(; i < n; i++) sum += (uint64_t) table[idx[i]];
+  return sum;
+}
+
+// Lanes of a scatter that hit the same index are written in lane
+// order, which matches the scalar loop
+void scatter32_avx512(int32_t* table, const int32_t* idx, const int32_t* val, size_t n) {
+  size_t i = 0;
+
+  for(; i + 16 <= n; i += 16) {
+    __m512i vi = _mm512_loadu_si512((const void *) (idx + i));
+    __m512i v = _mm512_loadu_si512((const void *) (val + i));
+    _mm512_i32scatter_epi32((void *) table, vi, v, 4);
+  }
+  for(; i < n; i++) table[idx[i]] = val[i];
+}
+
+void scatter64_avx512(int64_t* table, const int64_t* idx, const int64_t* val, size_t n) {
+  size_t i = 0;
+
+  for(; i + 8 <= n; i += 8) {
+    __m512i vi = _mm512_loadu_si512((const void *) (idx + i));
+    __m512i v = _mm512_loadu_si512((const void *) (val + i));
+    _mm512_i64scatter_epi64((void *) table, vi, v, 8);
+  }
+  for(; i < n; i++) table[idx[i]] = val[i];
+}
+
+void masked32_avx512(int32_t* dst, const int32_t* src, const int32_t* mask, size_t n) {
+  size_t i = 0;
+
+  for(; i + 16 <= n; i += 16) {
+    __m512i m = _mm512_loadu_si512((const void *) (mask + i));
+    __mmask16 k = _mm512_test_epi32_mask(m, m);
+    __m512i v = _mm512_maskz_loadu_epi32(k, (const void *) (src + i));
+    _mm512_mask_storeu_epi32((void *) (dst + i), k, v);
+  }
+  for(; i < n; i++) {
+    if(mask[i]) dst[i] = src[i];
+  }
+}
+
+void masked64_avx512(int64_t* dst, const int64_t* src, const int64_t* mask, size_t n) {
+  size_t i = 0;
+
+  for(; i + 8 <= n; i += 8) {
+    __m512i m = _mm512_loadu_si512((const void *) (mask + i));
+    __mmask8 k = _mm512_test_epi64_mask(m, m);
+    __m512i v = _mm512_maskz_loadu_epi64(k, (const void *) (src + i));
+    _mm512_mask_storeu_epi64((void *) (dst + i), k, v);
+  }
+  for(; i < n; i++) {
+    if(mask[i]) dst[i] = src[i];
+  }
+}
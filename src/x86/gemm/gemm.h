@@ -0,0 +1,25 @@
+#ifndef __GEMM_KERNELS__
+#define __GEMM_KERNELS__
+
+#include <stddef.h>
+
+// Register-blocked microkernels of the GEMM benchmark. The AVX2 and
+// AVX-512 versions live in their own files, compiled with the
+// corresponding flags, and must only be called if the CPU supports them.
+//
+// Each kernel computes C += A * B on a MR x NR tile of C (row major,
+// with leading dimension ldc), where A is a MR x kc panel packed by
+// columns (MR consecutive elements for each k) and B is a kc x NR panel
+// packed by rows (NR consecutive elements for each k). The tile is two
+// vectors wide, so NR is twice the number of elements of a vector.
+
+#define GEMM_MR_AVX2    6
+#define GEMM_MR_AVX512  8
+
+void sgemm_avx2(int kc, const float* a, const float* b, float* c, size_t ldc);
+void dgemm_avx2(int kc, const double* a, const double* b, double* c, size_t ldc);
+
+void sgemm_avx512(int kc, const float* a, const float* b, float* c, size_t ldc);
+void dgemm_avx512(int kc, const double* a, const double* b, double* c, size_t ldc);
+
+#endif
@@ -0,0 +1,63 @@
+#include <immintrin.h>
+
+#include "gemm.h"
+
+// The 6x2 tile keeps 12 accumulators, the two B vectors and the
+// broadcast A element in the 16 YMM registers. 12 independent FMAs
+// per k are enough to cover the FMA latency on two ports.
+
+#define SGEMM_LOAD(i) \
+  __m256 c##i##0 = _mm256_loadu_ps(c + i*ldc); \
+  __m256 c##i##1 = _mm256_loadu_ps(c + i*ldc + 8);
+
+#define SGEMM_ROW(i) \
+  ai = _mm256_broadcast_ss(a + i); \
+  c##i##0 = _mm256_fmadd_ps(ai, b0, c##i##0); \
+  c##i##1 = _mm256_fmadd_ps(ai, b1, c##i##1);
+
+#define SGEMM_STORE(i) \
+  _mm256_storeu_ps(c + i*ldc, c##i##0); \
+  _mm256_storeu_ps(c + i*ldc + 8, c##i##1);
+
+void sgemm_avx2(int kc, const float* a, const float* b, float* c, size_t ldc) {
+  SGEMM_LOAD(0) SGEMM_LOAD(1) SGEMM_LOAD(2) SGEMM_LOAD(3) SGEMM_LOAD(4) SGEMM_LOAD(5)
+  __m256 ai, b0, b1;
+
+  for(int p=0; p < kc; p++) {
+    b0 = _mm256_loadu_ps(b);
+    b1 = _mm256_loadu_ps(b + 8);
+    SGEMM_ROW(0) SGEMM_ROW(1) SGEMM_ROW(2) SGEMM_ROW(3) SGEMM_ROW(4) SGEMM_ROW(5)
+    a += GEMM_MR_AVX2;
+    b += 16;
+  }
+
+  SGEMM_STORE(0) SGEMM_STORE(1) SGEMM_STORE(2) SGEMM_STORE(3) SGEMM_STORE(4) SGEMM_STORE(5)
+}
+
+#define DGEMM_LOAD(i) \
+  __m256d c##i##0 = _mm256_loadu_pd(c + i*ldc); \
+  __m256d c##i##1 = _mm256_loadu_pd(c + i*ldc + 4);
+
+#define DGEMM_ROW(i) \
+  ai = _mm256_broadcast_sd(a + i); \
+  c##i##0 = _mm256_fmadd_pd(ai, b0, c##i##0); \
+  c##i##1 = _mm256_fmadd_pd(ai, b1, c##i##1);
+
+#define DGEMM_STORE(i) \
+  _mm256_storeu_pd(c + i*ldc, c##i##0); \
+  _mm256_storeu_pd(c + i*ldc + 4, c##i##1);
+
+void dgemm_avx2(int kc, const double* a, const double* b, double* c, size_t ldc) {
+  DGEMM_LOAD(0) DGEMM_LOAD(1) DGEMM_LOAD(2) DGEMM_LOAD(3) DGEMM_LOAD(4) DGEMM_LOAD(5)
+  __m256d ai, b0, b1;
+
+  for(int p=0; p < kc; p++) {
+    b0 = _mm256_loadu_pd(b);
+    b1 = _mm256_loadu_pd(b + 4);
+    DGEMM_ROW(0) DGEMM_ROW(1) DGEMM_ROW(2) DGEMM_ROW(3) DGEMM_ROW(4) DGEMM_ROW(5)
+    a += GEMM_MR_AVX2;
+    b += 8;
+  }
+
+  DGEMM_STORE(0) DGEMM_STORE(1) DGEMM_STORE(2) DGEMM_STORE(3) DGEMM_STORE(4) DGEMM_STORE(5)
+}
@@ -0,0 +1,69 @@
+#include <immintrin.h>
+
+#include "gemm.h"
+
+// The 8x2 tile uses 16 of the 32 ZMM registers as accumulators. The
+// broadcasts are folded into the FMAs as memory operands, so each k
+// only needs two explicit loads for the B vectors.
+
+#define SGEMM_LOAD(i) \
+  __m512 c##i##0 = _mm512_loadu_ps(c + i*ldc); \
+  __m512 c##i##1 = _mm512_loadu_ps(c + i*ldc + 16);
+
+#define SGEMM_ROW(i) \
+  ai = _mm512_set1_ps(a[i]); \
+  c##i##0 = _mm512_fmadd_ps(ai, b0, c##i##0); \
+  c##i##1 = _mm512_fmadd_ps(ai, b1, c##i##1);
+
+#define SGEMM_STORE(i) \
+  _mm512_storeu_ps(c + i*ldc, c##i##0); \
+  _mm512_storeu_ps(c + i*ldc + 16, c##i##1);
+
+void sgemm_avx512(int kc, const float* a, const float* b, float* c, size_t ldc) {
+  SGEMM_LOAD(0) SGEMM_LOAD(1) SGEMM_LOAD(2) SGEMM_LOAD(3)
+  SGEMM_LOAD(4) SGEMM_LOAD(5) SGEMM_LOAD(6) SGEMM_LOAD(7)
+  __m512 ai, b0, b1;
+
+  for(int p=0; p < kc; p++) {
+    b0 = _mm512_loadu_ps(b);
+    b1 = _mm512_loadu_ps(b + 16);
+    SGEMM_ROW(0) SGEMM_ROW(1) SGEMM_ROW(2) SGEMM_ROW(3)
+    SGEMM_ROW(4) SGEMM_ROW(5) SGEMM_ROW(6) SGEMM_ROW(7)
+    a += GEMM_MR_AVX512;
+    b += 32;
+  }
+
+  SGEMM_STORE(0) SGEMM_STORE(1) SGEMM_STORE(2) SGEMM_STORE(3)
+  SGEMM_STORE(4) SGEMM_STORE(5) SGEMM_STORE(6) SGEMM_STORE(7)
+}
+
+#define DGEMM_LOAD(i) \
+  __m512d c##i##0 = _mm512_loadu_pd(c + i*ldc); \
+  __m512d c##i##1 = _mm512_loadu_pd(c + i*ldc + 8);
+
+#define DGEMM_ROW(i) \
+  ai = _mm512_set1_pd(a[i]); \
+  c##i##0 = _mm512_fmadd_pd(ai, b0, c##i##0); \
+  c##i##1 = _mm512_fmadd_pd(ai, b1, c##i##1);
+
+#define DGEMM_STORE(i) \
+  _mm512_storeu_pd(c + i*ldc, c##i##0); \
+  _mm512_storeu_pd(c + i*ldc + 8, c##i##1);
+
+void dgemm_avx512(int kc, const double* a, const double* b, double* c, size_t ldc) {
+  DGEMM_LOAD(0) DGEMM_LOAD(1) DGEMM_LOAD(2) DGEMM_LOAD(3)
+  DGEMM_LOAD(4) DGEMM_LOAD(5) DGEMM_LOAD(6) DGEMM_LOAD(7)
+  __m512d ai, b0, b1;
+
+  for(int p=0; p < kc; p++) {
+    b0 = _mm512_loadu_pd(b);
+    b1 = _mm512_loadu_pd(b + 8);
+    DGEMM_ROW(0) DGEMM_ROW(1) DGEMM_ROW(2) DGEMM_ROW(3)
+    DGEMM_ROW(4) DGEMM_ROW(5) DGEMM_ROW(6) DGEMM_ROW(7)
+    a += GEMM_MR_AVX512;
+    b += 16;
+  }
+
+  DGEMM_STORE(0) DGEMM_STORE(1) DGEMM_STORE(2) DGEMM_STORE(3)
+  DGEMM_STORE(4) DGEMM_STORE(5) DGEMM_STORE(6) DGEMM_STORE(7)
+}
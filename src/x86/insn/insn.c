@@ -0,0 +1,248 @@
+#include <stddef.h>
+
+#include "insn.h"
+
+enum {
+  ISA_BASE,
+  ISA_POPCNT,
+  ISA_LZCNT,
+  ISA_BMI1,
+  ISA_BMI2,
+  ISA_SSE2,
+  ISA_SSSE3,
+  ISA_SSE4_1,
+  ISA_AVX,
+  ISA_AVX2,
+  ISA_FMA3,
+  ISA_AVX512F,
+  ISA_AVX512BW
+};
+
+#ifdef __x86_64__
+
+// Constants loaded in the 8th and 9th vector registers (ones and
+// zeros). FP kernels keep every chain at exactly 1.0 (x+0, x*1,
+// x/1, sqrt(x), x+0*0), so no denormal or special value shows up
+static const double ones_pd[8] __attribute__((aligned(64))) = { 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 };
+static const float ones_ps[16] __attribute__((aligned(64))) = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+                                                               1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+#define REP4(x)  x x x x
+#define REP8(x)  REP4(x) REP4(x)
+#define REP32(x) REP8(x) REP8(x) REP8(x) REP8(x)
+
+// Registers of each chain: r8-r15 for integer kernels and 0-7 for
+// vector kernels, with the constants in 8 and 9
+#define Q_0 "%%r8"
+#define Q_1 "%%r9"
+#define Q_2 "%%r10"
+#define Q_3 "%%r11"
+#define Q_4 "%%r12"
+#define Q_5 "%%r13"
+#define Q_6 "%%r14"
+#define Q_7 "%%r15"
+#define Q(n) Q_##n
+#define X(n) "%%xmm" #n
+#define Y(n) "%%ymm" #n
+#define Z(n) "%%zmm" #n
+
+#define LAT_BODY(OP, ins, s, R)  REP32(OP(ins, s, R, 0))
+#define TPUT_BODY(OP, ins, s, R) REP4(OP(ins, s, R, 0) OP(ins, s, R, 1) OP(ins, s, R, 2) OP(ins, s, R, 3) \
+                                      OP(ins, s, R, 4) OP(ins, s, R, 5) OP(ins, s, R, 6) OP(ins, s, R, 7))
+
+// Operand forms (AT&T syntax, destination last). The chain always goes
+// through the destination register d, and s is the constant source
+#define OP1(ins, s, R, d)   ins " " R(d) ", " R(d) "\n\t"
+#define OP2(ins, s, R, d)   ins " " R(s) ", " R(d) "\n\t"
+#define OP3(ins, s, R, d)   ins " " R(s) ", " R(d) ", " R(d) "\n\t"
+#define OPFMA(ins, s, R, d) ins " " R(s) ", " R(s) ", " R(d) "\n\t"
+#define OPPERM(ins, s, R, d) ins " " R(d) ", " R(s) ", " R(d) "\n\t"
+#define OPIMM2(ins, s, R, d) ins " $0x1b, " R(s) ", " R(d) "\n\t"
+#define OPIMM3(ins, s, R, d) ins " $0x1b, " R(s) ", " R(d) ", " R(d) "\n\t"
+#define GPR1(ins, s, R, d)  ins " " R(d) ", " R(d) "\n\t"
+#define GPR2(ins, s, R, d)  ins " " s ", " R(d) "\n\t"
+#define GPR3(ins, s, R, d)  ins " " s ", " R(d) ", " R(d) "\n\t"
+// div has implicit operands, so the latency chain goes through rax and
+// each instance of the throughput kernel divides the value of a chain
+#define DIV_LAT(ins, s, R, d)  "xor %%edx, %%edx\n\t" ins " " s "\n\t"
+#define DIV_TPUT(ins, s, R, d) "mov " R(d) ", %%rax\n\t" "xor %%edx, %%edx\n\t" ins " " s "\n\t"
+
+#define LOOP_BEGIN "1:\n\t"
+#define LOOP_END   "dec %0\n\t" "jnz 1b\n\t"
+
+#define GPR_CLOBBERS "rax", "rdx", "rsi", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "r15", "cc"
+#define GPR_INIT \
+  "mov $1, %%rsi\n\t" "mov %1, %%rax\n\t" \
+  "mov %1, %%r8\n\t" "mov %1, %%r9\n\t" "mov %1, %%r10\n\t" "mov %1, %%r11\n\t" \
+  "mov %1, %%r12\n\t" "mov %1, %%r13\n\t" "mov %1, %%r14\n\t" "mov %1, %%r15\n\t"
+
+#define VEC_CLOBBERS "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7", "xmm8", "xmm9", "cc", "memory"
+#define VEC_MOVS(mov, R) \
+  mov " " R(8) ", " R(0) "\n\t" mov " " R(8) ", " R(1) "\n\t" mov " " R(8) ", " R(2) "\n\t" mov " " R(8) ", " R(3) "\n\t" \
+  mov " " R(8) ", " R(4) "\n\t" mov " " R(8) ", " R(5) "\n\t" mov " " R(8) ", " R(6) "\n\t" mov " " R(8) ", " R(7) "\n\t"
+#define INIT_X "movups (%1), %%xmm8\n\t" "xorps %%xmm9, %%xmm9\n\t" VEC_MOVS("movaps", X)
+#define INIT_Y "vmovups (%1), %%ymm8\n\t" "vxorps %%ymm9, %%ymm9, %%ymm9\n\t" VEC_MOVS("vmovaps", Y)
+#define INIT_Z "vmovups (%1), %%zmm8\n\t" "vpxord %%zmm9, %%zmm9, %%zmm9\n\t" VEC_MOVS("vmovaps", Z)
+#define END_X ""
+#define END_Y "vzeroupper\n\t"
+#define END_Z "vzeroupper\n\t"
+
+#define GPR_KERNELS(name, LAT, TPUT, ins, s, init)                                 \
+  static void name##_lat(uint64_t iters) {                                         \
+    __asm volatile(GPR_INIT LOOP_BEGIN LAT_BODY(LAT, ins, s, Q) LOOP_END           \
+                   : "+r"(iters) : "r"((uint64_t) (init)) : GPR_CLOBBERS);          \
+  }                                                                                \
+  static void name##_tput(uint64_t iters) {                                        \
+    __asm volatile(GPR_INIT LOOP_BEGIN TPUT_BODY(TPUT, ins, s, Q) LOOP_END         \
+                   : "+r"(iters) : "r"((uint64_t) (init)) : GPR_CLOBBERS);          \
+  }
+
+#define VEC_KERNELS(name, OP, ins, s, R, ones)                                     \
+  static void name##_lat(uint64_t iters) {                                         \
+    __asm volatile(INIT_##R LOOP_BEGIN LAT_BODY(OP, ins, s, R) LOOP_END END_##R    \
+                   : "+r"(iters) : "r"(ones) : VEC_CLOBBERS);                       \
+  }                                                                                \
+  static void name##_tput(uint64_t iters) {                                        \
+    __asm volatile(INIT_##R LOOP_BEGIN TPUT_BODY(OP, ins, s, R) LOOP_END END_##R   \
+                   : "+r"(iters) : "r"(ones) : VEC_CLOBBERS);                       \
+  }
+
+// Integer (div keeps the dividend constant by dividing by one)
+GPR_KERNELS(add_r64,    GPR2,    GPR2,     "add",    "%%rsi", 3)
+GPR_KERNELS(imul_r64,   GPR2,    GPR2,     "imul",   "%%rsi", 3)
+GPR_KERNELS(div_r32,    DIV_LAT, DIV_TPUT, "div",    "%%esi", 0x12345678)
+GPR_KERNELS(div_r64,    DIV_LAT, DIV_TPUT, "div",    "%%rsi", 0x123456789ABCDEF)
+GPR_KERNELS(popcnt_r64, GPR1,    GPR1,     "popcnt", "",      3)
+GPR_KERNELS(lzcnt_r64,  GPR1,    GPR1,     "lzcnt",  "",      3)
+GPR_KERNELS(tzcnt_r64,  GPR1,    GPR1,     "tzcnt",  "",      3)
+GPR_KERNELS(pdep_r64,   GPR3,    GPR3,     "pdep",   "%%rsi", 3)
+
+// Floating point
+VEC_KERNELS(addsd_x,       OP2,   "addsd",        9, X, ones_pd)
+VEC_KERNELS(addpd_x,       OP2,   "addpd",        9, X, ones_pd)
+VEC_KERNELS(vaddpd_y,      OP3,   "vaddpd",       9, Y, ones_pd)
+VEC_KERNELS(vaddpd_z,      OP3,   "vaddpd",       9, Z, ones_pd)
+VEC_KERNELS(mulsd_x,       OP2,   "mulsd",        8, X, ones_pd)
+VEC_KERNELS(mulpd_x,       OP2,   "mulpd",        8, X, ones_pd)
+VEC_KERNELS(vmulpd_y,      OP3,   "vmulpd",       8, Y, ones_pd)
+VEC_KERNELS(vmulpd_z,      OP3,   "vmulpd",       8, Z, ones_pd)
+VEC_KERNELS(vfmadd231sd_x, OPFMA, "vfmadd231sd",  9, X, ones_pd)
+VEC_KERNELS(vfmadd231pd_x, OPFMA, "vfmadd231pd",  9, X, ones_pd)
+VEC_KERNELS(vfmadd231pd_y, OPFMA, "vfmadd231pd",  9, Y, ones_pd)
+VEC_KERNELS(vfmadd231pd_z, OPFMA, "vfmadd231pd",  9, Z, ones_pd)
+VEC_KERNELS(divss_x,       OP2,   "divss",        8, X, ones_ps)
+VEC_KERNELS(divps_x,       OP2,   "divps",        8, X, ones_ps)
+VEC_KERNELS(vdivps_y,      OP3,   "vdivps",       8, Y, ones_ps)
+VEC_KERNELS(vdivps_z,      OP3,   "vdivps",       8, Z, ones_ps)
+VEC_KERNELS(divsd_x,       OP2,   "divsd",        8, X, ones_pd)
+VEC_KERNELS(divpd_x,       OP2,   "divpd",        8, X, ones_pd)
+VEC_KERNELS(vdivpd_y,      OP3,   "vdivpd",       8, Y, ones_pd)
+VEC_KERNELS(vdivpd_z,      OP3,   "vdivpd",       8, Z, ones_pd)
+VEC_KERNELS(sqrtss_x,      OP1,   "sqrtss",       0, X, ones_ps)
+VEC_KERNELS(sqrtps_x,      OP1,   "sqrtps",       0, X, ones_ps)
+VEC_KERNELS(vsqrtps_y,     OP1,   "vsqrtps",      0, Y, ones_ps)
+VEC_KERNELS(vsqrtps_z,     OP1,   "vsqrtps",      0, Z, ones_ps)
+VEC_KERNELS(sqrtsd_x,      OP1,   "sqrtsd",       0, X, ones_pd)
+VEC_KERNELS(sqrtpd_x,      OP1,   "sqrtpd",       0, X, ones_pd)
+VEC_KERNELS(vsqrtpd_y,     OP1,   "vsqrtpd",      0, Y, ones_pd)
+VEC_KERNELS(vsqrtpd_z,     OP1,   "vsqrtpd",      0, Z, ones_pd)
+
+// Vector integer and shuffles
+VEC_KERNELS(paddd_x,       OP2,    "paddd",       9, X, ones_pd)
+VEC_KERNELS(vpaddd_y,      OP3,    "vpaddd",      9, Y, ones_pd)
+VEC_KERNELS(vpaddd_z,      OP3,    "vpaddd",      9, Z, ones_pd)
+VEC_KERNELS(pmulld_x,      OP2,    "pmulld",      8, X, ones_pd)
+VEC_KERNELS(vpmulld_y,     OP3,    "vpmulld",     8, Y, ones_pd)
+VEC_KERNELS(vpmulld_z,     OP3,    "vpmulld",     8, Z, ones_pd)
+VEC_KERNELS(shufps_x,      OPIMM2, "shufps",      9, X, ones_ps)
+VEC_KERNELS(vshufps_y,     OPIMM3, "vshufps",     9, Y, ones_ps)
+VEC_KERNELS(vshufps_z,     OPIMM3, "vshufps",     9, Z, ones_ps)
+VEC_KERNELS(pshufb_x,      OP2,    "pshufb",      9, X, ones_ps)
+VEC_KERNELS(vpshufb_y,     OP3,    "vpshufb",     9, Y, ones_ps)
+VEC_KERNELS(vpshufb_z,     OP3,    "vpshufb",     9, Z, ones_ps)
+VEC_KERNELS(vpermps_y,     OPPERM, "vpermps",     9, Y, ones_ps)
+VEC_KERNELS(vpermps_z,     OPPERM, "vpermps",     9, Z, ones_ps)
+
+#define INSN(name, str, isa) { str, isa, name##_lat, name##_tput }
+
+const struct insn_test insn_tests[] = {
+  INSN(add_r64,       "add r64",           ISA_BASE),
+  INSN(imul_r64,      "imul r64",          ISA_BASE),
+  INSN(div_r32,       "div r32",           ISA_BASE),
+  INSN(div_r64,       "div r64",           ISA_BASE),
+  INSN(popcnt_r64,    "popcnt r64",        ISA_POPCNT),
+  INSN(lzcnt_r64,     "lzcnt r64",         ISA_LZCNT),
+  INSN(tzcnt_r64,     "tzcnt r64",         ISA_BMI1),
+  INSN(pdep_r64,      "pdep r64",          ISA_BMI2),
+  INSN(addsd_x,       "addsd xmm",         ISA_SSE2),
+  INSN(addpd_x,       "addpd xmm",         ISA_SSE2),
+  INSN(vaddpd_y,      "vaddpd ymm",        ISA_AVX),
+  INSN(vaddpd_z,      "vaddpd zmm",        ISA_AVX512F),
+  INSN(mulsd_x,       "mulsd xmm",         ISA_SSE2),
+  INSN(mulpd_x,       "mulpd xmm",         ISA_SSE2),
+  INSN(vmulpd_y,      "vmulpd ymm",        ISA_AVX),
+  INSN(vmulpd_z,      "vmulpd zmm",        ISA_AVX512F),
+  INSN(vfmadd231sd_x, "vfmadd231sd xmm",   ISA_FMA3),
+  INSN(vfmadd231pd_x, "vfmadd231pd xmm",   ISA_FMA3),
+  INSN(vfmadd231pd_y, "vfmadd231pd ymm",   ISA_FMA3),
+  INSN(vfmadd231pd_z, "vfmadd231pd zmm",   ISA_AVX512F),
+  INSN(divss_x,       "divss xmm",         ISA_SSE2),
+  INSN(divps_x,       "divps xmm",         ISA_SSE2),
+  INSN(vdivps_y,      "vdivps ymm",        ISA_AVX),
+  INSN(vdivps_z,      "vdivps zmm",        ISA_AVX512F),
+  INSN(divsd_x,       "divsd xmm",         ISA_SSE2),
+  INSN(divpd_x,       "divpd xmm",         ISA_SSE2),
+  INSN(vdivpd_y,      "vdivpd ymm",        ISA_AVX),
+  INSN(vdivpd_z,      "vdivpd zmm",        ISA_AVX512F),
+  INSN(sqrtss_x,      "sqrtss xmm",        ISA_SSE2),
+  INSN(sqrtps_x,      "sqrtps xmm",        ISA_SSE2),
+  INSN(vsqrtps_y,     "vsqrtps ymm",       ISA_AVX),
+  INSN(vsqrtps_z,     "vsqrtps zmm",       ISA_AVX512F),
+  INSN(sqrtsd_x,      "sqrtsd xmm",        ISA_SSE2),
+  INSN(sqrtpd_x,      "sqrtpd xmm",        ISA_SSE2),
+  INSN(vsqrtpd_y,     "vsqrtpd ymm",       ISA_AVX),
+  INSN(vsqrtpd_z,     "vsqrtpd zmm",       ISA_AVX512F),
+  INSN(paddd_x,       "paddd xmm",         ISA_SSE2),
+  INSN(vpaddd_y,      "vpaddd ymm",        ISA_AVX2),
+  INSN(vpaddd_z,      "vpaddd zmm",        ISA_AVX512F),
+  INSN(pmulld_x,      "pmulld xmm",        ISA_SSE4_1),
+  INSN(vpmulld_y,     "vpmulld ymm",       ISA_AVX2),
+  INSN(vpmulld_z,     "vpmulld zmm",       ISA_AVX512F),
+  INSN(shufps_x,      "shufps xmm",        ISA_SSE2),
+  INSN(vshufps_y,     "vshufps ymm",       ISA_AVX),
+  INSN(vshufps_z,     "vshufps zmm",       ISA_AVX512F),
+  INSN(pshufb_x,      "pshufb xmm",        ISA_SSSE3),
+  INSN(vpshufb_y,     "vpshufb ymm",       ISA_AVX2),
+  INSN(vpshufb_z,     "vpshufb zmm",       ISA_AVX512BW),
+  INSN(vpermps_y,     "vpermps ymm",       ISA_AVX2),
+  INSN(vpermps_z,     "vpermps zmm",       ISA_AVX512F),
+};
+
+const int insn_num_tests = sizeof(insn_tests) / sizeof(insn_tests[0]);
+
+#else
+
+// The kernels use the registers of x86_64
+const struct insn_test insn_tests[] = { { "", ISA_BASE, NULL, NULL } };
+const int insn_num_tests = 0;
+
+#endif // #ifdef __x86_64__
+
+bool insn_supported(struct features* feat, int isa) {
+  switch(isa) {
+    case ISA_BASE:     return true;
+    case ISA_POPCNT:   return feat->POPCNT;
+    case ISA_LZCNT:    return feat->LZCNT;
+    case ISA_BMI1:     return feat->BMI1;
+    case ISA_BMI2:     return feat->BMI2;
+    case ISA_SSE2:     return feat->SSE2;
+    case ISA_SSSE3:    return feat->SSSE3;
+    case ISA_SSE4_1:   return feat->SSE4_1;
+    case ISA_AVX:      return feat->AVX;
+    case ISA_AVX2:     return feat->AVX2;
+    case ISA_FMA3:     return feat->FMA3;
+    case ISA_AVX512F:  return feat->AVX512;
+    case ISA_AVX512BW: return feat->AVX512BW;
+    default:           return false;
+  }
+}
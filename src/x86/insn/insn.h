@@ -0,0 +1,34 @@
+#ifndef __INSN_KERNELS__
+#define __INSN_KERNELS__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../common/cpu.h"
+
+// Kernels used by the instruction latency/throughput table. Each kernel
+// runs INSN_PER_ITER instances of the instruction per iteration: the
+// latency one as a single dependency chain and the throughput one as
+// INSN_CHAINS independent chains. They are written in inline assembly,
+// so they do not need any special compiler flag, but must only be
+// called if insn_supported returns true for the CPU. The first test
+// is always the integer add, whose latency is one cycle in every core.
+
+#define INSN_PER_ITER  32
+#define INSN_CHAINS     8
+
+typedef void (*insn_fn)(uint64_t iters);
+
+struct insn_test {
+  const char* name;
+  int isa;
+  insn_fn lat;
+  insn_fn tput;
+};
+
+extern const struct insn_test insn_tests[];
+extern const int insn_num_tests;
+
+bool insn_supported(struct features* feat, int isa);
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "pmu.h"
+#include "cpuid_asm.h"
+#include "../common/global.h"
+
+// Architectural events of leaf 0xA (EBX), in bit order
+const char* pmu_arch_events[PMU_NUM_ARCH_EVENTS] = {
+  "cycles",
+  "instructions",
+  "ref-cycles",
+  "llc-references",
+  "llc-misses",
+  "branches",
+  "branch-misses",
+  "topdown-slots"
+};
+
+void get_pmu_info_intel(struct cpuInfo* cpu, struct pmu* pmu) {
+  uint32_t eax, ebx, ecx, edx;
+
+  if(cpu->maxLevels < 0x0000000A) {
+    printWarn("Can't read PMU information from cpuid (needed level is 0x%.8X, max is 0x%.8X)", 0x0000000A, cpu->maxLevels);
+    return;
+  }
+
+  eax = 0x00000001;
+  ecx = 0x00000000;
+  cpuid(&eax, &ebx, &ecx, &edx);
+  pmu->ds   = (edx & (1U << 21)) != 0;
+  pmu->pdcm = (ecx & (1U << 15)) != 0;
+
+  eax = 0x0000000A;
+  ecx = 0x00000000;
+  cpuid(&eax, &ebx, &ecx, &edx);
+  pmu->version  = eax & 0xFF;
+  pmu->num_gp   = (eax >> 8) & 0xFF;
+  pmu->gp_width = (eax >> 16) & 0xFF;
+  // A set bit in EBX means that the event is NOT available
+  uint32_t ebx_len = (eax >> 24) & 0xFF;
+  for(uint32_t i=0; i < ebx_len && i < PMU_NUM_ARCH_EVENTS; i++) {
+    if((ebx & (1U << i)) == 0) pmu->events |= 1U << i;
+  }
+  if(pmu->version > 1) {
+    pmu->num_fixed   = edx & 0x1F;
+    pmu->fixed_width = (edx >> 5) & 0xFF;
+  }
+
+  eax = 0x00000007;
+  ecx = 0x00000000;
+  cpuid(&eax, &ebx, &ecx, &edx);
+  pmu->arch_lbr = (edx & (1U << 19)) != 0;
+
+  if(pmu->arch_lbr && cpu->maxLevels >= 0x0000001C) {
+    eax = 0x0000001C;
+    ecx = 0x00000000;
+    cpuid(&eax, &ebx, &ecx, &edx);
+    // Bit n set means that a depth of 8*(n+1) is supported
+    for(int i=7; i >= 0; i--) {
+      if(eax & (1U << i)) {
+        pmu->lbr_depth = 8 * (i+1);
+        break;
+      }
+    }
+  }
+}
+
+void get_pmu_info_amd(struct cpuInfo* cpu, struct pmu* pmu) {
+  uint32_t eax, ebx, ecx, edx;
+
+  // Legacy counters (K7 onwards)
+  pmu->num_gp = 4;
+  pmu->gp_width = 48;
+
+  if(cpu->maxExtendedLevels < 0x80000001) {
+    printWarn("Can't read PMU information from cpuid (needed extended level is 0x%.8X, max is 0x%.8X)", 0x80000001, cpu->maxExtendedLevels);
+    return;
+  }
+
+  eax = 0x80000001;
+  ecx = 0x00000000;
+  cpuid(&eax, &ebx, &ecx, &edx);
+  pmu->ibs = (ecx & (1U << 10)) != 0;
+  if(ecx & (1U << 23)) pmu->num_gp = 6;
+  if(ecx & (1U << 24)) pmu->num_nb = 4;
+  if(ecx & (1U << 28)) pmu->num_llc = 6;
+
+  if(cpu->maxExtendedLevels >= 0x80000022) {
+    eax = 0x80000022;
+    ecx = 0x00000000;
+    cpuid(&eax, &ebx, &ecx, &edx);
+    pmu->perfmon_v2 = (eax & (1U << 0)) != 0;
+    if(pmu->perfmon_v2) {
+      pmu->num_gp = ebx & 0xF;
+      pmu->lbr_depth = (ebx >> 4) & 0x3F;
+      pmu->num_nb = (ebx >> 10) & 0x3F;
+    }
+  }
+}
+
+// Decodes the performance monitoring leaves of the CPU where the
+// caller is running (counters may differ between P and E cores).
+// See Intel SDM Vol. 3B, chapter 20 and AMD APM Vol. 2, chapter 13
+struct pmu* get_pmu_info(struct cpuInfo* cpu) {
+  struct pmu* pmu = ecalloc(1, sizeof(struct pmu));
+
+  if(cpu->cpu_vendor == CPU_VENDOR_INTEL)
+    get_pmu_info_intel(cpu, pmu);
+  else if(cpu->cpu_vendor == CPU_VENDOR_AMD || cpu->cpu_vendor == CPU_VENDOR_HYGON)
+    get_pmu_info_amd(cpu, pmu);
+
+  return pmu;
+}
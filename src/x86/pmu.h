@@ -0,0 +1,33 @@
+#ifndef __PMU__
+#define __PMU__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpuid.h"
+
+#define PMU_NUM_ARCH_EVENTS 8
+
+// Performance monitoring capabilities reported by cpuid
+struct pmu {
+  uint32_t version;      // Intel architectural perfmon version (0 if none)
+  uint32_t num_gp;       // General-purpose counters per logical CPU
+  uint32_t gp_width;
+  uint32_t num_fixed;    // Fixed-function counters
+  uint32_t fixed_width;
+  uint32_t events;       // Available architectural events (bitmask)
+  bool ds;               // Debug store, needed by PEBS and BTS
+  bool pdcm;             // Perfmon and debug capability MSR
+  bool arch_lbr;
+  uint32_t lbr_depth;    // 0 if unknown
+  bool perfmon_v2;       // AMD
+  bool ibs;              // AMD instruction based sampling
+  uint32_t num_nb;       // AMD northbridge/data fabric counters
+  uint32_t num_llc;      // AMD L3 counters
+};
+
+extern const char* pmu_arch_events[PMU_NUM_ARCH_EVENTS];
+
+struct pmu* get_pmu_info(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,110 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "rdt.h"
+#include "cpuid_asm.h"
+#include "../common/global.h"
+
+#define RDT_L3_RES   1
+#define RDT_L2_RES   2
+#define RDT_MBA_RES  3
+
+static void get_cat_info(struct rdt_cat* cat, uint32_t subleaf) {
+  uint32_t eax = 0x00000010;
+  uint32_t ebx = 0;
+  uint32_t ecx = subleaf;
+  uint32_t edx = 0;
+  cpuid(&eax, &ebx, &ecx, &edx);
+
+  cat->supported     = true;
+  cat->cbm_len       = (eax & 0x1F) + 1;
+  cat->shareable     = ebx;
+  cat->cdp           = (ecx & (1U << 2)) != 0;
+  cat->noncontiguous = (ecx & (1U << 3)) != 0;
+  cat->num_clos      = (edx & 0xFFFF) + 1;
+}
+
+// Decodes the Intel RDT / AMD PQoS leaves. See Intel SDM Vol. 3B,
+// chapter 18.18-19 and AMD Platform Quality of Service Extensions
+struct rdt* get_rdt_info(struct cpuInfo* cpu) {
+  struct rdt* rdt = ecalloc(1, sizeof(struct rdt));
+  uint32_t eax, ebx, ecx, edx;
+
+  if(cpu->maxLevels < 0x00000007) {
+    printWarn("Can't read RDT information from cpuid (needed level is 0x%.8X, max is 0x%.8X)", 0x00000007, cpu->maxLevels);
+    return rdt;
+  }
+
+  eax = 0x00000007;
+  ecx = 0x00000000;
+  cpuid(&eax, &ebx, &ecx, &edx);
+  bool rdt_m = (ebx & (1U << 12)) != 0; // PQM on AMD
+  bool rdt_a = (ebx & (1U << 15)) != 0; // PQE on AMD
+
+  if(rdt_m && cpu->maxLevels >= 0x0000000F) {
+    eax = 0x0000000F;
+    ecx = 0x00000000;
+    cpuid(&eax, &ebx, &ecx, &edx);
+
+    // Only the L3 is monitored for now (EDX bit 1)
+    if(edx & (1U << 1)) {
+      eax = 0x0000000F;
+      ecx = 0x00000001;
+      cpuid(&eax, &ebx, &ecx, &edx);
+
+      rdt->monitoring    = true;
+      rdt->upscale       = ebx;
+      rdt->num_rmids     = ecx + 1;
+      rdt->llc_occupancy = (edx & (1U << 0)) != 0;
+      rdt->mbm_total     = (edx & (1U << 1)) != 0;
+      rdt->mbm_local     = (edx & (1U << 2)) != 0;
+      // The counter width is given as an offset from 24 bits
+      if(cpu->cpu_vendor == CPU_VENDOR_INTEL && (eax & 0xFF) != 0)
+        rdt->counter_width = 24 + (eax & 0xFF);
+    }
+  }
+
+  if(rdt_a && cpu->maxLevels >= 0x00000010) {
+    eax = 0x00000010;
+    ecx = 0x00000000;
+    cpuid(&eax, &ebx, &ecx, &edx);
+    bool l3 = (ebx & (1U << RDT_L3_RES)) != 0;
+    bool l2 = (ebx & (1U << RDT_L2_RES)) != 0;
+    bool mba = (ebx & (1U << RDT_MBA_RES)) != 0;
+
+    if(l3) get_cat_info(&rdt->l3, RDT_L3_RES);
+    if(l2) get_cat_info(&rdt->l2, RDT_L2_RES);
+
+    if(mba && cpu->cpu_vendor == CPU_VENDOR_INTEL) {
+      eax = 0x00000010;
+      ecx = RDT_MBA_RES;
+      cpuid(&eax, &ebx, &ecx, &edx);
+      rdt->mba        = true;
+      rdt->mba_max    = (eax & 0xFFF) + 1;
+      rdt->mba_linear = (ecx & (1U << 2)) != 0;
+      rdt->mba_clos   = (edx & 0xFFFF) + 1;
+    }
+  }
+
+  // AMD reports bandwidth enforcement in 0x80000008 EBX bit 6
+  // and describes it in 0x80000020 (subleaf 1)
+  if(rdt_a && (cpu->cpu_vendor == CPU_VENDOR_AMD || cpu->cpu_vendor == CPU_VENDOR_HYGON) && cpu->maxExtendedLevels >= 0x80000020) {
+    eax = 0x80000008;
+    ecx = 0x00000000;
+    cpuid(&eax, &ebx, &ecx, &edx);
+
+    if(ebx & (1U << 6)) {
+      eax = 0x80000020;
+      ecx = 0x00000001;
+      cpuid(&eax, &ebx, &ecx, &edx);
+      rdt->mba          = true;
+      rdt->mba_absolute = true;
+      rdt->mba_max      = 1U << (eax & 0x1F);
+      rdt->mba_clos     = (edx & 0xFFFF) + 1;
+    }
+  }
+
+  rdt->allocation = rdt->l3.supported || rdt->l2.supported || rdt->mba;
+  return rdt;
+}
@@ -0,0 +1,44 @@
+#ifndef __RDT__
+#define __RDT__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cpuid.h"
+
+// Cache allocation (CAT) of one cache level
+struct rdt_cat {
+  bool supported;
+  uint32_t cbm_len;      // Bits in the capacity bitmask
+  uint32_t num_clos;     // Classes of service
+  uint32_t shareable;    // Bits shared with other agents (e.g., I/O)
+  bool cdp;              // Code and data prioritization
+  bool noncontiguous;    // Non-contiguous bitmasks are allowed
+};
+
+// Intel Resource Director Technology (RDT) or AMD Platform
+// Quality of Service (PQoS), as reported by cpuid
+struct rdt {
+  // Monitoring (leaf 0xF)
+  bool monitoring;
+  uint32_t num_rmids;
+  uint32_t upscale;       // Bytes per counter unit
+  uint32_t counter_width; // 0 if unknown
+  bool llc_occupancy;
+  bool mbm_total;
+  bool mbm_local;
+
+  // Allocation (leaf 0x10, and 0x80000020 on AMD)
+  bool allocation;
+  struct rdt_cat l3;
+  struct rdt_cat l2;
+  bool mba;
+  uint32_t mba_clos;
+  uint32_t mba_max;       // Max throttling (%) or max bandwidth (AMD)
+  bool mba_linear;
+  bool mba_absolute;      // AMD: limits are given in 1/8 GB/s units
+};
+
+struct rdt* get_rdt_info(struct cpuInfo* cpu);
+
+#endif
@@ -0,0 +1,35 @@
+#include <stdio.h>
+
+#include "retpoline.h"
+#include "../../common/global.h"
+
+// This file is built with -mindirect-branch=thunk (GCC) or -mretpoline
+// (clang), so that every indirect call goes through a retpoline, like
+// in a kernel built with CONFIG_MITIGATION_RETPOLINE. The kernel is
+// shared with run_ibranch in common/mitigations.c
+#ifdef RETPOLINE_THUNK
+
+#include "../../common/ibranchkernel.h"
+
+bool retpoline_compiled(void) {
+  return true;
+}
+
+uint64_t run_ibranch_retpoline(const uint8_t* seq, uint64_t iters) {
+  return ibranch_kernel(seq, iters);
+}
+
+#else
+
+bool retpoline_compiled(void) {
+  return false;
+}
+
+uint64_t run_ibranch_retpoline(const uint8_t* seq, uint64_t iters) {
+  UNUSED(seq);
+  UNUSED(iters);
+  printBug("run_ibranch_retpoline: cpufetch was built without retpoline support");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef __RETPOLINE__
+#define __RETPOLINE__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../../common/mitigations.h"
+
+bool retpoline_compiled(void);
+uint64_t run_ibranch_retpoline(const uint8_t* seq, uint64_t iters);
+
+#endif